@@ -0,0 +1,276 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+#include <CamEncoder/av_video.h>
+#include <CamEncoder/av_packet_pool.h>
+#include <CamEncoder/av_cam_codec/av_cam_codec.h>
+#include "benchmark_utilities.h"
+#include <string>
+#include <vector>
+
+// warm up frames, used to fill the packet pool before we start counting allocations.
+constexpr auto warmup_frame_count = 30;
+
+static av_packet_pool &get_packet_pool(const av_video &video)
+{
+    auto *context = static_cast<CamStudioContext *>(video.get_codec_context()->priv_data);
+    return *context->packet_pool;
+}
+
+/*!
+ * Encode synthetic desktop frames with the camstudio codec, and report the packet buffer
+ * allocations per frame in steady state (after warm up).
+ */
+static void benchmark_cam_codec_encode(benchmark::State &state)
+{
+    const auto width = static_cast<int>(state.range(0));
+    const auto height = static_cast<int>(state.range(1));
+    synthetic_desktop desktop(width, height);
+
+    av_video_meta meta;
+    meta.codec = video::codec::camstudio;
+    meta.bpp = 32;
+    meta.width = width;
+    meta.height = height;
+    meta.fps = {30, 1};
+
+    av_video_codec config;
+    config.pixel_format = AV_PIX_FMT_BGRA;
+
+    av_video video(config, meta);
+    av_dict dict;
+    video.open(nullptr, dict);
+
+    AVPacket *pkt = av_packet_alloc();
+    int frame_index = 0;
+    int64_t total_bytes = 0;
+
+    const auto encode_frame = [&]()
+    {
+        video.push_encode_frame(frame_index, desktop.render(frame_index), width, height, desktop.stride());
+        ++frame_index;
+
+        for (bool valid_packet = true; valid_packet;)
+        {
+            if (!video.pull_encoded_packet(pkt, &valid_packet) || !valid_packet)
+                break;
+            total_bytes += pkt->size;
+            av_packet_unref(pkt);
+        }
+    };
+
+    for (int i = 0; i < warmup_frame_count; ++i)
+        encode_frame();
+
+    const auto &pool = get_packet_pool(video);
+    const auto warmup_allocations = pool.get_allocation_count();
+    total_bytes = 0;
+
+    for (auto _ : state)
+        encode_frame();
+
+    const auto allocations = pool.get_allocation_count() - warmup_allocations;
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(desktop.stride()) * height);
+    state.counters["allocs_per_frame"] = benchmark::Counter(static_cast<double>(allocations),
+        benchmark::Counter::kAvgIterations);
+    state.counters["packet_bytes"] = benchmark::Counter(static_cast<double>(total_bytes),
+        benchmark::Counter::kAvgIterations);
+
+    av_packet_free(&pkt);
+}
+
+BENCHMARK(benchmark_cam_codec_encode)
+    ->Args({1920, 1080})
+    ->Args({3840, 2160})
+    ->Unit(benchmark::kMillisecond);
+
+// the synthetic desktop corpus, every corpus starts with a keyframe.
+constexpr auto corpus_frame_count = 50;
+
+static AVCodecContext *create_cam_codec_encoder(int width, int height, const benchmark::State &state)
+{
+    AVCodecContext *context = avcodec_alloc_context3(&cam_codec_encoder);
+    context->width = width;
+    context->height = height;
+    context->pix_fmt = AV_PIX_FMT_BGR0;
+    context->time_base = {1, 30};
+
+    const auto level = state.range(1);
+    av_opt_set_int(context->priv_data, "algorithm", state.range(0), 0);
+    av_opt_set_int(context->priv_data, "gzip_level", level, 0);
+    av_opt_set_int(context->priv_data, "lz4_level", level, 0);
+    av_opt_set_int(context->priv_data, "zstd_level", level, 0);
+    av_opt_set_int(context->priv_data, "zstd_long", state.range(2), 0);
+    av_opt_set_int(context->priv_data, "autokeyframe_rate", corpus_frame_count, 0);
+
+    if (avcodec_open2(context, &cam_codec_encoder, nullptr) < 0)
+        avcodec_free_context(&context);
+
+    return context;
+}
+
+static AVFrame *create_corpus_frame(synthetic_desktop &desktop)
+{
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_PIX_FMT_BGR0;
+    frame->width = desktop.width();
+    frame->height = desktop.height();
+    av_frame_get_buffer(frame, 1);
+    return frame;
+}
+
+static void render_corpus_frame(synthetic_desktop &desktop, AVFrame *frame, int index)
+{
+    av_image_copy_plane(frame->data[0], frame->linesize[0], desktop.render(index), desktop.stride(),
+        desktop.stride(), desktop.height());
+}
+
+static void set_compression_label(benchmark::State &state)
+{
+    constexpr const char *algorithm_names[] = {"lzo", "gzip", "lz4", "zstd"};
+    auto label = std::string(algorithm_names[state.range(0)]) + "-" + std::to_string(state.range(1));
+    if (state.range(2) != 0)
+        label += "-long";
+    state.SetLabel(label);
+}
+
+/*!
+ * Encode the synthetic desktop corpus with every compression algorithm, and report the compression
+ * ratio next to the encode speed.
+ */
+static void benchmark_cam_codec_compression(benchmark::State &state)
+{
+    constexpr auto width = 1920;
+    constexpr auto height = 1080;
+    synthetic_desktop desktop(width, height);
+
+    AVCodecContext *context = create_cam_codec_encoder(width, height, state);
+    if (context == nullptr)
+    {
+        state.SkipWithError("unable to open the camstudio encoder");
+        return;
+    }
+
+    AVFrame *frame = create_corpus_frame(desktop);
+    AVPacket *pkt = av_packet_alloc();
+    int frame_index = 0;
+    int64_t packet_bytes = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        render_corpus_frame(desktop, frame, frame_index % corpus_frame_count);
+        frame->pts = frame_index++;
+        state.ResumeTiming();
+
+        avcodec_send_frame(context, frame);
+        if (avcodec_receive_packet(context, pkt) == 0)
+        {
+            packet_bytes += pkt->size;
+            av_packet_unref(pkt);
+        }
+    }
+
+    const auto raw_bytes = state.iterations() * static_cast<int64_t>(desktop.stride()) * height;
+    set_compression_label(state);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(raw_bytes);
+    state.counters["ratio"] = static_cast<double>(raw_bytes) / std::max<int64_t>(packet_bytes, 1);
+
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&context);
+}
+
+/*!
+ * Decode the synthetic desktop corpus, the corpus is encoded once up front.
+ */
+static void benchmark_cam_codec_decompression(benchmark::State &state)
+{
+    constexpr auto width = 1920;
+    constexpr auto height = 1080;
+    synthetic_desktop desktop(width, height);
+
+    AVCodecContext *encoder = create_cam_codec_encoder(width, height, state);
+    if (encoder == nullptr)
+    {
+        state.SkipWithError("unable to open the camstudio encoder");
+        return;
+    }
+
+    AVFrame *frame = create_corpus_frame(desktop);
+    std::vector<AVPacket *> corpus;
+    for (int i = 0; i < corpus_frame_count; ++i)
+    {
+        render_corpus_frame(desktop, frame, i);
+        frame->pts = i;
+        AVPacket *pkt = av_packet_alloc();
+        avcodec_send_frame(encoder, frame);
+        avcodec_receive_packet(encoder, pkt);
+        corpus.push_back(pkt);
+    }
+
+    AVCodecContext *decoder = avcodec_alloc_context3(&cam_codec_decoder);
+    decoder->width = width;
+    decoder->height = height;
+    decoder->bits_per_coded_sample = encoder->bits_per_coded_sample;
+    avcodec_open2(decoder, &cam_codec_decoder, nullptr);
+
+    int frame_index = 0;
+    for (auto _ : state)
+    {
+        avcodec_send_packet(decoder, corpus[frame_index++ % corpus_frame_count]);
+        if (avcodec_receive_frame(decoder, frame) == 0)
+            av_frame_unref(frame);
+    }
+
+    set_compression_label(state);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(desktop.stride()) * height);
+
+    for (auto *pkt : corpus)
+        av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&decoder);
+    avcodec_free_context(&encoder);
+}
+
+// algorithm, level, long range.
+static void compression_matrix(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->Args({CSCD_ALGORITHM_LZO, 0, 0});
+    benchmark->Args({CSCD_ALGORITHM_GZIP, 1, 0});
+    benchmark->Args({CSCD_ALGORITHM_GZIP, 6, 0});
+    benchmark->Args({CSCD_ALGORITHM_GZIP, 9, 0});
+    benchmark->Args({CSCD_ALGORITHM_LZ4, 0, 0});
+    benchmark->Args({CSCD_ALGORITHM_LZ4, 9, 0});
+    benchmark->Args({CSCD_ALGORITHM_ZSTD, 1, 0});
+    benchmark->Args({CSCD_ALGORITHM_ZSTD, 3, 0});
+    benchmark->Args({CSCD_ALGORITHM_ZSTD, 3, 1});
+    benchmark->Args({CSCD_ALGORITHM_ZSTD, 9, 0});
+    benchmark->Args({CSCD_ALGORITHM_ZSTD, 19, 1});
+}
+
+BENCHMARK(benchmark_cam_codec_compression)
+    ->Apply(compression_matrix)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(benchmark_cam_codec_decompression)
+    ->Apply(compression_matrix)
+    ->Unit(benchmark::kMillisecond);
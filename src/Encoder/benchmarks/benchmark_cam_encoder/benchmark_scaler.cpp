@@ -0,0 +1,143 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+#include <CamEncoder/av_video.h>
+#include "benchmark_utilities.h"
+#include <stdexcept>
+
+/* the common case, record a 4K desktop into a 1080p video. */
+constexpr auto scaler_src_width = 3840;
+constexpr auto scaler_src_height = 2160;
+constexpr auto scaler_dst_width = 1920;
+constexpr auto scaler_dst_height = 1080;
+
+/* a yuv420p image with tightly packed planes. */
+class yuv420_image
+{
+public:
+    yuv420_image(int width, int height)
+        : y_(static_cast<size_t>(width) * height)
+        , u_(static_cast<size_t>(width / 2) * (height / 2))
+        , v_(static_cast<size_t>(width / 2) * (height / 2))
+        , data_{y_.data(), u_.data(), v_.data()}
+        , stride_{width, width / 2, width / 2}
+    {
+    }
+
+    uint8_t *const *data() noexcept
+    {
+        return data_;
+    }
+
+    const int *stride() const noexcept
+    {
+        return stride_;
+    }
+
+private:
+    std::vector<uint8_t> y_;
+    std::vector<uint8_t> u_;
+    std::vector<uint8_t> v_;
+    uint8_t *data_[3];
+    int stride_[3];
+};
+
+static SwsContext *create_scaler(int src_width, int src_height, AVPixelFormat src_format, int dst_width,
+    int dst_height, AVPixelFormat dst_format, int flags)
+{
+    auto *context = sws_getContext(src_width, src_height, src_format, dst_width, dst_height, dst_format, flags,
+        nullptr, nullptr, nullptr);
+    if (context == nullptr)
+        throw std::runtime_error("unable to create scaler");
+    return context;
+}
+
+static void scale_filter_args(benchmark::internal::Benchmark *b)
+{
+    b->ArgNames({"filter"});
+    for (int filter = 0; filter < static_cast<int>(video::scale_filter_names.size()); ++filter)
+        b->Args({filter});
+}
+
+/*!
+ * The fused path, as used by av_video. A single swscale pass scales the BGRA frame and converts
+ * it to yuv420p, so the full size frame is read only once.
+ */
+static void benchmark_scale_fused(benchmark::State &state)
+{
+    const auto flags = av_get_scale_flags(static_cast<video::scale_filter>(state.range(0)));
+    synthetic_desktop desktop(scaler_src_width, scaler_src_height);
+    yuv420_image dst(scaler_dst_width, scaler_dst_height);
+
+    auto *scaler = create_scaler(scaler_src_width, scaler_src_height, AV_PIX_FMT_BGRA, scaler_dst_width,
+        scaler_dst_height, AV_PIX_FMT_YUV420P, flags);
+
+    const uint8_t *src[1] = {desktop.render(0)};
+    const int src_stride[1] = {desktop.stride()};
+
+    for (auto _ : state)
+    {
+        sws_scale(scaler, src, src_stride, 0, scaler_src_height, dst.data(), dst.stride());
+        benchmark::ClobberMemory();
+    }
+
+    sws_freeContext(scaler);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * desktop.stride() * desktop.height());
+}
+
+/*!
+ * The two pass path, first downscale in BGRA and then convert the downscaled frame to yuv420p.
+ */
+static void benchmark_scale_two_pass(benchmark::State &state)
+{
+    const auto flags = av_get_scale_flags(static_cast<video::scale_filter>(state.range(0)));
+    synthetic_desktop desktop(scaler_src_width, scaler_src_height);
+    std::vector<uint8_t> scaled(static_cast<size_t>(scaler_dst_width) * scaler_dst_height * 4);
+    yuv420_image dst(scaler_dst_width, scaler_dst_height);
+
+    auto *scaler = create_scaler(scaler_src_width, scaler_src_height, AV_PIX_FMT_BGRA, scaler_dst_width,
+        scaler_dst_height, AV_PIX_FMT_BGRA, flags);
+    auto *converter = create_scaler(scaler_dst_width, scaler_dst_height, AV_PIX_FMT_BGRA, scaler_dst_width,
+        scaler_dst_height, AV_PIX_FMT_YUV420P, SWS_POINT);
+
+    const uint8_t *src[1] = {desktop.render(0)};
+    const int src_stride[1] = {desktop.stride()};
+    uint8_t *scaled_data[1] = {scaled.data()};
+    const int scaled_stride[1] = {scaler_dst_width * 4};
+
+    for (auto _ : state)
+    {
+        sws_scale(scaler, src, src_stride, 0, scaler_src_height, scaled_data, scaled_stride);
+        sws_scale(converter, scaled_data, scaled_stride, 0, scaler_dst_height, dst.data(), dst.stride());
+        benchmark::ClobberMemory();
+    }
+
+    sws_freeContext(converter);
+    sws_freeContext(scaler);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * desktop.stride() * desktop.height());
+}
+
+BENCHMARK(benchmark_scale_fused)
+    ->Apply(scale_filter_args)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(benchmark_scale_two_pass)
+    ->Apply(scale_filter_args)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,114 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+/*!
+ * Synthetic 'desktop' BGRA frame source. The frame consists of a flat background, a couple of
+ * static windows filled with text like patterns and a small window that moves every frame. This
+ * roughly matches the content and the amount of change of a real screen recording.
+ */
+class synthetic_desktop
+{
+public:
+    synthetic_desktop(int width, int height)
+        : width_(width)
+        , height_(height)
+        , frame_(static_cast<size_t>(width) * height * 4)
+    {
+        fill_rect(0, 0, width_, height_, 0xff3a6ea5);
+        fill_window(width_ / 16, height_ / 16, width_ / 2, height_ / 2, 1);
+        fill_window(width_ / 3, height_ / 3, width_ / 2, height_ / 2, 2);
+        background_ = frame_;
+    }
+
+    // render frame with the given index, and return the frame data.
+    auto render(int index) -> uint8_t *
+    {
+        frame_ = background_;
+
+        const auto window_width = std::max(width_ / 8, 1);
+        const auto window_height = std::max(height_ / 8, 1);
+        const auto x = (index * 7) % std::max(width_ - window_width, 1);
+        const auto y = (index * 3) % std::max(height_ - window_height, 1);
+        fill_window(x, y, window_width, window_height, index);
+        return frame_.data();
+    }
+
+    auto data() noexcept -> uint8_t *
+    {
+        return frame_.data();
+    }
+
+    int width() const noexcept
+    {
+        return width_;
+    }
+
+    int height() const noexcept
+    {
+        return height_;
+    }
+
+    int stride() const noexcept
+    {
+        return width_ * 4;
+    }
+
+private:
+    void fill_rect(int x, int y, int width, int height, uint32_t color)
+    {
+        const auto x_end = std::min(x + width, width_);
+        const auto y_end = std::min(y + height, height_);
+        auto *pixels = reinterpret_cast<uint32_t *>(frame_.data());
+        for (int j = std::max(y, 0); j < y_end; ++j)
+            std::fill(pixels + j * width_ + std::max(x, 0), pixels + j * width_ + x_end, color);
+    }
+
+    // a window with a title bar, and 'text' lines.
+    void fill_window(int x, int y, int width, int height, int seed)
+    {
+        fill_rect(x, y, width, height, 0xfff0f0f0);
+        fill_rect(x, y, width, 24, 0xff2b579a);
+
+        auto *pixels = reinterpret_cast<uint32_t *>(frame_.data());
+        uint32_t state = 0x9e3779b9u * static_cast<uint32_t>(seed + 1);
+        for (int line = y + 32; line + 12 < std::min(y + height, height_); line += 18)
+        {
+            for (int j = line; j < line + 12; ++j)
+            {
+                for (int i = x + 8; i < std::min(x + width - 8, width_); ++i)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+                    if ((state & 7) == 0)
+                        pixels[j * width_ + i] = 0xff202020;
+                }
+            }
+        }
+    }
+
+    int width_;
+    int height_;
+    std::vector<uint8_t> frame_;
+    std::vector<uint8_t> background_;
+};
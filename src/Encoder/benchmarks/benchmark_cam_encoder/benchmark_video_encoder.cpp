@@ -0,0 +1,142 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+#include <CamEncoder/av_video.h>
+#include "benchmark_utilities.h"
+#include <chrono>
+#include <vector>
+
+constexpr auto benchmark_width = 1920;
+constexpr auto benchmark_height = 1080;
+constexpr auto benchmark_frame_count = 60;
+
+using benchmark_clock = std::chrono::steady_clock;
+
+/*!
+ * Threading matrix argument layout:
+ *   0: preset (video::preset)
+ *   1: tune zerolatency (0 - no tune, 1 - zerolatency)
+ *   2: thread count (0 - auto)
+ *   3: thread type (video::thread_type)
+ *   4: rc-lookahead (-1 - encoder default)
+ */
+static void threading_matrix(benchmark::internal::Benchmark *b)
+{
+    b->ArgNames({"preset", "zerolatency", "threads", "type", "lookahead"});
+    for (const auto preset : {video::preset::ultrafast, video::preset::veryfast, video::preset::medium})
+    {
+        for (const auto zerolatency : {0, 1})
+        {
+            for (const auto threads : {1, 4, 0})
+            {
+                for (const auto type : {video::thread_type::frame, video::thread_type::slice})
+                {
+                    for (const auto lookahead : {-1, 0})
+                        b->Args({static_cast<int>(preset), zerolatency, threads, static_cast<int>(type), lookahead});
+                }
+            }
+        }
+    }
+}
+
+static av_video_meta create_benchmark_meta(const benchmark::State &state)
+{
+    av_video_meta meta;
+    meta.codec = video::codec::x264;
+    meta.quality = 25;
+    meta.bpp = 32;
+    meta.width = benchmark_width;
+    meta.height = benchmark_height;
+    meta.fps = {30, 1};
+    meta.preset = static_cast<video::preset>(state.range(0));
+    if (state.range(1))
+        meta.tune = video::tune::zerolatency;
+    meta.thread_count = static_cast<int>(state.range(2));
+    meta.thread_type = static_cast<video::thread_type>(state.range(3));
+    if (state.range(4) >= 0)
+        meta.lookahead = static_cast<int>(state.range(4));
+    return meta;
+}
+
+/*!
+ * Encode a fixed amount of synthetic desktop frames, and report the average latency between
+ * pushing a frame and receiving its packet, and the encode throughput.
+ */
+static void benchmark_x264_threading(benchmark::State &state)
+{
+    const auto meta = create_benchmark_meta(state);
+    synthetic_desktop desktop(meta.width, meta.height);
+
+    av_video_codec config;
+    config.pixel_format = AV_PIX_FMT_BGRA;
+
+    double total_latency = 0.0;
+    double max_latency = 0.0;
+    int64_t total_packets = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        av_video video(config, meta);
+        av_dict dict;
+        video.open(nullptr, dict);
+        std::vector<benchmark_clock::time_point> push_times(benchmark_frame_count);
+        AVPacket pkt = {};
+        av_init_packet(&pkt);
+        state.ResumeTiming();
+
+        const auto pull_packets = [&]()
+        {
+            for (bool valid_packet = true; valid_packet;)
+            {
+                if (!video.pull_encoded_packet(&pkt, &valid_packet) || !valid_packet)
+                    break;
+
+                const auto now = benchmark_clock::now();
+                const auto latency = std::chrono::duration<double, std::milli>(now - push_times.at(pkt.pts)).count();
+                total_latency += latency;
+                max_latency = std::max(max_latency, latency);
+                ++total_packets;
+                av_packet_unref(&pkt);
+            }
+        };
+
+        for (int i = 0; i < benchmark_frame_count; ++i)
+        {
+            // time base is 1ms, so using the frame index as pts keeps the lookup simple.
+            auto *data = desktop.render(i);
+            push_times[i] = benchmark_clock::now();
+            video.push_encode_frame(i, data, desktop.width(), desktop.height(), desktop.stride());
+            pull_packets();
+        }
+
+        video.push_encode_frame(0, nullptr, 0, 0, 0);
+        pull_packets();
+    }
+
+    state.SetItemsProcessed(state.iterations() * benchmark_frame_count);
+    state.counters["latency_ms"] = total_packets ? total_latency / total_packets : 0.0;
+    state.counters["max_latency_ms"] = max_latency;
+}
+
+BENCHMARK(benchmark_x264_threading)
+    ->Apply(threading_matrix)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
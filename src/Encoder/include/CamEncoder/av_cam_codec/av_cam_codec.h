@@ -19,6 +19,16 @@
 
 #include "CamEncoder/av_ffmpeg.h"
 
+class av_packet_pool;
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+/* compression algorithms, stored in the algo bits of the frame header. */
+#define CSCD_ALGORITHM_LZO 0
+#define CSCD_ALGORITHM_GZIP 1
+#define CSCD_ALGORITHM_LZ4 2
+#define CSCD_ALGORITHM_ZSTD 3
+
 struct CamStudioContext
 {
     AVClass *klass;
@@ -26,6 +36,9 @@ struct CamStudioContext
     /* encoder options */
     int algorithm;
     int gzip_level;
+    int lz4_level;
+    int zstd_level;
+    int zstd_long;
     int autokeyframe;
     int autokeyframe_rate;
 
@@ -36,6 +49,17 @@ struct CamStudioContext
     unsigned int comp_size;
     unsigned char *comp_buf;
 
+    /* compression scratch buffer, sized for the worst case compressed frame. */
+    unsigned int scratch_size;
+    unsigned char *scratch_buf;
+
+    /* the final packets are borrowed from this pool. */
+    av_packet_pool *packet_pool;
+
+    /* lz4 and zstd compression state, reused between frames. */
+    void *lz4_state;
+    ZSTD_CCtx_s *zstd_ctx;
+
     int linelen;
     int height;
     int bpp;
@@ -45,15 +69,37 @@ struct CamStudioContext
     int currentFrame;
 };
 
+struct CamStudioDecodeContext
+{
+    int linelen;
+    int height;
+    int bpp;
+    int frame_size;
+
+    /* the reconstructed frame, delta frames are added to it. */
+    unsigned char *frame_buf;
+    unsigned char *decomp_buf;
+
+    ZSTD_DCtx_s *zstd_ctx;
+};
+
 /* init video encoder */
 int __cdecl cam_codec_init(AVCodecContext *avctx);
 int __cdecl cam_codec_encode_picture(AVCodecContext *avctx, AVPacket *pkt, const AVFrame *frame, int *got_packet);
 int __cdecl cam_codec_encode_end(AVCodecContext *avctx);
 
+/* init video decoder */
+int __cdecl cam_codec_decode_init(AVCodecContext *avctx);
+int __cdecl cam_codec_decode_frame(AVCodecContext *avctx, void *data, int *got_frame, AVPacket *avpkt);
+int __cdecl cam_codec_decode_end(AVCodecContext *avctx);
+
 #define OFFSET(x) offsetof(CamStudioContext, x)
 static const AVOption cam_codec_options[] = {
-    { "algorithm", "42", OFFSET(algorithm), AV_OPT_TYPE_INT, {0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
+    { "algorithm", "the compression algorithm, 0 lzo, 1 gzip, 2 lz4, 3 zstd", OFFSET(algorithm), AV_OPT_TYPE_INT, {0}, 0, 3, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
     { "gzip_level", "the gzip compression level 0-9", OFFSET(gzip_level), AV_OPT_TYPE_INT,{ 0 }, 0, 10, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
+    { "lz4_level", "the lz4 compression level, 0 is lz4 fast, 1-12 is lz4 hc", OFFSET(lz4_level), AV_OPT_TYPE_INT,{ 0 }, 0, 12, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
+    { "zstd_level", "the zstd compression level", OFFSET(zstd_level), AV_OPT_TYPE_INT,{ 1 }, -7, 22, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
+    { "zstd_long", "enable zstd long distance matching", OFFSET(zstd_long), AV_OPT_TYPE_INT,{ 0 }, 0, 1, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
     { "autokeyframe", "enable auto keyframe insertion, when disabled we are always inserting key frames", OFFSET(autokeyframe), AV_OPT_TYPE_INT,{ 1 }, 0, 1, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
     { "autokeyframe_rate", "the rate of the keyframe insertion", OFFSET(autokeyframe_rate), AV_OPT_TYPE_INT,{ 25 }, 0, 1000 /* should be int max */, AV_OPT_FLAG_ENCODING_PARAM, nullptr },
     { nullptr },
@@ -113,3 +159,39 @@ static AVCodec cam_codec_encoder = {
     nullptr,                        // const char *bsfs;
     nullptr,                        // const struct AVCodecHWConfigInternal **hw_configs;
 };
+
+static AVCodec cam_codec_decoder = {
+    "cscd",                         // const char *name;
+    "CamStudio",                    // const char *long_name;
+    AVMEDIA_TYPE_VIDEO,             // enum AVMediaType type;
+    AV_CODEC_ID_CSCD,               // enum AVCodecID id;
+    0,                              // int capabilities;
+    nullptr,                        // const AVRational *supported_framerates;
+    nullptr,                        // const enum AVPixelFormat *pix_fmts;
+    nullptr,                        // const int *supported_samplerates;
+    nullptr,                        // const enum AVSampleFormat *sample_fmts;
+    nullptr,                        // const uint64_t *channel_layouts;
+    0,                              // uint8_t max_lowres;
+    nullptr,                        // const AVClass *priv_class;
+    nullptr,                        // const AVProfile *profiles;
+    nullptr,                        // const char *wrapper_name;
+    // private data fields
+    sizeof(CamStudioDecodeContext), // int priv_data_size;
+    nullptr,                        // struct AVCodec *next;
+    nullptr,                        // int(*init_thread_copy)(AVCodecContext *);
+    nullptr,                        // int(*update_thread_context)(AVCodecContext *dst, const AVCodecContext *src);
+    nullptr,                        // const AVCodecDefault *defaults;
+    nullptr,                        // void(*init_static_data)(struct AVCodec *codec);
+    cam_codec_decode_init,          // int(*init)(AVCodecContext *);
+    nullptr,                        // int(*encode_sub)(AVCodecContext *, uint8_t *buf, int buf_size, const struct AVSubtitle *sub);
+    nullptr,                        // int(*encode2)(AVCodecContext *avctx, AVPacket *avpkt, const AVFrame *frame, int *got_packet_ptr);
+    cam_codec_decode_frame,         // int(*decode)(AVCodecContext *, void *outdata, int *outdata_size, AVPacket *avpkt);
+    cam_codec_decode_end,           // int(*close)(AVCodecContext *);
+    nullptr,                        // int(*send_frame)(AVCodecContext *avctx, const AVFrame *frame);
+    nullptr,                        // int(*receive_packet)(AVCodecContext *avctx, AVPacket *avpkt);
+    nullptr,                        // int(*receive_frame)(AVCodecContext *avctx, AVFrame *frame);
+    nullptr,                        // void(*flush)(AVCodecContext *);
+    0,                              // int caps_internal;
+    nullptr,                        // const char *bsfs;
+    nullptr,                        // const struct AVCodecHWConfigInternal **hw_configs;
+};
@@ -0,0 +1,47 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// a range of frames [start, end) in milliseconds, start is always a keyframe.
+struct av_chunk
+{
+    int64_t start{0};
+    int64_t end{0};
+};
+
+constexpr bool operator==(const av_chunk &lhs, const av_chunk &rhs) noexcept
+{
+    return lhs.start == rhs.start && lhs.end == rhs.end;
+}
+
+/*!
+ * Split a recording into chunks that can be decoded independently, for processing a recording on
+ * multiple threads. Every chunk starts at a keyframe (the start of a GOP), and the chunks cover the
+ * recording from the first keyframe up to end_time without gaps.
+ *
+ * \param keyframe_times the sorted times of the keyframes in the recording (ms).
+ * \param end_time the end of the last frame in the recording (ms).
+ * \param chunk_count the amount of chunks to aim for, the result can have less chunks when the
+ *        recording has less keyframes.
+ * \throw std::invalid_argument when there are no keyframes, or chunk_count is below 1.
+ */
+auto av_plan_chunks(const std::vector<int64_t> &keyframe_times, int64_t end_time, int chunk_count)
+    -> std::vector<av_chunk>;
@@ -0,0 +1,34 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "av_muxer.h"
+#include <string>
+#include <vector>
+
+/*!
+ * Join the video streams of a number of recordings into a single file, without re-encoding.
+ *
+ * The inputs must be encoded with the same encoder settings (a.e. the chunks of a recording that
+ * were encoded on separate threads), and must have ascending timestamps. Their timestamps are
+ * kept, so chunks that were encoded with the original timestamps line up again.
+ * \throw std::runtime_error when an input differs from the first input in codec, frame size or
+ *        codec headers (a.e. the x264 SPS/PPS), as its packets would not decode.
+ */
+void av_concat_files(const std::vector<std::string> &input_filenames, const std::string &output_filename,
+    av_muxer_type muxer_type);
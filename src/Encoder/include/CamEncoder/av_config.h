@@ -129,6 +129,40 @@ namespace video
         level5_2,
     };
 
+    // camstudio codec compression algorithm. Only lzo and gzip can be decoded by other players.
+    enum class compression
+    {
+        lzo,
+        gzip,
+        lz4, // fast, suited for real time recording. Only readable by the camstudio decoder.
+        zstd, // best ratio, optionally with long distance matching. Only readable by the camstudio decoder.
+    };
+
+    // encoder threading model.
+    enum class thread_type
+    {
+        frame, // frame threading, best throughput but every thread adds a frame of latency.
+        slice, // slice threading (x264 sliced-threads), lowest latency.
+    };
+
+    // output resolution scaling filter, ordered from fastest to best quality.
+    enum class scale_filter
+    {
+        point, // nearest neighbour, keeps text sharp at integer ratios.
+        bilinear,
+        area, // box average, the best choice for large downscales.
+        bicubic,
+        lanczos,
+    };
+
+    constexpr std::array<const char *, 5> scale_filter_names = {
+        "point",
+        "bilinear",
+        "area",
+        "bicubic",
+        "lanczos"
+    };
+
     constexpr std::array<std::string_view, 18> codec_level_names = {
         "Auto",
         "1.0",
@@ -182,6 +216,7 @@ struct frame_rate
 // is a mix of video input config and user configurations. \todo split these.
 struct av_video_meta
 {
+    // the size of the input frames.
     int width{ 0 };
     int height{ 0 };
     int bpp{ 0 };
@@ -195,6 +230,28 @@ struct av_video_meta
     std::optional<video::tune> tune;
     std::optional<video::profile> profile; // for example h264
     std::optional<video::codec_level> level;
+    // encoder threading, a thread count of 0 means auto detect. When not set the encoder
+    // defaults are used.
+    std::optional<int> thread_count;
+    std::optional<video::thread_type> thread_type;
+    std::optional<int> slices;
+    std::optional<int> lookahead; // rate control lookahead in frames.
+    // when set, insert a keyframe when the dirty tile ratio of a frame reaches this threshold.
+    std::optional<double> scene_change_threshold;
+    // camstudio codec compression, when not set lzo is used. The level is algorithm specific.
+    std::optional<video::compression> compression;
+    std::optional<int> compression_level;
+    bool long_range{ false }; // zstd long distance matching.
+    // the size of the encoded video, when not set the input size is used. The input frames are
+    // scaled to this size with scale_filter (default bicubic) while converting to the encoder
+    // pixel format.
+    std::optional<int> output_width;
+    std::optional<int> output_height;
+    std::optional<video::scale_filter> scale_filter;
+    // allow the preset to change during the recording (see av_video::set_preset). The encoder then
+    // sends its parameter sets in-band and does not use b-frames, so a restarted encoder is able to
+    // continue the same stream.
+    bool reconfigurable{ false };
 };
 
 struct av_video_codec
@@ -19,3 +19,4 @@
 #include "av_audio.h"
 #include "av_video.h"
 #include "av_muxer.h"
+#include "av_quality_controller.h"
@@ -22,8 +22,10 @@
 #include "av_video.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <array>
+#include <vector>
 
 enum class av_track_type
 {
@@ -61,6 +63,45 @@ struct av_metadata
     std::string encoding_tool;
 };
 
+struct av_muxer_stream;
+
+// what queue_frame() does when the queue of an encoder thread is full.
+enum class av_queue_full_policy
+{
+    // wait until the encoder thread took a frame from the queue.
+    block,
+    // drop the frame, the previous frame simply lasts longer.
+    drop
+};
+
+struct av_muxer_thread_config
+{
+    // the maximum amount of frames waiting in the queue of every encoder thread.
+    int max_queue_depth{ 8 };
+    av_queue_full_policy full_policy{ av_queue_full_policy::drop };
+};
+
+// a snapshot of the muxer progress, safe to read from any thread.
+struct av_muxer_stats
+{
+    // the encoded video frames of the stream that is furthest behind.
+    int64_t encoded_frames{0};
+    // the encoded packet bytes of all streams, without the container overhead.
+    int64_t bytes_written{0};
+    // the frames of all streams that were dropped because an encoder queue was full.
+    int64_t dropped_frames{0};
+    int queue_depth{0};
+};
+
+/*!
+ * Muxes one or more video streams into a single file.
+ *
+ * By default frames are encoded on the calling thread with encode_frame(). With multiple streams
+ * (a.e. one per monitor) start_encoder_threads() gives every stream its own encoder thread, frames
+ * are then handed over with queue_frame(). All streams share the same clock, frames captured at the
+ * same moment must be passed with the same timestamp. The packets of all streams are interleaved
+ * by the muxer.
+ */
 class av_muxer
 {
 public:
@@ -69,13 +110,53 @@ public:
 
     // open the muxer so its ready to encode stuff.
     void open();
+
+    /*!
+     * Drain the encoders of all streams, no frames can be encoded after this. Only the first call
+     * does anything, the destructor flushes when this was not called.
+     * \throw std::runtime_error when encoding the last frames failed.
+     */
     void flush();
 
-    // Add a video codec as track/stream.
-    void add_stream(std::unique_ptr<av_video> video_codec);
+    // Add a video codec as track/stream, returns the index of the stream.
+    int add_stream(std::unique_ptr<av_video> video_codec);
+    int get_stream_count() const noexcept;
 
     // this sends a video frame to the video encoder and sends any pending results to the muxer.
     void encode_frame(timestamp_t timestamp, unsigned char *data, int width, int height, int stride);
+    void encode_frame(int stream_index, timestamp_t timestamp, unsigned char *data, int width, int height,
+        int stride);
+
+    /*!
+     * Start an encoder thread for every stream, must be called after open(). From here on frames
+     * are passed with queue_frame(). The threads are stopped by flush().
+     */
+    void start_encoder_threads(const av_muxer_thread_config &config = {});
+
+    /*!
+     * Copy a frame into the queue of the stream its encoder thread, so the caller can reuse the
+     * frame data right away. The queue is bounded, see av_muxer_thread_config.
+     * \return false when the frame was dropped because the queue was full.
+     * \throw std::runtime_error when the encoder thread of the stream failed.
+     */
+    bool queue_frame(int stream_index, timestamp_t timestamp, const unsigned char *data, int width, int height,
+        int stride);
+
+    // request the next encoded video frame of every stream to be a keyframe.
+    void request_keyframe() noexcept;
+
+    // change the video encoder preset of every stream, the change is applied on the next encoded frame.
+    void set_preset(video::preset preset) noexcept;
+
+    /* the amount of video frames queued for the video encoder beyond its pipeline delay, of the
+     * stream that is furthest behind. */
+    int get_queue_depth() const noexcept;
+
+    // the amount of video frames of all streams that were encoded without a color conversion.
+    int64_t get_avoided_conversion_count() const noexcept;
+
+    // the encoder progress of all streams, cheap enough to poll every frame.
+    av_muxer_stats get_stats() const noexcept;
 
     /* audio output */
     AVFrame *alloc_audio_frame(enum AVSampleFormat sample_fmt, uint64_t channel_layout,
@@ -93,18 +174,28 @@ public:
     void close_stream(AVFormatContext *format_context, av_track *ost);
 
 private:
-    int write_frame(const AVRational &time_base, AVStream *st, AVPacket *pkt);
+    int write_frame(const AVRational &time_base, AVStream *st, AVPacket *pkt, int64_t *last_dts = nullptr);
+    void _encode_stream_frame(av_muxer_stream &stream, timestamp_t timestamp, unsigned char *data, int width,
+        int height, int stride);
+    void _run_encoder_thread(av_muxer_stream &stream);
+    void _stop_encoder_threads();
+    auto _get_stream(int stream_index) const -> av_muxer_stream &;
 private:
     AVFormatContext *format_context_{ nullptr };
     AVOutputFormat *output_format_{ nullptr };
-    std::unique_ptr<av_video> video_codec_{};
+    std::vector<std::unique_ptr<av_muxer_stream>> streams_{};
     //std::unique_ptr<av_audio> audio_codec_;
-    av_track video_track{};
     av_track audio_track{};
     std::string filename_{};
     av_metadata metadata_{};
     AVRational time_base_{1, 0};
 
+    // the streams write their packets from their own encoder thread.
+    std::mutex write_mutex_{};
+    bool threaded_{ false };
+    av_muxer_thread_config thread_config_{};
+    bool flushed_{ false };
+
     // Commented, because we do not handle audio yet.
     //int have_audio{0};
     //int encode_audio{0};
@@ -0,0 +1,68 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "av_ffmpeg.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*!
+ * Packet buffer pool with power of two size classes.
+ *
+ * Every size class is backed by a AVBufferPool, so a packet that borrowed a buffer from this pool
+ * returns it automatically when the last reference to the packet is released (a.e. after the
+ * muxer has written it). In steady state this means no allocations at all.
+ *
+ * \note the pool must outlive the borrowed buffers, or uninit them via AVBufferPool semantics.
+ */
+class av_packet_pool
+{
+public:
+    // the smallest size class is 4 KiB.
+    static constexpr int min_size_class = 12;
+    static constexpr int size_class_count = 32 - min_size_class;
+
+    av_packet_pool() noexcept = default;
+    ~av_packet_pool();
+
+    av_packet_pool(const av_packet_pool &) = delete;
+    av_packet_pool &operator=(const av_packet_pool &) = delete;
+
+    /*!
+     * Let the packet borrow a buffer of at least size bytes (+ input padding) from the pool.
+     * \return 0 on success or a negative AVERROR code.
+     */
+    int alloc_packet(AVPacket *pkt, int size);
+
+    // the amount of real buffer allocations done by this pool.
+    int64_t get_allocation_count() const noexcept;
+
+    // the amount of buffers borrowed from this pool.
+    int64_t get_acquire_count() const noexcept;
+
+    // returns the size class index for a buffer size.
+    static int get_size_class(int size) noexcept;
+
+private:
+    static AVBufferRef *allocate_buffer(void *opaque, int size);
+
+    std::array<AVBufferPool *, size_class_count> pools_{};
+    std::atomic<int64_t> allocation_count_{0};
+    int64_t acquire_count_{0};
+};
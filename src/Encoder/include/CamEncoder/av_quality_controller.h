@@ -0,0 +1,90 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "av_config.h"
+
+struct av_quality_controller_config
+{
+    // the time budget of a single frame in seconds (1/fps).
+    double frame_budget{ 1.0 / 30.0 };
+    // the configured preset, we never step above this preset.
+    video::preset max_preset{ video::preset::medium };
+    // the fastest preset we are allowed to step down to.
+    video::preset min_preset{ video::preset::ultrafast };
+    // after running out of presets we lower the frame rate, up to 1/max_fps_divisor.
+    int max_fps_divisor{ 2 };
+    // an encoder queue deeper than this is considered an overload. The queue depth must not include
+    // the pipeline delay of the encoder, see av_video::get_queue_depth().
+    int max_queue_depth{ 60 };
+    // a frame is late when its encode time is above overload_ratio * frame budget.
+    double overload_ratio{ 0.9 };
+    // we have headroom when the average encode time is below headroom_ratio * frame budget.
+    double headroom_ratio{ 0.5 };
+    // the amount of late frames before we step down.
+    int overload_frames{ 15 };
+    // the amount of frames with headroom before we step back up.
+    int headroom_frames{ 90 };
+};
+
+enum class av_quality_decision
+{
+    none,
+    step_down,
+    step_up
+};
+
+/*!
+ * Feedback controller that lowers the encoder quality when the encoder falls behind.
+ *
+ * The controller walks a quality ladder. Level 0 is the configured preset at full frame rate, every
+ * level below steps the preset down until min_preset is reached, after which the frame rate is
+ * divided. When the encoder has enough headroom again, it steps back up.
+ */
+class av_quality_controller
+{
+public:
+    explicit av_quality_controller(const av_quality_controller_config &config);
+
+    /*!
+     * Feed the encode time (seconds) of the last frame and the current encoder queue depth.
+     * \return the decision taken, the new quality level can be read with get_preset() and
+     *         get_fps_divisor().
+     */
+    av_quality_decision update(double encode_time, int queue_depth) noexcept;
+
+    video::preset get_preset() const noexcept;
+    int get_fps_divisor() const noexcept;
+
+    // the current position on the quality ladder, 0 is the best quality.
+    int get_level() const noexcept;
+    int get_level_count() const noexcept;
+
+    // the smoothed encode time as fraction of the frame budget.
+    double get_load() const noexcept;
+
+private:
+    void _change_level(int level) noexcept;
+
+    av_quality_controller_config config_;
+    int level_{ 0 };
+    int preset_level_count_{ 0 };
+    double load_{ 0.0 };
+    int overload_count_{ 0 };
+    int headroom_count_{ 0 };
+};
@@ -0,0 +1,67 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+/*!
+ * Cheap pre-encode scene change detector.
+ *
+ * The frame is divided into square tiles and a hash is kept per tile. A tile is dirty when its
+ * hash differs from the hash of the previous frame. When the ratio of dirty tiles reaches the
+ * threshold, the frame is considered a scene change and the encoder should insert a keyframe.
+ */
+class av_scene_change_detector
+{
+public:
+    static constexpr int default_tile_size = 32;
+    static constexpr double default_threshold = 0.6;
+
+    av_scene_change_detector(int width, int height, int bytes_per_pixel,
+        double threshold = default_threshold, int tile_size = default_tile_size);
+
+    /*!
+     * Update the tile hashes with a new frame.
+     * \return true when the dirty tile ratio is equal or above the threshold.
+     * \note the first frame never triggers a scene change, it will be a keyframe anyway.
+     */
+    bool detect(const unsigned char *data, int stride);
+
+    // reset the detector, so the next frame is handled as the first frame.
+    void reset() noexcept;
+
+    // the dirty tile ratio (0.0 - 1.0) of the last detected frame.
+    double get_dirty_ratio() const noexcept;
+
+    int get_tile_count() const noexcept;
+    int get_dirty_tile_count() const noexcept;
+
+private:
+    int width_;
+    int height_;
+    int bytes_per_pixel_;
+    int tile_size_;
+    int tiles_x_;
+    int tiles_y_;
+    double threshold_;
+
+    int dirty_tile_count_{0};
+    bool has_previous_frame_{false};
+    std::vector<uint64_t> tile_hashes_;
+};
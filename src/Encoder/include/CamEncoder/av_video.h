@@ -21,8 +21,12 @@
 #include "av_icodec.h"
 #include "av_dict.h"
 #include "av_ffmpeg.h"
+#include "av_scene_detect.h"
 #include <stdexcept>
 #include <cstdint>
+#include <memory>
+#include <atomic>
+#include <vector>
 
 using timestamp_t = uint64_t;
 
@@ -39,6 +43,20 @@ enum class av_video_colorspace
     JPEG    /* 0 - 255 */
 };
 
+// returns the swscale flags of a scale filter.
+int av_get_scale_flags(video::scale_filter filter) noexcept;
+
+// the input pixel formats a codec encodes without a color conversion, in order of preference.
+std::vector<AVPixelFormat> av_get_native_pixel_formats(video::codec codec);
+
+/*!
+ * Pick the pixel format a source should deliver to an encoder. The first source format the codec
+ * encodes natively is used, otherwise the first source format, which the encoder then converts.
+ * \param source_formats the formats the source can deliver, in order of preference.
+ * \throw std::invalid_argument when the source has no formats.
+ */
+AVPixelFormat av_negotiate_pixel_format(const std::vector<AVPixelFormat> &source_formats, video::codec codec);
+
 class av_video : public av_icodec
 {
 public:
@@ -49,6 +67,36 @@ public:
 
     void push_encode_frame(timestamp_t timestamp, unsigned char *data, int width, int height, int stride);
 
+    /*!
+     * request the next pushed frame to be encoded as a keyframe (IDR). Can be used a.e. on
+     * resume after pause, on a capture window switch or on a segment boundary.
+     */
+    void request_keyframe() noexcept;
+
+    /*!
+     * request a preset change. The change is not applied directly, the owner of the encoder must
+     * drain the encoder and call reconfigure(), after which the encoder restarts with a keyframe.
+     * \note ignored when the encoder is not av_video_meta::reconfigurable, and for cscd as the
+     * camstudio codec has no presets.
+     */
+    void set_preset(video::preset preset) noexcept;
+    bool has_pending_reconfigure() const noexcept;
+    bool is_reconfigurable() const noexcept;
+    void reconfigure();
+
+    /* the amount of frames pushed into the encoder for which we did not receive a packet yet, on
+     * top of the pipeline delay of the encoder. So 0 as long as the encoder keeps up. */
+    int get_queue_depth() const noexcept;
+
+    // the amount of frames the encoder holds back in normal operation, -1 before the first packet.
+    int get_pipeline_delay() const noexcept;
+
+    // true when frames are copied into the encoder as is, without a color conversion or scale.
+    bool is_conversion_free() const noexcept;
+
+    // the amount of frames that were copied into the encoder without a color conversion.
+    int64_t get_avoided_conversion_count() const noexcept;
+
     // this function will return false, if it was unable to read a encoded packet.
     bool pull_encoded_packet(AVPacket *pkt, bool *valid_packet) override;
 
@@ -57,9 +105,13 @@ public:
     AVRational get_time_base() const noexcept override;
 
 private:
-    // create a video frame scaler/converter so we can convert our rgb24 to a.e. yuv420.
+    void create_codec_context(const av_video_meta &meta);
+
+    /* create a video frame scaler/converter so we can convert our rgb24 to a.e. yuv420. Scaling
+     * to the output size is done in the same pass as the color conversion. */
     SwsContext *create_software_scaler(AVPixelFormat src_pixel_format, int src_width, int src_height,
-                                       AVPixelFormat dst_pixel_format, int dst_width, int dst_height);
+                                       AVPixelFormat dst_pixel_format, int dst_width, int dst_height,
+                                       int flags);
 
 private:
     AVCodec *codec_{ nullptr };
@@ -71,5 +123,13 @@ private:
     SwsContext *sws_context_{ nullptr };
 
     av_video_codec_type codec_type_{ av_video_codec_type::none };
+    av_video_meta meta_{};
     av_dict av_opts_{};
+    std::optional<video::preset> pending_preset_{};
+    int queue_depth_{ 0 };
+    int pipeline_delay_{ -1 };
+    std::atomic<int64_t> avoided_conversion_count_{ 0 };
+
+    std::atomic<bool> keyframe_requested_{ false };
+    std::unique_ptr<av_scene_change_detector> scene_detector_;
 };
@@ -0,0 +1,93 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "av_config.h"
+#include "av_ffmpeg.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// a decoded video frame, in BGRA.
+struct av_decoded_frame
+{
+    int64_t time{0}; // presentation time in milliseconds.
+    int width{0};
+    int height{0};
+    int stride{0};
+    std::vector<uint8_t> data;
+};
+
+// the keyframes of a video stream, found without decoding the stream.
+struct av_video_index
+{
+    std::vector<int64_t> keyframe_times; // milliseconds.
+    int64_t end_time{0}; // the end of the last frame in milliseconds.
+};
+
+/*!
+ * Reads and decodes the video stream of a recording, the counterpart of av_muxer. Frames are
+ * converted to BGRA, so they can be drawn on with a cam_canvas.
+ *
+ * \note a reader is not thread safe, to read a recording on multiple threads every thread opens
+ *       its own reader.
+ */
+class av_video_reader
+{
+public:
+    /*!
+     * \param filename the recording to read.
+     * \param stream_index the stream to read, a.e. for recordings with a track per monitor. By default
+     *                     the best video stream is read.
+     */
+    explicit av_video_reader(const std::string &filename, int stream_index = -1);
+    ~av_video_reader();
+
+    av_video_reader(const av_video_reader &) = delete;
+    av_video_reader &operator=(const av_video_reader &) = delete;
+
+    int get_width() const noexcept;
+    int get_height() const noexcept;
+    frame_rate get_frame_rate() const noexcept;
+
+    /*!
+     * scan all packets of the video stream for keyframes. This only reads the container, so it is
+     * fast even for long recordings. The reader is rewound to the start afterwards.
+     */
+    auto read_index() -> av_video_index;
+
+    // seek to the last keyframe at or before time (ms).
+    void seek(int64_t time);
+
+    // decode the next frame, returns false at the end of the stream.
+    bool read_frame(av_decoded_frame &frame);
+
+private:
+    void _close() noexcept;
+    bool _receive_frame();
+    auto _to_milliseconds(int64_t timestamp) const noexcept -> int64_t;
+
+    AVFormatContext *format_context_{nullptr};
+    AVCodecContext *context_{nullptr};
+    AVFrame *frame_{nullptr};
+    AVPacket *packet_{nullptr};
+    SwsContext *sws_context_{nullptr};
+    int stream_index_{-1};
+    AVRational time_base_{1, 1000};
+    bool end_of_file_{false};
+};
@@ -16,46 +16,14 @@
  */
 
 #include "CamEncoder/av_cam_codec/av_cam_codec.h"
+#include "CamEncoder/av_packet_pool.h"
 #include <minilzo/minilzo.h>
 #include <zlib.h>
-
-int ff_alloc_packet2(AVCodecContext *avctx, AVPacket *avpkt, int64_t size, int64_t min_size)
-{
-    if (avpkt->size < 0)
-    {
-        av_log(avctx, AV_LOG_ERROR, "Invalid negative user packet size %d\n", avpkt->size);
-        return AVERROR(EINVAL);
-    }
-    if (size < 0 || size > INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE)
-    {
-        av_log(avctx, AV_LOG_ERROR, "Invalid minimum required packet size %" PRId64 " (max allowed is %d)\n", size,
-               INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE);
-        return AVERROR(EINVAL);
-    }
-
-    if (avpkt->data)
-    {
-        AVBufferRef *buf = avpkt->buf;
-
-        if (avpkt->size < size)
-        {
-            av_log(avctx, AV_LOG_ERROR, "User packet is too small (%d < %" PRId64 ")\n", avpkt->size, size);
-            return AVERROR(EINVAL);
-        }
-
-        av_init_packet(avpkt);
-        avpkt->buf = buf;
-        avpkt->size = (int)size;
-        return 0;
-    }
-    else
-    {
-        int ret = av_new_packet(avpkt, (int)size);
-        if (ret < 0)
-            av_log(avctx, AV_LOG_ERROR, "Failed to allocate packet of size %" PRId64 "\n", size);
-        return ret;
-    }
-}
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+#include <algorithm>
+#include <cstring>
 
 int __cdecl cam_codec_init(AVCodecContext *avctx)
 {
@@ -91,6 +59,36 @@ int __cdecl cam_codec_init(AVCodecContext *avctx)
 
     c->comp_size = LZO1X_1_MEM_COMPRESS * 8;
     c->comp_buf = (unsigned char *)av_malloc(c->comp_size + AV_LZO_OUTPUT_PADDING);
+    if (c->comp_buf == nullptr)
+        return AVERROR(ENOMEM);
+
+    /* worst case output size of all the compressors, +2 for the header bytes. */
+    const auto lzo_bound = c->frame_size + c->frame_size / 16 + 64 + 3;
+    const auto zlib_bound = static_cast<int>(compressBound(static_cast<uLong>(c->frame_size)));
+    const auto lz4_bound = LZ4_compressBound(c->frame_size);
+    const auto zstd_bound = static_cast<int>(ZSTD_compressBound(static_cast<size_t>(c->frame_size)));
+    c->scratch_size = std::max({lzo_bound, zlib_bound, lz4_bound, zstd_bound}) + 2;
+    c->scratch_buf = (unsigned char *)av_malloc(c->scratch_size + AV_LZO_OUTPUT_PADDING);
+    if (c->scratch_buf == nullptr)
+        return AVERROR(ENOMEM);
+
+    c->packet_pool = new av_packet_pool();
+
+    if (c->algorithm == CSCD_ALGORITHM_LZ4)
+    {
+        c->lz4_state = av_malloc(std::max(LZ4_sizeofState(), LZ4_sizeofStateHC()));
+        if (c->lz4_state == nullptr)
+            return AVERROR(ENOMEM);
+    }
+    else if (c->algorithm == CSCD_ALGORITHM_ZSTD)
+    {
+        c->zstd_ctx = ZSTD_createCCtx();
+        if (c->zstd_ctx == nullptr)
+            return AVERROR(ENOMEM);
+
+        ZSTD_CCtx_setParameter(c->zstd_ctx, ZSTD_c_compressionLevel, c->zstd_level);
+        ZSTD_CCtx_setParameter(c->zstd_ctx, ZSTD_c_enableLongDistanceMatching, c->zstd_long);
+    }
 
     //c->algorithm = 0; // we hardcode to lzo for now
     //c->autokeyframe = 1; // we force enable keyframe insertion
@@ -142,16 +140,16 @@ int gzip_compress(const Bytef * src, uLong src_len, Bytef *dst, uLongf *dst_len,
  *
  * Level: 4 bits
  *
- *   Level was initially used to store the gzip compression level. But this value is currently not
- *   used by the decoder.
+ *   Level was initially used to store the gzip compression level, we also store the lz4 and zstd
+ *   level (clamped to 0-15). This value is informational only and not used by the decoder.
  *
  * Algo: 3 bits
  *
  *   Algo stores the used compression algorithm.
  *   - 0 lzo
  *   - 1 gzip
- *   - 2 reserved
- *   - 3 reserved
+ *   - 2 lz4
+ *   - 3 zstd
  *   - 4 reserved
  *   - 5 reserved
  *   - 6 reserved
@@ -180,42 +178,107 @@ int gzip_compress(const Bytef * src, uLong src_len, Bytef *dst, uLongf *dst_len,
 #define CSCD_NON_KEYFRAME_BIT 0
 #define CSCD_KEYFRAME_BIT 1
 
-int __cdecl cam_codec_encode_picture(AVCodecContext *avctx, AVPacket *pkt, const AVFrame *frame, int *got_packet)
+/* the level bits stored in the frame header, see above. */
+static unsigned char cam_codec_level_bits(const CamStudioContext *c)
 {
-    CamStudioContext *c = (CamStudioContext *)avctx->priv_data;
+    switch (c->algorithm)
+    {
+    case CSCD_ALGORITHM_GZIP:
+        return static_cast<unsigned char>(std::clamp(c->gzip_level, 0, 15) << 4);
+    case CSCD_ALGORITHM_LZ4:
+        return static_cast<unsigned char>(std::clamp(c->lz4_level, 0, 15) << 4);
+    case CSCD_ALGORITHM_ZSTD:
+        return static_cast<unsigned char>(std::clamp(c->zstd_level, 0, 15) << 4);
+    default:
+        return 0;
+    }
+}
 
-    lzo_uint in_len = 0;
+/* compress a (delta) frame into dst, returns the compressed size or a negative AVERROR code. */
+static int cam_codec_compress(CamStudioContext *c, const unsigned char *src, unsigned char *dst, int dst_size)
+{
+    switch (c->algorithm)
+    {
+    case CSCD_ALGORITHM_LZO: {
+        lzo_uint out_len = 0;
+        const auto r = lzo1x_1_compress(src, c->frame_size, dst, &out_len, c->comp_buf);
+        if (r != LZO_E_OK)
+            return AVERROR(EFAULT);
+        return static_cast<int>(out_len);
+    }
+    case CSCD_ALGORITHM_GZIP: {
+        uLongf out_len = static_cast<uLongf>(dst_size);
+        const auto r = gzip_compress(src, static_cast<uLong>(c->frame_size), dst, &out_len, c->gzip_level);
+        if (r != Z_OK)
+            return AVERROR(EFAULT);
+        return static_cast<int>(out_len);
+    }
+    case CSCD_ALGORITHM_LZ4: {
+        const auto *lz4_src = reinterpret_cast<const char *>(src);
+        auto *lz4_dst = reinterpret_cast<char *>(dst);
+        int out_len = 0;
+        if (c->lz4_level > 0)
+            out_len = LZ4_compress_HC_extStateHC(c->lz4_state, lz4_src, lz4_dst, c->frame_size, dst_size, c->lz4_level);
+        else
+            out_len = LZ4_compress_fast_extState(c->lz4_state, lz4_src, lz4_dst, c->frame_size, dst_size, 1);
+        if (out_len <= 0)
+            return AVERROR(EFAULT);
+        return out_len;
+    }
+    case CSCD_ALGORITHM_ZSTD: {
+        const auto out_len = ZSTD_compress2(c->zstd_ctx, dst, dst_size, src, c->frame_size);
+        if (ZSTD_isError(out_len))
+            return AVERROR(EFAULT);
+        return static_cast<int>(out_len);
+    }
+    default:
+        return AVERROR(EINVAL);
+    }
+}
 
-    const auto initial_packet_size = c->frame_size + 2; // +2 because we have 2 header bytes
-    if (int ret = ff_alloc_packet2(avctx, pkt, initial_packet_size, 0); ret < 0)
+/* copy the compressed frame from the scratch buffer into a exact size pooled packet. */
+static int cam_codec_output_packet(CamStudioContext *c, AVPacket *pkt, int size)
+{
+    if (int ret = c->packet_pool->alloc_packet(pkt, size); ret < 0)
         return ret;
 
-    uint8_t *buf = pkt->data;
+    std::memcpy(pkt->data, c->scratch_buf, size);
+    return 0;
+}
+
+int __cdecl cam_codec_encode_picture(AVCodecContext *avctx, AVPacket *pkt, const AVFrame *frame, int *got_packet)
+{
+    CamStudioContext *c = (CamStudioContext *)avctx->priv_data;
+
+    /* compress into the scratch buffer, the packet is allocated when we know the final size. */
+    uint8_t *buf = c->scratch_buf;
 
     bool insert_keyframe = (c->currentFrame % c->autokeyframe_rate) == 0;
 
+    /* a keyframe was requested by the user, restart the auto keyframe interval from here. */
+    if (frame->pict_type == AV_PICTURE_TYPE_I)
+    {
+        insert_keyframe = true;
+        c->currentFrame = 0;
+    }
+
+    /* when auto key frame is disabled, it means that we always insert a keyframe. */
+    if (c->autokeyframe == 0)
+        insert_keyframe = true;
+
     unsigned char keybit = insert_keyframe ? CSCD_KEYFRAME_BIT : CSCD_NON_KEYFRAME_BIT;
     unsigned char algo = static_cast<unsigned char>(c->algorithm) << 1;
-    unsigned char gzip_level_bits = 0;
-
-    /* why would you need to store the gzip compression level in your bytestream? */
-    if (c->algorithm == 1)
-        gzip_level_bits = static_cast<unsigned char>(c->gzip_level) << 4;
 
     unsigned char convertmodebit = 0;
     unsigned char originalRGBbit = ((c->bpp / 8) - 1) << 2;
 
-    unsigned char byte1 = keybit | algo | gzip_level_bits;
+    unsigned char byte1 = keybit | algo | cam_codec_level_bits(c);
     unsigned char byte2 = convertmodebit | originalRGBbit;
 
     buf[0] = byte1;
     buf[1] = byte2;
 
-    /* when auto key frame is disabled, it means that we always insert a keyframe. */
-    if (c->autokeyframe == 0)
-        insert_keyframe = true;
-
-    in_len = c->frame_size;
+    const unsigned char *compress_src = frame->data[0];
     if (insert_keyframe)
     {
         int ret = av_frame_copy(c->previouse_frame, frame);
@@ -224,33 +287,6 @@ int __cdecl cam_codec_encode_picture(AVCodecContext *avctx, AVPacket *pkt, const
             // just return some error code... for now...
             return AVERROR(ENOMEM);
         }
-
-        if (c->algorithm == 0)
-        {
-            lzo_uint out_len = 0;
-            const auto r = lzo1x_1_compress(frame->data[0], in_len, buf + 2, &out_len, c->comp_buf);
-            if (r !=LZO_E_OK)
-            {
-                // just return some error code... for now...
-                return AVERROR(EFAULT);
-            }
-            pkt->flags |= AV_PKT_FLAG_KEY;
-
-            av_shrink_packet(pkt, static_cast<int>(out_len + 2));
-        }
-        else if (c->algorithm == 1)
-        {
-            uLong out_len = initial_packet_size;
-            const auto r = gzip_compress(frame->data[0], static_cast<uLong>(in_len), buf + 2, &out_len, c->gzip_level);
-            if (r != Z_OK)
-            {
-                // just return some error code... for now...
-                return AVERROR(EFAULT);
-            }
-            pkt->flags |= AV_PKT_FLAG_KEY;
-
-            av_shrink_packet(pkt, static_cast<int>(out_len + 2));
-        }
     }
     else
     {
@@ -259,7 +295,7 @@ int __cdecl cam_codec_encode_picture(AVCodecContext *avctx, AVPacket *pkt, const
         unsigned char *inputptr = frame->data[0];
         unsigned char *prevFrameptr = c->previouse_frame->data[0];
 
-        for (unsigned long i = 0; i != in_len; ++i)
+        for (int i = 0; i != c->frame_size; ++i)
         {
             *diffinputptr = *inputptr - *prevFrameptr;
             *prevFrameptr = *inputptr;
@@ -269,36 +305,20 @@ int __cdecl cam_codec_encode_picture(AVCodecContext *avctx, AVPacket *pkt, const
             diffinputptr++;
         }
 
-        if (c->algorithm == 0)
-        {
-            lzo_uint out_len = 0;
-            const auto r = lzo1x_1_compress(c->delta_frame->data[0], in_len, buf + 2, &out_len, c->comp_buf);
-            if (r != LZO_E_OK)
-            {
-                // just return some error code... for now...
-                return AVERROR(EFAULT);
-            }
+        compress_src = c->delta_frame->data[0];
+    }
 
-            pkt->flags &= ~AV_PKT_FLAG_KEY;
+    const auto out_len = cam_codec_compress(c, compress_src, buf + 2, static_cast<int>(c->scratch_size) - 2);
+    if (out_len < 0)
+        return out_len;
 
-            av_shrink_packet(pkt, static_cast<int>(out_len + 2));
-        }
-        else if (c->algorithm == 1)
-        {
-            uLong out_len = initial_packet_size;
-            const auto r = gzip_compress(c->delta_frame->data[0], static_cast<uLong>(in_len), buf + 2,
-                &out_len, c->gzip_level);
-
-            if (r != Z_OK)
-            {
-                // just return some error code... for now...
-                return AVERROR(EFAULT);
-            }
-            pkt->flags &= ~AV_PKT_FLAG_KEY;
-
-            av_shrink_packet(pkt, static_cast<int>(out_len + 2));
-        }
-    }
+    if (int ret = cam_codec_output_packet(c, pkt, out_len + 2); ret < 0)
+        return ret;
+
+    if (insert_keyframe)
+        pkt->flags |= AV_PKT_FLAG_KEY;
+    else
+        pkt->flags &= ~AV_PKT_FLAG_KEY;
 
     c->currentFrame++;
     *got_packet = 1;
@@ -309,6 +329,12 @@ int __cdecl cam_codec_encode_end(AVCodecContext *avctx)
 {
     CamStudioContext *c = (CamStudioContext *)avctx->priv_data;
     av_freep(&c->comp_buf);
+    av_freep(&c->scratch_buf);
+    delete c->packet_pool;
+    c->packet_pool = nullptr;
+    av_freep(&c->lz4_state);
+    ZSTD_freeCCtx(c->zstd_ctx);
+    c->zstd_ctx = nullptr;
     av_frame_free(&c->previouse_frame);
     av_frame_free(&c->delta_frame);
     return 0;
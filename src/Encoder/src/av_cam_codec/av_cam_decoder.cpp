@@ -0,0 +1,160 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CamEncoder/av_cam_codec/av_cam_codec.h"
+#include <zlib.h>
+#include <lz4.h>
+#include <zstd.h>
+#include <cstring>
+
+/* the decoder mirrors the frame header and the delta coding of the encoder, see av_cam_codec.cpp */
+
+int __cdecl cam_codec_decode_init(AVCodecContext *avctx)
+{
+    switch (avctx->bits_per_coded_sample)
+    {
+    case 16:
+        avctx->pix_fmt = AV_PIX_FMT_RGB555LE;
+        break;
+    case 24:
+        avctx->pix_fmt = AV_PIX_FMT_BGR24;
+        break;
+    case 32:
+        avctx->pix_fmt = AV_PIX_FMT_BGR0;
+        break;
+    default:
+        av_log(avctx, AV_LOG_ERROR, "CamStudio codec error: invalid bits per pixel %i\n",
+            avctx->bits_per_coded_sample);
+        return AVERROR_INVALIDDATA;
+    }
+
+    CamStudioDecodeContext *c = (CamStudioDecodeContext *)avctx->priv_data;
+    c->bpp = avctx->bits_per_coded_sample;
+    c->linelen = avctx->width * avctx->bits_per_coded_sample / 8;
+    c->height = avctx->height;
+
+    const int stride = FFALIGN(c->linelen, 4);
+    c->frame_size = c->height * stride;
+
+    /* the reconstructed frame starts black, so a stream that starts with a delta frame still decodes. */
+    c->frame_buf = (unsigned char *)av_mallocz(c->frame_size);
+    if (c->frame_buf == nullptr)
+        return AVERROR(ENOMEM);
+
+    c->decomp_buf = (unsigned char *)av_malloc(c->frame_size + AV_LZO_OUTPUT_PADDING);
+    if (c->decomp_buf == nullptr)
+        return AVERROR(ENOMEM);
+
+    c->zstd_ctx = ZSTD_createDCtx();
+    if (c->zstd_ctx == nullptr)
+        return AVERROR(ENOMEM);
+
+    return 0;
+}
+
+/* decompress a (delta) frame into the decompression buffer, returns 0 or a negative AVERROR code. */
+static int cam_codec_decompress(CamStudioDecodeContext *c, int algorithm, const unsigned char *src, int src_size)
+{
+    switch (algorithm)
+    {
+    case CSCD_ALGORITHM_LZO: {
+        int out_len = c->frame_size;
+        int in_len = src_size;
+        if (av_lzo1x_decode(c->decomp_buf, &out_len, src, &in_len) != 0 || out_len != 0)
+            return AVERROR_INVALIDDATA;
+        return 0;
+    }
+    case CSCD_ALGORITHM_GZIP: {
+        uLongf out_len = static_cast<uLongf>(c->frame_size);
+        if (uncompress(c->decomp_buf, &out_len, src, static_cast<uLong>(src_size)) != Z_OK ||
+            out_len != static_cast<uLongf>(c->frame_size))
+            return AVERROR_INVALIDDATA;
+        return 0;
+    }
+    case CSCD_ALGORITHM_LZ4: {
+        const auto out_len = LZ4_decompress_safe(reinterpret_cast<const char *>(src),
+            reinterpret_cast<char *>(c->decomp_buf), src_size, c->frame_size);
+        if (out_len != c->frame_size)
+            return AVERROR_INVALIDDATA;
+        return 0;
+    }
+    case CSCD_ALGORITHM_ZSTD: {
+        const auto out_len = ZSTD_decompressDCtx(c->zstd_ctx, c->decomp_buf, c->frame_size, src, src_size);
+        if (ZSTD_isError(out_len) || out_len != static_cast<size_t>(c->frame_size))
+            return AVERROR_INVALIDDATA;
+        return 0;
+    }
+    default:
+        return AVERROR_PATCHWELCOME;
+    }
+}
+
+int __cdecl cam_codec_decode_frame(AVCodecContext *avctx, void *data, int *got_frame, AVPacket *avpkt)
+{
+    CamStudioDecodeContext *c = (CamStudioDecodeContext *)avctx->priv_data;
+    AVFrame *frame = (AVFrame *)data;
+
+    if (avpkt->size < 2)
+        return AVERROR_INVALIDDATA;
+
+    const bool keyframe = (avpkt->data[0] & 1) != 0;
+    const int algorithm = (avpkt->data[0] >> 1) & 7;
+
+    if (int ret = cam_codec_decompress(c, algorithm, avpkt->data + 2, avpkt->size - 2); ret < 0)
+    {
+        av_log(avctx, AV_LOG_ERROR, "CamStudio codec error: unable to decompress frame\n");
+        return ret;
+    }
+
+    if (keyframe)
+    {
+        std::memcpy(c->frame_buf, c->decomp_buf, c->frame_size);
+    }
+    else
+    {
+        for (int i = 0; i != c->frame_size; ++i)
+            c->frame_buf[i] += c->decomp_buf[i];
+    }
+
+    frame->format = avctx->pix_fmt;
+    frame->width = avctx->width;
+    frame->height = avctx->height;
+    if (int ret = av_frame_get_buffer(frame, 32); ret < 0)
+        return ret;
+
+    /* camstudio frames are stored bottom up, like a windows dib. */
+    const int stride = FFALIGN(c->linelen, 4);
+    av_image_copy_plane(frame->data[0], frame->linesize[0], c->frame_buf + (c->height - 1) * stride, -stride,
+        c->linelen, c->height);
+
+    frame->key_frame = keyframe ? 1 : 0;
+    frame->pict_type = keyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_P;
+    frame->pts = avpkt->pts;
+
+    *got_frame = 1;
+    return avpkt->size;
+}
+
+int __cdecl cam_codec_decode_end(AVCodecContext *avctx)
+{
+    CamStudioDecodeContext *c = (CamStudioDecodeContext *)avctx->priv_data;
+    av_freep(&c->frame_buf);
+    av_freep(&c->decomp_buf);
+    ZSTD_freeDCtx(c->zstd_ctx);
+    c->zstd_ctx = nullptr;
+    return 0;
+}
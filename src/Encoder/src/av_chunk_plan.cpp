@@ -0,0 +1,73 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CamEncoder/av_chunk_plan.h"
+#include <stdexcept>
+
+auto av_plan_chunks(const std::vector<int64_t> &keyframe_times, int64_t end_time, int chunk_count)
+    -> std::vector<av_chunk>
+{
+    if (keyframe_times.empty())
+        throw std::invalid_argument("av_plan_chunks: no keyframes");
+
+    if (chunk_count < 1)
+        throw std::invalid_argument("av_plan_chunks: invalid chunk count");
+
+    const auto start_time = keyframe_times.front();
+    if (end_time <= start_time)
+        return {{start_time, start_time}};
+
+    /* cut at the first keyframe past the ideal chunk length, GOPs are not equally long so we keep
+     * measuring from the actual cut to not let the error accumulate. */
+    const auto total_duration = end_time - start_time;
+
+    std::vector<av_chunk> chunks;
+    chunks.reserve(chunk_count);
+
+    auto chunk_start = start_time;
+    for (const auto keyframe_time : keyframe_times)
+    {
+        if (keyframe_time >= end_time)
+            break;
+
+        const auto remaining_chunks = chunk_count - static_cast<int>(chunks.size());
+        if (remaining_chunks <= 1)
+            break;
+
+        const auto target_duration = (end_time - chunk_start) / remaining_chunks;
+        if (keyframe_time - chunk_start >= target_duration && keyframe_time > chunk_start)
+        {
+            chunks.push_back({chunk_start, keyframe_time});
+            chunk_start = keyframe_time;
+        }
+    }
+    chunks.push_back({chunk_start, end_time});
+
+    /* a tiny last chunk only adds overhead (encoder startup, an extra file), merge it. */
+    if (chunks.size() > 1)
+    {
+        const auto last_duration = chunks.back().end - chunks.back().start;
+        if (last_duration * chunk_count * 4 < total_duration)
+        {
+            const auto last_end = chunks.back().end;
+            chunks.pop_back();
+            chunks.back().end = last_end;
+        }
+    }
+
+    return chunks;
+}
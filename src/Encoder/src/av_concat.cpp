@@ -0,0 +1,187 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CamEncoder/av_concat.h"
+#include "CamEncoder/av_error.h"
+#include <fmt/format.h>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+struct av_input_deleter
+{
+    void operator()(AVFormatContext *context) const noexcept
+    {
+        avformat_close_input(&context);
+    }
+};
+
+struct av_output_deleter
+{
+    void operator()(AVFormatContext *context) const noexcept
+    {
+        if (context->pb != nullptr)
+            avio_closep(&context->pb);
+        avformat_free_context(context);
+    }
+};
+
+struct av_packet_deleter
+{
+    void operator()(AVPacket *packet) const noexcept
+    {
+        av_packet_free(&packet);
+    }
+};
+
+using av_input_ptr = std::unique_ptr<AVFormatContext, av_input_deleter>;
+using av_output_ptr = std::unique_ptr<AVFormatContext, av_output_deleter>;
+using av_packet_ptr = std::unique_ptr<AVPacket, av_packet_deleter>;
+
+static auto open_input(const std::string &filename) -> std::pair<av_input_ptr, int>
+{
+    AVFormatContext *context = nullptr;
+    if (const auto ret = avformat_open_input(&context, filename.c_str(), nullptr, nullptr); ret < 0)
+        throw std::runtime_error(fmt::format("av_concat: unable to open '{}': {}", filename,
+            av_error_to_string(ret)));
+
+    av_input_ptr input(context);
+    if (const auto ret = avformat_find_stream_info(context, nullptr); ret < 0)
+        throw std::runtime_error(fmt::format("av_concat: unable to read stream info of '{}': {}", filename,
+            av_error_to_string(ret)));
+
+    const auto stream_index = av_find_best_stream(context, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (stream_index < 0)
+        throw std::runtime_error(fmt::format("av_concat: no video stream in '{}'", filename));
+
+    return {std::move(input), stream_index};
+}
+
+/* the packets of every input are copied as is, so they must decode with the codec headers of the
+ * first input. */
+static void check_same_stream_parameters(const AVCodecParameters *first, const AVCodecParameters *other,
+    const std::string &filename)
+{
+    if (other->codec_id != first->codec_id)
+        throw std::runtime_error(fmt::format("av_concat: '{}' uses a different codec", filename));
+
+    if (other->width != first->width || other->height != first->height || other->format != first->format)
+        throw std::runtime_error(fmt::format("av_concat: '{}' has a different frame size or format", filename));
+
+    if (other->extradata_size != first->extradata_size ||
+        (first->extradata_size > 0 && std::memcmp(other->extradata, first->extradata, first->extradata_size) != 0))
+        throw std::runtime_error(fmt::format("av_concat: '{}' has different codec headers", filename));
+}
+
+void av_concat_files(const std::vector<std::string> &input_filenames, const std::string &output_filename,
+    av_muxer_type muxer_type)
+{
+    if (input_filenames.empty())
+        throw std::invalid_argument("av_concat: no input files");
+
+    const auto muxer_type_name = av_muxer_type_names.at(static_cast<int>(muxer_type));
+
+    AVFormatContext *output_context = nullptr;
+    if (const auto ret = avformat_alloc_output_context2(&output_context, nullptr, muxer_type_name,
+        output_filename.c_str()); ret < 0)
+        throw std::runtime_error(fmt::format("av_concat: unable to create output context: {}",
+            av_error_to_string(ret)));
+
+    av_output_ptr output(output_context);
+
+    /* the stream parameters (and the codec headers) are taken from the first input. */
+    auto [first_input, first_stream_index] = open_input(input_filenames.front());
+    const auto *first_stream = first_input->streams[first_stream_index];
+
+    AVStream *output_stream = avformat_new_stream(output_context, nullptr);
+    if (output_stream == nullptr)
+        throw std::runtime_error("av_concat: unable to allocate stream");
+
+    if (const auto ret = avcodec_parameters_copy(output_stream->codecpar, first_stream->codecpar); ret < 0)
+        throw std::runtime_error(fmt::format("av_concat: unable to copy stream parameters: {}",
+            av_error_to_string(ret)));
+
+    output_stream->codecpar->codec_tag = 0;
+    output_stream->time_base = first_stream->time_base;
+
+    /* check all inputs before anything is written. */
+    for (size_t i = 1; i < input_filenames.size(); ++i)
+    {
+        const auto [input, stream_index] = open_input(input_filenames[i]);
+        check_same_stream_parameters(first_stream->codecpar, input->streams[stream_index]->codecpar,
+            input_filenames[i]);
+    }
+    first_input.reset();
+
+    if (!(output_context->oformat->flags & AVFMT_NOFILE))
+    {
+        if (const auto ret = avio_open(&output_context->pb, output_filename.c_str(), AVIO_FLAG_WRITE); ret < 0)
+            throw std::runtime_error(fmt::format("av_concat: could not open '{}': {}", output_filename,
+                av_error_to_string(ret)));
+    }
+
+    if (const auto ret = avformat_write_header(output_context, nullptr); ret < 0)
+        throw std::runtime_error(fmt::format("av_concat: unable to write header: {}", av_error_to_string(ret)));
+
+    av_packet_ptr packet_guard(av_packet_alloc());
+    if (packet_guard == nullptr)
+        throw std::runtime_error("av_concat: unable to allocate packet");
+
+    AVPacket *packet = packet_guard.get();
+
+    int64_t last_dts = AV_NOPTS_VALUE;
+    for (const auto &input_filename : input_filenames)
+    {
+        auto [input, stream_index] = open_input(input_filename);
+        const auto input_time_base = input->streams[stream_index]->time_base;
+
+        while (av_read_frame(input.get(), packet) >= 0)
+        {
+            if (packet->stream_index != stream_index)
+            {
+                av_packet_unref(packet);
+                continue;
+            }
+
+            av_packet_rescale_ts(packet, input_time_base, output_stream->time_base);
+            packet->stream_index = output_stream->index;
+            packet->pos = -1;
+
+            /* every chunk encoder starts its decode timestamps before its first frame, make sure
+             * they never go back in time at a chunk boundary. */
+            if (packet->dts != AV_NOPTS_VALUE)
+            {
+                if (last_dts != AV_NOPTS_VALUE && packet->dts <= last_dts)
+                {
+                    packet->dts = last_dts + 1;
+                    if (packet->pts != AV_NOPTS_VALUE && packet->pts < packet->dts)
+                        packet->pts = packet->dts;
+                }
+                last_dts = packet->dts;
+            }
+
+            const auto ret = av_interleaved_write_frame(output_context, packet);
+            av_packet_unref(packet);
+            if (ret < 0)
+                throw std::runtime_error(fmt::format("av_concat: unable to write packet: {}",
+                    av_error_to_string(ret)));
+        }
+    }
+
+    if (const auto ret = av_write_trailer(output_context); ret < 0)
+        throw std::runtime_error(fmt::format("av_concat: unable to write trailer: {}", av_error_to_string(ret)));
+}
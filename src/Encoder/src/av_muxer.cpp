@@ -22,7 +22,58 @@
 
 #include <fmt/format.h>
 #include <fmt/chrono.h>
+#include <algorithm>
 #include <cassert>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
+#include <utility>
+
+// a frame copied into the queue of an encoder thread.
+struct av_muxer_frame
+{
+    timestamp_t timestamp{0};
+    std::vector<unsigned char> data;
+    int width{0};
+    int height{0};
+    int stride{0};
+};
+
+struct av_muxer_stream
+{
+    ~av_muxer_stream()
+    {
+        av_packet_free(&packet);
+    }
+
+    std::unique_ptr<av_video> codec;
+    av_track track{};
+    // reused for every encoded frame, the muxer takes over the packet data.
+    AVPacket *packet{nullptr};
+    int64_t last_dts{AV_NOPTS_VALUE};
+
+    // a preset change, applied before the next encoded frame. -1 when there is none.
+    std::atomic<int> pending_preset{-1};
+    std::atomic<int> queue_depth{0};
+    std::atomic<int> queued_frames{0};
+    std::atomic<int64_t> encoded_frames{0};
+    std::atomic<int64_t> bytes_written{0};
+    std::atomic<int64_t> dropped_frames{0};
+
+    /* the encoder thread and its frame queue */
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable queue_changed;
+    // signaled when the encoder thread took a frame from the queue, or stopped.
+    std::condition_variable queue_space;
+    std::deque<av_muxer_frame> queue;
+    // the buffers of encoded frames, reused for the next queued frames.
+    std::vector<std::vector<unsigned char>> free_buffers;
+    bool stop{false};
+    std::exception_ptr error;
+};
 
 void av_log_packet(const AVFormatContext *fmt_ctx, const AVPacket *pkt)
 {
@@ -74,7 +125,15 @@ av_muxer::av_muxer(std::string filename, const av_muxer_type muxer_type, av_meta
 
 av_muxer::~av_muxer()
 {
-    flush();
+    /* nothing may escape the destructor, call flush() first to handle the errors of the last frames. */
+    try
+    {
+        flush();
+    }
+    catch (const std::exception &e)
+    {
+        _log("av_muxer: flushing the encoders failed: {}\n", e.what());
+    }
 
     /* Write the trailer, if any. The trailer must be written before you
      * close the CodecContexts open when you wrote the header; otherwise
@@ -87,7 +146,7 @@ av_muxer::~av_muxer()
     //    close_stream(format_context_, &audio_track);
 
     /* Close each codec. */
-    video_codec_.reset();
+    streams_.clear();
 
     if (!(output_format_->flags & AVFMT_NOFILE))
         /* Close the output file. */
@@ -105,7 +164,8 @@ av_muxer::~av_muxer()
 void av_muxer::open()
 {
     av_dict avargs;
-    video_codec_->open(video_track.stream, avargs);
+    for (auto &stream : streams_)
+        stream->codec->open(stream->track.stream, avargs);
 
     // if (output_format_->audio_codec != AV_CODEC_ID_NONE)
     //{
@@ -148,35 +208,278 @@ void av_muxer::open()
 
 void av_muxer::flush()
 {
-    encode_frame(0, nullptr, 0, 0, 0);
+    /* an encoder can only be drained once, it does not accept frames after that. */
+    if (flushed_)
+        return;
+    flushed_ = true;
+
+    _stop_encoder_threads();
+
+    /* a stream whose encoder thread failed is not drained, its error is reported instead. */
+    std::exception_ptr error;
+    for (auto &stream : streams_)
+    {
+        if (stream->error)
+        {
+            if (!error)
+                error = stream->error;
+            stream->error = nullptr;
+            continue;
+        }
+
+        try
+        {
+            _encode_stream_frame(*stream, 0, nullptr, 0, 0, 0);
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    if (error)
+        std::rethrow_exception(error);
 }
 
 void av_muxer::encode_frame(timestamp_t timestamp, unsigned char *data, int width, int height, int stride)
 {
-    video_codec_->push_encode_frame(timestamp, data, width, height, stride);
+    encode_frame(0, timestamp, data, width, height, stride);
+}
 
-    AVPacket pkt = {};
-    av_init_packet(&pkt);
+void av_muxer::encode_frame(int stream_index, timestamp_t timestamp, unsigned char *data, int width, int height,
+    int stride)
+{
+    if (threaded_)
+        throw std::runtime_error("av_muxer: frames must be queued while the encoder threads are running");
+
+    _encode_stream_frame(_get_stream(stream_index), timestamp, data, width, height, stride);
+}
+
+void av_muxer::start_encoder_threads(const av_muxer_thread_config &config)
+{
+    if (threaded_)
+        return;
 
-    const auto time_base = video_codec_->get_time_base();
+    thread_config_ = config;
+    thread_config_.max_queue_depth = std::max(thread_config_.max_queue_depth, 1);
+
+    for (auto &stream : streams_)
+    {
+        stream->stop = false;
+        stream->thread = std::thread([this, &muxer_stream = *stream]() { _run_encoder_thread(muxer_stream); });
+    }
+    threaded_ = true;
+}
+
+bool av_muxer::queue_frame(int stream_index, timestamp_t timestamp, const unsigned char *data, int width,
+    int height, int stride)
+{
+    if (!threaded_)
+        throw std::runtime_error("av_muxer: the encoder threads are not running");
+
+    auto &stream = _get_stream(stream_index);
+    const auto max_queue_depth = static_cast<size_t>(thread_config_.max_queue_depth);
+
+    av_muxer_frame frame{timestamp, {}, width, height, stride};
+    {
+        std::unique_lock lock(stream.mutex);
+        if (thread_config_.full_policy == av_queue_full_policy::block)
+        {
+            stream.queue_space.wait(lock, [&stream, max_queue_depth]() {
+                return stream.queue.size() < max_queue_depth || stream.error;
+            });
+        }
+
+        if (stream.error)
+            std::rethrow_exception(stream.error);
+
+        /* only the caller adds frames, so the queue can not grow until we pushed the frame */
+        if (stream.queue.size() >= max_queue_depth)
+        {
+            stream.dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (!stream.free_buffers.empty())
+        {
+            frame.data = std::move(stream.free_buffers.back());
+            stream.free_buffers.pop_back();
+        }
+    }
+
+    /* copy outside of the lock, so the encoder thread can keep going. */
+    frame.data.assign(data, data + static_cast<size_t>(stride) * height);
+
+    ++stream.queued_frames;
+    {
+        std::lock_guard lock(stream.mutex);
+        stream.queue.push_back(std::move(frame));
+    }
+    stream.queue_changed.notify_one();
+    return true;
+}
+
+void av_muxer::request_keyframe() noexcept
+{
+    for (auto &stream : streams_)
+        stream->codec->request_keyframe();
+}
+
+void av_muxer::set_preset(video::preset preset) noexcept
+{
+    for (auto &stream : streams_)
+        stream->pending_preset = static_cast<int>(preset);
+}
+
+int av_muxer::get_queue_depth() const noexcept
+{
+    int queue_depth = 0;
+    for (const auto &stream : streams_)
+        queue_depth = std::max(queue_depth, stream->queue_depth + stream->queued_frames);
+    return queue_depth;
+}
+
+int64_t av_muxer::get_avoided_conversion_count() const noexcept
+{
+    int64_t count = 0;
+    for (const auto &stream : streams_)
+        count += stream->codec->get_avoided_conversion_count();
+    return count;
+}
+
+av_muxer_stats av_muxer::get_stats() const noexcept
+{
+    av_muxer_stats stats;
+    for (std::size_t i = 0; i < streams_.size(); ++i)
+    {
+        const auto &stream = *streams_[i];
+        const auto encoded_frames = stream.encoded_frames.load(std::memory_order_relaxed);
+        stats.encoded_frames = i == 0 ? encoded_frames : std::min(stats.encoded_frames, encoded_frames);
+        stats.bytes_written += stream.bytes_written.load(std::memory_order_relaxed);
+        stats.dropped_frames += stream.dropped_frames.load(std::memory_order_relaxed);
+    }
+    stats.queue_depth = get_queue_depth();
+    return stats;
+}
+
+int av_muxer::get_stream_count() const noexcept
+{
+    return static_cast<int>(streams_.size());
+}
+
+void av_muxer::_encode_stream_frame(av_muxer_stream &stream, timestamp_t timestamp, unsigned char *data,
+    int width, int height, int stride)
+{
+    auto &codec = *stream.codec;
+    if (const auto preset = stream.pending_preset.exchange(-1); preset >= 0)
+        codec.set_preset(static_cast<video::preset>(preset));
+
+    /* drain the current encoder before switching to the reconfigured encoder. */
+    if (data != nullptr && codec.has_pending_reconfigure())
+    {
+        _encode_stream_frame(stream, 0, nullptr, 0, 0, 0);
+        codec.reconfigure();
+    }
+
+    codec.push_encode_frame(timestamp, data, width, height, stride);
+
+    const auto time_base = codec.get_time_base();
 
     for(bool valid_packet = true; valid_packet;)
     {
-        if (!video_codec_->pull_encoded_packet(&pkt, &valid_packet))
+        if (!codec.pull_encoded_packet(stream.packet, &valid_packet))
             throw std::runtime_error("pull encoded packet failed");
 
         if (!valid_packet)
             break;
 
-        write_frame(time_base, video_track.stream, &pkt);
-        av_packet_unref(&pkt);
+        stream.bytes_written.fetch_add(stream.packet->size, std::memory_order_relaxed);
+        write_frame(time_base, stream.track.stream, stream.packet, &stream.last_dts);
+        av_packet_unref(stream.packet);
     }
+
+    if (data != nullptr)
+        stream.encoded_frames.fetch_add(1, std::memory_order_relaxed);
+    stream.queue_depth = codec.get_queue_depth();
 }
 
-void av_muxer::add_stream(std::unique_ptr<av_video> video_codec)
+void av_muxer::_run_encoder_thread(av_muxer_stream &stream)
 {
-    video_codec_ = std::move(video_codec);
-    const auto codec_context = video_codec_->get_codec_context();
+    try
+    {
+        for (;;)
+        {
+            av_muxer_frame frame;
+            {
+                std::unique_lock lock(stream.mutex);
+                stream.queue_changed.wait(lock, [&stream]() { return stream.stop || !stream.queue.empty(); });
+
+                /* the queue is always drained before the thread stops. */
+                if (stream.queue.empty())
+                    return;
+
+                frame = std::move(stream.queue.front());
+                stream.queue.pop_front();
+            }
+            stream.queue_space.notify_one();
+
+            _encode_stream_frame(stream, frame.timestamp, frame.data.data(), frame.width, frame.height,
+                frame.stride);
+            --stream.queued_frames;
+
+            std::lock_guard lock(stream.mutex);
+            stream.free_buffers.push_back(std::move(frame.data));
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard lock(stream.mutex);
+            stream.error = std::current_exception();
+        }
+        /* a blocked queue_frame() would otherwise wait forever */
+        stream.queue_space.notify_all();
+    }
+}
+
+void av_muxer::_stop_encoder_threads()
+{
+    if (!threaded_)
+        return;
+
+    for (auto &stream : streams_)
+    {
+        {
+            std::lock_guard lock(stream->mutex);
+            stream->stop = true;
+        }
+        stream->queue_changed.notify_one();
+    }
+
+    for (auto &stream : streams_)
+        stream->thread.join();
+
+    threaded_ = false;
+}
+
+auto av_muxer::_get_stream(int stream_index) const -> av_muxer_stream &
+{
+    if (stream_index < 0 || stream_index >= get_stream_count())
+        throw std::invalid_argument(fmt::format("av_muxer: invalid stream index: {}", stream_index));
+
+    return *streams_[stream_index];
+}
+
+int av_muxer::add_stream(std::unique_ptr<av_video> video_codec)
+{
+    auto stream = std::make_unique<av_muxer_stream>();
+    stream->codec = std::move(video_codec);
+    stream->packet = av_packet_alloc();
+    if (stream->packet == nullptr)
+        throw std::runtime_error("av_muxer: unable to allocate packet");
+
+    const auto codec_context = stream->codec->get_codec_context();
 
     av_track track = {};
     track.type = av_track_type::video;
@@ -187,11 +490,14 @@ void av_muxer::add_stream(std::unique_ptr<av_video> video_codec)
     track.stream->id = format_context_->nb_streams - 1;
     track.stream->time_base = time_base_;
 
-    /* Some formats want stream headers to be separate. */
-    if (format_context_->oformat->flags & AVFMT_GLOBALHEADER)
+    /* Some formats want stream headers to be separate. A reconfigurable encoder sends its headers
+     * in-band, so the parameter sets of a restarted encoder reach the decoder as well. */
+    if ((format_context_->oformat->flags & AVFMT_GLOBALHEADER) && !stream->codec->is_reconfigurable())
         codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
-    video_track = track;
+    stream->track = track;
+    streams_.push_back(std::move(stream));
+    return get_stream_count() - 1;
 }
 
 AVFrame *av_muxer::alloc_audio_frame(enum AVSampleFormat sample_fmt, uint64_t channel_layout, int sample_rate,
@@ -353,16 +659,30 @@ void av_muxer::close_stream(AVFormatContext *format_context, av_track *ost)
     avcodec_free_context(&ost->codec_context);
 }
 
-int av_muxer::write_frame(const AVRational &time_base, AVStream *stream, AVPacket *pkt)
+int av_muxer::write_frame(const AVRational &time_base, AVStream *stream, AVPacket *pkt, int64_t *last_dts)
 {
     /* rescale output packet timestamp values from codec to stream timebase */
     av_packet_rescale_ts(pkt, time_base, stream->time_base);
     pkt->stream_index = stream->index;
 
+    /* Make sure the decode timestamps never go back in time when the encoder is restarted. A
+     * reconfigurable encoder has no b-frames, so its dts equals its pts and is left as is. */
+    if (last_dts != nullptr && pkt->dts != AV_NOPTS_VALUE)
+    {
+        if (*last_dts != AV_NOPTS_VALUE && pkt->dts <= *last_dts)
+        {
+            pkt->dts = *last_dts + 1;
+            if (pkt->pts != AV_NOPTS_VALUE && pkt->pts < pkt->dts)
+                pkt->pts = pkt->dts;
+        }
+        *last_dts = pkt->dts;
+    }
+
     /* Log packet info */
     //av_log_packet(format_context_, pkt);
 
-    /* Write the compressed frame to the media file. */
+    /* Write the compressed frame to the media file, the streams are interleaved by dts. */
+    std::lock_guard lock(write_mutex_);
     const auto ret = av_interleaved_write_frame(format_context_, pkt);
     assert(ret == 0);
     return ret;
@@ -0,0 +1,80 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CamEncoder/av_packet_pool.h"
+#include <climits>
+#include <cstring>
+
+av_packet_pool::~av_packet_pool()
+{
+    /* buffers that are still borrowed keep their pool alive until they are released. */
+    for (auto &pool : pools_)
+        av_buffer_pool_uninit(&pool);
+}
+
+int av_packet_pool::alloc_packet(AVPacket *pkt, int size)
+{
+    if (size < 0 || size > INT_MAX / 2 - AV_INPUT_BUFFER_PADDING_SIZE)
+        return AVERROR(EINVAL);
+
+    const auto size_class = get_size_class(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    auto &pool = pools_.at(size_class);
+    if (pool == nullptr)
+    {
+        pool = av_buffer_pool_init2(1 << (size_class + min_size_class), this, allocate_buffer, nullptr);
+        if (pool == nullptr)
+            return AVERROR(ENOMEM);
+    }
+
+    AVBufferRef *buf = av_buffer_pool_get(pool);
+    if (buf == nullptr)
+        return AVERROR(ENOMEM);
+
+    ++acquire_count_;
+
+    av_packet_unref(pkt);
+    pkt->buf = buf;
+    pkt->data = buf->data;
+    pkt->size = size;
+    std::memset(pkt->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    return 0;
+}
+
+int64_t av_packet_pool::get_allocation_count() const noexcept
+{
+    return allocation_count_;
+}
+
+int64_t av_packet_pool::get_acquire_count() const noexcept
+{
+    return acquire_count_;
+}
+
+int av_packet_pool::get_size_class(int size) noexcept
+{
+    int size_class = 0;
+    while ((1 << (size_class + min_size_class)) < size)
+        ++size_class;
+    return size_class;
+}
+
+AVBufferRef *av_packet_pool::allocate_buffer(void *opaque, int size)
+{
+    auto *self = static_cast<av_packet_pool *>(opaque);
+    ++self->allocation_count_;
+    return av_buffer_alloc(size);
+}
@@ -0,0 +1,117 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CamEncoder/av_quality_controller.h"
+#include <algorithm>
+#include <stdexcept>
+
+// smoothing factor of the exponential moving average of the encoder load.
+constexpr double load_smoothing = 0.1;
+
+av_quality_controller::av_quality_controller(const av_quality_controller_config &config)
+    : config_(config)
+{
+    const auto max_preset = static_cast<int>(config_.max_preset);
+    const auto min_preset = static_cast<int>(config_.min_preset);
+    if (min_preset > max_preset)
+        throw std::invalid_argument("av_quality_controller: min preset is slower than max preset");
+
+    if (config_.frame_budget <= 0.0)
+        throw std::invalid_argument("av_quality_controller: invalid frame budget");
+
+    config_.max_fps_divisor = std::max(config_.max_fps_divisor, 1);
+    preset_level_count_ = max_preset - min_preset + 1;
+}
+
+av_quality_decision av_quality_controller::update(double encode_time, int queue_depth) noexcept
+{
+    /* the frame rate divisor gives every frame more time */
+    const auto effective_budget = config_.frame_budget * get_fps_divisor();
+    const auto frame_load = encode_time / effective_budget;
+
+    if (overload_count_ == 0 && headroom_count_ == 0 && load_ == 0.0)
+        load_ = frame_load;
+    else
+        load_ += (frame_load - load_) * load_smoothing;
+
+    const auto is_late = frame_load > config_.overload_ratio || queue_depth > config_.max_queue_depth;
+    if (is_late)
+        ++overload_count_;
+    else if (overload_count_ > 0)
+        --overload_count_;
+
+    /* headroom is always measured against the full frame rate, so stepping up does not overload
+     * the encoder again right away. */
+    const auto nominal_load = load_ * get_fps_divisor();
+    if (!is_late && nominal_load < config_.headroom_ratio && queue_depth <= config_.max_queue_depth / 2)
+        ++headroom_count_;
+    else
+        headroom_count_ = 0;
+
+    if (overload_count_ >= config_.overload_frames && level_ + 1 < get_level_count())
+    {
+        _change_level(level_ + 1);
+        return av_quality_decision::step_down;
+    }
+
+    if (headroom_count_ >= config_.headroom_frames && level_ > 0)
+    {
+        _change_level(level_ - 1);
+        return av_quality_decision::step_up;
+    }
+
+    return av_quality_decision::none;
+}
+
+video::preset av_quality_controller::get_preset() const noexcept
+{
+    const auto max_preset = static_cast<int>(config_.max_preset);
+    const auto preset_level = std::min(level_, preset_level_count_ - 1);
+    return static_cast<video::preset>(max_preset - preset_level);
+}
+
+int av_quality_controller::get_fps_divisor() const noexcept
+{
+    if (level_ < preset_level_count_)
+        return 1;
+    return level_ - preset_level_count_ + 2;
+}
+
+int av_quality_controller::get_level() const noexcept
+{
+    return level_;
+}
+
+int av_quality_controller::get_level_count() const noexcept
+{
+    return preset_level_count_ + config_.max_fps_divisor - 1;
+}
+
+double av_quality_controller::get_load() const noexcept
+{
+    return load_;
+}
+
+void av_quality_controller::_change_level(int level) noexcept
+{
+    level_ = level;
+
+    /* start measuring from scratch at the new level. */
+    load_ = 0.0;
+    overload_count_ = 0;
+    headroom_count_ = 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CamEncoder/av_scene_detect.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+namespace
+{
+constexpr uint64_t hash_seed = 0xcbf29ce484222325ull;
+constexpr uint64_t hash_prime = 0x100000001b3ull;
+
+/* hash 8 bytes at a time, the tail is hashed byte by byte. */
+uint64_t hash_span(uint64_t hash, const unsigned char *data, const int size) noexcept
+{
+    int i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t value;
+        std::memcpy(&value, data + i, sizeof(value));
+        hash = (hash ^ value) * hash_prime;
+    }
+
+    for (; i < size; ++i)
+        hash = (hash ^ data[i]) * hash_prime;
+
+    return hash;
+}
+} // namespace
+
+av_scene_change_detector::av_scene_change_detector(int width, int height, int bytes_per_pixel,
+    double threshold, int tile_size)
+    : width_(width)
+    , height_(height)
+    , bytes_per_pixel_(bytes_per_pixel)
+    , tile_size_(tile_size)
+    , tiles_x_(0)
+    , tiles_y_(0)
+    , threshold_(threshold)
+{
+    if (width <= 0 || height <= 0 || bytes_per_pixel <= 0 || tile_size <= 0)
+        throw std::invalid_argument("av_scene_change_detector: invalid frame dimensions");
+
+    tiles_x_ = (width_ + tile_size_ - 1) / tile_size_;
+    tiles_y_ = (height_ + tile_size_ - 1) / tile_size_;
+    tile_hashes_.resize(static_cast<size_t>(tiles_x_) * tiles_y_, 0);
+}
+
+bool av_scene_change_detector::detect(const unsigned char *data, int stride)
+{
+    dirty_tile_count_ = 0;
+
+    const auto tile_line_size = tile_size_ * bytes_per_pixel_;
+    const auto line_size = width_ * bytes_per_pixel_;
+
+    std::vector<uint64_t> row_hashes(tiles_x_);
+    for (int tile_y = 0; tile_y < tiles_y_; ++tile_y)
+    {
+        std::fill(row_hashes.begin(), row_hashes.end(), hash_seed);
+
+        const auto y_begin = tile_y * tile_size_;
+        const auto y_end = std::min(y_begin + tile_size_, height_);
+        for (int y = y_begin; y < y_end; ++y)
+        {
+            const auto line = data + static_cast<ptrdiff_t>(y) * stride;
+            for (int tile_x = 0; tile_x < tiles_x_; ++tile_x)
+            {
+                const auto offset = tile_x * tile_line_size;
+                const auto size = std::min(tile_line_size, line_size - offset);
+                row_hashes[tile_x] = hash_span(row_hashes[tile_x], line + offset, size);
+            }
+        }
+
+        auto *hashes = &tile_hashes_[static_cast<size_t>(tile_y) * tiles_x_];
+        for (int tile_x = 0; tile_x < tiles_x_; ++tile_x)
+        {
+            if (hashes[tile_x] != row_hashes[tile_x])
+                ++dirty_tile_count_;
+            hashes[tile_x] = row_hashes[tile_x];
+        }
+    }
+
+    if (!has_previous_frame_)
+    {
+        has_previous_frame_ = true;
+        dirty_tile_count_ = 0;
+        return false;
+    }
+
+    return get_dirty_ratio() >= threshold_;
+}
+
+void av_scene_change_detector::reset() noexcept
+{
+    has_previous_frame_ = false;
+    dirty_tile_count_ = 0;
+}
+
+double av_scene_change_detector::get_dirty_ratio() const noexcept
+{
+    return static_cast<double>(dirty_tile_count_) / get_tile_count();
+}
+
+int av_scene_change_detector::get_tile_count() const noexcept
+{
+    return tiles_x_ * tiles_y_;
+}
+
+int av_scene_change_detector::get_dirty_tile_count() const noexcept
+{
+    return dirty_tile_count_;
+}
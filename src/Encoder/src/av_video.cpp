@@ -23,6 +23,7 @@
 #include "av_log.h"
 
 #include <yuvconvert.h>
+#include <algorithm>
 #include <cassert>
 
 
@@ -52,6 +53,19 @@ int calculate_gop_size(const av_video_meta &meta)
     return static_cast<int>(gob_size);
 }
 
+int av_get_scale_flags(video::scale_filter filter) noexcept
+{
+    switch (filter)
+    {
+    case video::scale_filter::point: return SWS_POINT;
+    case video::scale_filter::bilinear: return SWS_BILINEAR;
+    case video::scale_filter::area: return SWS_AREA;
+    case video::scale_filter::bicubic: return SWS_BICUBIC;
+    case video::scale_filter::lanczos: return SWS_LANCZOS;
+    }
+    return SWS_BICUBIC;
+}
+
 void apply_preset(av_dict &av_opts, std::optional<video::preset> preset)
 {
     const auto preset_idx = static_cast<int>(preset.value_or(video::preset::medium));
@@ -89,6 +103,62 @@ void apply_level(AVCodecContext *condext, std::optional<video::codec_level> leve
     condext->level = level_value;
 }
 
+void apply_threading(AVCodecContext *context, av_dict &av_opts, const av_video_meta &meta)
+{
+    if (meta.thread_count)
+        context->thread_count = meta.thread_count.value();
+
+    if (meta.thread_type)
+    {
+        /* libx264 enables sliced-threads when slice threading is selected. */
+        switch (meta.thread_type.value())
+        {
+        case video::thread_type::frame:
+            context->thread_type = FF_THREAD_FRAME;
+            break;
+        case video::thread_type::slice:
+            context->thread_type = FF_THREAD_SLICE;
+            break;
+        }
+    }
+
+    if (meta.slices)
+        context->slices = meta.slices.value();
+
+    if (meta.lookahead)
+        av_opts["rc-lookahead"] = static_cast<int64_t>(meta.lookahead.value());
+}
+
+void apply_compression(av_dict &av_opts, const av_video_meta &meta)
+{
+    /* lz4 and zstd are extensions that only our own decoder understands. The stream is tagged cscd,
+     * so the default must stay readable by the ffmpeg cscd decoder, and with it every player. */
+    const auto compression = meta.compression.value_or(video::compression::lzo);
+    av_opts["algorithm"] = static_cast<int64_t>(compression);
+
+    if (meta.compression_level)
+    {
+        const auto level = static_cast<int64_t>(meta.compression_level.value());
+        switch (compression)
+        {
+        case video::compression::lzo:
+            break; // lzo1x-1 has no levels.
+        case video::compression::gzip:
+            av_opts["gzip_level"] = level;
+            break;
+        case video::compression::lz4:
+            av_opts["lz4_level"] = level;
+            break;
+        case video::compression::zstd:
+            av_opts["zstd_level"] = level;
+            break;
+        }
+    }
+
+    if (meta.long_range)
+        av_opts["zstd_long"] = 1;
+}
+
 void dump_context(AVCodecContext *context)
 {
     AVCodecParameters * params = avcodec_parameters_alloc();
@@ -106,6 +176,8 @@ void dump_context(AVCodecContext *context)
     _log("         level: {}\n", params->level);
     _log("  aspect ratio: {}\n", params->sample_aspect_ratio);
     _log("    dimentions: {}x{}\n", params->width, params->height);
+    _log("       threads: {} type: {} slices: {}\n", context->thread_count, context->thread_type,
+        context->slices);
 
     avcodec_parameters_free(&params);
     params = nullptr;
@@ -161,6 +233,33 @@ void my_av_log_callback(void *avcl, int level, const char *fmt, va_list vl)
 }
 
 
+std::vector<AVPixelFormat> av_get_native_pixel_formats(video::codec codec)
+{
+    switch (codec)
+    {
+    case video::codec::camstudio:
+        return {AV_PIX_FMT_BGR0, AV_PIX_FMT_BGR24, AV_PIX_FMT_RGB555LE};
+    case video::codec::x264:
+        return {AV_PIX_FMT_YUV420P};
+    }
+    return {};
+}
+
+AVPixelFormat av_negotiate_pixel_format(const std::vector<AVPixelFormat> &source_formats, video::codec codec)
+{
+    if (source_formats.empty())
+        throw std::invalid_argument("av_negotiate_pixel_format: the source has no pixel formats");
+
+    const auto native_formats = av_get_native_pixel_formats(codec);
+    for (const auto source_format : source_formats)
+    {
+        if (std::find(native_formats.begin(), native_formats.end(), source_format) != native_formats.end())
+            return source_format;
+    }
+
+    return source_formats.front();
+}
+
 av_video::av_video(const av_video_codec &config, const av_video_meta &meta)
 {
     //av_log_set_level(AV_LOG_DEBUG);
@@ -172,11 +271,17 @@ av_video::av_video(const av_video_codec &config, const av_video_meta &meta)
     switch (meta.codec)
     {
     case video::codec::camstudio:
+    {
         codec_type_ = av_video_codec_type::cscd;
         input_pixel_format_ = config.pixel_format;
-        output_pixel_format_ = AV_PIX_FMT_BGR24;
+
+        /* the camstudio codec takes a couple of rgb formats, only convert when we have to. */
+        const auto native_formats = av_get_native_pixel_formats(meta.codec);
+        const auto is_native = std::find(native_formats.begin(), native_formats.end(), input_pixel_format_)
+            != native_formats.end();
+        output_pixel_format_ = is_native ? input_pixel_format_ : AV_PIX_FMT_BGR24;
         codec_ = &cam_codec_encoder;
-        break;
+    } break;
     case video::codec::x264:
         codec_type_ = av_video_codec_type::h264;
         input_pixel_format_ = config.pixel_format;
@@ -190,116 +295,36 @@ av_video::av_video(const av_video_codec &config, const av_video_meta &meta)
         break;
     }
 
-    context_ = avcodec_alloc_context3(codec_);
+    meta_ = meta;
+    create_codec_context(meta);
 
-    auto fps = AVRational{ meta.fps.num, meta.fps.den };
+    frame_ = create_video_frame(context_->pix_fmt, context_->width, context_->height,
+        codec_type_ == av_video_codec_type::cscd);
 
-    // Check if the codec has a specific set of supported frame rates. If it has, find the nearest
-    // matching framerate.
-    if (codec_->supported_framerates)
+    /* without a conversion or scale, frames are copied into the encoder frame directly. */
+    if (!is_conversion_free())
     {
-        const auto idx = av_find_nearest_q_idx(fps, codec_->supported_framerates);
-        AVRational supported_fps = codec_->supported_framerates[idx];
-        if (supported_fps != fps)
-        {
-            _log("av_video: framerate {} is not supported. Using {}.", fps, supported_fps);
-            fps = supported_fps;
-        }
+        sws_context_ = create_software_scaler(
+            input_pixel_format_, meta.width, meta.height,
+            output_pixel_format_, context_->width, context_->height,
+            av_get_scale_flags(meta.scale_filter.value_or(video::scale_filter::bicubic))
+        );
     }
 
-    // always force variable framerate with ms timestamps.
-    context_->time_base = { 1, 1000 };
-
-    if (codec_type_ != av_video_codec_type::cscd)
+    if (meta.scene_change_threshold)
     {
-        // calculate a approximate gob size.
-        context_->gop_size = calculate_gop_size(meta);
-
-        // either quality of bitrate must be set.
-        assert(!!meta.quality || !!meta.bitrate);
-
-        apply_preset(av_opts_, meta.preset);
-        apply_tune(av_opts_, meta.tune);
-        apply_profile(av_opts_, meta.profile);
-        apply_level(context_, meta.level);
-
-        switch(meta.container)
-        {
-        case video::container::mp4:
-        {
-            av_opts_["brand"] = "mp42";
-
-            /*
-             * disable_chpl: Disable Nero chapter markers (chpl atom)
-             */
-            av_opts_["movflags"] = "disable_chpl";
-        } break;
-        }
-
-        /*!
-         * set variable framerate.
-         * \see https://superuser.com/questions/908295/ffmpeg-libx264-how-to-specify-a-variable-frame-rate-but-with-a-maximum
-         */
-        //av_opts_["vsync"] = "vfr";
-
-        // Now set the things in context that we don't want to allow
-        // the user to override.
-        if (meta.bitrate)
-        {
-            // Average bitrate
-            context_->bit_rate = static_cast<int64_t>(1000.0 * meta.bitrate.value());
-
-            // ffmpeg's mpeg2 encoder requires that the bit_rate_tolerance be >= bitrate * fps
-            //context_->bit_rate_tolerance = static_cast<int>(context_->bit_rate * av_q2d(fps) + 1);
-        }
-        else
-        {
-            /* Constant quantizer */
-            context_->flags |= AV_CODEC_FLAG_QSCALE;
-
-            /* global_quality only seem to apply to mpeg 1, 2 and 4 */
-            //context_->global_quality =
-            //      static_cast<int>(FF_QP2LAMBDA * meta.quality.value() + 0.5);
-
-            // x264 requires this.
-            av_opts_["crf"] = static_cast<int64_t>(meta.quality.value());
-        }
-    }
-    else
-    {
-        av_opts_["algorithm"] = 1; // select lzo compressor
-        av_opts_["gzip_level"] = 9; // gzip compresion level is not used.
-        av_opts_["autokeyframe"] = 1; // enable keyframe insertion every x frames.
-        av_opts_["autokeyframe_rate"] = calculate_gop_size(meta) * 10;
+        /* the padded size, bgr0 has 24 significant bits in 32 bit pixels */
+        const auto bits_per_pixel = av_get_padded_bits_per_pixel(av_pix_fmt_desc_get(input_pixel_format_));
+        scene_detector_ = std::make_unique<av_scene_change_detector>(meta.width, meta.height,
+            bits_per_pixel / 8, meta.scene_change_threshold.value());
     }
-
-    context_->width = meta.width;
-    context_->height = meta.height;
-    context_->pix_fmt = output_pixel_format_;
-    context_->sample_aspect_ratio.num = 1;
-    context_->sample_aspect_ratio.den = 1;
-
-    set_colorspace(context_, av_video_colorspace::JPEG);
-
-    // \todo we have no grayscale settings for now
-    //if (grayscale)
-    //    context->flags |= AV_CODEC_FLAG_GRAY;
-
-    context_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
-
-    frame_ = create_video_frame(context_->pix_fmt, context_->width, context_->height,
-        codec_type_ == av_video_codec_type::cscd);
-
-    sws_context_ = create_software_scaler(
-        input_pixel_format_, context_->width, context_->height,
-        output_pixel_format_, context_->width, context_->height
-    );
 }
 
 av_video::~av_video()
 {
     avcodec_free_context(&context_);
     av_frame_free(&frame_);
+    sws_freeContext(sws_context_);
 }
 
 void av_video::open(AVStream *stream, av_dict &dict)
@@ -352,10 +377,6 @@ void av_video::push_encode_frame(timestamp_t timestamp, unsigned char *data, int
         const auto src_width = width;
         const auto src_height = height;
 
-        const auto dst_width = context_->width;
-        const auto dst_height = context_->height;
-        const auto dst_pixel_format = context_->pix_fmt;
-
         /* \todo fix hard coded src ptr and stride. */
         uint8_t *src[3] = {const_cast<uint8_t *>(src_data), nullptr, nullptr};
         int src_stride[3] = {stride, 0, 0};
@@ -363,7 +384,7 @@ void av_video::push_encode_frame(timestamp_t timestamp, unsigned char *data, int
         /* special case camstudio codec, because it wants its data upside down. */
         if (codec_type_ == av_video_codec_type::cscd)
         {
-            src[0] = src[0] + (dst_height * src_stride[0]) - src_stride[0];
+            src[0] = src[0] + (src_height * src_stride[0]) - src_stride[0];
             src_stride[0] = src_stride[0] * -1;
         }
 
@@ -386,7 +407,14 @@ void av_video::push_encode_frame(timestamp_t timestamp, unsigned char *data, int
             break;
         }
 
-        //if (output_pixel_format_ != AV_PIX_FMT_YUV420P)
+        if (sws_context_ == nullptr)
+        {
+            const auto bytes_per_line = av_image_get_linesize(input_pixel_format_, context_->width, 0);
+            av_image_copy_plane(frame_->data[0], dst_stride[0], src[0], src_stride[0], bytes_per_line,
+                context_->height);
+            ++avoided_conversion_count_;
+        }
+        else
         {
             if (int ret = sws_scale(sws_context_, src, src_stride, 0, src_height, frame_->data, dst_stride); ret < 0)
                 throw std::runtime_error(fmt::format("av_video: sws scale failed: {}", av_error_to_string(ret)));
@@ -404,8 +432,18 @@ void av_video::push_encode_frame(timestamp_t timestamp, unsigned char *data, int
         }
 #endif
 
+        /* the scene detector runs on the source frame, before the cscd flip or color conversion */
+        bool insert_keyframe = keyframe_requested_.exchange(false);
+        if (scene_detector_ && scene_detector_->detect(data, stride))
+        {
+            _log("av_video: scene change detected, dirty ratio: {}\n", scene_detector_->get_dirty_ratio());
+            insert_keyframe = true;
+        }
+
+        frame_->pict_type = insert_keyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
         frame_->pts = timestamp;
         encode_frame = frame_;
+        ++queue_depth_;
     }
     else
     {
@@ -428,7 +466,15 @@ bool av_video::pull_encoded_packet(AVPacket *pkt, bool *valid_packet)
     *valid_packet = (ret == 0);
 
     if (ret == 0)
+    {
+        /* the frames still in the encoder when the first packet comes out are its pipeline delay
+         * (lookahead, frame threads and b-frames), in normal operation it stays at that depth. */
+        if (pipeline_delay_ < 0)
+            pipeline_delay_ = std::max(queue_depth_ - 1, 0);
+
+        queue_depth_ = std::max(queue_depth_ - 1, 0);
         return true;
+    }
 
     if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
         return true;
@@ -436,6 +482,90 @@ bool av_video::pull_encoded_packet(AVPacket *pkt, bool *valid_packet)
     return false;
 }
 
+void av_video::request_keyframe() noexcept
+{
+    keyframe_requested_ = true;
+}
+
+void av_video::set_preset(video::preset preset) noexcept
+{
+    if (!is_reconfigurable())
+        return;
+
+    if (meta_.preset.value_or(video::preset::medium) == preset)
+    {
+        pending_preset_.reset();
+        return;
+    }
+
+    pending_preset_ = preset;
+}
+
+bool av_video::has_pending_reconfigure() const noexcept
+{
+    return pending_preset_.has_value();
+}
+
+bool av_video::is_reconfigurable() const noexcept
+{
+    return meta_.reconfigurable && codec_type_ != av_video_codec_type::cscd;
+}
+
+void av_video::reconfigure()
+{
+    if (!pending_preset_)
+        return;
+
+    _log("av_video: reconfigure preset {} -> {}\n",
+        video::preset_names.at(static_cast<int>(meta_.preset.value_or(video::preset::medium))),
+        video::preset_names.at(static_cast<int>(pending_preset_.value())));
+
+    meta_.preset = pending_preset_;
+    pending_preset_.reset();
+
+    avcodec_free_context(&context_);
+    av_opts_.clear();
+
+    /* a reconfigurable encoder has no global header (see av_muxer::add_stream), its parameter sets
+     * are repeated in-band with every keyframe. So the decoder picks up those of the new encoder. */
+    create_codec_context(meta_);
+
+    av_dict dict;
+    open(nullptr, dict);
+
+    queue_depth_ = 0;
+    pipeline_delay_ = -1;
+    keyframe_requested_ = true;
+}
+
+int av_video::get_queue_depth() const noexcept
+{
+    /* until the first packet the encoder is still filling its pipeline. */
+    if (pipeline_delay_ < 0)
+        return 0;
+
+    return std::max(queue_depth_ - pipeline_delay_, 0);
+}
+
+int av_video::get_pipeline_delay() const noexcept
+{
+    return pipeline_delay_;
+}
+
+bool av_video::is_conversion_free() const noexcept
+{
+    /* only packed formats, the frame data is a single plane */
+    return input_pixel_format_ == output_pixel_format_
+        && av_pix_fmt_count_planes(input_pixel_format_) == 1
+        && context_->width == meta_.width
+        && context_->height == meta_.height;
+}
+
+int64_t av_video::get_avoided_conversion_count() const noexcept
+{
+    return avoided_conversion_count_;
+}
+
 av_video_codec_type av_video::get_codec_type() const noexcept
 {
     return codec_type_;
@@ -451,13 +581,135 @@ AVRational av_video::get_time_base() const noexcept
     return context_->time_base;
 }
 
+void av_video::create_codec_context(const av_video_meta &meta)
+{
+    context_ = avcodec_alloc_context3(codec_);
+
+    auto fps = AVRational{ meta.fps.num, meta.fps.den };
+
+    // Check if the codec has a specific set of supported frame rates. If it has, find the nearest
+    // matching framerate.
+    if (codec_->supported_framerates)
+    {
+        const auto idx = av_find_nearest_q_idx(fps, codec_->supported_framerates);
+        AVRational supported_fps = codec_->supported_framerates[idx];
+        if (supported_fps != fps)
+        {
+            _log("av_video: framerate {} is not supported. Using {}.", fps, supported_fps);
+            fps = supported_fps;
+        }
+    }
+
+    // always force variable framerate with ms timestamps.
+    context_->time_base = { 1, 1000 };
+
+    if (codec_type_ != av_video_codec_type::cscd)
+    {
+        // calculate a approximate gob size.
+        context_->gop_size = calculate_gop_size(meta);
+
+        // either quality of bitrate must be set.
+        assert(!!meta.quality || !!meta.bitrate);
+
+        apply_preset(av_opts_, meta.preset);
+        apply_tune(av_opts_, meta.tune);
+        apply_profile(av_opts_, meta.profile);
+        apply_level(context_, meta.level);
+        apply_threading(context_, av_opts_, meta);
+
+        // make forced keyframes (see request_keyframe) real IDR frames, so they are seekable.
+        av_opts_["forced-idr"] = 1;
+
+        /* A reconfigured encoder starts a new stream within the same file. Without b-frames the
+         * decode timestamps equal the presentation timestamps, so they continue where the previous
+         * encoder stopped. */
+        if (meta.reconfigurable)
+        {
+            context_->max_b_frames = 0;
+            av_opts_["x264-params"] = "repeat-headers=1";
+        }
+
+        switch(meta.container)
+        {
+        case video::container::mp4:
+        {
+            av_opts_["brand"] = "mp42";
+
+            /*
+             * disable_chpl: Disable Nero chapter markers (chpl atom)
+             */
+            av_opts_["movflags"] = "disable_chpl";
+        } break;
+        }
+
+        /*!
+         * set variable framerate.
+         * \see https://superuser.com/questions/908295/ffmpeg-libx264-how-to-specify-a-variable-frame-rate-but-with-a-maximum
+         */
+        //av_opts_["vsync"] = "vfr";
+
+        // Now set the things in context that we don't want to allow
+        // the user to override.
+        if (meta.bitrate)
+        {
+            // Average bitrate
+            context_->bit_rate = static_cast<int64_t>(1000.0 * meta.bitrate.value());
+
+            // ffmpeg's mpeg2 encoder requires that the bit_rate_tolerance be >= bitrate * fps
+            //context_->bit_rate_tolerance = static_cast<int>(context_->bit_rate * av_q2d(fps) + 1);
+        }
+        else
+        {
+            /* Constant quantizer */
+            context_->flags |= AV_CODEC_FLAG_QSCALE;
+
+            /* global_quality only seem to apply to mpeg 1, 2 and 4 */
+            //context_->global_quality =
+            //      static_cast<int>(FF_QP2LAMBDA * meta.quality.value() + 0.5);
+
+            // x264 requires this.
+            av_opts_["crf"] = static_cast<int64_t>(meta.quality.value());
+        }
+    }
+    else
+    {
+        apply_compression(av_opts_, meta);
+        av_opts_["autokeyframe"] = 1; // enable keyframe insertion every x frames.
+        av_opts_["autokeyframe_rate"] = calculate_gop_size(meta) * 10;
+    }
+
+    context_->width = meta.output_width.value_or(meta.width);
+    context_->height = meta.output_height.value_or(meta.height);
+    context_->pix_fmt = output_pixel_format_;
+
+    /* yuv420 has half resolution chroma, so x264 only accepts even dimensions. */
+    if (output_pixel_format_ == AV_PIX_FMT_YUV420P)
+    {
+        context_->width = std::max(context_->width & ~1, 2);
+        context_->height = std::max(context_->height & ~1, 2);
+    }
+    context_->sample_aspect_ratio.num = 1;
+    context_->sample_aspect_ratio.den = 1;
+
+    set_colorspace(context_, av_video_colorspace::JPEG);
+
+    // \todo we have no grayscale settings for now
+    //if (grayscale)
+    //    context->flags |= AV_CODEC_FLAG_GRAY;
+
+    /* the global header holds the parameter sets of the first encoder only. */
+    if (!is_reconfigurable())
+        context_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+}
+
 SwsContext *av_video::create_software_scaler(AVPixelFormat src_pixel_format, int src_width, int src_height,
-                                             AVPixelFormat dst_pixel_format, int dst_width, int dst_height)
+                                             AVPixelFormat dst_pixel_format, int dst_width, int dst_height,
+                                             int flags)
 {
     SwsContext *software_scaler_context = sws_getContext(
         src_width, src_height, src_pixel_format,
         dst_width, dst_height, dst_pixel_format,
-        SWS_BICUBIC, nullptr, nullptr, nullptr);
+        flags, nullptr, nullptr, nullptr);
 
     if (!software_scaler_context)
         throw std::runtime_error("Could not initialize the conversion context");
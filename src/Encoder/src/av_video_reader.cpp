@@ -0,0 +1,229 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CamEncoder/av_video_reader.h"
+#include "CamEncoder/av_error.h"
+#include "CamEncoder/av_cam_codec/av_cam_codec.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <stdexcept>
+
+constexpr AVRational milliseconds_time_base = {1, 1000};
+
+av_video_reader::av_video_reader(const std::string &filename, int stream_index)
+{
+    if (const auto ret = avformat_open_input(&format_context_, filename.c_str(), nullptr, nullptr); ret < 0)
+        throw std::runtime_error(fmt::format("av_video_reader: unable to open '{}': {}", filename,
+            av_error_to_string(ret)));
+
+    if (const auto ret = avformat_find_stream_info(format_context_, nullptr); ret < 0)
+    {
+        avformat_close_input(&format_context_);
+        throw std::runtime_error(fmt::format("av_video_reader: unable to read stream info: {}",
+            av_error_to_string(ret)));
+    }
+
+    stream_index_ = av_find_best_stream(format_context_, AVMEDIA_TYPE_VIDEO, stream_index, -1, nullptr, 0);
+    const auto *stream = stream_index_ >= 0 ? format_context_->streams[stream_index_] : nullptr;
+
+    /* the ffmpeg cscd decoder only knows lzo and gzip, our own decoder also reads lz4 and zstd. */
+    AVCodec *codec = nullptr;
+    if (stream != nullptr)
+    {
+        codec = stream->codecpar->codec_id == AV_CODEC_ID_CSCD
+            ? &cam_codec_decoder
+            : avcodec_find_decoder(stream->codecpar->codec_id);
+    }
+
+    if (codec == nullptr)
+    {
+        avformat_close_input(&format_context_);
+        throw std::runtime_error(fmt::format("av_video_reader: no decodable video stream in '{}'", filename));
+    }
+
+    time_base_ = stream->time_base;
+
+    context_ = avcodec_alloc_context3(codec);
+    frame_ = av_frame_alloc();
+    packet_ = av_packet_alloc();
+    if (context_ == nullptr || frame_ == nullptr || packet_ == nullptr)
+    {
+        _close();
+        throw std::runtime_error("av_video_reader: out of memory");
+    }
+
+    auto ret = avcodec_parameters_to_context(context_, stream->codecpar);
+    if (ret >= 0)
+        ret = avcodec_open2(context_, codec, nullptr);
+
+    if (ret < 0)
+    {
+        _close();
+        throw std::runtime_error(fmt::format("av_video_reader: unable to open video decoder: {}",
+            av_error_to_string(ret)));
+    }
+}
+
+av_video_reader::~av_video_reader()
+{
+    _close();
+}
+
+void av_video_reader::_close() noexcept
+{
+    sws_freeContext(sws_context_);
+    sws_context_ = nullptr;
+    av_packet_free(&packet_);
+    av_frame_free(&frame_);
+    avcodec_free_context(&context_);
+    avformat_close_input(&format_context_);
+}
+
+int av_video_reader::get_width() const noexcept
+{
+    return context_->width;
+}
+
+int av_video_reader::get_height() const noexcept
+{
+    return context_->height;
+}
+
+frame_rate av_video_reader::get_frame_rate() const noexcept
+{
+    const auto rate = av_guess_frame_rate(format_context_, format_context_->streams[stream_index_], nullptr);
+    return {rate.num, rate.den};
+}
+
+auto av_video_reader::read_index() -> av_video_index
+{
+    av_video_index index;
+
+    seek(0);
+    while (av_read_frame(format_context_, packet_) >= 0)
+    {
+        if (packet_->stream_index == stream_index_)
+        {
+            const auto timestamp = packet_->pts != AV_NOPTS_VALUE ? packet_->pts : packet_->dts;
+            if (timestamp != AV_NOPTS_VALUE)
+            {
+                const auto time = _to_milliseconds(timestamp);
+                if ((packet_->flags & AV_PKT_FLAG_KEY) != 0)
+                    index.keyframe_times.push_back(time);
+
+                index.end_time = std::max(index.end_time, time + std::max<int64_t>(
+                    _to_milliseconds(packet_->duration), 1));
+            }
+        }
+        av_packet_unref(packet_);
+    }
+
+    /* mkv and mp4 store b-frames out of order, but keyframes are in decode order. */
+    std::sort(index.keyframe_times.begin(), index.keyframe_times.end());
+
+    seek(0);
+    return index;
+}
+
+void av_video_reader::seek(int64_t time)
+{
+    /* seek to the keyframe at or before the timestamp, when there is none (a.e. the first frame
+     * starts after the timestamp) take the first keyframe after it. */
+    const auto timestamp = av_rescale_q(time, milliseconds_time_base, time_base_);
+    auto ret = avformat_seek_file(format_context_, stream_index_, INT64_MIN, timestamp, timestamp, 0);
+    if (ret < 0)
+        ret = avformat_seek_file(format_context_, stream_index_, INT64_MIN, timestamp, INT64_MAX, 0);
+
+    if (ret < 0)
+        throw std::runtime_error(fmt::format("av_video_reader: seek to {}ms failed: {}", time,
+            av_error_to_string(ret)));
+
+    avcodec_flush_buffers(context_);
+    end_of_file_ = false;
+}
+
+bool av_video_reader::read_frame(av_decoded_frame &frame)
+{
+    if (!_receive_frame())
+        return false;
+
+    const auto width = frame_->width;
+    const auto height = frame_->height;
+
+    sws_context_ = sws_getCachedContext(sws_context_, width, height, static_cast<AVPixelFormat>(frame_->format),
+        width, height, AV_PIX_FMT_BGRA, SWS_POINT, nullptr, nullptr, nullptr);
+    if (sws_context_ == nullptr)
+        throw std::runtime_error("av_video_reader: unable to create color converter");
+
+    frame.width = width;
+    frame.height = height;
+    frame.stride = width * 4;
+    frame.data.resize(static_cast<size_t>(frame.stride) * height);
+    frame.time = _to_milliseconds(frame_->best_effort_timestamp);
+
+    uint8_t *dst[4] = {frame.data.data(), nullptr, nullptr, nullptr};
+    int dst_stride[4] = {frame.stride, 0, 0, 0};
+    sws_scale(sws_context_, frame_->data, frame_->linesize, 0, height, dst, dst_stride);
+
+    av_frame_unref(frame_);
+    return true;
+}
+
+bool av_video_reader::_receive_frame()
+{
+    for (;;)
+    {
+        const auto ret = avcodec_receive_frame(context_, frame_);
+        if (ret == 0)
+            return true;
+
+        if (ret == AVERROR_EOF)
+            return false;
+
+        if (ret != AVERROR(EAGAIN))
+            throw std::runtime_error(fmt::format("av_video_reader: decode failed: {}", av_error_to_string(ret)));
+
+        if (end_of_file_)
+            return false;
+
+        /* feed the decoder the next packet of our stream, or drain it at the end of the file. */
+        if (av_read_frame(format_context_, packet_) < 0)
+        {
+            end_of_file_ = true;
+            avcodec_send_packet(context_, nullptr);
+            continue;
+        }
+
+        if (packet_->stream_index == stream_index_)
+        {
+            const auto send_ret = avcodec_send_packet(context_, packet_);
+            av_packet_unref(packet_);
+            if (send_ret < 0 && send_ret != AVERROR(EAGAIN))
+                throw std::runtime_error(fmt::format("av_video_reader: unable to send packet to decoder: {}",
+                    av_error_to_string(send_ret)));
+        }
+        else
+        {
+            av_packet_unref(packet_);
+        }
+    }
+}
+
+auto av_video_reader::_to_milliseconds(int64_t timestamp) const noexcept -> int64_t
+{
+    return av_rescale_q(timestamp, time_base_, milliseconds_time_base);
+}
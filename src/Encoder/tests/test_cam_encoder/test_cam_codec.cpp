@@ -0,0 +1,153 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_cam_codec/av_cam_codec.h>
+#include <cstring>
+#include <vector>
+
+constexpr auto test_width = 64;
+constexpr auto test_height = 48;
+constexpr auto test_frame_count = 30;
+
+struct cam_codec_test_config
+{
+    int algorithm;
+    int level;
+    int long_range;
+};
+
+/* fill a bgr0 frame with a static background and a square that moves every frame. */
+static void fill_test_frame(AVFrame *frame, int index)
+{
+    for (int y = 0; y < frame->height; ++y)
+    {
+        auto *line = frame->data[0] + y * frame->linesize[0];
+        for (int x = 0; x < frame->width; ++x)
+        {
+            const bool square = x >= index && x < index + 8 && y >= index && y < index + 8;
+            line[x * 4 + 0] = square ? 0xff : static_cast<uint8_t>(x * 3);
+            line[x * 4 + 1] = square ? 0x00 : static_cast<uint8_t>(y * 5);
+            line[x * 4 + 2] = square ? static_cast<uint8_t>(index) : 0x40;
+            line[x * 4 + 3] = 0;
+        }
+    }
+}
+
+class test_cam_codec : public ::testing::TestWithParam<cam_codec_test_config>
+{
+};
+
+TEST_P(test_cam_codec, test_round_trip)
+{
+    const auto config = GetParam();
+
+    AVCodecContext *encoder = avcodec_alloc_context3(&cam_codec_encoder);
+    ASSERT_NE(encoder, nullptr);
+    encoder->width = test_width;
+    encoder->height = test_height;
+    encoder->pix_fmt = AV_PIX_FMT_BGR0;
+    encoder->time_base = {1, 25};
+    av_opt_set_int(encoder->priv_data, "algorithm", config.algorithm, 0);
+    av_opt_set_int(encoder->priv_data, "gzip_level", config.level, 0);
+    av_opt_set_int(encoder->priv_data, "lz4_level", config.level, 0);
+    av_opt_set_int(encoder->priv_data, "zstd_level", config.level, 0);
+    av_opt_set_int(encoder->priv_data, "zstd_long", config.long_range, 0);
+    av_opt_set_int(encoder->priv_data, "autokeyframe_rate", 10, 0);
+    ASSERT_EQ(avcodec_open2(encoder, &cam_codec_encoder, nullptr), 0);
+
+    AVCodecContext *decoder = avcodec_alloc_context3(&cam_codec_decoder);
+    ASSERT_NE(decoder, nullptr);
+    decoder->width = test_width;
+    decoder->height = test_height;
+    decoder->bits_per_coded_sample = encoder->bits_per_coded_sample;
+    ASSERT_EQ(avcodec_open2(decoder, &cam_codec_decoder, nullptr), 0);
+    EXPECT_EQ(decoder->pix_fmt, AV_PIX_FMT_BGR0);
+
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_PIX_FMT_BGR0;
+    frame->width = test_width;
+    frame->height = test_height;
+    ASSERT_EQ(av_frame_get_buffer(frame, 1), 0);
+
+    AVFrame *decoded = av_frame_alloc();
+    AVPacket *pkt = av_packet_alloc();
+    int keyframe_count = 0;
+
+    for (int i = 0; i < test_frame_count; ++i)
+    {
+        fill_test_frame(frame, i);
+        frame->pts = i;
+        ASSERT_EQ(avcodec_send_frame(encoder, frame), 0);
+        ASSERT_EQ(avcodec_receive_packet(encoder, pkt), 0);
+        EXPECT_EQ((pkt->data[0] >> 1) & 7, config.algorithm);
+        if (pkt->flags & AV_PKT_FLAG_KEY)
+            ++keyframe_count;
+
+        ASSERT_EQ(avcodec_send_packet(decoder, pkt), 0);
+        ASSERT_EQ(avcodec_receive_frame(decoder, decoded), 0);
+        av_packet_unref(pkt);
+
+        /* the decoder outputs the frame bottom up. */
+        const auto line_size = test_width * 4;
+        for (int y = 0; y < test_height; ++y)
+        {
+            const auto *expected = frame->data[0] + (test_height - 1 - y) * frame->linesize[0];
+            const auto *actual = decoded->data[0] + y * decoded->linesize[0];
+            ASSERT_EQ(std::memcmp(expected, actual, line_size), 0) << "frame " << i << " line " << y;
+        }
+        av_frame_unref(decoded);
+    }
+
+    EXPECT_EQ(keyframe_count, test_frame_count / 10);
+
+    av_packet_free(&pkt);
+    av_frame_free(&decoded);
+    av_frame_free(&frame);
+    avcodec_free_context(&decoder);
+    avcodec_free_context(&encoder);
+}
+
+INSTANTIATE_TEST_CASE_P(test_cam_codec_algorithms, test_cam_codec,
+    ::testing::Values(
+        cam_codec_test_config{CSCD_ALGORITHM_LZO, 0, 0},
+        cam_codec_test_config{CSCD_ALGORITHM_GZIP, 6, 0},
+        cam_codec_test_config{CSCD_ALGORITHM_LZ4, 0, 0},
+        cam_codec_test_config{CSCD_ALGORITHM_LZ4, 9, 0},
+        cam_codec_test_config{CSCD_ALGORITHM_ZSTD, 1, 0},
+        cam_codec_test_config{CSCD_ALGORITHM_ZSTD, 19, 1}));
+
+TEST(test_cam_codec_decoder, test_invalid_packet)
+{
+    AVCodecContext *decoder = avcodec_alloc_context3(&cam_codec_decoder);
+    decoder->width = test_width;
+    decoder->height = test_height;
+    decoder->bits_per_coded_sample = 32;
+    ASSERT_EQ(avcodec_open2(decoder, &cam_codec_decoder, nullptr), 0);
+
+    /* a lz4 keyframe with garbage payload. */
+    std::vector<uint8_t> data(64 + AV_INPUT_BUFFER_PADDING_SIZE, 0xcd);
+    data[0] = CSCD_ALGORITHM_LZ4 << 1 | 1;
+
+    AVPacket *pkt = av_packet_alloc();
+    pkt->data = data.data();
+    pkt->size = 64;
+    EXPECT_LT(avcodec_send_packet(decoder, pkt), 0);
+
+    av_packet_free(&pkt);
+    avcodec_free_context(&decoder);
+}
@@ -0,0 +1,103 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_chunk_plan.h>
+#include <algorithm>
+#include <stdexcept>
+
+/* keyframes every gop milliseconds, starting at 0. */
+static std::vector<int64_t> create_keyframes(int64_t duration, int64_t gop)
+{
+    std::vector<int64_t> keyframes;
+    for (int64_t time = 0; time < duration; time += gop)
+        keyframes.push_back(time);
+    return keyframes;
+}
+
+/* the chunks must start at a keyframe, and cover the recording without gaps. */
+static void expect_valid_chunks(const std::vector<av_chunk> &chunks, const std::vector<int64_t> &keyframes,
+    int64_t end_time)
+{
+    ASSERT_FALSE(chunks.empty());
+    EXPECT_EQ(chunks.front().start, keyframes.front());
+    EXPECT_EQ(chunks.back().end, end_time);
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        EXPECT_LT(chunks[i].start, chunks[i].end);
+        EXPECT_NE(std::find(keyframes.begin(), keyframes.end(), chunks[i].start), keyframes.end());
+        if (i > 0)
+            EXPECT_EQ(chunks[i - 1].end, chunks[i].start);
+    }
+}
+
+TEST(test_chunk_plan, test_equal_gops)
+{
+    // one hour, a keyframe every second.
+    constexpr int64_t duration = 3600 * 1000;
+    const auto keyframes = create_keyframes(duration, 1000);
+
+    const auto chunks = av_plan_chunks(keyframes, duration, 16);
+    expect_valid_chunks(chunks, keyframes, duration);
+    ASSERT_EQ(chunks.size(), 16u);
+
+    for (const auto &chunk : chunks)
+        EXPECT_NEAR(static_cast<double>(chunk.end - chunk.start), duration / 16.0, 1000.0);
+}
+
+TEST(test_chunk_plan, test_irregular_gops)
+{
+    // scene change keyframes in between the regular keyframes.
+    std::vector<int64_t> keyframes = {0, 1000, 1200, 1250, 2000, 3000, 3100, 4000, 5000, 6000, 6500};
+    const auto chunks = av_plan_chunks(keyframes, 7000, 3);
+    expect_valid_chunks(chunks, keyframes, 7000);
+    EXPECT_EQ(chunks.size(), 3u);
+}
+
+TEST(test_chunk_plan, test_less_keyframes_than_chunks)
+{
+    const std::vector<int64_t> keyframes = {0, 5000};
+    const auto chunks = av_plan_chunks(keyframes, 10000, 8);
+    expect_valid_chunks(chunks, keyframes, 10000);
+    ASSERT_EQ(chunks.size(), 2u);
+    EXPECT_EQ(chunks[0], (av_chunk{0, 5000}));
+    EXPECT_EQ(chunks[1], (av_chunk{5000, 10000}));
+}
+
+TEST(test_chunk_plan, test_single_chunk)
+{
+    const auto keyframes = create_keyframes(60000, 1000);
+    const auto chunks = av_plan_chunks(keyframes, 60000, 1);
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0], (av_chunk{0, 60000}));
+}
+
+TEST(test_chunk_plan, test_merge_tiny_last_chunk)
+{
+    // the last keyframe is right before the end of the recording.
+    const std::vector<int64_t> keyframes = {0, 2500, 5000, 7500, 9990};
+    const auto chunks = av_plan_chunks(keyframes, 10000, 4);
+    expect_valid_chunks(chunks, keyframes, 10000);
+    EXPECT_EQ(chunks.back().start, 7500);
+}
+
+TEST(test_chunk_plan, test_invalid_arguments)
+{
+    EXPECT_THROW(av_plan_chunks({}, 1000, 4), std::invalid_argument);
+    EXPECT_THROW(av_plan_chunks({0}, 1000, 0), std::invalid_argument);
+}
@@ -0,0 +1,196 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_muxer.h>
+#include <CamEncoder/av_video_reader.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+constexpr auto multi_stream_test_fps = 30;
+constexpr auto multi_stream_test_frames = 60;
+
+// a scaled down monitor layout, every monitor has its own size.
+constexpr std::array<std::pair<int, int>, 3> test_monitor_sizes = {{{160, 90}, {128, 96}, {96, 160}}};
+
+static auto create_test_stream(int width, int height) -> std::unique_ptr<av_video>
+{
+    av_video_meta meta;
+    meta.codec = video::codec::x264;
+    meta.quality = 20;
+    meta.bpp = 32;
+    meta.width = width;
+    meta.height = height;
+    meta.fps = {multi_stream_test_fps, 1};
+    meta.preset = video::preset::ultrafast;
+    meta.tune = video::tune::zerolatency;
+
+    av_video_codec video_codec_config;
+    video_codec_config.pixel_format = AV_PIX_FMT_BGRA;
+    return std::make_unique<av_video>(video_codec_config, meta);
+}
+
+/* the gray level of a frame of a synthetic source, so every stream and frame can be told apart. */
+static auto get_test_level(int stream_index, int frame_index) -> uint8_t
+{
+    return static_cast<uint8_t>(stream_index * 64 + frame_index * 2);
+}
+
+/* record all synthetic sources into one file, with a shared clock. */
+static void write_multi_stream_recording(const std::string &filename, bool threaded)
+{
+    av_muxer muxer(filename, av_muxer_type::mkv, av_metadata{"test"});
+    for (const auto &[width, height] : test_monitor_sizes)
+        muxer.add_stream(create_test_stream(width, height));
+    ASSERT_EQ(muxer.get_stream_count(), static_cast<int>(test_monitor_sizes.size()));
+
+    muxer.open();
+
+    /* every frame must end up in the recording, so wait for the encoder instead of dropping */
+    av_muxer_thread_config thread_config;
+    thread_config.max_queue_depth = 4;
+    thread_config.full_policy = av_queue_full_policy::block;
+    if (threaded)
+        muxer.start_encoder_threads(thread_config);
+
+    std::vector<uint8_t> frame;
+    for (int i = 0; i < multi_stream_test_frames; ++i)
+    {
+        const auto timestamp = static_cast<timestamp_t>(i * 1000 / multi_stream_test_fps);
+        for (int stream = 0; stream < muxer.get_stream_count(); ++stream)
+        {
+            const auto [width, height] = test_monitor_sizes[stream];
+            frame.assign(static_cast<size_t>(width) * height * 4, get_test_level(stream, i));
+            if (threaded)
+                EXPECT_TRUE(muxer.queue_frame(stream, timestamp, frame.data(), width, height, width * 4));
+            else
+                muxer.encode_frame(stream, timestamp, frame.data(), width, height, width * 4);
+        }
+    }
+
+    muxer.flush();
+
+    // the destructor and a second flush do nothing.
+    EXPECT_NO_THROW(muxer.flush());
+}
+
+static void verify_multi_stream_recording(const std::string &filename)
+{
+    std::vector<std::vector<int64_t>> stream_times;
+    for (int stream = 0; stream < static_cast<int>(test_monitor_sizes.size()); ++stream)
+    {
+        av_video_reader reader(filename, stream);
+        const auto [width, height] = test_monitor_sizes[stream];
+        EXPECT_EQ(reader.get_width(), width);
+        EXPECT_EQ(reader.get_height(), height);
+
+        std::vector<int64_t> times;
+        av_decoded_frame frame;
+        while (reader.read_frame(frame))
+        {
+            const auto frame_index = static_cast<int>(times.size());
+            EXPECT_NEAR(frame.data[frame.stride * (height / 2) + width * 2], get_test_level(stream, frame_index), 3);
+            times.push_back(frame.time);
+        }
+        EXPECT_EQ(times.size(), static_cast<size_t>(multi_stream_test_frames));
+        stream_times.push_back(times);
+    }
+
+    // frames that were captured at the same moment have the same time in every stream.
+    for (const auto &times : stream_times)
+        EXPECT_EQ(times, stream_times.front());
+}
+
+TEST(test_multi_stream_muxer, test_encode_on_calling_thread)
+{
+    const std::string filename = "test_multi_stream.mkv";
+    write_multi_stream_recording(filename, false);
+    verify_multi_stream_recording(filename);
+    std::remove(filename.c_str());
+}
+
+TEST(test_multi_stream_muxer, test_encoder_threads)
+{
+    const std::string filename = "test_multi_stream_threaded.mkv";
+    write_multi_stream_recording(filename, true);
+    verify_multi_stream_recording(filename);
+    std::remove(filename.c_str());
+}
+
+TEST(test_multi_stream_muxer, test_drop_when_queue_full)
+{
+    const std::string filename = "test_multi_stream_drop.mkv";
+    const auto [width, height] = test_monitor_sizes[0];
+    int64_t dropped_frames = 0;
+    {
+        av_muxer muxer(filename, av_muxer_type::mkv, av_metadata{"test"});
+        muxer.add_stream(create_test_stream(width, height));
+        muxer.open();
+
+        av_muxer_thread_config thread_config;
+        thread_config.max_queue_depth = 1;
+        thread_config.full_policy = av_queue_full_policy::drop;
+        muxer.start_encoder_threads(thread_config);
+
+        std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4);
+        for (int i = 0; i < multi_stream_test_frames; ++i)
+        {
+            frame.assign(frame.size(), get_test_level(0, i));
+            const auto timestamp = static_cast<timestamp_t>(i * 1000 / multi_stream_test_fps);
+            if (!muxer.queue_frame(0, timestamp, frame.data(), width, height, width * 4))
+                ++dropped_frames;
+        }
+        muxer.flush();
+
+        // every frame is either encoded or counted as dropped.
+        const auto stats = muxer.get_stats();
+        EXPECT_EQ(stats.dropped_frames, dropped_frames);
+        EXPECT_EQ(stats.encoded_frames + stats.dropped_frames, multi_stream_test_frames);
+    }
+
+    av_video_reader reader(filename, 0);
+    av_decoded_frame frame;
+    int64_t frame_count = 0;
+    while (reader.read_frame(frame))
+        ++frame_count;
+    EXPECT_EQ(frame_count, multi_stream_test_frames - dropped_frames);
+    std::remove(filename.c_str());
+}
+
+TEST(test_multi_stream_muxer, test_invalid_usage)
+{
+    const std::string filename = "test_multi_stream_invalid.mkv";
+    {
+        std::vector<uint8_t> frame(128 * 96 * 4);
+
+        av_muxer muxer(filename, av_muxer_type::mkv, av_metadata{"test"});
+        muxer.add_stream(create_test_stream(128, 96));
+        muxer.open();
+
+        EXPECT_THROW(muxer.encode_frame(1, 0, frame.data(), 128, 96, 128 * 4), std::invalid_argument);
+        EXPECT_THROW(muxer.queue_frame(0, 0, frame.data(), 128, 96, 128 * 4), std::runtime_error);
+
+        muxer.start_encoder_threads();
+        EXPECT_THROW(muxer.encode_frame(0, 0, frame.data(), 128, 96, 128 * 4), std::runtime_error);
+        EXPECT_NO_THROW(muxer.queue_frame(0, 0, frame.data(), 128, 96, 128 * 4));
+    }
+    std::remove(filename.c_str());
+}
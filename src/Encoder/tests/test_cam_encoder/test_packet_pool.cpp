@@ -0,0 +1,80 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_packet_pool.h>
+
+TEST(test_packet_pool, test_size_class)
+{
+    EXPECT_EQ(av_packet_pool::get_size_class(1), 0);
+    EXPECT_EQ(av_packet_pool::get_size_class(4096), 0);
+    EXPECT_EQ(av_packet_pool::get_size_class(4097), 1);
+    EXPECT_EQ(av_packet_pool::get_size_class(8192), 1);
+    EXPECT_EQ(av_packet_pool::get_size_class(1 << 20), 20 - av_packet_pool::min_size_class);
+}
+
+TEST(test_packet_pool, test_alloc_packet)
+{
+    av_packet_pool pool;
+    AVPacket *pkt = av_packet_alloc();
+
+    ASSERT_EQ(pool.alloc_packet(pkt, 1000), 0);
+    EXPECT_EQ(pkt->size, 1000);
+    ASSERT_NE(pkt->buf, nullptr);
+    EXPECT_GE(pkt->buf->size, 1000 + AV_INPUT_BUFFER_PADDING_SIZE);
+    EXPECT_EQ(pkt->data, pkt->buf->data);
+
+    av_packet_free(&pkt);
+}
+
+TEST(test_packet_pool, test_steady_state_reuse)
+{
+    av_packet_pool pool;
+    AVPacket *pkt = av_packet_alloc();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        // sizes vary, but stay within a single size class.
+        ASSERT_EQ(pool.alloc_packet(pkt, 20000 + i * 10), 0);
+        av_packet_unref(pkt);
+    }
+
+    EXPECT_EQ(pool.get_allocation_count(), 1);
+    EXPECT_EQ(pool.get_acquire_count(), 100);
+    av_packet_free(&pkt);
+}
+
+TEST(test_packet_pool, test_buffer_outlives_pool)
+{
+    AVPacket *pkt = av_packet_alloc();
+    {
+        av_packet_pool pool;
+        ASSERT_EQ(pool.alloc_packet(pkt, 64), 0);
+    }
+
+    // the buffer is still valid after the pool is gone.
+    pkt->data[0] = 42;
+    av_packet_free(&pkt);
+}
+
+TEST(test_packet_pool, test_invalid_size)
+{
+    av_packet_pool pool;
+    AVPacket *pkt = av_packet_alloc();
+    EXPECT_LT(pool.alloc_packet(pkt, -1), 0);
+    av_packet_free(&pkt);
+}
@@ -0,0 +1,140 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_quality_controller.h>
+#include <array>
+
+constexpr auto test_fps = 30.0;
+
+/* a fake encoder, its encode time depends on the preset and an artificial throttle factor. */
+class throttled_encoder
+{
+public:
+    double encode(video::preset preset) const noexcept
+    {
+        // encode time in ms per preset, ultrafast - veryslow.
+        constexpr std::array<double, 9> preset_cost = {5.0, 7.0, 10.0, 14.0, 18.0, 25.0, 40.0, 60.0, 90.0};
+        return preset_cost.at(static_cast<int>(preset)) * throttle_ / 1000.0;
+    }
+
+    double throttle_{1.0};
+};
+
+static av_quality_controller_config create_test_config()
+{
+    av_quality_controller_config config;
+    config.frame_budget = 1.0 / test_fps;
+    config.max_preset = video::preset::medium;
+    config.headroom_ratio = 0.8;
+    return config;
+}
+
+/* run the controller for a number of frames, and return the amount of decisions taken. */
+static int run_frames(av_quality_controller &controller, const throttled_encoder &encoder, int frame_count,
+    int queue_depth = 0)
+{
+    int decisions = 0;
+    for (int i = 0; i < frame_count; ++i)
+    {
+        const auto decision = controller.update(encoder.encode(controller.get_preset()), queue_depth);
+        if (decision != av_quality_decision::none)
+            ++decisions;
+    }
+    return decisions;
+}
+
+TEST(test_quality_controller, test_stable_encoder)
+{
+    av_quality_controller controller(create_test_config());
+    throttled_encoder encoder;
+
+    EXPECT_EQ(run_frames(controller, encoder, 1000), 0);
+    EXPECT_EQ(controller.get_preset(), video::preset::medium);
+    EXPECT_EQ(controller.get_fps_divisor(), 1);
+}
+
+TEST(test_quality_controller, test_step_down_when_throttled)
+{
+    av_quality_controller controller(create_test_config());
+    throttled_encoder encoder;
+    encoder.throttle_ = 2.0;
+
+    run_frames(controller, encoder, 1000);
+
+    // medium (50ms) and fast (36ms) miss the 30ms deadline, faster (28ms) is in time.
+    EXPECT_EQ(controller.get_preset(), video::preset::faster);
+    EXPECT_EQ(controller.get_fps_divisor(), 1);
+}
+
+TEST(test_quality_controller, test_step_up_when_headroom_returns)
+{
+    av_quality_controller controller(create_test_config());
+    throttled_encoder encoder;
+    encoder.throttle_ = 2.0;
+    run_frames(controller, encoder, 1000);
+    ASSERT_LT(controller.get_preset(), video::preset::medium);
+
+    encoder.throttle_ = 1.0;
+    run_frames(controller, encoder, 1000);
+    EXPECT_EQ(controller.get_preset(), video::preset::medium);
+    EXPECT_EQ(controller.get_level(), 0);
+}
+
+TEST(test_quality_controller, test_lower_frame_rate_after_fastest_preset)
+{
+    av_quality_controller controller(create_test_config());
+    throttled_encoder encoder;
+    // ultrafast now takes 40ms.
+    encoder.throttle_ = 8.0;
+
+    run_frames(controller, encoder, 2000);
+
+    EXPECT_EQ(controller.get_preset(), video::preset::ultrafast);
+    EXPECT_EQ(controller.get_fps_divisor(), 2);
+    EXPECT_EQ(controller.get_level(), controller.get_level_count() - 1);
+}
+
+TEST(test_quality_controller, test_queue_depth_overload)
+{
+    auto config = create_test_config();
+    config.max_queue_depth = 10;
+    av_quality_controller controller(config);
+    throttled_encoder encoder;
+
+    // encode time is fine, but the queue keeps growing.
+    run_frames(controller, encoder, config.overload_frames, 20);
+    EXPECT_EQ(controller.get_preset(), video::preset::fast);
+}
+
+TEST(test_quality_controller, test_no_oscillation)
+{
+    av_quality_controller controller(create_test_config());
+    throttled_encoder encoder;
+    encoder.throttle_ = 2.0;
+    run_frames(controller, encoder, 1000);
+
+    // once settled, no more decisions must be taken.
+    EXPECT_EQ(run_frames(controller, encoder, 5000), 0);
+}
+
+TEST(test_quality_controller, test_invalid_config)
+{
+    auto config = create_test_config();
+    config.min_preset = video::preset::slow;
+    EXPECT_THROW(av_quality_controller{config}, std::invalid_argument);
+}
@@ -0,0 +1,120 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_scene_detect.h>
+#include <vector>
+#include <algorithm>
+
+constexpr auto test_width = 128;
+constexpr auto test_height = 96;
+constexpr auto test_bpp = 4;
+constexpr auto test_stride = test_width * test_bpp;
+
+static void fill_rect(std::vector<unsigned char> &frame, int x, int y, int width, int height,
+    unsigned char value)
+{
+    for (int j = y; j < y + height; ++j)
+        std::fill_n(&frame[j * test_stride + x * test_bpp], width * test_bpp, value);
+}
+
+TEST(test_scene_detect, test_first_frame_is_no_scene_change)
+{
+    av_scene_change_detector detector(test_width, test_height, test_bpp, 0.5, 32);
+    std::vector<unsigned char> frame(test_stride * test_height, 0x10);
+
+    EXPECT_FALSE(detector.detect(frame.data(), test_stride));
+    EXPECT_EQ(detector.get_dirty_tile_count(), 0);
+    EXPECT_EQ(detector.get_tile_count(), 4 * 3);
+}
+
+TEST(test_scene_detect, test_static_frame)
+{
+    av_scene_change_detector detector(test_width, test_height, test_bpp, 0.5, 32);
+    std::vector<unsigned char> frame(test_stride * test_height, 0x10);
+
+    detector.detect(frame.data(), test_stride);
+    EXPECT_FALSE(detector.detect(frame.data(), test_stride));
+    EXPECT_DOUBLE_EQ(detector.get_dirty_ratio(), 0.0);
+}
+
+TEST(test_scene_detect, test_small_change_is_no_scene_change)
+{
+    av_scene_change_detector detector(test_width, test_height, test_bpp, 0.5, 32);
+    std::vector<unsigned char> frame(test_stride * test_height, 0x10);
+    detector.detect(frame.data(), test_stride);
+
+    // a 'cursor' moving within a single tile.
+    fill_rect(frame, 4, 4, 8, 8, 0xff);
+    EXPECT_FALSE(detector.detect(frame.data(), test_stride));
+    EXPECT_EQ(detector.get_dirty_tile_count(), 1);
+}
+
+TEST(test_scene_detect, test_full_change_is_scene_change)
+{
+    av_scene_change_detector detector(test_width, test_height, test_bpp, 0.5, 32);
+    std::vector<unsigned char> frame(test_stride * test_height, 0x10);
+    detector.detect(frame.data(), test_stride);
+
+    std::fill(frame.begin(), frame.end(), 0x20);
+    EXPECT_TRUE(detector.detect(frame.data(), test_stride));
+    EXPECT_DOUBLE_EQ(detector.get_dirty_ratio(), 1.0);
+
+    // the new frame is the reference now.
+    EXPECT_FALSE(detector.detect(frame.data(), test_stride));
+}
+
+TEST(test_scene_detect, test_partial_tiles)
+{
+    // 100x50 with 32 pixel tiles gives partial tiles at the right and bottom edge.
+    constexpr auto width = 100;
+    constexpr auto height = 50;
+    constexpr auto stride = 112 * test_bpp; // stride padding must be ignored
+    av_scene_change_detector detector(width, height, test_bpp, 0.5, 32);
+    EXPECT_EQ(detector.get_tile_count(), 4 * 2);
+
+    std::vector<unsigned char> frame(stride * height, 0);
+    detector.detect(frame.data(), stride);
+
+    // only touch the padding, which is not part of the image.
+    for (int y = 0; y < height; ++y)
+        frame[y * stride + width * test_bpp] = 0xff;
+    EXPECT_FALSE(detector.detect(frame.data(), stride));
+    EXPECT_EQ(detector.get_dirty_tile_count(), 0);
+
+    // touch the last pixel of the image.
+    frame[(height - 1) * stride + (width - 1) * test_bpp] = 0xff;
+    EXPECT_FALSE(detector.detect(frame.data(), stride));
+    EXPECT_EQ(detector.get_dirty_tile_count(), 1);
+}
+
+TEST(test_scene_detect, test_reset)
+{
+    av_scene_change_detector detector(test_width, test_height, test_bpp, 0.5, 32);
+    std::vector<unsigned char> frame(test_stride * test_height, 0x10);
+    detector.detect(frame.data(), test_stride);
+    detector.reset();
+
+    std::fill(frame.begin(), frame.end(), 0x20);
+    EXPECT_FALSE(detector.detect(frame.data(), test_stride));
+}
+
+TEST(test_scene_detect, test_invalid_dimensions)
+{
+    EXPECT_THROW(av_scene_change_detector(0, test_height, test_bpp), std::invalid_argument);
+    EXPECT_THROW(av_scene_change_detector(test_width, test_height, 0), std::invalid_argument);
+}
@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 #include <CamEncoder/av_video.h>
+#include <CamEncoder/av_quality_controller.h>
 #include "test_utilities.h"
 
 TEST(test_video_encoder, test_create_h264_encoder)
@@ -43,3 +44,111 @@ TEST(test_video_encoder, test_create_h264_encoder)
         frame->bmiHeader.biHeight, frame->bmiHeader.biWidth);
     free(frame);
 }
+
+TEST(test_video_encoder, test_negotiate_pixel_format)
+{
+    // the camstudio codec takes bgr0 directly, so the alpha byte does not have to be dropped.
+    EXPECT_EQ(av_negotiate_pixel_format({AV_PIX_FMT_BGR0}, video::codec::camstudio), AV_PIX_FMT_BGR0);
+    EXPECT_EQ(av_negotiate_pixel_format({AV_PIX_FMT_BGRA, AV_PIX_FMT_BGR24}, video::codec::camstudio),
+        AV_PIX_FMT_BGR24);
+
+    // x264 always converts to yuv, the preferred source format is used.
+    EXPECT_EQ(av_negotiate_pixel_format({AV_PIX_FMT_BGR0, AV_PIX_FMT_BGR24}, video::codec::x264), AV_PIX_FMT_BGR0);
+
+    EXPECT_THROW(av_negotiate_pixel_format({}, video::codec::x264), std::invalid_argument);
+}
+
+TEST(test_video_encoder, test_conversion_free_camstudio_encoder)
+{
+    av_video_codec video_codec_config;
+    video_codec_config.pixel_format = AV_PIX_FMT_BGR0;
+
+    av_video_meta meta;
+    meta.codec = video::codec::camstudio;
+    meta.bpp = 32;
+    meta.width = 64;
+    meta.height = 48;
+    meta.fps = { 25, 1 };
+
+    av_dict avargs;
+    av_video test(video_codec_config, meta);
+    test.open(nullptr, avargs);
+    ASSERT_TRUE(test.is_conversion_free());
+
+    auto frame = create_bmpinfo(meta.width, meta.height, AV_PIX_FMT_BGR0);
+    for (int i = 0; i < 3; ++i)
+    {
+        fill_bmpinfo(frame, i, AV_PIX_FMT_BGR0);
+        test.push_encode_frame(i * 40, (unsigned char *)frame->bmiColors, meta.width, meta.height, meta.width * 4);
+    }
+    free(frame);
+
+    EXPECT_EQ(test.get_avoided_conversion_count(), 3);
+}
+
+TEST(test_video_encoder, test_scaled_encoder_converts)
+{
+    av_video_codec video_codec_config;
+    video_codec_config.pixel_format = AV_PIX_FMT_BGR0;
+
+    av_video_meta meta;
+    meta.codec = video::codec::camstudio;
+    meta.bpp = 32;
+    meta.width = 64;
+    meta.height = 48;
+    meta.output_width = 32;
+    meta.output_height = 24;
+    meta.fps = { 25, 1 };
+
+    av_video test(video_codec_config, meta);
+    EXPECT_FALSE(test.is_conversion_free());
+}
+
+TEST(test_video_encoder, test_pipeline_delay_is_no_backlog)
+{
+    av_video_codec video_codec_config;
+    video_codec_config.pixel_format = AV_PIX_FMT_BGR0;
+
+    av_video_meta meta;
+    meta.codec = video::codec::x264;
+    meta.quality = 25;
+    meta.bpp = 32;
+    meta.width = 128;
+    meta.height = 96;
+    meta.fps = { 60, 1 };
+    meta.preset = video::preset::medium;
+    meta.lookahead = 40;
+
+    av_dict avargs;
+    av_video test(video_codec_config, meta);
+    test.open(nullptr, avargs);
+
+    av_quality_controller_config config;
+    config.frame_budget = 1.0 / 60.0;
+    config.max_queue_depth = 30;
+    av_quality_controller controller(config);
+
+    auto frame = create_bmpinfo(meta.width, meta.height, AV_PIX_FMT_BGR0);
+    AVPacket *packet = av_packet_alloc();
+    for (int i = 0; i < 300; ++i)
+    {
+        fill_bmpinfo(frame, i, AV_PIX_FMT_BGR0);
+        test.push_encode_frame(i * 1000 / 60, (unsigned char *)frame->bmiColors, meta.width, meta.height,
+            meta.width * 4);
+
+        for (bool valid_packet = true; valid_packet;)
+        {
+            ASSERT_TRUE(test.pull_encoded_packet(packet, &valid_packet));
+            if (valid_packet)
+                av_packet_unref(packet);
+        }
+
+        // the lookahead of x264 is a constant queue depth, the encoder is not falling behind.
+        EXPECT_EQ(controller.update(0.0, test.get_queue_depth()), av_quality_decision::none);
+    }
+    av_packet_free(&packet);
+    free(frame);
+
+    EXPECT_GT(test.get_pipeline_delay(), config.max_queue_depth);
+    EXPECT_EQ(test.get_queue_depth(), 0);
+}
@@ -0,0 +1,270 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_concat.h>
+#include <CamEncoder/av_muxer.h>
+#include <CamEncoder/av_video_reader.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <vector>
+
+constexpr auto reader_test_width = 128;
+constexpr auto reader_test_height = 96;
+constexpr auto reader_test_fps = 30;
+// the encoder inserts a keyframe every second.
+constexpr auto reader_test_gop = reader_test_fps;
+
+/* write frames [first_frame, last_frame) of a test recording, every frame has its own gray level. */
+static void write_test_recording(const std::string &filename, int first_frame, int last_frame,
+    video::codec codec = video::codec::x264, std::optional<video::compression> compression = {})
+{
+    av_video_meta meta;
+    meta.codec = codec;
+    meta.compression = compression;
+    meta.bpp = 32;
+    meta.width = reader_test_width;
+    meta.height = reader_test_height;
+    meta.fps = {reader_test_fps, 1};
+
+    av_video_codec video_codec_config;
+    video_codec_config.pixel_format = AV_PIX_FMT_BGRA;
+    if (codec == video::codec::camstudio)
+    {
+        video_codec_config.pixel_format = AV_PIX_FMT_BGR0;
+    }
+    else
+    {
+        meta.quality = 20;
+        meta.preset = video::preset::ultrafast;
+        meta.tune = video::tune::zerolatency;
+    }
+
+    av_muxer muxer(filename, av_muxer_type::mkv, av_metadata{"test"});
+    muxer.add_stream(std::make_unique<av_video>(video_codec_config, meta));
+    muxer.open();
+
+    std::vector<uint8_t> frame(reader_test_width * reader_test_height * 4);
+    for (int i = first_frame; i < last_frame; ++i)
+    {
+        std::fill(frame.begin(), frame.end(), static_cast<uint8_t>(i * 4));
+        const auto timestamp = static_cast<timestamp_t>(i * 1000 / reader_test_fps);
+        muxer.encode_frame(timestamp, frame.data(), reader_test_width, reader_test_height, reader_test_width * 4);
+    }
+}
+
+TEST(test_video_reader, test_read_frames)
+{
+    const std::string filename = "test_video_reader.mkv";
+    write_test_recording(filename, 0, 60);
+
+    {
+        av_video_reader reader(filename);
+        EXPECT_EQ(reader.get_width(), reader_test_width);
+        EXPECT_EQ(reader.get_height(), reader_test_height);
+
+        av_decoded_frame frame;
+        int frame_count = 0;
+        int64_t last_time = -1;
+        while (reader.read_frame(frame))
+        {
+            EXPECT_GT(frame.time, last_time);
+            EXPECT_EQ(frame.stride, reader_test_width * 4);
+            EXPECT_NEAR(frame.data[frame.stride * 10 + 40], frame_count * 4, 3);
+            last_time = frame.time;
+            ++frame_count;
+        }
+        EXPECT_EQ(frame_count, 60);
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(test_video_reader, test_read_default_camstudio_recording)
+{
+    // a camstudio recording with the default compression must be readable by the ffmpeg decoder.
+    const std::string filename = "test_video_reader_cscd.mkv";
+    write_test_recording(filename, 0, 30, video::codec::camstudio);
+
+    {
+        av_video_reader reader(filename);
+        av_decoded_frame frame;
+        int frame_count = 0;
+        while (reader.read_frame(frame))
+        {
+            EXPECT_NEAR(frame.data[frame.stride * 10 + 40], frame_count * 4, 3);
+            ++frame_count;
+        }
+        EXPECT_EQ(frame_count, 30);
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(test_video_reader, test_read_camstudio_extended_compression)
+{
+    // lz4 and zstd are not known by the ffmpeg cscd decoder, the reader must use our own decoder.
+    for (const auto compression : {video::compression::lz4, video::compression::zstd})
+    {
+        const std::string filename = "test_video_reader_cscd_ext.mkv";
+        write_test_recording(filename, 0, 30, video::codec::camstudio, compression);
+
+        {
+            av_video_reader reader(filename);
+            av_decoded_frame frame;
+            int frame_count = 0;
+            while (reader.read_frame(frame))
+            {
+                EXPECT_NEAR(frame.data[frame.stride * 10 + 40], frame_count * 4, 3);
+                ++frame_count;
+            }
+            EXPECT_EQ(frame_count, 30);
+        }
+
+        std::remove(filename.c_str());
+    }
+}
+
+/* write a recording that switches preset halfway, and check every frame decodes. */
+static void check_read_across_preset_switch(const std::string &filename, av_muxer_type muxer_type)
+{
+    {
+        av_video_meta meta;
+        meta.bpp = 32;
+        meta.width = reader_test_width;
+        meta.height = reader_test_height;
+        meta.fps = {reader_test_fps, 1};
+        meta.quality = 20;
+        meta.preset = video::preset::veryfast;
+        meta.reconfigurable = true;
+
+        av_video_codec video_codec_config;
+        video_codec_config.pixel_format = AV_PIX_FMT_BGRA;
+
+        av_muxer muxer(filename, muxer_type, av_metadata{"test"});
+        muxer.add_stream(std::make_unique<av_video>(video_codec_config, meta));
+        muxer.open();
+
+        std::vector<uint8_t> frame(reader_test_width * reader_test_height * 4);
+        for (int i = 0; i < 60; ++i)
+        {
+            // the encoder is drained and restarted with the new preset halfway.
+            if (i == 30)
+                muxer.set_preset(video::preset::ultrafast);
+
+            std::fill(frame.begin(), frame.end(), static_cast<uint8_t>(i * 4));
+            const auto timestamp = static_cast<timestamp_t>(i * 1000 / reader_test_fps);
+            muxer.encode_frame(timestamp, frame.data(), reader_test_width, reader_test_height,
+                reader_test_width * 4);
+        }
+    }
+
+    {
+        av_video_reader reader(filename);
+        av_decoded_frame frame;
+        int frame_count = 0;
+        int64_t last_time = -1;
+        while (reader.read_frame(frame))
+        {
+            EXPECT_GT(frame.time, last_time);
+            EXPECT_NEAR(frame.data[frame.stride * 10 + 40], frame_count * 4, 3);
+            last_time = frame.time;
+            ++frame_count;
+        }
+        EXPECT_EQ(frame_count, 60);
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(test_video_reader, test_read_across_preset_switch)
+{
+    check_read_across_preset_switch("test_video_reader_preset.mkv", av_muxer_type::mkv);
+    check_read_across_preset_switch("test_video_reader_preset.mp4", av_muxer_type::mp4);
+}
+
+TEST(test_video_reader, test_index_and_seek)
+{
+    const std::string filename = "test_video_reader_index.mkv";
+    write_test_recording(filename, 0, 60);
+
+    {
+        av_video_reader reader(filename);
+        const auto index = reader.read_index();
+        ASSERT_EQ(index.keyframe_times.size(), 60u / reader_test_gop);
+        EXPECT_EQ(index.keyframe_times.front(), 0);
+        EXPECT_GE(index.end_time, 59 * 1000 / reader_test_fps);
+
+        // seeking to a keyframe starts decoding right at that frame.
+        const auto keyframe_time = index.keyframe_times[1];
+        reader.seek(keyframe_time);
+
+        av_decoded_frame frame;
+        ASSERT_TRUE(reader.read_frame(frame));
+        EXPECT_EQ(frame.time, keyframe_time);
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(test_video_reader, test_concat_chunks)
+{
+    const std::vector<std::string> chunk_filenames = {"test_chunk_0.mkv", "test_chunk_1.mkv"};
+    const std::string filename = "test_concat.mkv";
+    write_test_recording(chunk_filenames[0], 0, 30);
+    write_test_recording(chunk_filenames[1], 30, 60);
+
+    av_concat_files(chunk_filenames, filename, av_muxer_type::mkv);
+
+    {
+        av_video_reader reader(filename);
+        EXPECT_EQ(reader.read_index().keyframe_times.size(), 60u / reader_test_gop);
+
+        av_decoded_frame frame;
+        int frame_count = 0;
+        while (reader.read_frame(frame))
+            ++frame_count;
+        EXPECT_EQ(frame_count, 60);
+    }
+
+    for (const auto &chunk_filename : chunk_filenames)
+        std::remove(chunk_filename.c_str());
+    std::remove(filename.c_str());
+}
+
+TEST(test_video_reader, test_concat_mismatched_chunks)
+{
+    // the packets are copied as is, a chunk with other codec headers would not decode.
+    const std::vector<std::string> chunk_filenames = {"test_chunk_x264.mkv", "test_chunk_cscd.mkv"};
+    const std::string filename = "test_concat_mismatched.mkv";
+    write_test_recording(chunk_filenames[0], 0, 30);
+    write_test_recording(chunk_filenames[1], 30, 60, video::codec::camstudio);
+
+    EXPECT_THROW(av_concat_files(chunk_filenames, filename, av_muxer_type::mkv), std::runtime_error);
+
+    for (const auto &chunk_filename : chunk_filenames)
+        std::remove(chunk_filename.c_str());
+    std::remove(filename.c_str());
+}
+
+TEST(test_video_reader, test_invalid_file)
+{
+    EXPECT_THROW(av_video_reader{"does_not_exist.mkv"}, std::runtime_error);
+    EXPECT_THROW(av_concat_files({}, "test_concat.mkv", av_muxer_type::mkv), std::invalid_argument);
+}
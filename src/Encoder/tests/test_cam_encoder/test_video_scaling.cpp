@@ -0,0 +1,124 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <CamEncoder/av_muxer.h>
+#include <CamEncoder/av_video_reader.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr auto scaling_test_width = 256;
+constexpr auto scaling_test_height = 192;
+constexpr auto scaling_test_frame_count = 10;
+
+/* write a recording of scaling_test_width x scaling_test_height frames, the left half of every
+ * frame is dark and the right half is bright. */
+static void write_scaled_recording(const std::string &filename, std::optional<int> output_width,
+    std::optional<int> output_height, video::scale_filter filter)
+{
+    av_video_meta meta;
+    meta.codec = video::codec::x264;
+    meta.quality = 20;
+    meta.bpp = 32;
+    meta.width = scaling_test_width;
+    meta.height = scaling_test_height;
+    meta.fps = {30, 1};
+    meta.preset = video::preset::ultrafast;
+    meta.tune = video::tune::zerolatency;
+    meta.output_width = output_width;
+    meta.output_height = output_height;
+    meta.scale_filter = filter;
+
+    av_video_codec video_codec_config;
+    video_codec_config.pixel_format = AV_PIX_FMT_BGRA;
+
+    av_muxer muxer(filename, av_muxer_type::mkv, av_metadata{"test"});
+    muxer.add_stream(std::make_unique<av_video>(video_codec_config, meta));
+    muxer.open();
+
+    const auto stride = scaling_test_width * 4;
+    std::vector<uint8_t> frame(stride * scaling_test_height);
+    for (int y = 0; y < scaling_test_height; ++y)
+        for (int x = 0; x < stride; ++x)
+            frame[y * stride + x] = x < stride / 2 ? 40 : 200;
+
+    for (int i = 0; i < scaling_test_frame_count; ++i)
+        muxer.encode_frame(static_cast<timestamp_t>(i * 33), frame.data(), scaling_test_width,
+            scaling_test_height, stride);
+}
+
+TEST(test_video_scaling, test_downscale_filters)
+{
+    for (const auto filter : {video::scale_filter::point, video::scale_filter::bilinear, video::scale_filter::area,
+        video::scale_filter::bicubic, video::scale_filter::lanczos})
+    {
+        SCOPED_TRACE(video::scale_filter_names.at(static_cast<int>(filter)));
+        const std::string filename = "test_video_scaling.mkv";
+        write_scaled_recording(filename, scaling_test_width / 2, scaling_test_height / 2, filter);
+
+        {
+            av_video_reader reader(filename);
+            EXPECT_EQ(reader.get_width(), scaling_test_width / 2);
+            EXPECT_EQ(reader.get_height(), scaling_test_height / 2);
+
+            av_decoded_frame frame;
+            int frame_count = 0;
+            while (reader.read_frame(frame))
+            {
+                ASSERT_EQ(frame.width, scaling_test_width / 2);
+                const auto row = frame.data.data() + frame.stride * (frame.height / 2);
+                // sample away from the edge, the filters only blur the area around it.
+                EXPECT_NEAR(row[8 * 4], 40, 4);
+                EXPECT_NEAR(row[(frame.width - 8) * 4], 200, 4);
+                ++frame_count;
+            }
+            EXPECT_EQ(frame_count, scaling_test_frame_count);
+        }
+
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(test_video_scaling, test_input_size_when_not_set)
+{
+    const std::string filename = "test_video_scaling_default.mkv";
+    write_scaled_recording(filename, std::nullopt, std::nullopt, video::scale_filter::bicubic);
+
+    {
+        av_video_reader reader(filename);
+        EXPECT_EQ(reader.get_width(), scaling_test_width);
+        EXPECT_EQ(reader.get_height(), scaling_test_height);
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(test_video_scaling, test_odd_output_size_is_made_even)
+{
+    const std::string filename = "test_video_scaling_odd.mkv";
+    write_scaled_recording(filename, 101, 75, video::scale_filter::area);
+
+    {
+        av_video_reader reader(filename);
+        EXPECT_EQ(reader.get_width(), 100);
+        EXPECT_EQ(reader.get_height(), 74);
+    }
+
+    std::remove(filename.c_str());
+}
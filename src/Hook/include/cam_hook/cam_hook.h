@@ -38,9 +38,13 @@ public:
     CAMHOOK_EXPORT void unpause();
 
     CAMHOOK_EXPORT auto get_mouse_events_count() -> int32_t;
-    CAMHOOK_EXPORT auto get_mouse_events(MSLLHOOKSTRUCT *dst, int32_t count) -> bool;
+    // pop up to count mouse events into dst, returns the number of events copied.
+    CAMHOOK_EXPORT auto get_mouse_events(MSLLHOOKSTRUCT *dst, int32_t count) -> int32_t;
     CAMHOOK_EXPORT void clear_mouse_events();
 
+    // the number of mouse events that were dropped because nobody read them in time.
+    CAMHOOK_EXPORT auto get_mouse_events_overflow_count() -> int64_t;
+
 protected:
     static auto CALLBACK global_message_proc(int nCode, WPARAM wParam, LPARAM lParam) -> LRESULT;
     auto message_proc(int nCode, WPARAM wParam, LPARAM lParam) -> LRESULT;
@@ -0,0 +1,167 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*!
+ * Lock free, fixed capacity single producer ring buffer. When the buffer is full the producer drops
+ * the oldest element, so push never blocks and never allocates, which makes it safe to use from a
+ * low level hook callback.
+ *
+ * The producer and consumer claim elements by advancing the read index with a compare exchange, so
+ * every pushed element is either popped once or counted as overflow once. Elements are stored as
+ * atomic words, a consumer that raced the producer overwriting its element just retries.
+ *
+ * \note only a single thread may push, popping is safe from any thread.
+ */
+template <typename T, std::size_t Capacity>
+class cam_spsc_ring_buffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "elements are copied as raw words");
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    static constexpr std::size_t word_count = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    static constexpr uint64_t index_mask = Capacity - 1;
+
+    struct slot
+    {
+        std::array<std::atomic<uint64_t>, word_count> words;
+    };
+
+public:
+    cam_spsc_ring_buffer() noexcept = default;
+    cam_spsc_ring_buffer(const cam_spsc_ring_buffer &) = delete;
+    cam_spsc_ring_buffer &operator=(const cam_spsc_ring_buffer &) = delete;
+
+    // producer: push an element, drops the oldest element when the buffer is full.
+    void push(const T &value) noexcept
+    {
+        const auto write = write_index_.load(std::memory_order_relaxed);
+        auto read = read_index_.load(std::memory_order_acquire);
+        if (write - read == Capacity)
+        {
+            /* when this fails the consumer just popped the oldest element, so there is room now */
+            if (read_index_.compare_exchange_strong(read, read + 1, std::memory_order_acq_rel))
+                overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::array<uint64_t, word_count> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        auto &dst = slots_[write & index_mask];
+        for (std::size_t i = 0; i < word_count; ++i)
+            dst.words[i].store(words[i], std::memory_order_relaxed);
+
+        write_index_.store(write + 1, std::memory_order_release);
+    }
+
+    // consumer: pop the oldest element, returns false when the buffer is empty.
+    bool pop(T &value) noexcept
+    {
+        auto read = read_index_.load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (read == write_index_.load(std::memory_order_acquire))
+                return false;
+
+            std::array<uint64_t, word_count> words;
+            const auto &src = slots_[read & index_mask];
+            for (std::size_t i = 0; i < word_count; ++i)
+                words[i] = src.words[i].load(std::memory_order_relaxed);
+
+            /* on failure the producer dropped this element, read now holds the new oldest element */
+            if (read_index_.compare_exchange_weak(read, read + 1, std::memory_order_acq_rel,
+                std::memory_order_acquire))
+            {
+                std::memcpy(&value, words.data(), sizeof(T));
+                return true;
+            }
+        }
+    }
+
+    // consumer: pop up to max_count elements into the output iterator, returns the number popped.
+    template <typename output_iterator>
+    auto pop_bulk(output_iterator output, const std::size_t max_count) noexcept -> std::size_t
+    {
+        std::size_t count = 0;
+        T value;
+        while (count < max_count && pop(value))
+        {
+            *output++ = value;
+            ++count;
+        }
+        return count;
+    }
+
+    // consumer: drop all elements.
+    void clear() noexcept
+    {
+        auto read = read_index_.load(std::memory_order_acquire);
+        while (read != write_index_.load(std::memory_order_acquire))
+        {
+            if (read_index_.compare_exchange_weak(read, write_index_.load(std::memory_order_acquire),
+                std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                break;
+            }
+        }
+    }
+
+    // the number of elements in the buffer, only a snapshot when the producer is running.
+    auto size() const noexcept -> std::size_t
+    {
+        const auto read = read_index_.load(std::memory_order_acquire);
+        const auto write = write_index_.load(std::memory_order_acquire);
+        return static_cast<std::size_t>(write - read);
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    static constexpr auto capacity() noexcept -> std::size_t
+    {
+        return Capacity;
+    }
+
+    // the total number of pushed elements.
+    auto get_push_count() const noexcept -> uint64_t
+    {
+        return write_index_.load(std::memory_order_relaxed);
+    }
+
+    // the number of elements that were dropped because the buffer was full.
+    auto get_overflow_count() const noexcept -> uint64_t
+    {
+        return overflow_count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // the producer and consumer indices live on their own cache line, to prevent false sharing.
+    alignas(64) std::atomic<uint64_t> write_index_{0};
+    alignas(64) std::atomic<uint64_t> read_index_{0};
+    alignas(64) std::atomic<uint64_t> overflow_count_{0};
+    std::array<slot, Capacity> slots_{};
+};
@@ -16,10 +16,9 @@
  */
 
 #include "cam_hook/cam_hook.h"
+#include "cam_hook/cam_spsc_ring_buffer.h"
 #include <fmt/printf.h>
 #include <limits>
-#include <vector>
-#include <mutex>
 #include <thread>
 #include <cstdint>
 #include <atomic>
@@ -32,9 +31,8 @@ struct hook_pimpl
     HINSTANCE instance_{ nullptr };
     HHOOK hook_{ nullptr };
 
-    // the mouse hook tracking part
-    std::mutex mouse_events_lock_;
-    std::vector<MSLLHOOKSTRUCT> mouse_events_;
+    // the mouse hook tracking part, the hook callback is the only producer.
+    cam_spsc_ring_buffer<MSLLHOOKSTRUCT, 1024> mouse_events_;
     std::thread debug_unhook_;
 };
 
@@ -136,10 +134,7 @@ auto mouse_hook::message_proc(int nCode, WPARAM wParam, LPARAM lParam) -> LRESUL
         {
             MSLLHOOKSTRUCT mouse_event = *reinterpret_cast<MSLLHOOKSTRUCT *>(lParam);
             mouse_event.dwExtraInfo = static_cast<ULONG_PTR>(wParam);
-            {
-                std::lock_guard<std::mutex> slock(pimpl_->mouse_events_lock_);
-                pimpl_->mouse_events_.emplace_back(mouse_event);
-            }
+            pimpl_->mouse_events_.push(mouse_event);
         } break;
 
         // ignore
@@ -155,36 +150,25 @@ auto mouse_hook::message_proc(int nCode, WPARAM wParam, LPARAM lParam) -> LRESUL
 
 auto mouse_hook::get_mouse_events_count() -> int32_t
 {
-    std::lock_guard<std::mutex> slock(pimpl_->mouse_events_lock_);
-    // \todo make lowering cast safe
+    // the buffer capacity is way below int32 max.
     return static_cast<int32_t>(pimpl_->mouse_events_.size());
 }
 
 // We must assume that the user has actually allocated enough memory. Please don't lie to us.
-auto mouse_hook::get_mouse_events(MSLLHOOKSTRUCT *dst, int32_t count) -> bool
+auto mouse_hook::get_mouse_events(MSLLHOOKSTRUCT *dst, int32_t count) -> int32_t
 {
-    if (dst == nullptr)
-        return false;
+    if (dst == nullptr || count <= 0)
+        return 0;
 
-    {
-        std::lock_guard<std::mutex> slock(pimpl_->mouse_events_lock_);
-        const auto copy_count = std::min<int32_t>(count, static_cast<int32_t>(pimpl_->mouse_events_.size()));
-        memcpy(dst, pimpl_->mouse_events_.data(), copy_count * sizeof(MSLLHOOKSTRUCT));
-
-        // \todo replace std::vector with circular object buffer.
-        const auto itr = pimpl_->mouse_events_.begin() + copy_count;
-        pimpl_->mouse_events_.erase(pimpl_->mouse_events_.begin(), itr);
-
-        if (pimpl_->mouse_events_.capacity() > 10000)
-            pimpl_->mouse_events_.shrink_to_fit();
-
-        return true;
-    }
+    return static_cast<int32_t>(pimpl_->mouse_events_.pop_bulk(dst, static_cast<size_t>(count)));
 }
 
 void mouse_hook::clear_mouse_events()
 {
-    std::lock_guard<std::mutex> slock(pimpl_->mouse_events_lock_);
     pimpl_->mouse_events_.clear();
-    pimpl_->mouse_events_.shrink_to_fit();
+}
+
+auto mouse_hook::get_mouse_events_overflow_count() -> int64_t
+{
+    return static_cast<int64_t>(pimpl_->mouse_events_.get_overflow_count());
 }
@@ -0,0 +1,140 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <cam_hook/cam_spsc_ring_buffer.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+struct test_event
+{
+    int32_t x;
+    int32_t y;
+    uint32_t time;
+    uint64_t sequence;
+};
+
+TEST(test_spsc_ring_buffer, test_push_pop)
+{
+    cam_spsc_ring_buffer<test_event, 8> buffer;
+    EXPECT_TRUE(buffer.empty());
+
+    buffer.push({1, 2, 3, 0});
+    buffer.push({4, 5, 6, 1});
+    EXPECT_EQ(buffer.size(), 2u);
+
+    test_event event{};
+    ASSERT_TRUE(buffer.pop(event));
+    EXPECT_EQ(event.x, 1);
+    EXPECT_EQ(event.y, 2);
+    EXPECT_EQ(event.time, 3u);
+    ASSERT_TRUE(buffer.pop(event));
+    EXPECT_EQ(event.sequence, 1u);
+    EXPECT_FALSE(buffer.pop(event));
+    EXPECT_EQ(buffer.get_overflow_count(), 0u);
+}
+
+TEST(test_spsc_ring_buffer, test_overwrite_oldest)
+{
+    cam_spsc_ring_buffer<uint32_t, 4> buffer;
+    for (uint32_t i = 0; i < 10; ++i)
+        buffer.push(i);
+
+    EXPECT_EQ(buffer.size(), 4u);
+    EXPECT_EQ(buffer.get_push_count(), 10u);
+    EXPECT_EQ(buffer.get_overflow_count(), 6u);
+
+    std::vector<uint32_t> values;
+    EXPECT_EQ(buffer.pop_bulk(std::back_inserter(values), 100), 4u);
+    EXPECT_EQ(values, (std::vector<uint32_t>{6, 7, 8, 9}));
+}
+
+TEST(test_spsc_ring_buffer, test_pop_bulk_max_count)
+{
+    cam_spsc_ring_buffer<uint32_t, 16> buffer;
+    for (uint32_t i = 0; i < 10; ++i)
+        buffer.push(i);
+
+    uint32_t values[4] = {};
+    EXPECT_EQ(buffer.pop_bulk(values, 4), 4u);
+    EXPECT_EQ(values[3], 3u);
+    EXPECT_EQ(buffer.size(), 6u);
+}
+
+TEST(test_spsc_ring_buffer, test_clear)
+{
+    cam_spsc_ring_buffer<uint32_t, 4> buffer;
+    buffer.push(1);
+    buffer.push(2);
+    buffer.clear();
+    EXPECT_TRUE(buffer.empty());
+
+    buffer.push(3);
+    uint32_t value = 0;
+    ASSERT_TRUE(buffer.pop(value));
+    EXPECT_EQ(value, 3u);
+}
+
+/* one thread pushes a sequence as fast as it can into a small buffer, while another thread pops it.
+ * every element must be popped or dropped exactly once, and the popped elements must stay ordered. */
+TEST(test_spsc_ring_buffer, test_stress)
+{
+    constexpr uint64_t push_count = 1000000;
+    cam_spsc_ring_buffer<test_event, 64> buffer;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < push_count; ++i)
+        {
+            const auto value = static_cast<int32_t>(i);
+            buffer.push({value, -value, static_cast<uint32_t>(i * 3), i});
+        }
+        done = true;
+    });
+
+    uint64_t pop_count = 0;
+    uint64_t last_sequence = 0;
+    bool first = true;
+    bool ordered = true;
+    bool intact = true;
+    test_event event{};
+    for (;;)
+    {
+        const auto producer_done = done.load();
+        while (buffer.pop(event))
+        {
+            ordered &= first || event.sequence > last_sequence;
+            intact &= event.x == static_cast<int32_t>(event.sequence) && event.y == -event.x
+                && event.time == static_cast<uint32_t>(event.sequence * 3);
+            last_sequence = event.sequence;
+            first = false;
+            ++pop_count;
+        }
+
+        if (producer_done)
+            break;
+    }
+
+    producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(intact);
+    EXPECT_EQ(last_sequence, push_count - 1);
+    EXPECT_EQ(pop_count + buffer.get_overflow_count(), push_count);
+}
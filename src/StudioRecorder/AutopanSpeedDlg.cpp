@@ -6,12 +6,18 @@
 #include "stdafx.h"
 #include "Recorder.h"
 #include "AutopanSpeedDlg.h"
+#include "settings_model.h"
+#include <algorithm>
+
+// the slider works in steps of 10 pixels per second.
+constexpr int pan_speed_step = 10;
 
 /////////////////////////////////////////////////////////////////////////////
 // CAutopanSpeedDlg dialog
 
-CAutopanSpeedDlg::CAutopanSpeedDlg(CWnd *pParent /*=nullptr*/)
+CAutopanSpeedDlg::CAutopanSpeedDlg(CWnd *pParent, settings_model &settings)
     : CDialog(CAutopanSpeedDlg::IDD, pParent)
+    , settings_(settings)
 {
     //{{AFX_DATA_INIT(CAutopanSpeedDlg)
     // NOTE: the ClassWizard will add member initialization here
@@ -45,13 +51,13 @@ BOOL CAutopanSpeedDlg::OnInitDialog()
     // extra initialization
     // set the slider limits and current position
     const int MAXPANSPEED = 200;
-    //ASSERT(cProgramOpts.m_iMaxPan <= MAXPANSPEED);
+    const auto pan_speed = std::clamp(settings_.get_capture_autopan_speed() / pan_speed_step, 1, MAXPANSPEED);
     m_ctrlSliderPanSpeed.SetRange(1, MAXPANSPEED, TRUE);
-    //m_ctrlSliderPanSpeed.SetPos(cProgramOpts.m_iMaxPan);
+    m_ctrlSliderPanSpeed.SetPos(pan_speed);
 
     // update the test speed display
     CString maxpanspeedstr;
-    //maxpanspeedstr.Format(_T("%d"), cProgramOpts.m_iMaxPan);
+    maxpanspeedstr.Format(_T("%d px/s"), pan_speed * pan_speed_step);
     m_ctrlStaticMaxSpeed.SetWindowText(maxpanspeedstr);
 
     return TRUE; // return TRUE unless you set the focus to a control
@@ -61,7 +67,7 @@ BOOL CAutopanSpeedDlg::OnInitDialog()
 void CAutopanSpeedDlg::OnOK()
 {
     // read the slider position and set the max pan speed
-    //cProgramOpts.m_iMaxPan = m_ctrlSliderPanSpeed.GetPos();
+    settings_.set_capture_autopan_speed(m_ctrlSliderPanSpeed.GetPos() * pan_speed_step);
     CDialog::OnOK();
 }
 
@@ -73,7 +79,7 @@ void CAutopanSpeedDlg::OnHScroll(UINT nSBCode, UINT nPos, CScrollBar *pScrollBar
     if (SB_THUMBTRACK == nSBCode)
     { // this (temporarily) fixes reset of the counter to 0 when slider is released
         CString maxpanspeedstr;
-        maxpanspeedstr.Format(_T("%u"), nPos);
+        maxpanspeedstr.Format(_T("%u px/s"), nPos * pan_speed_step);
         m_ctrlStaticMaxSpeed.SetWindowText(maxpanspeedstr);
     }
 
@@ -83,5 +89,5 @@ void CAutopanSpeedDlg::OnHScroll(UINT nSBCode, UINT nPos, CScrollBar *pScrollBar
 
 void CAutopanSpeedDlg::OnBnClickedOk()
 {
-    CDialog::OnOK();
+    OnOK();
 }
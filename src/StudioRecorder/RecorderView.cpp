@@ -34,6 +34,7 @@
 #include "settings_model.h"
 #include "mouse_capture_ui.h"
 #include "ui/window_select/window_select_ui.h"
+#include "ui/window_select/window_list_service.h"
 #include "shortcut_settings_ui.h"
 #include "shortcut_controller.h"
 
@@ -43,6 +44,7 @@
 #include <fmt/printf.h>
 #include <fmt/chrono.h>
 
+#include <array>
 #include <memory>
 #include <algorithm>
 #include <filesystem>
@@ -51,6 +53,10 @@
 
 constexpr auto TEMPFILETAGINDICATOR = L"~temp";
 
+// the timer that picks up the live preview and the recording stats during a recording.
+constexpr UINT_PTR preview_timer_id = 1;
+constexpr UINT preview_timer_interval = 100;
+
 static auto logger = logging::get_logger("recorder-view");
 
 /////////////////////////////////////////////////////////////////////////////
@@ -68,6 +74,7 @@ BEGIN_MESSAGE_MAP(CRecorderView, CView)
     ON_REGISTERED_MESSAGE(CRecorderView::WM_USER_GENERIC, &CRecorderView::OnUserGeneric)
 
     ON_WM_PAINT()
+    ON_WM_TIMER()
     ON_WM_CREATE()
     ON_WM_DESTROY()
     ON_WM_SETFOCUS()
@@ -82,6 +89,9 @@ BEGIN_MESSAGE_MAP(CRecorderView, CView)
     ON_UPDATE_COMMAND_UI(ID_REGION_PANREGION, &CRecorderView::OnUpdateRegionPanregion)
     ON_COMMAND(ID_OPTIONS_VIDEOOPTIONS, &CRecorderView::OnVideoSettings)
     ON_COMMAND(ID_OPTIONS_CURSOROPTIONS, &CRecorderView::OnOptionsCursoroptions)
+    ON_COMMAND(ID_OPTIONS_AUTOPAN, &CRecorderView::OnOptionsAutopan)
+    ON_UPDATE_COMMAND_UI(ID_OPTIONS_AUTOPAN, &CRecorderView::OnUpdateOptionsAutopan)
+    ON_COMMAND(ID_OPTIONS_ATUOPANSPEED, &CRecorderView::OnOptionsAutopanSpeed)
     ON_COMMAND(ID_REGION_FULLSCREEN, &CRecorderView::OnRegionFullscreen)
     ON_UPDATE_COMMAND_UI(ID_REGION_FULLSCREEN, &CRecorderView::OnUpdateRegionFullscreen)
     ON_COMMAND(ID_SCREENS_SELECTSCREEN, &CRecorderView::OnRegionSelectScreen)
@@ -226,6 +236,7 @@ void CRecorderView::OnPaint()
         // dcBits.FillRect(&rectClient, &brushBlack);
 
         DisplayBackground(dcBits);
+        DisplayPreview(dcBits);
         DisplayRecordingStatistics(dcBits);
         // OffScreen Buffer
         dc.BitBlt(0, 0, rectClient.Width(), rectClient.Height(), &dcBits, 0, 0, SRCCOPY);
@@ -239,6 +250,24 @@ void CRecorderView::OnPaint()
     }
 }
 
+void CRecorderView::OnTimer(UINT_PTR nIDEvent)
+{
+    if (nIDEvent != preview_timer_id)
+    {
+        CView::OnTimer(nIDEvent);
+        return;
+    }
+
+    if (!capture_thread_ || capture_thread_->get_preview_tap() == nullptr)
+        return;
+
+    if (const auto *preview = capture_thread_->get_preview_tap()->take_preview(); preview != nullptr)
+        preview_ = preview;
+
+    /* the recording stats change on every tick, so always repaint */
+    Invalidate(FALSE);
+}
+
 int CRecorderView::OnCreate(LPCREATESTRUCT lpCreateStruct)
 {
     if (CView::OnCreate(lpCreateStruct) == -1)
@@ -257,6 +286,9 @@ int CRecorderView::OnCreate(LPCREATESTRUCT lpCreateStruct)
         }
     );
 
+    /* keep the window list for the window picker up to date from now on */
+    window_list_service_ = std::make_unique<window_list_service>();
+
     g_hLogoBM = LoadBitmap(AfxGetInstanceHandle(), MAKEINTRESOURCE(IDB_BITMAP3));
 
     srand((unsigned)time(nullptr));
@@ -267,6 +299,7 @@ int CRecorderView::OnCreate(LPCREATESTRUCT lpCreateStruct)
 void CRecorderView::OnDestroy()
 {
     settings_model_->save();
+    window_list_service_.reset();
 
     if (g_hLogoBM)
     {
@@ -423,6 +456,7 @@ LRESULT CRecorderView::OnRecordStart(WPARAM /*wParam*/, LPARAM lParam)
         [this](){PostMessage(WM_USER_GENERIC, 1 /* cancel recording */, 0);}
      );
     capture_thread_->start(settings);
+    SetTimer(preview_timer_id, preview_timer_interval, nullptr);
 
     allow_new_record_start_key_ = TRUE; // allow this only after record_state_ is set to 1
     return 0;
@@ -454,6 +488,11 @@ void CRecorderView::_interrupt_recording(const record_interrupt_reason reason)
     else /* if (reason == record_interupt_reason::canceled) */
         capture_thread_->cancel();
 
+    /* the preview is owned by the capture thread */
+    KillTimer(preview_timer_id);
+    preview_ = nullptr;
+    Invalidate();
+
     capture_thread_.reset();
     mouse_capture_hook_->detach();
 
@@ -697,7 +736,7 @@ void CRecorderView::OnRecord()
     case capture_type::window:
     {
         const auto hwnd = m_hWnd;
-        window_select_ui window_select(this,
+        window_select_ui window_select(this, *window_list_service_,
             [hwnd](const HWND selected_window)
             {
                 const auto style = static_cast<unsigned int>(::GetWindowLongPtr(selected_window,
@@ -767,6 +806,24 @@ void CRecorderView::OnOptionsCursoroptions()
     settings_model_->save();
 }
 
+void CRecorderView::OnOptionsAutopan()
+{
+    settings_model_->set_capture_autopan_enabled(!settings_model_->get_capture_autopan_enabled());
+    settings_model_->save();
+}
+
+void CRecorderView::OnUpdateOptionsAutopan(CCmdUI *pCmdUI)
+{
+    pCmdUI->SetCheck(settings_model_->get_capture_autopan_enabled());
+}
+
+void CRecorderView::OnOptionsAutopanSpeed()
+{
+    CAutopanSpeedDlg autopan_speed(this, *settings_model_);
+    if (autopan_speed.DoModal() == IDOK)
+        settings_model_->save();
+}
+
 void CRecorderView::OnPause()
 {
     if (!capture_thread_ || capture_thread_->get_capture_state() == capture_state::paused)
@@ -905,127 +962,53 @@ void CRecorderView::OnCaptureChanged(CWnd *pWnd)
     CView::OnCaptureChanged(pWnd);
 }
 
-void CRecorderView::DisplayRecordingStatistics(CDC &/*srcDC*/)
+void CRecorderView::DisplayRecordingStatistics(CDC &srcDC)
 {
-#if 0
-    // TRACE("CRecorderView::DisplayRecordingStatistics\n");
+    if (!capture_thread_)
+        return;
+
+    /* a consistent snapshot, published by the capture thread without waiting for us */
+    const auto stats = capture_thread_->get_stats();
+
+    const auto elapsed_seconds = static_cast<int>(stats.elapsed_time);
+    constexpr double megabyte = 1024.0 * 1024.0;
+
+    std::array<CString, 7> lines;
+    lines[0].Format(_T("Time Elapsed : %d:%02d:%02d"), elapsed_seconds / 3600, (elapsed_seconds / 60) % 60,
+        elapsed_seconds % 60);
+    lines[1].Format(_T("Frames : %lld captured, %lld encoded, %lld unchanged"), stats.captured_frames,
+        stats.encoded_frames, stats.skipped_frames);
+    lines[2].Format(_T("Frame Rate : %.1f fps captured, %.1f fps encoded"), stats.capture_fps, stats.encode_fps);
+    lines[3].Format(_T("Bitrate : %.0f kbit/s"), stats.output_bitrate / 1000.0);
+    lines[4].Format(_T("Current File Size : %.2f MB"), stats.bytes_written / megabyte);
+    lines[5].Format(_T("Late Frames : %lld, Dropped Frames : %lld"), stats.late_frames, stats.dropped_frames);
+    lines[6].Format(_T("Encoder Queue : %d frames"), stats.queue_depth);
 
     CFont fontANSI;
     fontANSI.CreateStockObject(ANSI_VAR_FONT);
     CFont *pOldFont = srcDC.SelectObject(&fontANSI);
 
-    COLORREF rectcolor = (g_nColors <= 8) ? RGB(255, 255, 255) : RGB(225, 225, 225);
-    COLORREF textcolor = (g_nColors <= 8) ? RGB(0, 0, 128) : RGB(0, 0, 100);
-    textcolor = RGB(0, 144, 0);
-
-    CBrush brushSolid;
-    brushSolid.CreateSolidBrush(rectcolor);
-    CBrush *pOldBrush = srcDC.SelectObject(&brushSolid);
-
-    COLORREF oldTextColor = srcDC.SetTextColor(textcolor);
-    COLORREF oldBkColor = srcDC.SetBkColor(rectcolor);
+    COLORREF oldTextColor = srcDC.SetTextColor(RGB(0, 144, 0));
     int iOldBkMode = srcDC.SetBkMode(TRANSPARENT);
 
     CRect rectText;
     GetClientRect(&rectText);
-    CSize sizeExtent(0);
-
-    CString csMsg;
-    int xoffset = 16;
-    int yoffset = 10;
-    int iLines = 9;       // Number of lines of information to display
-    int iLineSpacing = 6; // Distance between two lines
-    int iStartPosY = rectText.bottom;
-
-    //////////////////////////////////
-    // Prepare information lines
-    //////////////////////////////////
-
-    // First line: Start recording
-    //csMsg.Format(_T("Start recording : %s"), cVideoOpts.m_cStartRecordingString.c_str());
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    iStartPosY -= (iLines * (sizeExtent.cy + iLineSpacing));
-    yoffset = iStartPosY;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    //    srcDC.Rectangle(&rectText);                        // Do we want to draw a fancy border around text?
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    // Line: Current frame
-    csMsg.Format(_T("Current Frame : %d"), g_nCurrFrame);
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    // Line: Current file sizing
-    const unsigned long MEGABYTE = (1024UL * 1024UL);
-    double dMegaBtyes = g_nTotalBytesWrittenSoFar;
-    dMegaBtyes /= MEGABYTE;
-
-    csMsg.Format(_T("Current File Size : %.2f Mb"), dMegaBtyes);
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    // Line : Input rate
-    csMsg.Format(_T("Actual Input Rate : %.2f fps"), g_fActualRate);
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    // Line : Elapsed time
-    // csMsg.Format("Time Elapsed : %.2f sec",  g_fTimeLength);
-    csMsg = "Time Elapsed : " + sTimeLength;
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    // Line : Colors info
-    csMsg.Format(_T("Number of Colors : %d g_iBits"), g_nColors);
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    // Line : Codex
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    // Line 9 : Dimension,sizing
-    csMsg.Format(_T("Dimension : %u X %d"), GetDocument()->FrameWidth(), GetDocument()->FrameHeight());
-    sizeExtent = srcDC.GetTextExtent(csMsg);
-    yoffset += sizeExtent.cy + iLineSpacing;
-    rectText.top = yoffset - 2;
-    rectText.bottom = yoffset + sizeExtent.cy + 4;
-    srcDC.TextOut(xoffset, yoffset, csMsg);
-
-    //////////////////////////////////
-    // Print information lines
-    //////////////////////////////////
+
+    const int xoffset = 16;
+    const int iLineSpacing = 6; // Distance between two lines
+    const int iLineHeight = srcDC.GetTextExtent(_T("0")).cy + iLineSpacing;
+
+    // the lines are aligned to the bottom of the view
+    int yoffset = rectText.bottom - static_cast<int>(lines.size()) * iLineHeight;
+    for (const auto &line : lines)
+    {
+        srcDC.TextOut(xoffset, yoffset, line);
+        yoffset += iLineHeight;
+    }
+
     srcDC.SelectObject(pOldFont);
-    srcDC.SelectObject(pOldBrush);
     srcDC.SetTextColor(oldTextColor);
-    srcDC.SetBkColor(oldBkColor);
     srcDC.SetBkMode(iOldBkMode);
-#endif
 }
 
 void CRecorderView::DisplayBackground(CDC &srcDC)
@@ -1048,6 +1031,32 @@ void CRecorderView::DisplayBackground(CDC &srcDC)
     bitmapLogo.Detach();
 }
 
+void CRecorderView::DisplayPreview(CDC &srcDC)
+{
+    if (preview_ == nullptr)
+        return;
+
+    CRect rectClient;
+    GetClientRect(&rectClient);
+
+    const auto preview_rect = cam::fit_rect(preview_->size, {rectClient.Width(), rectClient.Height()},
+        cam_fit_mode::letterbox);
+
+    BITMAPINFO bitmap_info = {};
+    bitmap_info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bitmap_info.bmiHeader.biWidth = preview_->stride / 4;
+    bitmap_info.bmiHeader.biHeight = -preview_->size.height();
+    bitmap_info.bmiHeader.biPlanes = 1;
+    bitmap_info.bmiHeader.biBitCount = 32;
+    bitmap_info.bmiHeader.biCompression = BI_RGB;
+
+    const auto old_mode = srcDC.SetStretchBltMode(HALFTONE);
+    ::StretchDIBits(srcDC.GetSafeHdc(), preview_rect.left(), preview_rect.top(), preview_rect.width(),
+        preview_rect.height(), 0, 0, preview_->size.width(), preview_->size.height(), preview_->data.data(),
+        &bitmap_info, DIB_RGB_COLORS, SRCCOPY);
+    srcDC.SetStretchBltMode(old_mode);
+}
+
 void CRecorderView::DisplayRecordingMsg(CDC &srcDC)
 {
     CPen penSolid;
@@ -1072,31 +1081,6 @@ void CRecorderView::DisplayRecordingMsg(CDC &srcDC)
     srcDC.SetBkColor(oldBkColor);
 }
 
-av_video_meta create_video_config(const int width, const int height, const int fps)
-{
-    av_video_meta meta;
-    meta.quality = 26; // a q factor of 26 should be enough for nice quality
-    meta.bpp = 24;
-    meta.width = width;
-    meta.height = height;
-    meta.fps = {fps, 1};
-    meta.gop = fps * 10;
-    meta.preset = video::preset::ultrafast;
-    meta.profile = video::profile::baseline;
-    meta.tune = video::tune::zerolatency;
-    return meta;
-}
-
-std::unique_ptr<av_video> create_video_codec(const av_video_meta &meta)
-{
-    av_video_codec video_codec_config;
-
-    // The video input pixel format should be automatically detected.
-    video_codec_config.pixel_format = AV_PIX_FMT_RGB24;
-
-    return std::make_unique<av_video>(video_codec_config, meta);
-}
-
 void CRecorderView::DisplayAutopanInfo(CRect /*rc*/)
 {
 }
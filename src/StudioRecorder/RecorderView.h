@@ -10,11 +10,13 @@ class CRecorderDoc;
 
 class mouse_capture_ui;
 class window_select_ui;
+class window_list_service;
 class video_settings_model;
 class settings_model;
 class mouse_hook;
 class shortcut_controller;
 class capture_thread;
+struct cam_preview_image;
 
 enum class record_interrupt_reason : int
 {
@@ -64,12 +66,16 @@ protected:
     afx_msg void OnRegionRubber();
     afx_msg void OnRegionPanregion();
     afx_msg void OnPaint();
+    afx_msg void OnTimer(UINT_PTR nIDEvent);
     afx_msg auto OnCreate(LPCREATESTRUCT lpCreateStruct) -> int;
     afx_msg void OnDestroy();
     afx_msg void OnUpdateRegionPanregion(CCmdUI *pCmdUI);
     afx_msg void OnUpdateRegionRubber(CCmdUI *pCmdUI);
     afx_msg void OnVideoSettings();
     afx_msg void OnOptionsCursoroptions();
+    afx_msg void OnOptionsAutopan();
+    afx_msg void OnUpdateOptionsAutopan(CCmdUI *pCmdUI);
+    afx_msg void OnOptionsAutopanSpeed();
     afx_msg void OnUpdateRecord(CCmdUI *pCmdUI);
     afx_msg void OnRegionFullscreen();
     afx_msg void OnUpdateRegionFullscreen(CCmdUI *pCmdUI);
@@ -105,15 +111,19 @@ private:
 
     void DisplayRecordingStatistics(CDC &srcDC);
     void DisplayBackground(CDC &srcDC);
+    void DisplayPreview(CDC &srcDC);
     void DisplayRecordingMsg(CDC &srcDC);
     void DisplayAutopanInfo(CRect rc);
 
     std::unique_ptr<capture_thread> capture_thread_;
+    // the latest live preview, owned by the preview tap of the capture thread.
+    const cam_preview_image *preview_{nullptr};
     std::unique_ptr<video_settings_model> video_settings_model_;
     std::unique_ptr<settings_model> settings_model_;
 
     std::unique_ptr<mouse_capture_ui> mouse_capture_ui_;
     std::unique_ptr<window_select_ui> window_select_ui_;
+    std::unique_ptr<window_list_service> window_list_service_;
 
     std::unique_ptr<mouse_hook> mouse_capture_hook_;
 
@@ -22,11 +22,20 @@
 #include <CamEncoder/av_encoder.h>
 #include <screen_capture/cam_stop_watch.h>
 #include <screen_capture/annotations/cam_annotation_cursor.h>
+#include <screen_capture/cam_input_stream.h>
+#include <screen_capture/cam_autopan.h>
+#include <screen_capture/cam_frame_dedup.h>
 #include <algorithm>
 #include <fmt/format.h>
 
 static auto logger = logging::get_logger("capture thread");
 
+// the live preview is updated about this many times per second.
+constexpr auto preview_fps = 5;
+
+// the interval in seconds at which the recording stats are published.
+constexpr auto stats_interval = 0.5;
+
 av_muxer_type cam_get_file_container(const video_container &container)
 {
     switch (container.get_index())
@@ -48,6 +57,18 @@ video::codec cam_create_codec(const video_codec &codec)
     return {};
 }
 
+video::compression cam_create_codec_compression(const video_codec_compression &compression)
+{
+    switch (compression.get_index())
+    {
+    case video_codec_compression::type::lzo: return video::compression::lzo;
+    case video_codec_compression::type::gzip: return video::compression::gzip;
+    case video_codec_compression::type::lz4: return video::compression::lz4;
+    case video_codec_compression::type::zstd: return video::compression::zstd;
+    }
+    return video::compression::lzo;
+}
+
 std::optional<video::preset> cam_create_codec_preset(const video_codec_preset &preset)
 {
     switch(preset.get_index())
@@ -121,6 +142,19 @@ std::optional<video::codec_level> cam_create_codec_level(video_codec_level level
     return {};
 }
 
+video::scale_filter cam_create_scale_filter(video_scale_filter filter)
+{
+    switch (filter.get_index())
+    {
+    case video_scale_filter::type::point: return video::scale_filter::point;
+    case video_scale_filter::type::bilinear: return video::scale_filter::bilinear;
+    case video_scale_filter::type::area: return video::scale_filter::area;
+    case video_scale_filter::type::bicubic: return video::scale_filter::bicubic;
+    case video_scale_filter::type::lanczos: return video::scale_filter::lanczos;
+    }
+    return video::scale_filter::bicubic;
+}
+
 av_video_meta cam_create_video_config(const int width, const int height, const int fps, const video_settings_model &settings)
 {
     av_video_meta meta;
@@ -147,17 +181,79 @@ av_video_meta cam_create_video_config(const int width, const int height, const i
     meta.profile = cam_create_codec_profile(settings.video_codec_profile_);
     meta.tune = cam_create_codec_tune(settings.video_codec_tune_);
     meta.level = cam_create_codec_level(settings.video_codec_level_);
+    // x264 detects scene cuts itself, so only the camstudio codec hashes the frames for it.
+    if (meta.codec == video::codec::camstudio)
+    {
+        meta.scene_change_threshold = av_scene_change_detector::default_threshold;
+        meta.compression = cam_create_codec_compression(settings.video_codec_compression_);
+        if (settings.video_codec_compression_level_ > 0)
+            meta.compression_level = settings.video_codec_compression_level_;
+        meta.long_range = settings.video_codec_compression_long_range_;
+    }
+    // with adaptive quality the quality controller steps the x264 preset down when the encoder
+    // falls behind.
+    meta.reconfigurable = meta.codec == video::codec::x264 && settings.video_codec_adaptive_quality_;
+
+    if (settings.video_output_width_ > 0 && settings.video_output_height_ > 0)
+    {
+        meta.output_width = settings.video_output_width_;
+        meta.output_height = settings.video_output_height_;
+    }
+    meta.scale_filter = cam_create_scale_filter(settings.video_scale_filter_);
 
     return meta;
 }
 
-std::unique_ptr<av_video> cam_create_video_codec(const av_video_meta &meta)
+AVPixelFormat cam_to_av_pixel_format(cam_pixel_format format)
+{
+    switch (format)
+    {
+    case cam_pixel_format::bgr0: return AV_PIX_FMT_BGR0;
+    case cam_pixel_format::bgra: return AV_PIX_FMT_BGRA;
+    case cam_pixel_format::bgr24: return AV_PIX_FMT_BGR24;
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+/* let the encoder take the format the capture source delivers, so it only converts when it has to */
+std::unique_ptr<av_video> cam_create_video_codec(const av_video_meta &meta,
+    const std::vector<cam_pixel_format> &source_formats)
 {
+    std::vector<AVPixelFormat> av_source_formats;
+    for (const auto format : source_formats)
+        av_source_formats.push_back(cam_to_av_pixel_format(format));
+
     av_video_codec video_codec_config;
-    // \todo remove 'pixel_format'.
-    video_codec_config.pixel_format = AV_PIX_FMT_BGRA;
+    video_codec_config.pixel_format = av_negotiate_pixel_format(av_source_formats, meta.codec);
+
+    auto video_codec = std::make_unique<av_video>(video_codec_config, meta);
+    logger->info("capture_thread: encoder input format: {}, conversion free: {}",
+        av_get_pix_fmt_name(video_codec_config.pixel_format), video_codec->is_conversion_free());
+    return video_codec;
+}
+
+av_quality_controller_config cam_create_quality_controller_config(const av_video_meta &meta, const double fps)
+{
+    av_quality_controller_config config;
+    config.frame_budget = 1.0 / fps;
+    config.max_preset = meta.preset.value_or(video::preset::medium);
 
-    return std::make_unique<av_video>(video_codec_config, meta);
+    /* the camstudio codec has no presets, so we are only able to lower the frame rate. */
+    if (meta.codec == video::codec::camstudio)
+        config.min_preset = config.max_preset;
+
+    return config;
+}
+
+const char *cam_quality_decision_name(av_quality_decision decision)
+{
+    switch (decision)
+    {
+    case av_quality_decision::none: return "none";
+    case av_quality_decision::step_down: return "step down";
+    case av_quality_decision::step_up: return "step up";
+    }
+    return "";
 }
 
 capture_thread::capture_thread(const std::function<void()> &on_recording_completed,
@@ -183,6 +279,13 @@ void capture_thread::start(capture_settings settings)
     run_ = true;
     capture_state_ = capture_state::capturing;
     capture_settings_ = std::move(settings);
+
+    /* the tap copies the previewed frames on the capture thread, so only a few frames per second */
+    cam_preview_config preview_config;
+    preview_config.frame_interval = std::max(capture_settings_.video_settings.video_source_fps_ / preview_fps, 1);
+    preview_tap_ = std::make_unique<cam_preview_tap>(preview_config);
+    stats_.store(recording_stats{});
+
     capture_thread_ = std::thread([this](){run();});
 
     logger->debug("capturing started, {}", settings.filename);
@@ -239,6 +342,16 @@ capture_state capture_thread::get_capture_state() const noexcept
     return capture_state_;
 }
 
+auto capture_thread::get_preview_tap() noexcept -> cam_preview_tap *
+{
+    return preview_tap_.get();
+}
+
+auto capture_thread::get_stats() const noexcept -> recording_stats
+{
+    return stats_.load();
+}
+
 const cam_frame *capture_thread::capture_screen_frame(const cam::rect<int> &capture_dst_rect)
 {
     if (!capture_source_->capture_frame(capture_dst_rect))
@@ -271,8 +384,16 @@ void capture_thread::run()
         capture_settings_.capture_rect_);
     capture_source_->enable_annotations();
 
+    /* a window is followed while it moves and resizes, the recording keeps its initial size */
+    if (capture_settings_.capture_hwnd_ != nullptr)
+        capture_source_->enable_window_tracking(cam_fit_mode::shrink);
+
     const auto &settings = capture_settings_.settings;
 
+    if (capture_settings_.capture_hwnd_ == nullptr && settings.get_capture_desktop_duplication()
+        && !capture_source_->enable_desktop_duplication())
+        logger->info("capture_thread: desktop duplication is not available, capturing with gdi");
+
     const auto halo_size = cam::size(
         settings.get_cursor_halo_size(),
         settings.get_cursor_halo_size()
@@ -283,10 +404,14 @@ void capture_thread::run()
         settings.get_cursor_ring_size()
     );
 
+    /* with recorded input the rings and halos are rendered afterwards (CamStudioRerender), so only
+     * the cursor is burned into the video, and the capture does not pay for the effects. */
+    const auto render_cursor_effects = !capture_settings_.record_input_events;
+
     const auto show_cursor_enabled = settings.get_cursor_enabled();
-    const auto show_cursor_ring_enabled = settings.get_cursor_ring_enabled();
-    const auto show_cursor_halo_enabled = settings.get_cursor_halo_enabled();
-    const auto show_cursor_halo_clicks_enabled = settings.get_cursor_click_enabled();
+    const auto show_cursor_ring_enabled = render_cursor_effects && settings.get_cursor_ring_enabled();
+    const auto show_cursor_halo_enabled = render_cursor_effects && settings.get_cursor_halo_enabled();
+    const auto show_cursor_halo_clicks_enabled = render_cursor_effects && settings.get_cursor_click_enabled();
 
     capture_source_->add_annotation(
         std::make_unique<cam_annotation_cursor>(
@@ -325,36 +450,189 @@ void capture_thread::run()
         cam_get_file_container(capture_settings_.video_settings.video_container_),
         metadata);
 
-    video_encoder->add_stream(cam_create_video_codec(config));
+    video_encoder->add_stream(cam_create_video_codec(config, capture_source_->get_native_pixel_formats()));
     video_encoder->open();
 
+    /* the input stream and the video share the same start time */
+    if (capture_settings_.record_input_events)
+        capture_source_->enable_input_recording();
+
     cam::stop_watch frame_limiter;
     frame_limiter.time_start();
 
     const auto max_frame_time = 1.0/capture_settings_.video_settings.video_source_fps_;
+
+    /* without adaptive quality the controller is never updated, so it keeps the configured preset
+     * and frame rate. */
+    const auto adaptive_quality = capture_settings_.video_settings.video_codec_adaptive_quality_;
+    av_quality_controller quality_controller(cam_create_quality_controller_config(config,
+        capture_settings_.video_settings.video_source_fps_));
+
+    /* the autopan viewport is scaled back up to the capture size, so the encoder config stays the same */
+    std::unique_ptr<cam_autopan> autopan;
+    if (settings.get_capture_autopan_enabled())
+    {
+        const auto frame_size = cam::size(pre_frame->width, pre_frame->height);
+        const auto zoom = std::max(settings.get_capture_autopan_zoom(), 1.0);
+
+        cam_autopan_config autopan_config;
+        autopan_config.viewport_size = cam::size(
+            std::max(static_cast<int>(frame_size.width() / zoom), 1),
+            std::max(static_cast<int>(frame_size.height() / zoom), 1));
+        autopan_config.output_size = frame_size;
+        autopan_config.max_speed = settings.get_capture_autopan_speed();
+        autopan = std::make_unique<cam_autopan>(frame_size, autopan_config);
+    }
+    auto timestamp_previous_frame = frame_limiter.time_now();
+
+    /* frames without damage are not encoded, the previous frame simply lasts longer */
+    cam_frame_dedup frame_dedup;
+
+    /* the rates are measured over the last stats interval */
+    recording_stats stats;
+    recording_stats previous_stats;
+    const auto timestamp_recording_start = frame_limiter.time_now();
+    auto timestamp_previous_stats = timestamp_recording_start;
+    auto paused_time = 0.0;
+    int64_t failed_capture_count = 0;
+
+    const auto publish_stats = [&](double timestamp_now) {
+        const auto muxer_stats = video_encoder->get_stats();
+        stats.elapsed_time = timestamp_now - timestamp_recording_start - paused_time;
+        stats.bytes_written = muxer_stats.bytes_written;
+        stats.encoded_frames = muxer_stats.encoded_frames;
+        stats.dropped_frames = failed_capture_count + muxer_stats.dropped_frames;
+        stats.queue_depth = muxer_stats.queue_depth;
+        stats.skipped_frames = frame_dedup.get_skipped_count();
+
+        if (const auto interval = timestamp_now - timestamp_previous_stats; interval > 0.0)
+        {
+            stats.capture_fps = (stats.captured_frames - previous_stats.captured_frames) / interval;
+            stats.encode_fps = (stats.encoded_frames - previous_stats.encoded_frames) / interval;
+            stats.output_bitrate = (stats.bytes_written - previous_stats.bytes_written) * 8.0 / interval;
+        }
+
+        stats_.store(stats);
+        previous_stats = stats;
+        timestamp_previous_stats = timestamp_now;
+    };
+
     while (run_)
     {
         const auto timestamp_capture_start = frame_limiter.time_now();
         const auto frame = capture_screen_frame(capture_settings_.capture_rect_);
-
         if (frame != nullptr)
+        {
+            preview_tap_->offer(*frame);
+            ++stats.captured_frames;
+        }
+        else
+        {
+            ++failed_capture_count;
+        }
+
+        /* autopan keeps moving over an unchanged frame, so those frames are always encoded */
+        const auto is_unchanged = frame != nullptr && autopan == nullptr
+            && !frame_dedup.should_encode(frame->damage, frame->timestamp / 1000000.0);
+
+        if (frame != nullptr && !is_unchanged)
         {
             const auto timestamp = static_cast<timestamp_t>(timestamp_capture_start * 1000.0);
-            video_encoder->encode_frame(timestamp, frame->bitmap_data, frame->width, frame->height,
-                frame->stride);
+            const auto timestamp_encode_start = frame_limiter.time_now();
+            if (autopan)
+            {
+                autopan->update(capture_source_->get_mouse_position(),
+                    timestamp_capture_start - timestamp_previous_frame);
+                autopan->render(frame->bitmap_data, frame->stride);
+
+                const auto &output_size = autopan->get_output_size();
+                video_encoder->encode_frame(timestamp, const_cast<uint8_t *>(autopan->get_output_data()),
+                    output_size.width(), output_size.height(), autopan->get_output_stride());
+            }
+            else
+            {
+                video_encoder->encode_frame(timestamp, frame->bitmap_data, frame->width, frame->height,
+                    frame->stride);
+            }
+            timestamp_previous_frame = timestamp_capture_start;
+            const auto encode_time = frame_limiter.time_now() - timestamp_encode_start;
+
+            const auto queue_depth = video_encoder->get_queue_depth();
+            const auto decision = adaptive_quality
+                ? quality_controller.update(encode_time, queue_depth)
+                : av_quality_decision::none;
+            if (decision != av_quality_decision::none)
+            {
+                const auto preset = quality_controller.get_preset();
+                logger->info("quality controller: {}, load: {:.2f}, queue depth: {}, preset: {}, fps divisor: {}",
+                    cam_quality_decision_name(decision), quality_controller.get_load(), queue_depth,
+                    video::preset_names.at(static_cast<int>(preset)), quality_controller.get_fps_divisor());
+
+                video_encoder->set_preset(preset);
+            }
         }
 
         const auto timestamp_capture_end = frame_limiter.time_now();
-        
-        if (const auto sleep_for = max_frame_time - (timestamp_capture_end - timestamp_capture_start); sleep_for > 0)
+        const auto frame_time = max_frame_time * quality_controller.get_fps_divisor();
+        if (timestamp_capture_end - timestamp_capture_start > frame_time)
+            ++stats.late_frames;
+
+        if (timestamp_capture_end - timestamp_previous_stats >= stats_interval)
+            publish_stats(timestamp_capture_end);
+
+        if (const auto sleep_for = frame_time - (timestamp_capture_end - timestamp_capture_start); sleep_for > 0)
             std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(std::ceil(sleep_for * 1000.0))));
 
-        while (capture_state_ == capture_state::paused && run_ == true)
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (capture_state_ == capture_state::paused)
+        {
+            const auto timestamp_pause_start = frame_limiter.time_now();
+            while (capture_state_ == capture_state::paused && run_ == true)
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+            /* the paused time counts neither for the elapsed time nor for the rates */
+            const auto pause_time = frame_limiter.time_now() - timestamp_pause_start;
+            paused_time += pause_time;
+            timestamp_previous_stats += pause_time;
+
+            // start the resumed part of the recording with a keyframe.
+            video_encoder->request_keyframe();
+            frame_dedup.reset();
+        }
     }
 
+    /* flush here, the muxer destructor can only swallow the errors of the last frames */
+    try
+    {
+        video_encoder->flush();
+    }
+    catch (const std::exception &e)
+    {
+        logger->error("capture_thread: unable to encode the last frames: {}", e.what());
+    }
+
+    publish_stats(frame_limiter.time_now());
+    const auto avoided_conversion_count = video_encoder->get_avoided_conversion_count();
     video_encoder.reset();
-    logger->debug("capture_thread: completed capturing");
+    logger->debug("capture_thread: completed capturing {:.1f}s, captured {} frames, encoded {}, "
+        "skipped {} unchanged, dropped {}, late {}, {} bytes written, {} frames without color conversion",
+        stats.elapsed_time, stats.captured_frames, stats.encoded_frames, stats.skipped_frames,
+        stats.dropped_frames, stats.late_frames, stats.bytes_written, avoided_conversion_count);
+
+    if (const auto *input_stream = capture_source_->get_input_stream();
+        input_stream != nullptr && capture_state_ == capture_state::stopping)
+    {
+        const auto input_filename = capture_settings_.filename + cam::input_stream_extension;
+        try
+        {
+            cam::save_input_stream(input_filename, input_stream->get_data());
+            logger->debug("capture_thread: saved {} input records to {}", input_stream->get_record_count(),
+                input_filename);
+        }
+        catch (const std::exception &e)
+        {
+            logger->error("capture_thread: {}", e.what());
+        }
+    }
 
     if (capture_state_ == capture_state::stopping)
         on_recording_completed_();
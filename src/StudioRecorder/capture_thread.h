@@ -18,7 +18,9 @@
 #pragma once
 
 #include <screen_capture/cam_capture.h>
+#include <screen_capture/cam_preview_tap.h>
 #include <screen_capture/cam_rect.h>
+#include <screen_capture/cam_seqlock.h>
 
 #include "video_settings_ui.h"
 #include "settings_model.h"
@@ -34,10 +36,34 @@ struct capture_settings
     capture_type capture_type_{ capture_type::allscreens };
 
     std::string filename;
+    // record the mouse input next to the video (filename + .caminput), for rendering cursor effects later.
+    // The video then only gets the cursor, the rings and halos are not burned in.
+    bool record_input_events{false};
     video_settings_model video_settings;
     settings_model settings;
 };
 
+// a snapshot of the recording progress, published by the capture thread a few times per second.
+struct recording_stats
+{
+    // the recorded time in seconds, without the paused time.
+    double elapsed_time{0.0};
+    double capture_fps{0.0};
+    double encode_fps{0.0};
+    // the encoded video bits per second.
+    double output_bitrate{0.0};
+    int64_t bytes_written{0};
+    int64_t captured_frames{0};
+    int64_t encoded_frames{0};
+    // unchanged frames that were not encoded.
+    int64_t skipped_frames{0};
+    // frames that were lost, the capture source failed to deliver them or the encoder queue was full.
+    int64_t dropped_frames{0};
+    // frames that took longer than the frame time to capture and encode.
+    int64_t late_frames{0};
+    int queue_depth{0};
+};
+
 enum class capture_state
 {
     stopping,
@@ -70,6 +96,10 @@ public:
     void unpause();
     /* returns the capture state */
     capture_state get_capture_state() const noexcept;
+    /* the live preview of the recording, only take previews from a single (ui) thread */
+    auto get_preview_tap() noexcept -> cam_preview_tap *;
+    /* the last published recording stats, safe to call from any thread at any rate */
+    auto get_stats() const noexcept -> recording_stats;
 
 protected:
     void run();
@@ -78,6 +108,8 @@ protected:
 private:
     capture_settings capture_settings_;
     std::unique_ptr<cam_capture_source> capture_source_;
+    std::unique_ptr<cam_preview_tap> preview_tap_;
+    cam_seqlock<recording_stats> stats_;
     std::thread capture_thread_;
     std::atomic<bool> run_{false};
     std::atomic<capture_state> capture_state_{capture_state::stopped};
@@ -25,8 +25,10 @@
 #include <screen_capture/cam_color.h>
 #include <screen_capture/cam_rect.h>
 #include <screen_capture/cam_gdiplus.h>
+#include <screen_capture/cam_canvas.h>
 #include <screen_capture/cam_draw_data.h>
 #include <screen_capture/cam_stop_watch.h>
+#include <vector>
 
 static auto logger = logging::get_logger("cursor_settings_ui");
 
@@ -206,11 +208,12 @@ void cursor_settings_ui::_draw_cursor_preview(cam_mouse_button::type mouse_butto
     CRect preview_rect;
     cursor_preview_.GetWindowRect(&preview_rect);
 
-    Gdiplus::Bitmap image(preview_rect.Width(), preview_rect.Height(), PixelFormat32bppPARGB);
+    const auto width = preview_rect.Width();
+    const auto height = preview_rect.Height();
 
-    Gdiplus::Graphics canvas(&image);
-    canvas.SetSmoothingMode(Gdiplus::SmoothingMode::SmoothingModeAntiAlias);
-    canvas.SetCompositingMode(Gdiplus::CompositingMode::CompositingModeSourceOver);
+    /* the annotations are blended onto a white background. */
+    std::vector<uint32_t> pixels(static_cast<size_t>(width) * height, 0xffffffff);
+    cam_canvas canvas(reinterpret_cast<uint8_t *>(pixels.data()), width, height, width * 4);
 
     // draw a raster so we can see what has alpha and what is not...
     //Gdiplus::Pen pen(Gdiplus::Color::Gray, 1);
@@ -224,6 +227,8 @@ void cursor_settings_ui::_draw_cursor_preview(cam_mouse_button::type mouse_butto
 
     annotation_->draw(canvas, draw_data);
 
+    Gdiplus::Bitmap image(width, height, width * 4, PixelFormat32bppPARGB, reinterpret_cast<BYTE *>(pixels.data()));
+
     HBITMAP bitmap;
     if (const auto ret = image.GetHBITMAP(Gdiplus::Color(255, 255, 255, 255), &bitmap); ret != Gdiplus::Status::Ok)
         logger->warn("failed to get HBitmap from gdiplug bitmap");
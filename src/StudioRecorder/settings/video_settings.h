@@ -84,6 +84,29 @@ using video_codec = settings_enum_type<video_codec_type,
 
 //////////////////////////////////////////////////////////////////////////
 
+struct video_codec_compression_type
+{
+    using enum_type = enum
+    {
+        lzo, // default, readable by every player.
+        gzip,
+        lz4,
+        zstd
+    };
+};
+
+static const wchar_t* video_codec_compression_strings[] = {
+    L"LZO",
+    L"GZip",
+    L"LZ4 (CamStudio player only)",
+    L"Zstandard (CamStudio player only)"
+};
+
+using video_codec_compression = settings_enum_type<video_codec_compression_type,
+    std::size(video_codec_compression_strings), video_codec_compression_strings>;
+
+//////////////////////////////////////////////////////////////////////////
+
 struct video_codec_preset_type
 {
     using enum_type = enum
@@ -223,3 +246,28 @@ static const wchar_t* video_codec_level_strings[] = {
 
 using video_codec_level = settings_enum_type<video_codec_level_type,
     std::size(video_codec_level_strings), video_codec_level_strings>;
+
+//////////////////////////////////////////////////////////////////////////
+
+struct video_scale_filter_type
+{
+    using enum_type = enum
+    {
+        point,
+        bilinear,
+        area,
+        bicubic,
+        lanczos
+    };
+};
+
+static const wchar_t* video_scale_filter_strings[] = {
+    L"Point (fastest)",
+    L"Bilinear",
+    L"Area",
+    L"Bicubic",
+    L"Lanczos (best)"
+};
+
+using video_scale_filter = settings_enum_type<video_scale_filter_type,
+    std::size(video_scale_filter_strings), video_scale_filter_strings>;
@@ -40,6 +40,10 @@ namespace capture
     constexpr auto region_fixed = "capture_region_fixed";
     constexpr auto region_mouse_drag = "capture_region_mouse_drag";
     constexpr auto rect = "capture_rect";
+    constexpr auto autopan_enabled = "capture_autopan_enabled";
+    constexpr auto autopan_speed = "capture_autopan_speed";
+    constexpr auto autopan_zoom = "capture_autopan_zoom";
+    constexpr auto desktop_duplication = "capture_desktop_duplication";
 }
 
 namespace cursor
@@ -368,6 +372,10 @@ void settings_model::_save_capture_settings(cpptoml::table &root)
     capture.insert(config::capture::region_fixed, capture_fixed_);
     capture.insert(config::capture::region_mouse_drag, capture_mouse_drag_);
     capture.insert(config::capture::rect, capture_rect_);
+    capture.insert(config::capture::autopan_enabled, capture_autopan_enabled_);
+    capture.insert(config::capture::autopan_speed, capture_autopan_speed_);
+    capture.insert(config::capture::autopan_zoom, capture_autopan_zoom_);
+    capture.insert(config::capture::desktop_duplication, capture_desktop_duplication_);
 
     root.insert(config::capture::settings, capture.get_table());
 }
@@ -444,6 +452,10 @@ void settings_model::_load_capture_settings(const cpptoml::table &root)
     capture_fixed_ = capture.get_optional<bool>(config::capture::region_fixed, false);
     capture_mouse_drag_ = capture.get_optional<bool>(config::capture::region_mouse_drag, false);
     capture_rect_ = capture.get_optional<cam::rect<int>>(config::capture::rect, {});
+    capture_autopan_enabled_ = capture.get_optional<bool>(config::capture::autopan_enabled, false);
+    capture_autopan_speed_ = capture.get_optional<int>(config::capture::autopan_speed, 1200);
+    capture_autopan_zoom_ = capture.get_optional<double>(config::capture::autopan_zoom, 2.0);
+    capture_desktop_duplication_ = capture.get_optional<bool>(config::capture::desktop_duplication, true);
 }
 
 void settings_model::_load_cursor_settings(const cpptoml::table &root)
@@ -599,6 +611,46 @@ bool settings_model::get_region_fixed()
     return capture_fixed_;
 }
 
+void settings_model::set_capture_autopan_enabled(bool enabled) noexcept
+{
+    capture_autopan_enabled_ = enabled;
+}
+
+auto settings_model::get_capture_autopan_enabled() const noexcept -> bool
+{
+    return capture_autopan_enabled_;
+}
+
+void settings_model::set_capture_autopan_speed(int speed) noexcept
+{
+    capture_autopan_speed_ = speed;
+}
+
+auto settings_model::get_capture_autopan_speed() const noexcept -> int
+{
+    return capture_autopan_speed_;
+}
+
+void settings_model::set_capture_autopan_zoom(double zoom) noexcept
+{
+    capture_autopan_zoom_ = zoom;
+}
+
+auto settings_model::get_capture_autopan_zoom() const noexcept -> double
+{
+    return capture_autopan_zoom_;
+}
+
+void settings_model::set_capture_desktop_duplication(bool enabled) noexcept
+{
+    capture_desktop_duplication_ = enabled;
+}
+
+auto settings_model::get_capture_desktop_duplication() const noexcept -> bool
+{
+    return capture_desktop_duplication_;
+}
+
 void settings_model::set_cursor_enabled(bool enabled)
 {
     cursor_enabled_ = enabled;
@@ -65,6 +65,19 @@ public:
     void set_region_fixed(bool capture_fixed);
     auto get_region_fixed() -> bool;
 
+    // follow the cursor with a zoomed in viewport.
+    void set_capture_autopan_enabled(bool enabled) noexcept;
+    auto get_capture_autopan_enabled() const noexcept -> bool;
+    // the maximum pan speed in pixels per second.
+    void set_capture_autopan_speed(int speed) noexcept;
+    auto get_capture_autopan_speed() const noexcept -> int;
+    // the zoom factor, the viewport is the capture area divided by the zoom factor.
+    void set_capture_autopan_zoom(double zoom) noexcept;
+    auto get_capture_autopan_zoom() const noexcept -> double;
+    // capture the desktop with desktop duplication, gdi is used when it is not available.
+    void set_capture_desktop_duplication(bool enabled) noexcept;
+    auto get_capture_desktop_duplication() const noexcept -> bool;
+
     /* cursor */
     void set_cursor_enabled(bool enabled);
     auto get_cursor_enabled() const -> bool;
@@ -153,6 +166,10 @@ private:
     cam::rect<int> capture_rect_{0, 0, 0, 0};
     bool capture_fixed_{false};
     bool capture_mouse_drag_{false};
+    bool capture_autopan_enabled_{false};
+    int capture_autopan_speed_{1200};
+    double capture_autopan_zoom_{2.0};
+    bool capture_desktop_duplication_{true};
 
     /* cursor settings */
     bool cursor_enabled_{true};
@@ -188,8 +205,6 @@ private:
     application_output_directory::type application_output_directory_access_{application_output_directory::ask_user};
     // user defined output directory
     std::string application_output_directory_{""};
-    // AutoPan = false; // not implemented
-    // MaxPan = 20; // not implemented
 
     /* shortcuts */
     std::map<shortcut_action::type, shortcut_definition> shortcut_settings_{
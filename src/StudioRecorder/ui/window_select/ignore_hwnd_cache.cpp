@@ -20,7 +20,12 @@ WindowAndProcPath *HWNDDataCache::get_internal(HWND hwnd) noexcept
 {
     auto root = GetAncestor(hwnd, GA_ROOT);
     // Filter the fast and easy cases
-    if (!IsWindowVisible(root) || is_invalid_hwnd(root) || is_invalid_class(root) || is_invalid_style(root))
+    if (!IsWindowVisible(root) || is_invalid_hwnd(root) || is_invalid_style(root))
+    {
+        return nullptr;
+    }
+    const auto type = get_class_type(root);
+    if (type == class_type::invalid)
     {
         return nullptr;
     }
@@ -32,10 +37,11 @@ WindowAndProcPath *HWNDDataCache::get_internal(HWND hwnd) noexcept
         cache_ptr = put_in_cache(root, pid);
     }
     // If the app is a UWP app, check if it isn't banned
-    if (is_uwp_app(root) && is_invalid_uwp_app(cache_ptr->process_path))
+    if (type == class_type::uwp_app && is_invalid_uwp_app(cache_ptr->process_path))
     {
         // cache the HWND of the invalid app so we wont search for it again
-        invalid_hwnds_.push_back(root);
+        invalid_hwnds_.insert(root);
+        cache_.erase(root);
         return nullptr;
     }
 
@@ -44,43 +50,46 @@ WindowAndProcPath *HWNDDataCache::get_internal(HWND hwnd) noexcept
 
 WindowAndProcPath *HWNDDataCache::get_from_cache(HWND root, DWORD pid) noexcept
 {
-    auto next = next_timestamp();
-    auto it = std::find_if(begin(cache_), end(cache_),
-                           [&](const auto &entry) { return root == entry.data.hwnd && pid == entry.pid; });
-    if (it == end(cache_))
+    auto entry = cache_.find(root);
+    // a reused HWND handle of another process is a cache miss.
+    if (entry == nullptr || entry->pid != pid)
         return nullptr;
 
-    it->atime = next;
-    return &(it->data);
+    return &(entry->data);
 }
 
 WindowAndProcPath *HWNDDataCache::put_in_cache(HWND root, DWORD pid) noexcept
 {
-    auto next = next_timestamp();
-    auto it = std::min_element(begin(cache_), end(cache_),
-                               [](const auto &lhs, const auto &rhs) { return lhs.atime < rhs.atime; });
-    it->atime = next;
-    it->pid = pid;
-    it->data.hwnd = root;
-    it->data.process_path = get_process_path(root);
-    return &(it->data);
+    auto &entry = cache_.insert(root, Entry{pid, WindowAndProcPath{root, get_process_path(root)}});
+    return &(entry.data);
 }
 
 bool HWNDDataCache::is_invalid_hwnd(HWND hwnd) const noexcept
 {
-    return std::find(begin(invalid_hwnds_), end(invalid_hwnds_), hwnd) != end(invalid_hwnds_);
+    return invalid_hwnds_.count(hwnd) != 0;
 }
-bool HWNDDataCache::is_invalid_class(HWND hwnd) const noexcept
+HWNDDataCache::class_type HWNDDataCache::get_class_type(HWND hwnd) noexcept
 {
-    std::array<char, 256> class_name;
-    GetClassNameA(hwnd, std::data(class_name), static_cast<int>(std::size(class_name)));
-
-    for (auto invalid : invalid_classes_)
+    const auto atom = static_cast<ATOM>(GetClassWord(hwnd, GCW_ATOM));
+    if (atom != 0)
     {
-        if (strcmp(invalid, std::data(class_name)) == 0)
-            return true;
+        if (const auto itr = class_types_.find(atom); itr != class_types_.end())
+            return itr->second;
     }
-    return false;
+
+    std::array<char, 256> class_name{};
+    GetClassNameA(hwnd, std::data(class_name), static_cast<int>(std::size(class_name)));
+
+    auto type = class_type::valid;
+    if (invalid_classes_.count(std::data(class_name)) != 0)
+        type = class_type::invalid;
+    else if (strcmp(std::data(class_name), "Windows.UI.Core.CoreWindow") == 0)
+        type = class_type::uwp_app;
+
+    if (atom != 0)
+        class_types_.emplace(atom, type);
+
+    return type;
 }
 bool HWNDDataCache::is_invalid_style(HWND hwnd) const noexcept
 {
@@ -102,12 +111,6 @@ bool HWNDDataCache::is_invalid_style(HWND hwnd) const noexcept
     }
     return false;
 }
-bool HWNDDataCache::is_uwp_app(HWND hwnd) const noexcept
-{
-    std::array<char, 256> class_name;
-    GetClassNameA(hwnd, std::data(class_name), static_cast<int>(std::size(class_name)));
-    return strcmp(std::data(class_name), "Windows.UI.Core.CoreWindow") == 0;
-}
 bool HWNDDataCache::is_invalid_uwp_app(const std::wstring &process_path) const noexcept
 {
     for (const auto &invalid : invalid_uwp_apps_)
@@ -122,16 +125,3 @@ bool HWNDDataCache::is_invalid_uwp_app(const std::wstring &process_path) const n
     return false;
 }
 
-unsigned HWNDDataCache::next_timestamp() noexcept
-{
-    auto next = ++current_timestamp_;
-    if (next == 0)
-    {
-        // Handle overflow by invalidating the cache
-        for (auto &entry : cache_)
-        {
-            entry.data.hwnd = nullptr;
-        }
-    }
-    return next;
-}
\ No newline at end of file
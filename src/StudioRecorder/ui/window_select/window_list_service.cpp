@@ -0,0 +1,115 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+#include "window_list_service.h"
+#include "window_thumbnail_widget.h"
+#include <cassert>
+
+// the window events do not carry any user data.
+static window_list_service *service_instance = nullptr;
+
+static HICON load_process_icon(const std::wstring &process_filepath)
+{
+    /* the shell icon functions need com on the worker thread */
+    thread_local const auto com_initialized = SUCCEEDED(::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED));
+    (void)com_initialized;
+
+    return get_shell_icon(process_filepath);
+}
+
+window_list_service::window_list_service()
+    : window_list_(source_)
+    , icon_cache_(load_process_icon,
+        [this](const std::wstring &)
+        {
+            if (const auto hwnd = icon_listener_.load(); hwnd != nullptr)
+                ::RedrawWindow(hwnd, nullptr, nullptr, RDW_INVALIDATE | RDW_ALLCHILDREN);
+        })
+{
+    assert(service_instance == nullptr);
+    service_instance = this;
+
+    /* install the hooks first, so no window is missed between the enumeration and the events. The
+     * location change events are in between, so use two hooks to skip those. */
+    constexpr auto flags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+    show_hide_hook_ = ::SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE, nullptr,
+        &window_list_service::_on_window_event, 0, 0, flags);
+    name_change_hook_ = ::SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, nullptr,
+        &window_list_service::_on_window_event, 0, 0, flags);
+
+    window_list_.populate();
+}
+
+window_list_service::~window_list_service()
+{
+    if (show_hide_hook_)
+        ::UnhookWinEvent(show_hide_hook_);
+    if (name_change_hook_)
+        ::UnhookWinEvent(name_change_hook_);
+
+    icon_listener_ = nullptr;
+    service_instance = nullptr;
+}
+
+auto window_list_service::get_windows() const -> std::vector<window_data>
+{
+    std::vector<window_data> result;
+    for (auto &window : window_list_.get_windows())
+    {
+        result.push_back({window.process_id, std::move(window.process_name), std::move(window.process_filepath),
+            std::move(window.title), reinterpret_cast<HWND>(window.id)});
+    }
+    return result;
+}
+
+auto window_list_service::get_icon(const std::wstring &process_filepath) -> std::optional<HICON>
+{
+    return icon_cache_.get(process_filepath);
+}
+
+void window_list_service::set_icon_listener(HWND hwnd) noexcept
+{
+    icon_listener_ = hwnd;
+}
+
+void CALLBACK window_list_service::_on_window_event(HWINEVENTHOOK /*hook*/, DWORD event, HWND hwnd,
+    LONG id_object, LONG id_child, DWORD /*event_thread*/, DWORD /*event_time*/)
+{
+    if (service_instance == nullptr || hwnd == nullptr || id_object != OBJID_WINDOW || id_child != CHILDID_SELF)
+        return;
+
+    cam_window_event window_event{cam_window_event_type::created, reinterpret_cast<cam_window_id>(hwnd)};
+    switch (event)
+    {
+    /* a window is created hidden, it only becomes a candidate when it is shown */
+    case EVENT_OBJECT_SHOW:
+        window_event.type = cam_window_event_type::created;
+        break;
+    case EVENT_OBJECT_HIDE:
+    case EVENT_OBJECT_DESTROY:
+        window_event.type = cam_window_event_type::destroyed;
+        break;
+    case EVENT_OBJECT_NAMECHANGE:
+        window_event.type = cam_window_event_type::renamed;
+        break;
+    default:
+        return;
+    }
+
+    service_instance->window_list_.apply(window_event);
+}
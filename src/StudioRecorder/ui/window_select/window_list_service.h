@@ -0,0 +1,65 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "window_list_source.h"
+#include "window_select_data.h"
+#include <screen_capture/cam_lazy_cache.h>
+#include <screen_capture/cam_window_list.h>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*!
+ * Keeps the list of capturable windows current in the background, so the window picker opens
+ * without enumerating all windows. The list is populated once, after that it follows the window
+ * create, destroy and rename events. The icons of the processes are loaded on a worker thread
+ * and cached per process path.
+ *
+ * \note the window events are received through a message loop, so create this on the ui thread.
+ *       Only a single instance can exist.
+ */
+class window_list_service
+{
+public:
+    window_list_service();
+    ~window_list_service();
+
+    window_list_service(const window_list_service &) = delete;
+    window_list_service &operator=(const window_list_service &) = delete;
+
+    auto get_windows() const -> std::vector<window_data>;
+
+    // the icon of the process, or nothing while it is being loaded.
+    auto get_icon(const std::wstring &process_filepath) -> std::optional<HICON>;
+
+    // the window (and its children) that is redrawn when an icon is loaded, nullptr for none.
+    void set_icon_listener(HWND hwnd) noexcept;
+
+private:
+    static void CALLBACK _on_window_event(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG id_object,
+        LONG id_child, DWORD event_thread, DWORD event_time);
+
+    win32_window_source source_;
+    cam_window_list window_list_;
+    std::atomic<HWND> icon_listener_{nullptr};
+    cam_lazy_cache<std::wstring, HICON> icon_cache_;
+    HWINEVENTHOOK show_hide_hook_{nullptr};
+    HWINEVENTHOOK name_change_hook_{nullptr};
+};
@@ -0,0 +1,108 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+#include "window_list_source.h"
+#include "utility/window_util.h"
+#include "utility/windows_api.h"
+
+/* weirdness that seems to work... okey ish for win 7 - 10 (I hope) */
+static bool is_window_candidate(HWND hwnd)
+{
+    HWND hwnd_candidate = nullptr;
+    HWND hwnd_walk_prev = nullptr;
+    bool result = false;
+
+    CRect rect;
+    const auto style = static_cast<unsigned int>(::GetWindowLongPtr(hwnd, GWL_STYLE));
+    if ((::GetWindowRect(hwnd, &rect) < 1 || !utility::rect_empty(rect))
+        && (style & WS_VISIBLE) ==  WS_VISIBLE
+        /*&& (style & WS_MINIMIZE) != WS_MINIMIZE*/)
+    {
+        HWND hwnd_walk = hwnd;
+        do
+        {
+            hwnd_walk_prev = hwnd_walk;
+            hwnd_walk = ::GetWindow(hwnd_walk, GW_OWNER);
+            CRect rect2;
+            if (!hwnd_candidate && hwnd_walk && ::GetWindowRect(hwnd_walk, &rect2) >= 1 && !utility::rect_empty(rect2))
+                hwnd_candidate = hwnd_walk;
+
+        } while(hwnd_walk);
+
+        const auto exstyle_prev = static_cast<unsigned int>(::GetWindowLongPtr(hwnd_walk_prev, GWL_EXSTYLE));
+        const auto exstyle_hwnd = static_cast<unsigned int>(::GetWindowLongPtr(hwnd, GWL_EXSTYLE));
+
+        unsigned int exstyle;
+        if (hwnd_walk_prev != hwnd)
+            exstyle = exstyle_hwnd;
+        else
+            exstyle = exstyle_prev;
+
+        if (hwnd_walk_prev == hwnd || !hwnd_candidate || (exstyle & WS_EX_APPWINDOW) == WS_EX_APPWINDOW)
+        {
+            result =
+                  !(exstyle_prev & WS_EX_TOOLWINDOW)
+                || (exstyle & WS_EX_APPWINDOW)
+                || (!(exstyle & WS_EX_TOOLWINDOW) && (exstyle & WS_EX_CONTROLPARENT));
+        }
+    }
+    return result;
+}
+
+win32_window_source::win32_window_source()
+    : current_process_id_(::GetCurrentProcessId())
+{
+}
+
+auto win32_window_source::enumerate() -> std::vector<cam_window_info>
+{
+    std::vector<cam_window_info> windows;
+    winapi::window::enum_windows(
+        [this, &windows](HWND hwnd)
+        {
+            if (auto window = _get_window_info(hwnd); window)
+                windows.emplace_back(std::move(*window));
+        }
+    );
+    return windows;
+}
+
+auto win32_window_source::query(const cam_window_id id) -> std::optional<cam_window_info>
+{
+    const auto hwnd = reinterpret_cast<HWND>(id);
+
+    /* events are also send for child windows, we only list top level windows */
+    if (!::IsWindow(hwnd) || ::GetAncestor(hwnd, GA_ROOT) != hwnd)
+        return std::nullopt;
+
+    return _get_window_info(hwnd);
+}
+
+auto win32_window_source::_get_window_info(HWND hwnd) const -> std::optional<cam_window_info>
+{
+    const auto process_id = winapi::window::get_thread_process_id(hwnd);
+    if (process_id == current_process_id_ || !is_window_candidate(hwnd))
+        return std::nullopt;
+
+    auto [process_name, process_filepath] = utility::get_process_name(process_id);
+    if (process_name.empty())
+        return std::nullopt;
+
+    return cam_window_info{reinterpret_cast<cam_window_id>(hwnd), process_id, std::move(process_name),
+        std::move(process_filepath), winapi::window::get_title(hwnd)};
+}
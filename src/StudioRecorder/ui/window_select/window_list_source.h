@@ -0,0 +1,36 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <screen_capture/cam_window_list.h>
+#include <windef.h>
+
+// the top level windows of other processes that can be captured.
+class win32_window_source : public cam_window_source
+{
+public:
+    win32_window_source();
+
+    auto enumerate() -> std::vector<cam_window_info> override;
+    auto query(const cam_window_id id) -> std::optional<cam_window_info> override;
+
+private:
+    auto _get_window_info(HWND hwnd) const -> std::optional<cam_window_info>;
+
+    DWORD current_process_id_{0};
+};
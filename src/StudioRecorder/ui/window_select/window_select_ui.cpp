@@ -17,11 +17,8 @@
 
 #include "stdafx.h"
 #include "window_select_ui.h"
-#include "utility/window_util.h"
-#include "utility/fmt_helper.h"
-#include "utility/windows_api.h"
+#include "window_list_service.h"
 
-#include <psapi.h>
 #include <vector>
 #include <string>
 
@@ -38,93 +35,24 @@ IMPLEMENT_DYNAMIC(window_select_ui, CDialogEx)
 constexpr auto button_width = 250;
 constexpr auto button_height = 250;
 
-/* weirdness that seems to work... okey ish for win 7 - 10 (I hope) */
-bool is_window_candidate(HWND hwnd)
-{
-    HWND hwnd_candidate = nullptr;
-    HWND hwnd_walk_prev = nullptr;
-    bool result = false;
-
-    CRect rect;
-    const auto style = static_cast<unsigned int>(::GetWindowLongPtr(hwnd, GWL_STYLE));
-    if ((::GetWindowRect(hwnd, &rect) < 1 || !utility::rect_empty(rect))
-        && (style & WS_VISIBLE) ==  WS_VISIBLE
-        /*&& (style & WS_MINIMIZE) != WS_MINIMIZE*/)
-    {
-        HWND hwnd_walk = hwnd;
-        do
-        {
-            hwnd_walk_prev = hwnd_walk;
-            hwnd_walk = ::GetWindow(hwnd_walk, GW_OWNER);
-            CRect rect2;
-            if (!hwnd_candidate && hwnd_walk && ::GetWindowRect(hwnd_walk, &rect2) >= 1 && !utility::rect_empty(rect2))
-                hwnd_candidate = hwnd_walk;
-
-        } while(hwnd_walk);
-
-        const auto exstyle_prev = static_cast<unsigned int>(::GetWindowLongPtr(hwnd_walk_prev, GWL_EXSTYLE));
-        const auto exstyle_hwnd = static_cast<unsigned int>(::GetWindowLongPtr(hwnd, GWL_EXSTYLE));
-
-        unsigned int exstyle;
-        if (hwnd_walk_prev != hwnd)
-            exstyle = exstyle_hwnd;
-        else
-            exstyle = exstyle_prev;
-
-        if (hwnd_walk_prev == hwnd || !hwnd_candidate || (exstyle & WS_EX_APPWINDOW) == WS_EX_APPWINDOW)
-        {
-            result =
-                  !(exstyle_prev & WS_EX_TOOLWINDOW)
-                || (exstyle & WS_EX_APPWINDOW)
-                || (!(exstyle & WS_EX_TOOLWINDOW) && (exstyle & WS_EX_CONTROLPARENT));
-        }
-    }
-    return result;
-}
-
-std::vector<window_data> window_select_ui::get_windows() const
-{
-    get_windows_info result;
-
-    result.ignore_camstudio_wnd = utility::get_root_parent(GetSafeHwnd());
-    result.ignore_shell_tray_wnd = ::FindWindow(L"Shell_TrayWnd", 0);
-    result.ignore_progman_wnd = ::FindWindow(L"Progman", 0); // DWM Thumbnail desktop
-    result.ignore_current_process_id = ::GetCurrentProcessId();
-
-    winapi::window::enum_windows(
-        [&result](HWND hwnd)
-        {
-            const auto process_id = winapi::window::get_thread_process_id(hwnd);
-            if (process_id != result.ignore_current_process_id && is_window_candidate(hwnd))
-            {
-                const auto[process_name, process_filepath] = utility::get_process_name(process_id);
-
-                if (process_name.empty())
-                    return;
-
-                const auto window_title = winapi::window::get_title(hwnd);
-
-                window_data data = { process_id, process_name, process_filepath, window_title, hwnd };
-                result.windows.emplace_back(data);
-            }
-        }
-    );
-    return result.windows;
-}
-
-window_select_ui::window_select_ui(CWnd* pParent, const std::function<void(const HWND window_handle)> &completed)
+window_select_ui::window_select_ui(CWnd* pParent, window_list_service &window_list,
+        const std::function<void(const HWND window_handle)> &completed)
     : CDialogEx(IDD_WINDOW_SELECT, pParent)
+    , window_list_(window_list)
     , completed_(completed)
 {
 }
 
 window_select_ui::~window_select_ui()
 {
+    window_list_.set_icon_listener(nullptr);
 }
 
 BOOL window_select_ui::OnInitDialog()
 {
-    const auto windows = get_windows();
+    /* the window list is kept up to date in the background, so this is only a copy */
+    const auto windows = window_list_.get_windows();
+    window_list_.set_icon_listener(GetSafeHwnd());
 
     CRect button_rect(0, 0, button_width, button_height);
 
@@ -146,7 +74,7 @@ BOOL window_select_ui::OnInitDialog()
     int i = 0;
     for (const auto &window : windows)
     {
-        auto btn = std::make_unique<window_button>(this, window);
+        auto btn = std::make_unique<window_button>(this, window, window_list_);
 
         const auto x = i % button_horizontal_count;
         const auto y = i / button_horizontal_count;
@@ -24,16 +24,7 @@
 #include <functional>
 #include <vector>
 
-struct get_windows_info
-{
-    std::vector<window_data> windows;
-
-    // hwnd's to ignore
-    HWND ignore_camstudio_wnd{nullptr};
-    HWND ignore_shell_tray_wnd{nullptr};
-    HWND ignore_progman_wnd{nullptr};
-    DWORD ignore_current_process_id{0};
-};
+class window_list_service;
 
 using message_handler_type = LRESULT WINAPI (HWND hWnd, UINT wMessage, WPARAM wParam, LPARAM lParam);
 
@@ -42,19 +33,19 @@ class window_select_ui : public CDialogEx
     DECLARE_DYNAMIC(window_select_ui)
 
 public:
-    window_select_ui(CWnd* pParent, const std::function<void(const HWND window_handle)> &completed);
+    window_select_ui(CWnd* pParent, window_list_service &window_list,
+        const std::function<void(const HWND window_handle)> &completed);
     virtual ~window_select_ui();
     window_select_ui(const window_select_ui &) = delete;
     window_select_ui &operator = (const window_select_ui &) = delete;
 
-    std::vector<window_data> get_windows() const;
-
     BOOL OnInitDialog() override;
     BOOL OnCmdMsg(UINT nID, int nCode, void *pExtra, AFX_CMDHANDLERINFO *pHandlerInfo) override;
 
     message_handler_type *old_message_handler_{nullptr};
     void *old_user_data_{nullptr};
 
+    window_list_service &window_list_;
     std::vector<std::unique_ptr<window_button>> capture_windows_;
     std::function<void(const HWND window_handle)> completed_;
 
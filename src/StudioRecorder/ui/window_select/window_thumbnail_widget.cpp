@@ -17,6 +17,7 @@
 
 #include "stdafx.h"
 #include "window_thumbnail_widget.h"
+#include "window_list_service.h"
 #include "utility/window_util.h"
 #include <shellapi.h>
 #include <CommonControls.h>
@@ -37,25 +38,11 @@ HICON get_shell_icon(const std::wstring &filepath)
     return nullptr;
 }
 
-HICON get_icon(HWND hwnd, const std::wstring &filepath)
-{
-    HICON result = 0;
-    const auto ret = ::SendMessageTimeout(hwnd, WM_GETICON, ICON_BIG, 0, SMTO_ABORTIFHUNG, 2000,
-        reinterpret_cast<DWORD_PTR*>(&result));
-    if (ret != 0 && result == nullptr)
-        result = reinterpret_cast<HICON>(::GetClassLongPtr(hwnd, GCLP_HICON));
-
-    if (result == nullptr)
-        result = get_shell_icon(filepath);
-
-    return result;
-}
-
-window_button::window_button(CWnd *parent, const window_data &data)
+window_button::window_button(CWnd *parent, const window_data &data, window_list_service &window_list)
     : CButton()
     , parent_(parent)
     , data_(data)
-    , window_icon_(get_icon(data.hwnd, data.process_filepath))
+    , window_list_(window_list)
 {
 }
 
@@ -91,11 +78,17 @@ void window_button::DrawItem(LPDRAWITEMSTRUCT lpDrawItemStruct)
     auto text_rect = rt;
     text_rect.DeflateRect(3, 3);
 
-    if (!window_icon_.empty())
+    if (!window_icon_)
+    {
+        if (const auto icon = window_list_.get_icon(data_.process_filepath); icon)
+            window_icon_.emplace(*icon);
+    }
+
+    if (window_icon_ && !window_icon_->empty())
     {
-        text_rect.bottom = text_rect.top + window_icon_.height;
-        dc.DrawIcon(text_rect.TopLeft(), window_icon_.window_icon_);
-        text_rect.left = window_icon_.width + 5;
+        text_rect.bottom = text_rect.top + window_icon_->height;
+        dc.DrawIcon(text_rect.TopLeft(), window_icon_->window_icon_);
+        text_rect.left = window_icon_->width + 5;
     }
 
     std::wstring &button_text = data_.window_title;
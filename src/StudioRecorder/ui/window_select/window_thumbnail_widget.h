@@ -18,6 +18,12 @@
 #pragma once
 
 #include "window_select_data.h"
+#include <optional>
+
+class window_list_service;
+
+// the large shell icon of a file, a.e. the icon of an executable.
+HICON get_shell_icon(const std::wstring &filepath);
 
 class window_icon
 {
@@ -74,7 +80,7 @@ public:
 class window_button : public CButton
 {
 public:
-    window_button(CWnd *parent, const window_data &data);
+    window_button(CWnd *parent, const window_data &data, window_list_service &window_list);
     window_button(const window_button &) = delete;
     window_button &operator = (const window_button &) = delete;
     window_button (window_button &&) = delete;
@@ -87,5 +93,7 @@ public:
 private:
     CWnd *parent_{nullptr};
     window_data data_;
-    window_icon window_icon_;
+    window_list_service &window_list_;
+    // loaded lazily, the icon is requested on the first draw.
+    std::optional<window_icon> window_icon_;
 };
@@ -51,9 +51,20 @@ void video_settings_model::save()
     codec->insert("quality_bitrate", video_codec_quality_bitrate_);
     codec->insert("quality_constant", video_codec_quality_constant_);
     codec->insert("quality_type", static_cast<int>(video_codec_quality_type_));
+    codec->insert("compression", video_codec_compression_.get_index());
+    codec->insert("compression_level", video_codec_compression_level_);
+    codec->insert("compression_long_range", video_codec_compression_long_range_);
+    codec->insert("adaptive_quality", video_codec_adaptive_quality_);
 
     videosettings->insert("video-codec", codec);
 
+    /* video output */
+    auto output = cpptoml::make_table();
+    output->insert("width", video_output_width_);
+    output->insert("height", video_output_height_);
+    output->insert("scale_filter", video_scale_filter_.get_index());
+    videosettings->insert("video-output", output);
+
     /* video container */
     videosettings->insert("video-container", video_container_.get_index());
 
@@ -94,6 +105,21 @@ void video_settings_model::load()
     video_codec_quality_constant_ = *codec->get_as<int>("quality_constant");
     video_codec_quality_type_ = static_cast<video_quality_type>(*codec->get_as<int>("quality_type"));
 
+    /* compression and adaptive quality, not available in older config files */
+    video_codec_compression_.set_index(
+        codec->get_as<int>("compression").value_or(video_codec_compression::type::lzo));
+    video_codec_compression_level_ = codec->get_as<int>("compression_level").value_or(0);
+    video_codec_compression_long_range_ = codec->get_as<bool>("compression_long_range").value_or(false);
+    video_codec_adaptive_quality_ = codec->get_as<bool>("adaptive_quality").value_or(false);
+
+    /* video output, not available in older config files */
+    if (const auto output = videosettings->get_table("video-output"); output)
+    {
+        video_output_width_ = output->get_as<int>("width").value_or(0);
+        video_output_height_ = output->get_as<int>("height").value_or(0);
+        video_scale_filter_.set_index(output->get_as<int>("scale_filter").value_or(video_scale_filter::type::bicubic));
+    }
+
     /* video container */
     video_container_.set_index(*videosettings->get_as<int>("video-container"));
 }
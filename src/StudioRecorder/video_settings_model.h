@@ -34,6 +34,16 @@ public:
     int video_codec_quality_bitrate_{4000};
     int video_codec_quality_constant_{25};
     video_quality_type video_codec_quality_type_{video_quality_type::constant_quality};
+    // camstudio codec compression, a level of 0 means the default level of the algorithm.
+    video_codec_compression video_codec_compression_{video_codec_compression::type::lzo};
+    int video_codec_compression_level_{0};
+    bool video_codec_compression_long_range_{false};
+    // lower the preset and then the frame rate when the encoder falls behind.
+    bool video_codec_adaptive_quality_{false};
+    // the size of the recorded video, 0 means the size of the captured area.
+    int video_output_width_{0};
+    int video_output_height_{0};
+    video_scale_filter video_scale_filter_{video_scale_filter::type::bicubic};
 
     /* For now we will fall back to a simple save and load strategy.
      * The current implementation has a couple of problems. No input validation. No format version
@@ -0,0 +1,159 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rerender_job.h"
+#include <screen_capture/annotations/cam_annotation_cursor.h>
+#include <fmt/format.h>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static void print_usage()
+{
+    fmt::print(
+        "usage: CamStudioRerender [options] <input> <output>\n"
+        "\n"
+        "Draws the cursor click effects from the recorded input events (<input>.caminput) onto a\n"
+        "recording and re-encodes it.\n"
+        "\n"
+        "options:\n"
+        "  --input-events <file>  the recorded input events, default <input>.caminput\n"
+        "  --threads <count>      the amount of render threads, default a thread per core\n"
+        "  --ring-size <pixels>   the size of the click rings, default 40\n"
+        "  --halo-size <pixels>   draw a halo around the mouse position, default off\n"
+        "  --preset <preset>      the x264 preset, default medium\n");
+}
+
+static auto get_muxer_type(std::string_view filename) -> av_muxer_type
+{
+    const auto ends_with = [filename](std::string_view extension) {
+        return filename.size() >= extension.size()
+            && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    if (ends_with(".mp4"))
+        return av_muxer_type::mp4;
+    if (ends_with(".avi"))
+        return av_muxer_type::avi;
+    return av_muxer_type::mkv;
+}
+
+static auto get_preset(std::string_view name) -> video::preset
+{
+    for (size_t i = 0; i < video::preset_names.size(); ++i)
+        if (name == video::preset_names[i])
+            return static_cast<video::preset>(i);
+
+    throw std::invalid_argument(fmt::format("unknown preset: '{}'", name));
+}
+
+static auto create_annotation_factory(int ring_size, int halo_size)
+{
+    return [ring_size, halo_size]() -> std::unique_ptr<cam_iannotation> {
+        const auto ring = cam::size<int>(ring_size, ring_size);
+        const auto halo = cam::size<int>(halo_size, halo_size);
+
+        /* the cursor shape is not recorded, the recording contains the cursor already. */
+        return std::make_unique<cam_annotation_cursor>(false, ring_size > 0,
+            mouse_action_config{ring_size > 0, ring, cam::colors::red},
+            mouse_action_config{ring_size > 0, ring, cam::colors::blue},
+            mouse_action_config{ring_size > 0, ring, cam::colors::green},
+            cam_halo_type::circle,
+            mouse_action_config{halo_size > 0, halo, cam::color(0x80, 0xff, 0xff, 0x00)},
+            mouse_action_config{},
+            mouse_action_config{},
+            mouse_action_config{});
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    rerender_settings settings;
+    settings.video_meta.codec = video::codec::x264;
+    settings.video_meta.quality = 23;
+    settings.video_meta.preset = video::preset::medium;
+
+    int ring_size = 40;
+    int halo_size = 0;
+
+    try
+    {
+        std::vector<std::string_view> positional;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            const auto next_arg = [&]() -> std::string_view {
+                if (i + 1 >= argc)
+                    throw std::invalid_argument(fmt::format("missing value for {}", arg));
+                return argv[++i];
+            };
+
+            if (arg == "--input-events")
+                settings.input_stream_filename = next_arg();
+            else if (arg == "--threads")
+                settings.thread_count = std::stoi(std::string(next_arg()));
+            else if (arg == "--ring-size")
+                ring_size = std::stoi(std::string(next_arg()));
+            else if (arg == "--halo-size")
+                halo_size = std::stoi(std::string(next_arg()));
+            else if (arg == "--preset")
+                settings.video_meta.preset = get_preset(next_arg());
+            else if (arg == "--help" || arg == "-h")
+            {
+                print_usage();
+                return 0;
+            }
+            else
+                positional.push_back(arg);
+        }
+
+        if (positional.size() != 2)
+        {
+            print_usage();
+            return 1;
+        }
+
+        settings.input_filename = positional[0];
+        settings.output_filename = positional[1];
+        settings.muxer_type = get_muxer_type(settings.output_filename);
+        settings.create_annotation = create_annotation_factory(ring_size, halo_size);
+
+        rerender_job job(settings);
+        const auto start_time = std::chrono::steady_clock::now();
+        auto result = std::async(std::launch::async, [&job]() { job.run(); });
+        while (result.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+        {
+            fmt::print("\rrendered {} / {} frames", job.get_rendered_frame_count(), job.get_total_frame_count());
+            std::fflush(stdout);
+        }
+        result.get();
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+        fmt::print("\rrendered {} frames in {:.1f} seconds\n", job.get_rendered_frame_count(), elapsed.count());
+    }
+    catch (const std::exception &e)
+    {
+        fmt::print(stderr, "\nerror: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rerender_job.h"
+#include <CamEncoder/av_concat.h>
+#include <CamEncoder/av_video_reader.h>
+#include <screen_capture/cam_canvas.h>
+#include <screen_capture/cam_input_replay.h>
+#include <screen_capture/cam_input_stream.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// more chunks than threads, so a thread that finishes early can pick up more work.
+constexpr int chunks_per_thread = 4;
+
+// the input events replayed before a chunk, so click animations continue over chunk boundaries.
+constexpr double pre_roll_time = 1.0;
+
+rerender_job::rerender_job(rerender_settings settings)
+    : settings_(std::move(settings))
+{
+    if (!settings_.create_annotation)
+        throw std::invalid_argument("rerender_job: no annotation");
+
+    if (settings_.input_stream_filename.empty())
+        settings_.input_stream_filename = settings_.input_filename + cam::input_stream_extension;
+}
+
+void rerender_job::run()
+{
+    input_stream_ = cam::load_input_stream(settings_.input_stream_filename);
+
+    av_video_index index;
+    {
+        av_video_reader reader(settings_.input_filename);
+        width_ = reader.get_width();
+        height_ = reader.get_height();
+        fps_ = reader.get_frame_rate();
+        index = reader.read_index();
+    }
+
+    if (index.keyframe_times.empty())
+        throw std::runtime_error(fmt::format("rerender_job: '{}' has no video frames", settings_.input_filename));
+
+    total_frame_count_ = (index.end_time - index.keyframe_times.front()) * fps_.num / (fps_.den * 1000LL);
+
+    const auto thread_count = settings_.thread_count > 0
+        ? settings_.thread_count
+        : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+
+    const auto chunks = av_plan_chunks(index.keyframe_times, index.end_time, thread_count * chunks_per_thread);
+
+    std::vector<std::string> chunk_filenames;
+    chunk_filenames.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i)
+        chunk_filenames.push_back(fmt::format("{}.chunk{}.mkv", settings_.output_filename, i));
+
+    std::atomic<size_t> next_chunk{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    const auto worker = [&]() {
+        for (auto i = next_chunk++; i < chunks.size() && !cancel_; i = next_chunk++)
+        {
+            try
+            {
+                _render_chunk(chunks[i], chunk_filenames[i]);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                cancel_ = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const auto worker_count = std::min(static_cast<size_t>(thread_count), chunks.size());
+    for (size_t i = 0; i < worker_count; ++i)
+        threads.emplace_back(worker);
+
+    for (auto &thread : threads)
+        thread.join();
+
+    if (!error)
+    {
+        try
+        {
+            av_concat_files(chunk_filenames, settings_.output_filename, settings_.muxer_type);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+    }
+
+    for (const auto &chunk_filename : chunk_filenames)
+        std::remove(chunk_filename.c_str());
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+auto rerender_job::get_rendered_frame_count() const noexcept -> int64_t
+{
+    return rendered_frame_count_;
+}
+
+auto rerender_job::get_total_frame_count() const noexcept -> int64_t
+{
+    return total_frame_count_;
+}
+
+void rerender_job::_render_chunk(const av_chunk &chunk, const std::string &chunk_filename)
+{
+    av_video_reader reader(settings_.input_filename);
+    reader.seek(chunk.start);
+
+    /* the chunk encoders run in parallel already, a single encoder thread each avoids
+     * oversubscribing the cores. */
+    auto meta = settings_.video_meta;
+    meta.width = width_;
+    meta.height = height_;
+    meta.fps = fps_;
+    meta.bpp = 32;
+    meta.thread_count = 1;
+
+    av_video_codec video_codec_config;
+    video_codec_config.pixel_format = AV_PIX_FMT_BGRA;
+
+    /* the intermediate chunks are always mkv, they are remuxed into the requested container. */
+    av_muxer muxer(chunk_filename, av_muxer_type::mkv, av_metadata{"CamStudio"});
+    muxer.add_stream(std::make_unique<av_video>(video_codec_config, meta));
+    muxer.open();
+
+    const auto annotation = settings_.create_annotation();
+    const cam::rect<int> canvas_rect(0, 0, width_, height_);
+
+    /* replay the input events just before the chunk on a scratch canvas, so the annotation has the
+     * same state as when the chunk would have been rendered as part of the whole recording. */
+    cam_input_replay replay(input_stream_);
+    const auto frame_duration = static_cast<double>(fps_.den) / fps_.num;
+    const auto chunk_start = chunk.start / 1000.0;
+    const auto pre_roll_start = std::max(chunk_start - pre_roll_time, 0.0);
+    replay.seek(pre_roll_start);
+    if (pre_roll_start < chunk_start)
+    {
+        std::vector<uint8_t> scratch(static_cast<size_t>(width_) * height_ * 4);
+        cam_canvas scratch_canvas(scratch.data(), width_, height_, width_ * 4);
+        for (auto time = pre_roll_start + frame_duration; time < chunk_start; time += frame_duration)
+        {
+            replay.advance(time);
+            annotation->draw(scratch_canvas, replay.get_draw_data(canvas_rect));
+        }
+    }
+
+    av_decoded_frame frame;
+    while (!cancel_ && reader.read_frame(frame))
+    {
+        if (frame.time < chunk.start)
+            continue;
+
+        if (frame.time >= chunk.end)
+            break;
+
+        replay.advance(frame.time / 1000.0);
+
+        cam_canvas canvas(frame.data.data(), frame.width, frame.height, frame.stride);
+        annotation->draw(canvas, replay.get_draw_data(canvas_rect));
+
+        muxer.encode_frame(static_cast<timestamp_t>(frame.time), frame.data.data(), frame.width, frame.height,
+            frame.stride);
+        ++rendered_frame_count_;
+    }
+
+    // report the errors of the last frames, the muxer destructor can not.
+    muxer.flush();
+}
@@ -0,0 +1,77 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <CamEncoder/av_chunk_plan.h>
+#include <CamEncoder/av_muxer.h>
+#include <screen_capture/cam_annotarion.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct rerender_settings
+{
+    std::string input_filename;
+    // the recorded input events, when empty <input_filename>.caminput is used.
+    std::string input_stream_filename;
+    std::string output_filename;
+    av_muxer_type muxer_type{av_muxer_type::mkv};
+    // the encoder settings, the size and frame rate are taken from the input.
+    av_video_meta video_meta;
+    // creates the annotation that is drawn on every frame, every thread gets its own instance.
+    std::function<std::unique_ptr<cam_iannotation>()> create_annotation;
+    // the amount of threads to render with, 0 uses a thread per core.
+    int thread_count{0};
+};
+
+/*!
+ * Offline re-render of a recording: decode, draw the annotations from the recorded input events
+ * and re-encode.
+ *
+ * The recording is split into GOP aligned chunks, which are rendered and encoded on separate
+ * threads into intermediate files. The chunk files are joined into the output file afterwards,
+ * without re-encoding.
+ */
+class rerender_job
+{
+public:
+    explicit rerender_job(rerender_settings settings);
+
+    // render the recording, blocks until done. Throws on errors.
+    void run();
+
+    // progress, these can be read from another thread while running.
+    auto get_rendered_frame_count() const noexcept -> int64_t;
+    auto get_total_frame_count() const noexcept -> int64_t;
+
+private:
+    void _render_chunk(const av_chunk &chunk, const std::string &chunk_filename);
+
+    rerender_settings settings_;
+    std::vector<uint8_t> input_stream_;
+    int width_{0};
+    int height_{0};
+    frame_rate fps_{0, 0};
+
+    std::atomic<bool> cancel_{false};
+    std::atomic<int64_t> rendered_frame_count_{0};
+    std::atomic<int64_t> total_frame_count_{0};
+};
@@ -0,0 +1,76 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+#include <screen_capture/annotations/cam_annotation_cursor.h>
+#include <screen_capture/cam_canvas.h>
+#include <screen_capture/cam_draw_data.h>
+#include <screen_capture/cam_rect.h>
+#include <vector>
+
+constexpr auto canvas_width = 1920;
+constexpr auto canvas_height = 1080;
+
+static cam_annotation_cursor create_cursor_annotation()
+{
+    const mouse_action_config ring_config{true, {100, 100}, cam::color(0xff, 0xff, 0, 0)};
+    const mouse_action_config halo_config{true, {100, 100}, cam::color(0x80, 0xff, 0xff, 0)};
+    const mouse_action_config disabled_config{};
+
+    /* the cursor itself is read from the system, so it is left out of the measurement. */
+    return cam_annotation_cursor(false, true, ring_config, ring_config, ring_config, cam_halo_type::circle,
+        halo_config, disabled_config, disabled_config, disabled_config);
+}
+
+/*!
+ * The per frame cost of the cursor annotation (halo and click rings) with an increasing number of
+ * rings on screen.
+ */
+static void benchmark_annotation_rings(benchmark::State &state)
+{
+    const auto ring_count = static_cast<int>(state.range(0));
+
+    std::vector<uint32_t> pixels(static_cast<size_t>(canvas_width) * canvas_height, 0xff202020);
+    cam_canvas canvas(reinterpret_cast<uint8_t *>(pixels.data()), canvas_width, canvas_height, canvas_width * 4);
+    const cam::rect<int> canvas_rect(0, 0, canvas_width, canvas_height);
+
+    auto annotation = create_cursor_annotation();
+
+    /* every click (down and up within the same frame) starts a new ring. */
+    const auto click = static_cast<cam_mouse_button::type>(cam_mouse_button::left_button_down
+        | cam_mouse_button::left_button_up);
+    for (int i = 0; i < ring_count; ++i)
+    {
+        const point<int> mouse_pos(100 + (i % 10) * 150, 200 + (i / 10) * 300);
+        annotation.draw(canvas, cam_draw_data(0.0, canvas_rect, mouse_pos, click));
+    }
+
+    /* grow the rings halfway, with a zero frame delta afterwards they keep their size. */
+    const point<int> mouse_pos(canvas_width / 2, canvas_height / 2);
+    annotation.draw(canvas, cam_draw_data(0.25, canvas_rect, mouse_pos, cam_mouse_button::none));
+
+    for (auto _ : state)
+    {
+        annotation.draw(canvas, cam_draw_data(0.0, canvas_rect, mouse_pos, cam_mouse_button::none));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_annotation_rings)->Arg(0)->Arg(1)->Arg(20);
+
+BENCHMARK_MAIN();
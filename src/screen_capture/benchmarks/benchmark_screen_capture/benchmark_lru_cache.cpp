@@ -0,0 +1,131 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+#include <screen_capture/cam_lru_cache.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/*!
+ * The previous window cache design, a fixed vector scanned with find_if on lookup and with
+ * min_element on insert. Kept here as the baseline for the hashed cache.
+ */
+class linear_lru_cache
+{
+public:
+    explicit linear_lru_cache(std::size_t capacity)
+        : entries_(capacity)
+    {
+    }
+
+    auto find(std::uintptr_t key) -> int *
+    {
+        const auto itr = std::find_if(entries_.begin(), entries_.end(),
+            [key](const auto &entry) { return entry.used && entry.key == key; });
+        if (itr == entries_.end())
+            return nullptr;
+
+        itr->atime = ++time_;
+        return &itr->value;
+    }
+
+    auto insert(std::uintptr_t key, int value) -> int &
+    {
+        const auto itr = std::min_element(entries_.begin(), entries_.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.atime < rhs.atime; });
+        *itr = {key, value, ++time_, true};
+        return itr->value;
+    }
+
+private:
+    struct entry
+    {
+        std::uintptr_t key{0};
+        int value{0};
+        unsigned atime{0};
+        bool used{false};
+    };
+
+    std::vector<entry> entries_;
+    unsigned time_{0};
+};
+
+/* hundreds of windows, mostly queried again and again while hovering the window list. */
+static auto create_queries(int window_count) -> std::vector<std::uintptr_t>
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, window_count - 1);
+
+    std::vector<std::uintptr_t> queries(4096);
+    for (auto &query : queries)
+        query = 0x10000 + static_cast<std::uintptr_t>(distribution(generator)) * 0x1a;
+    return queries;
+}
+
+/*!
+ * Argument layout:
+ *   0: cache capacity
+ *   1: amount of distinct windows queried
+ */
+static void cache_args(benchmark::internal::Benchmark *b)
+{
+    b->ArgNames({"capacity", "windows"});
+    for (const auto capacity : {32, 256})
+        for (const auto windows : {16, 200, 1000})
+            b->Args({capacity, windows});
+}
+
+template <typename Cache>
+static void run_cache_benchmark(benchmark::State &state, Cache &cache)
+{
+    const auto queries = create_queries(static_cast<int>(state.range(1)));
+
+    int64_t misses = 0;
+    for (auto _ : state)
+    {
+        for (const auto query : queries)
+        {
+            auto *value = cache.find(query);
+            if (value == nullptr)
+            {
+                value = &cache.insert(query, static_cast<int>(query));
+                ++misses;
+            }
+            benchmark::DoNotOptimize(value);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * queries.size());
+    state.counters["miss_ratio"] = static_cast<double>(misses) / (state.iterations() * queries.size());
+}
+
+static void benchmark_lru_cache_hashed(benchmark::State &state)
+{
+    cam_lru_cache<std::uintptr_t, int> cache(static_cast<std::size_t>(state.range(0)));
+    run_cache_benchmark(state, cache);
+}
+
+static void benchmark_lru_cache_linear(benchmark::State &state)
+{
+    linear_lru_cache cache(static_cast<std::size_t>(state.range(0)));
+    run_cache_benchmark(state, cache);
+}
+
+BENCHMARK(benchmark_lru_cache_hashed)->Apply(cache_args);
+BENCHMARK(benchmark_lru_cache_linear)->Apply(cache_args);
@@ -23,6 +23,11 @@
 #include "screen_capture/cam_point.h"
 #include "screen_capture/cam_size.h"
 #include "screen_capture/cam_rect.h"
+#include "screen_capture/cam_sprite.h"
+#include "screen_capture/cam_cursor.h"
+#include "screen_capture/cam_frame.h"
+#include "screen_capture/cam_click_rings.h"
+#include <cstdint>
 #include <vector>
 
 enum class cam_halo_type
@@ -40,25 +45,19 @@ struct mouse_action_config
     cam::color color{};
 };
 
-class cam_mouse_ring_state
+// the parameters a halo sprite is rendered with.
+struct cam_halo_sprite_key
 {
-public:
-    constexpr cam_mouse_ring_state(const point<int> &ring_center, const cam_mouse_button::type ring_type) noexcept
-        : ring_center_(ring_center)
-        , ring_type_(ring_type)
-    {
-    }
-
-    point<int> ring_center_;
-    double lifetime_{ 0.0 };
-    cam_mouse_button::type ring_type_;
+    cam_halo_type type{cam_halo_type::circle};
+    cam::size<int> size{ 0, 0 };
+    uint32_t color{ 0 };
 };
 
-constexpr bool operator == (const cam_mouse_ring_state &lhs, const cam_mouse_ring_state &rhs)
+constexpr bool operator == (const cam_halo_sprite_key &lhs, const cam_halo_sprite_key &rhs)
 {
-    return lhs.lifetime_ == rhs.lifetime_
-        && lhs.ring_center_ == rhs.ring_center_
-        && lhs.ring_type_ == rhs.ring_type_;
+    return lhs.type == rhs.type
+        && lhs.size == rhs.size
+        && lhs.color == rhs.color;
 }
 
 class cam_annotation_cursor : public cam_iannotation
@@ -75,18 +74,18 @@ public:
         const mouse_action_config &halo_config,
         const mouse_action_config &halo_left_click_config,
         const mouse_action_config &halo_right_click_config,
-        const mouse_action_config &halo_middle_click_config) noexcept;
+        const mouse_action_config &halo_middle_click_config);
 
     ~cam_annotation_cursor() override;
 
-    void draw(Gdiplus::Graphics &canvas, const cam_draw_data &draw_data) override;
+    void draw(cam_canvas &canvas, const cam_draw_data &draw_data) override;
 
     void set_cursor_enabled(const bool enabled) noexcept;
     void set_cursor_ring_enabled(const bool enabled);
 
-    void set_ring_left_click_config(const mouse_action_config &config) noexcept;
-    void set_ring_right_click_config(const mouse_action_config &config) noexcept;
-    void set_ring_middle_click_config(const mouse_action_config &config) noexcept;
+    void set_ring_left_click_config(const mouse_action_config &config);
+    void set_ring_right_click_config(const mouse_action_config &config);
+    void set_ring_middle_click_config(const mouse_action_config &config);
 
     void set_halo_type(const cam_halo_type halo_type) noexcept;
     void set_halo_config(const mouse_action_config &config) noexcept;
@@ -98,12 +97,10 @@ public:
 protected:
     void _handle_ring_button_state_changed(const point<int> &position, const unsigned int mouse_button_state, const cam_mouse_button::type mouse_button_type);
 
-    void _draw_cursor(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect, const point<int> &mouse_pos);
-    void _draw_halo(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect, const point<int> &mouse_pos, const mouse_action_config &halo_config);
-    void _draw_rings(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect, const double frame_delta);
-    auto _draw_ring(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect, cam_mouse_ring_state &ring, const double frame_delta) -> bool;
-
-    auto _get_ring_config(const cam_mouse_button::type mouse_button_type) -> mouse_action_config &;
+    void _draw_cursor(cam_canvas &canvas, const cam::rect<int> &canvas_rect, const point<int> &mouse_pos,
+                      const cam_cursor_state &cursor, const double frame_delta);
+    auto _get_cursor_image(const uintptr_t cursor_handle, const double frame_delta) -> const cam_cursor_image *;
+    void _draw_halo(cam_canvas &canvas, const cam::rect<int> &canvas_rect, const point<int> &mouse_pos, const mouse_action_config &halo_config, cam_cached_sprite<cam_halo_sprite_key> &halo_sprite);
 private:
     // 'cached' config fields
     bool cursor_enabled_{false};
@@ -117,13 +114,23 @@ private:
 
     // Ring config fields
     bool ring_enabled_{false};
-    int ring_speed_{5};
-    double ring_width_{1.5};
-    mouse_action_config ring_left_click_config_{};
-    mouse_action_config ring_right_click_config_{};
-    mouse_action_config ring_middle_click_config_{};
-
-    std::vector<cam_mouse_ring_state> queued_rings_;
+    cam_click_rings rings_;
+
+    // converted cursor shapes, and the cursor that was drawn last.
+    cam_cursor_cache cursor_cache_;
+    uintptr_t cursor_handle_{0};
+    uint64_t cursor_shape_hash_{0};
+    double cursor_revalidate_time_{0.0};
+
+    // scratch buffers for reading the cursor bitmaps.
+    std::vector<uint8_t> cursor_mask_bits_;
+    std::vector<uint32_t> cursor_color_bits_;
+
+    // the halo sprites are rendered once, and only re-rendered when the halo config changes.
+    cam_cached_sprite<cam_halo_sprite_key> halo_sprite_;
+    cam_cached_sprite<cam_halo_sprite_key> halo_left_click_sprite_;
+    cam_cached_sprite<cam_halo_sprite_key> halo_right_click_sprite_;
+    cam_cached_sprite<cam_halo_sprite_key> halo_middle_click_sprite_;
 
     // draw 'runtime' settings.
     unsigned int mouse_button_state_{0};
@@ -17,22 +17,16 @@
 
 #pragma once
 
-#include "screen_capture/cam_annotarion.h"
+#include "screen_capture/annotations/cam_annotation_text.h"
 #include "screen_capture/cam_point.h"
 #include "screen_capture/cam_color.h"
-#include <memory>
 
-
-class cam_annotation_systemtime : public cam_iannotation
+/*!
+ * Draws the current date and time, rendered with a GDI+ Arial font.
+ */
+class cam_annotation_systemtime : public cam_annotation_text
 {
 public:
-    cam_annotation_systemtime() noexcept = default;
-    cam_annotation_systemtime(point<int> systemtime_position, cam::color systemtime_color) noexcept;
+    cam_annotation_systemtime(point<int> systemtime_position, cam::color systemtime_color);
     ~cam_annotation_systemtime() override;
-
-    void draw(Gdiplus::Graphics &canvas, const cam_draw_data &draw_data) override;
-private:
-    point<int> systemtime_position_;
-    cam::color systemtime_color_;
-    std::unique_ptr<struct font_ptr> font_pimpl_;
 };
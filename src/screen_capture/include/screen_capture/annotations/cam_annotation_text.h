@@ -0,0 +1,75 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "screen_capture/cam_annotarion.h"
+#include "screen_capture/cam_color.h"
+#include "screen_capture/cam_font.h"
+#include "screen_capture/cam_point.h"
+#include "screen_capture/cam_text_overlay.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum class cam_text_overlay_type
+{
+    system_time,
+    recording_time,
+    frame_number,
+    watermark
+};
+
+/*!
+ * Draws a line of text at a fixed position, the text is rendered with a glyph cached text overlay.
+ */
+class cam_annotation_text : public cam_iannotation
+{
+public:
+    cam_annotation_text(const cam_text_overlay_type type, const point<int> &position, const cam::color &color,
+                        std::unique_ptr<cam_font> font, std::wstring watermark = {});
+    ~cam_annotation_text() override;
+
+    void draw(cam_canvas &canvas, const cam_draw_data &draw_data) override;
+
+    auto get_overlay() const noexcept -> const cam_text_overlay &;
+
+private:
+    void _format_text();
+
+    cam_text_overlay_type type_;
+    point<int> position_;
+    std::wstring watermark_;
+    std::unique_ptr<cam_font> font_;
+    cam_text_overlay overlay_;
+
+    // the time and number of frames since the first frame that was drawn.
+    double recording_time_{0.0};
+    int64_t frame_number_{0};
+    bool first_frame_{true};
+
+    // scratch buffer for formatting the text.
+    std::wstring text_;
+};
+
+namespace cam
+{
+
+// append a duration in seconds to the text, formatted as hh:mm:ss.mmm
+void format_recording_time(std::wstring &text, const double seconds);
+
+} // namespace cam
@@ -17,14 +17,16 @@
 
 #pragma once
 
-#include "cam_gdiplus_fwd.h"
-#include <cstdint>
-
 class cam_draw_data;
+class cam_canvas;
 
 class cam_iannotation
 {
 public:
     virtual ~cam_iannotation() = default;
-    virtual void draw(Gdiplus::Graphics &canvas, const cam_draw_data &draw_data) = 0;
+    /*!
+     * Draw the annotation into the canvas. The canvas is backend neutral, annotations render
+     * themselves into (cached) sprites and blend those into the canvas.
+     */
+    virtual void draw(cam_canvas &canvas, const cam_draw_data &draw_data) = 0;
 };
\ No newline at end of file
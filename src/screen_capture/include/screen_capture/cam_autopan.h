@@ -0,0 +1,77 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_point.h"
+#include "cam_rect.h"
+#include "cam_scale.h"
+#include "cam_size.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct cam_autopan_config
+{
+    // the size of the region around the cursor that is recorded, in frame pixels.
+    cam::size<int> viewport_size{0, 0};
+    // the size of the output frames, the viewport is scaled to this size.
+    cam::size<int> output_size{0, 0};
+    // the maximum pan speed in pixels per second.
+    double max_speed{1200.0};
+    /* the cursor moves freely in the center of the viewport, the viewport only pans when the
+     * cursor comes within margin * viewport size of its edge. */
+    double margin{0.2};
+    cam::scale_filter filter{cam::scale_filter::bilinear};
+};
+
+/*!
+ * Zoom and pan virtual camera, a stage between capture and encode.
+ *
+ * A viewport follows the cursor over the captured frame, and is scaled to the output size. The
+ * viewport eases towards the cursor with a limited speed, so the recording pans smoothly instead
+ * of jumping with every mouse move. Only the pixels of the viewport are read from the frame.
+ */
+class cam_autopan
+{
+public:
+    cam_autopan(const cam::size<int> &frame_size, const cam_autopan_config &config);
+
+    // move the viewport towards the cursor (frame coordinates), the first update centers on the cursor.
+    void update(const point<int> &cursor, const double frame_delta) noexcept;
+
+    // crop the viewport from the frame, and scale it into the output frame.
+    void render(const uint8_t *frame_data, const int frame_stride);
+
+    auto get_viewport() const noexcept -> cam::rect<int>;
+
+    auto get_output_data() const noexcept -> const uint8_t *;
+    auto get_output_size() const noexcept -> const cam::size<int> &;
+    auto get_output_stride() const noexcept -> int;
+
+private:
+    auto _clamp_center(const double x, const double y) const noexcept -> point<double>;
+    auto _get_target(const point<int> &cursor) const noexcept -> point<double>;
+
+    cam::size<int> frame_size_;
+    cam::size<int> viewport_size_;
+    cam_autopan_config config_;
+
+    std::optional<point<double>> center_;
+    cam_scaler scaler_;
+    std::vector<uint8_t> output_;
+};
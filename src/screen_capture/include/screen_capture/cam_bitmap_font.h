@@ -0,0 +1,43 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_font.h"
+
+/*!
+ * A fixed width 5x7 pixel font for printable ascii, embedded in the binary. It does not depend on
+ * any platform font api, so it also works headless. Glyphs outside printable ascii are drawn as '?'.
+ */
+class cam_bitmap_font : public cam_font
+{
+public:
+    static constexpr int glyph_width = 5;
+    static constexpr int glyph_height = 7;
+
+    // every glyph pixel is drawn as a scale x scale block.
+    explicit cam_bitmap_font(const int scale = 2);
+
+    auto get_line_height() const noexcept -> int override;
+    auto render_glyph(const wchar_t glyph, const cam::color &color) const -> cam_sprite override;
+
+    // the advance of every glyph in pixels.
+    auto get_glyph_advance() const noexcept -> int;
+
+private:
+    int scale_{1};
+};
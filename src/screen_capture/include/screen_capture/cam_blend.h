@@ -0,0 +1,55 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace cam
+{
+
+/*!
+ * Alpha blend kernels for premultiplied BGRA pixels.
+ *
+ * All kernels compute dst = src + dst * (255 - src.a) / 255 per channel, with the same integer
+ * rounding, so the scalar and simd kernels produce bit identical results.
+ */
+enum class blend_kernel
+{
+    scalar,
+    sse2,
+    avx2
+};
+
+using blend_row_function = void (*)(uint32_t *dst, const uint32_t *src, int count);
+
+void blend_row_scalar(uint32_t *dst, const uint32_t *src, int count) noexcept;
+void blend_row_sse2(uint32_t *dst, const uint32_t *src, int count) noexcept;
+void blend_row_avx2(uint32_t *dst, const uint32_t *src, int count) noexcept;
+
+// returns true when the kernel is supported by the current cpu.
+bool is_blend_kernel_supported(const blend_kernel kernel) noexcept;
+
+// the fastest kernel supported by the current cpu.
+auto get_best_blend_kernel() noexcept -> blend_kernel;
+
+auto get_blend_row_function(const blend_kernel kernel) noexcept -> blend_row_function;
+
+// blend a row of premultiplied pixels with the fastest kernel supported by the current cpu.
+void blend_row(uint32_t *dst, const uint32_t *src, int count) noexcept;
+
+} // namespace cam
@@ -0,0 +1,65 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_rect.h"
+#include "cam_point.h"
+#include <cstdint>
+
+class cam_sprite;
+struct cam_sprite_view;
+
+/*!
+ * Backend neutral draw target for annotations. The canvas wraps a BGRA frame (for example the
+ * captured frame) and blends premultiplied sprites into it. Only the pixels covered by a sprite
+ * are touched, the union of these is tracked as the dirty rect.
+ */
+class cam_canvas
+{
+public:
+    cam_canvas(uint8_t *data, const int width, const int height, const int stride) noexcept;
+
+    /*!
+     * Blend a sprite into the canvas, the sprite is clipped against the canvas.
+     * \param position the position of the top left corner of the sprite in canvas coordinates.
+     */
+    void draw_sprite(const cam_sprite_view &sprite, const point<int> &position) noexcept;
+    void draw_sprite(const cam_sprite &sprite, const point<int> &position) noexcept;
+
+    // draw a sprite with its center at the given position.
+    void draw_sprite_centered(const cam_sprite_view &sprite, const point<int> &center) noexcept;
+    void draw_sprite_centered(const cam_sprite &sprite, const point<int> &center) noexcept;
+
+    int width() const noexcept;
+    int height() const noexcept;
+    int stride() const noexcept;
+
+    auto data() noexcept -> uint8_t *;
+    auto row(const int y) noexcept -> uint32_t *;
+
+    // the area that has been drawn to, empty when nothing has been drawn.
+    auto get_dirty_rect() const noexcept -> const cam::rect<int> &;
+    void reset_dirty_rect() noexcept;
+
+private:
+    uint8_t *data_;
+    int width_;
+    int height_;
+    int stride_;
+    cam::rect<int> dirty_rect_;
+};
@@ -19,10 +19,15 @@
 
 #include "cam_rect.h"
 #include "cam_annotarion.h"
+#include "cam_capture_plan.h"
+#include "cam_frame.h"
+#include "cam_input_event.h"
 #include "cam_virtual_screen_info.h"
+#include "cam_window_tracker.h"
 
 #include <windows.h>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace cam
@@ -30,19 +35,19 @@ namespace cam
     class stop_watch;
 } // namespace cam
 
-struct cam_frame
-{
-    BITMAPINFO *bitmap_info{nullptr};
-    unsigned char *bitmap_data{nullptr};
-    int width{0};
-    int height{0};
-    int stride{0};
-};
+class cam_input_stream_writer;
+class cam_dxgi_capture;
 
 class cam_capture_source
 {
 public:
     cam_capture_source() = delete;
+
+    /*!
+     * \param hwnd the window to capture, or nullptr to capture the desktop.
+     * \param view the region of the desktop that will be captured, the frame is allocated at this
+     *             size. An empty view allocates a frame for the entire virtual screen.
+     */
     cam_capture_source(HWND hwnd, const cam::rect<int> &view);
     ~cam_capture_source();
 
@@ -53,15 +58,67 @@ public:
     bool capture_frame(const cam::rect<int> &capture_rect);
     const cam_frame *get_frame();
 
+    // the pixel formats this source delivers without a conversion, in order of preference.
+    auto get_native_pixel_formats() const -> std::vector<cam_pixel_format>;
+
     void enable_annotations();
 
+    /*!
+     * Follow the window while it moves and resizes. The frames keep the initial window size, the
+     * window content is scaled to fit. Only valid when capturing a window.
+     */
+    void enable_window_tracking(const cam_fit_mode fit_mode);
+
+    /*!
+     * Capture the desktop with desktop duplication instead of gdi, which also reports the frame
+     * damage. Only valid when capturing the desktop.
+     * \return false when desktop duplication is not available, gdi is used instead.
+     */
+    bool enable_desktop_duplication();
+
     void add_annotation(std::unique_ptr<cam_iannotation> annotation);
 
+    /*!
+     * Record the mouse input into an input stream, so cursor effects can be rendered later. This
+     * starts a new stream, the record times are relative to this call.
+     */
+    void enable_input_recording();
+    auto get_input_stream() const noexcept -> const cam_input_stream_writer *;
+
+    // the mouse position of the last captured frame, relative to the captured rect.
+    auto get_mouse_position() const noexcept -> point<int>;
+
 protected:
+    void _read_input(const cam::rect<int> &capture_rect);
     void _draw_annotations(const cam::rect<int> &capture_rect);
     auto _translate_from_virtual(const POINT &mouse_position) -> point<int>;
+    auto _get_input_time(const DWORD tick) const noexcept -> int64_t;
+    static auto _to_frame_position(const point<int> &position, const cam::rect<int> &capture_rect) noexcept
+        -> point<int>;
+
+    bool _capture_frame(const cam::rect<int> &capture_rect);
+    void _read_cursor_state();
+    void _update_cursor_position();
+    bool _capture_tracked_window();
+    void _create_frame_bitmap(const cam::size<int> &size);
+    void _release_frame_bitmap() noexcept;
+    void _update_capture_plan(const cam::rect<int> &capture_rect);
+    auto _copy_capture_plan() -> bool;
+    void _release_copy_targets() noexcept;
+    bool _update_desktop_duplication(const cam::rect<int> &capture_rect);
+    bool _capture_desktop_duplication(const cam::rect<int> &capture_rect);
 
 private:
+    /* a view on the rows of the frame a single plan copy writes to, with its own device contexts
+     * so the copies can run in parallel. */
+    struct copy_target
+    {
+        HDC screen_dc{nullptr};
+        HDC memory_dc{nullptr};
+        HBITMAP bitmap{nullptr};
+        HGDIOBJ old_bitmap{nullptr};
+    };
+
     BITMAPINFO bitmap_info_;
     HBITMAP bitmap_frame_;
     HWND hwnd_;
@@ -71,15 +128,37 @@ private:
     cam::virtual_screen_info virtual_screen_info_;
 
     unsigned char *bitmap_data_{nullptr};
+    HANDLE frame_section_{nullptr};
     cam_frame frame_;
+
+    std::vector<cam::rect<int>> monitors_;
+    std::optional<cam_capture_plan> capture_plan_;
+    std::vector<copy_target> copy_targets_;
+    std::unique_ptr<cam_window_tracker> window_tracker_;
+    std::unique_ptr<cam_dxgi_capture> dxgi_capture_;
+    bool desktop_duplication_{false};
+
     cam::rect<int> captured_rect_;
 
     HGDIOBJ old_selected_bitmap_{nullptr};
 
     bool enable_annotations_{false};
     std::vector<std::unique_ptr<cam_iannotation>> annotations_;
+    cam_annotation_damage annotation_damage_;
     std::unique_ptr<cam::stop_watch> stopwatch_;
 
     // hack...
     std::vector<MSLLHOOKSTRUCT> mouse_events_;
+
+    // the input of the current frame.
+    double frame_delta_{0.0};
+    point<int> mouse_point_{};
+    // the cursor hotspot of the current frame, in virtual screen coordinates.
+    point<int> cursor_point_{};
+    unsigned int mouse_status_{0};
+    std::vector<cam_input_event> input_events_;
+
+    std::unique_ptr<cam_input_stream_writer> input_stream_;
+    DWORD input_start_tick_{0};
+    std::optional<point<int>> last_recorded_mouse_position_;
 };
@@ -0,0 +1,58 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_rect.h"
+#include <vector>
+
+// a single copy of a capture plan, from one monitor into the frame.
+struct cam_capture_copy
+{
+    // index of the source monitor in the monitor list the plan was created from.
+    int monitor_index{0};
+    // the part of the monitor to copy, in screen coordinates.
+    cam::rect<int> src;
+    // the top left position of the copy in the frame.
+    point<int> dst;
+};
+
+/*!
+ * Describes how a capture rect is assembled from the monitors it spans. The frame is exactly the
+ * size of the capture rect, every monitor that intersects it contributes one copy.
+ */
+struct cam_capture_plan
+{
+    cam::rect<int> capture_rect;
+    std::vector<cam_capture_copy> copies;
+    // false when parts of the capture rect are not on any monitor, these parts must be cleared.
+    bool fully_covered{false};
+
+    auto get_frame_size() const noexcept -> cam::size<int>
+    {
+        return capture_rect.size();
+    }
+};
+
+/*!
+ * Map a capture rect onto a monitor layout.
+ * \param capture_rect the rect to capture, in screen coordinates.
+ * \param monitors the monitor rects, in screen coordinates.
+ * \throw std::invalid_argument when the capture rect is empty.
+ */
+auto cam_create_capture_plan(const cam::rect<int> &capture_rect, const std::vector<cam::rect<int>> &monitors)
+    -> cam_capture_plan;
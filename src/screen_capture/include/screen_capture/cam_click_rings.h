@@ -0,0 +1,114 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_color.h"
+#include "cam_input_event.h"
+#include "cam_mouse_button.h"
+#include "cam_point.h"
+#include "cam_ring_animation.h"
+#include "cam_ring_buffer.h"
+#include "cam_span.h"
+#include <cstddef>
+
+class cam_canvas;
+
+class cam_mouse_ring_state
+{
+public:
+    constexpr cam_mouse_ring_state() noexcept = default;
+    constexpr cam_mouse_ring_state(const point<int> &ring_center, const cam_mouse_button::type ring_type) noexcept
+        : ring_center_(ring_center)
+        , ring_type_(ring_type)
+    {
+    }
+
+    point<int> ring_center_{};
+    double lifetime_{ 0.0 };
+    cam_mouse_button::type ring_type_{cam_mouse_button::left_button_down};
+    bool alive_{ true };
+};
+
+constexpr bool operator == (const cam_mouse_ring_state &lhs, const cam_mouse_ring_state &rhs)
+{
+    return lhs.lifetime_ == rhs.lifetime_
+        && lhs.ring_center_ == rhs.ring_center_
+        && lhs.ring_type_ == rhs.ring_type_
+        && lhs.alive_ == rhs.alive_;
+}
+
+/*!
+ * The rings that grow from the mouse position on a click, one ring per button down event.
+ *
+ * Rings are animated from the time of the click, so a click halfway a frame starts with a ring that
+ * is already half a frame old.
+ */
+class cam_click_rings
+{
+public:
+    // the maximum number of rings that are animated at the same time, the oldest ring is dropped first.
+    static constexpr std::size_t max_rings = 32;
+
+    // set the size a ring grows to, and its color for a mouse button (a button down flag).
+    void set_style(const cam_mouse_button::type button, const int max_size, const cam::color &color);
+
+    /*!
+     * Start a ring.
+     * \param time the time of the click in seconds, relative to the previous frame.
+     */
+    void add(const point<int> &center, const cam_mouse_button::type button, const double time = 0.0) noexcept;
+
+    // start a ring for every button down event.
+    void add(cam::span<const cam_input_event> input_events) noexcept;
+
+    /*!
+     * Advance the rings by a frame and draw them.
+     * \param origin the position of the canvas in ring (mouse) coordinates.
+     */
+    void draw(cam_canvas &canvas, const point<int> &origin, const double frame_delta);
+
+    auto size() const noexcept -> std::size_t;
+    bool empty() const noexcept;
+    void clear() noexcept;
+
+    // the ring size (diameter in pixels) of a ring, as it was drawn last.
+    auto get_ring_size(const std::size_t index) const noexcept -> int;
+
+    // the ring, index 0 is the oldest ring.
+    auto get_ring(const std::size_t index) const noexcept -> const cam_mouse_ring_state &;
+
+private:
+    struct ring_style
+    {
+        int max_size{0};
+        cam::color color{};
+        cam_ring_animation animation;
+    };
+
+    auto _get_style(const cam_mouse_button::type button) noexcept -> ring_style &;
+    auto _draw_ring(cam_canvas &canvas, const point<int> &origin, cam_mouse_ring_state &ring,
+                    const double frame_delta) -> bool;
+
+    int ring_speed_{5};
+    double ring_width_{1.5};
+
+    cam_ring_buffer<cam_mouse_ring_state, max_rings> rings_;
+    ring_style left_style_;
+    ring_style right_style_;
+    ring_style middle_style_;
+};
@@ -0,0 +1,115 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_sprite.h"
+#include "cam_point.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// a cursor shape converted to a premultiplied sprite.
+struct cam_cursor_image
+{
+    cam_sprite sprite;
+    point<int> hotspot;
+};
+
+namespace cam
+{
+
+// 64 bit fnv-1a hash, used to detect cursor shape changes.
+auto hash_bytes(const void *data, const size_t size, const uint64_t seed = 0xcbf29ce484222325ull) noexcept
+    -> uint64_t;
+
+/*!
+ * Convert a monochrome cursor into a sprite. The masks are 1 bit per pixel, most significant bit
+ * first, with mask_stride bytes per row.
+ *
+ * and | xor | result
+ *  0  |  0  | black
+ *  0  |  1  | white
+ *  1  |  0  | transparent
+ *  1  |  1  | inverted screen, which we can not express with alpha blending, drawn as black.
+ */
+auto create_monochrome_cursor_sprite(const int width, const int height, const uint8_t *and_mask,
+    const uint8_t *xor_mask, const int mask_stride) -> cam_sprite;
+
+/*!
+ * Convert a 32 bit BGRA color cursor into a sprite. When any pixel has alpha, the color is
+ * treated as straight alpha. Otherwise the and mask (may be nullptr) decides the transparency.
+ */
+auto create_color_cursor_sprite(const int width, const int height, const uint32_t *pixels,
+    const uint8_t *and_mask, const int mask_stride) -> cam_sprite;
+
+} // namespace cam
+
+/*!
+ * Cache of converted cursor shapes, looked up by the cursor handle and a hash of the cursor shape.
+ * Handles are reused by the os and animated cursors change shape behind the same handle, so the
+ * handle alone is not enough. When the cache is full, the least recently used shape is evicted.
+ */
+class cam_cursor_cache
+{
+public:
+    using handle_type = uintptr_t;
+    static constexpr size_t default_capacity = 32;
+
+    explicit cam_cursor_cache(const size_t capacity = default_capacity);
+
+    auto find(const handle_type handle, const uint64_t shape_hash) noexcept -> const cam_cursor_image *;
+
+    // returns the cached cursor image, or converts (create) and caches it.
+    template <typename create_function>
+    auto get(const handle_type handle, const uint64_t shape_hash, create_function &&create)
+        -> const cam_cursor_image &
+    {
+        if (const auto *image = find(handle, shape_hash); image != nullptr)
+            return *image;
+
+        ++miss_count_;
+        return _insert(handle, shape_hash, create());
+    }
+
+    void clear() noexcept;
+
+    auto size() const noexcept -> size_t;
+    auto capacity() const noexcept -> size_t;
+
+    auto get_hit_count() const noexcept -> uint64_t;
+    auto get_miss_count() const noexcept -> uint64_t;
+
+private:
+    struct entry
+    {
+        handle_type handle;
+        uint64_t shape_hash;
+        uint64_t last_used;
+        cam_cursor_image image;
+    };
+
+    auto _insert(const handle_type handle, const uint64_t shape_hash, cam_cursor_image &&image)
+        -> const cam_cursor_image &;
+
+    // the amount of distinct cursors is small, so a linear search is fine.
+    std::vector<entry> entries_;
+    size_t capacity_;
+    uint64_t use_counter_{0};
+    uint64_t hit_count_{0};
+    uint64_t miss_count_{0};
+};
@@ -17,28 +17,36 @@
 
 #pragma once
 
+#include "screen_capture/cam_frame.h"
 #include "screen_capture/cam_mouse_button.h"
-
-template<typename T>
-class rect;
-
-template<typename T>
-class point;
+#include "screen_capture/cam_input_event.h"
+#include "screen_capture/cam_point.h"
+#include "screen_capture/cam_rect.h"
+#include "screen_capture/cam_span.h"
 
 class cam_draw_data
 {
 public:
     constexpr cam_draw_data(const double frame_delta, const cam::rect<int> &canvas_rect,
-                            const point<int> &mouse_pos, const cam_mouse_button::type mouse_button_state) noexcept
+                            const point<int> &mouse_pos, const cam_mouse_button::type mouse_button_state,
+                            const cam::span<const cam_input_event> input_events = {},
+                            const cam_cursor_state &cursor = {}) noexcept
         : frame_delta_(frame_delta)
         , canvas_rect_(canvas_rect)
         , mouse_pos_(mouse_pos)
         , mouse_button_state_(mouse_button_state)
+        , input_events_(input_events)
+        , cursor_(cursor)
     {
     }
 
     double frame_delta_;
     const cam::rect<int> &canvas_rect_;
     const point<int> &mouse_pos_;
+    // all mouse buttons that went down or up since the previous frame.
     cam_mouse_button::type mouse_button_state_;
+    // the mouse events since the previous frame in the order they happened, with their time.
+    cam::span<const cam_input_event> input_events_;
+    // the cursor of the captured frame, only its visibility and shape are used for drawing.
+    cam_cursor_state cursor_;
 };
@@ -0,0 +1,103 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_capture_plan.h"
+#include "cam_frame_damage.h"
+#include "cam_rect.h"
+
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi1_2.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * Desktop Duplication capture backend.
+ *
+ * Duplicates every output (monitor) the capture rect spans, and reports the dirty and move rects
+ * the OS gives us as frame damage. A clean copy of the capture rect is kept up to date by only
+ * reading the changed rects back from the gpu, which is much cheaper than a full BitBlt at high
+ * resolutions.
+ *
+ * \note the cursor is not part of the duplicated image, like a BitBlt it is drawn as annotation.
+ */
+class cam_dxgi_capture
+{
+public:
+    /*!
+     * \param capture_rect the rect to capture, in screen coordinates.
+     * \throw std::runtime_error when the rect can not be captured with desktop duplication, a.e.
+     *        because it spans an output of another adapter or a rotated output.
+     */
+    explicit cam_dxgi_capture(const cam::rect<int> &capture_rect);
+    ~cam_dxgi_capture();
+
+    cam_dxgi_capture(const cam_dxgi_capture &) = delete;
+    cam_dxgi_capture &operator=(const cam_dxgi_capture &) = delete;
+
+    /*!
+     * Bring data up to date with the current image of the capture rect, and report what changed
+     * since the previous capture in frame coordinates. Does not wait for a new desktop frame.
+     *
+     * Only the changed rects are copied, so data must still hold the previous capture. The first
+     * capture into a buffer copies the complete image.
+     * \param restore_rect a rect of data that was drawn over since the previous capture (a.e. by
+     *        the annotations), it is restored from the clean image.
+     * \return false when duplication failed, the caller should fall back to another backend.
+     */
+    bool capture_frame(uint8_t *data, const int stride, const cam::rect<int> &restore_rect,
+        cam_frame_damage &damage);
+
+    auto get_capture_rect() const noexcept -> const cam::rect<int> &;
+
+private:
+    struct output_duplication
+    {
+        Microsoft::WRL::ComPtr<IDXGIOutput1> output;
+        Microsoft::WRL::ComPtr<IDXGIOutputDuplication> duplication;
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+        // the output in screen coordinates.
+        cam::rect<int> desktop_rect;
+        // the part of the capture rect on this output.
+        cam_capture_copy copy;
+        // the first frame, and the first frame after access was lost, are copied completely.
+        bool needs_full_copy{true};
+    };
+
+    void _duplicate_output(output_duplication &output);
+    bool _update_output(output_duplication &output, bool &full_copy);
+    bool _read_metadata(output_duplication &output, const DXGI_OUTDUPL_FRAME_INFO &frame_info);
+    void _copy_rect(const D3D11_MAPPED_SUBRESOURCE &mapped, const output_duplication &output,
+        const cam::rect<int> &rect);
+
+    cam::rect<int> capture_rect_;
+    Microsoft::WRL::ComPtr<ID3D11Device> device_;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> context_;
+    std::vector<output_duplication> outputs_;
+
+    // the clean image of the capture rect.
+    std::vector<uint8_t> image_;
+    // the damage of the current capture in screen coordinates.
+    cam_frame_damage desktop_damage_;
+
+    std::vector<uint8_t> metadata_buffer_;
+    // the buffer of the previous capture, only the changes are copied into it.
+    const uint8_t *previous_data_{nullptr};
+};
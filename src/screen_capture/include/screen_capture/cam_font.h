@@ -0,0 +1,37 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_color.h"
+#include "cam_sprite.h"
+
+/*!
+ * A source of glyph images for the text overlay. Glyphs are rendered one at a time and cached by the
+ * text overlay, so rendering a glyph is allowed to be slow.
+ */
+class cam_font
+{
+public:
+    virtual ~cam_font() = default;
+
+    // the height of a line of text in pixels, all glyph sprites have this height.
+    virtual auto get_line_height() const noexcept -> int = 0;
+
+    // render a single glyph, the width of the sprite is the advance of the glyph.
+    virtual auto render_glyph(const wchar_t glyph, const cam::color &color) const -> cam_sprite = 0;
+};
@@ -0,0 +1,83 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_frame_damage.h"
+#include "cam_point.h"
+#include <chrono>
+#include <cstdint>
+
+// the byte order of a pixel in memory.
+enum class cam_pixel_format
+{
+    // 32 bit, the 4th byte is undefined (a.e. a gdi dib section).
+    bgr0,
+    // 32 bit with alpha.
+    bgra,
+    // 24 bit.
+    bgr24
+};
+
+struct cam_cursor_state
+{
+    bool visible{false};
+    // the cursor hotspot in frame coordinates.
+    point<int> position{};
+    // frames with the same shape id have the same cursor image, 0 when unknown.
+    uint64_t shape_id{0};
+};
+
+/*!
+ * A captured frame and what is known about it.
+ *
+ * This is a plain descriptor without platform types, so the capture, annotation, encoder and stats
+ * code can all pass it around. The pixels are owned by the capture source and stay valid until the
+ * next capture.
+ */
+struct cam_frame
+{
+    unsigned char *bitmap_data{nullptr};
+    int width{0};
+    int height{0};
+    int stride{0};
+    cam_pixel_format pixel_format{cam_pixel_format::bgr0};
+    // increases by one for every captured frame, the first frame is 1.
+    uint64_t sequence{0};
+    // the time the capture started, in microseconds on the monotonic clock (see cam::get_frame_time).
+    int64_t timestamp{0};
+    // what changed since the previous frame, invalid when the capture backend does not know.
+    cam_frame_damage damage;
+    cam_cursor_state cursor;
+};
+
+namespace cam
+{
+
+constexpr auto get_pixel_size(const cam_pixel_format format) noexcept -> int
+{
+    return format == cam_pixel_format::bgr24 ? 3 : 4;
+}
+
+// the monotonic clock the frame timestamps are taken from, in microseconds.
+inline auto get_frame_time() noexcept -> int64_t
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+} // namespace cam
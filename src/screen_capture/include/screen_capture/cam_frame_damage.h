@@ -0,0 +1,109 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_point.h"
+#include "cam_rect.h"
+#include <cstdint>
+#include <vector>
+
+// a region of the desktop that moved, a.e. a dragged window or a scrolled view.
+struct cam_move_rect
+{
+    // the top left of the region in the previous frame.
+    point<int> src;
+    // the region in the new frame.
+    cam::rect<int> dst;
+};
+
+/*!
+ * What changed since the previous frame, as reported by the capture backend.
+ *
+ * Backends without damage information (a.e. GDI) report invalid damage, consumers must then treat
+ * the whole frame as changed.
+ */
+struct cam_frame_damage
+{
+    // true when the backend reported the damage, false when it is unknown.
+    bool valid{false};
+    std::vector<cam::rect<int>> dirty_rects;
+    std::vector<cam_move_rect> move_rects;
+
+    // true when the frame is known to be identical to the previous frame.
+    auto is_unchanged() const noexcept -> bool
+    {
+        return valid && dirty_rects.empty() && move_rects.empty();
+    }
+
+    void reset(const bool is_valid) noexcept
+    {
+        valid = is_valid;
+        dirty_rects.clear();
+        move_rects.clear();
+    }
+};
+
+class cam_canvas;
+
+/*!
+ * Adds the damage of the annotations to the frame damage.
+ *
+ * The annotations are drawn over the clean desktop image every frame, so the area they covered in
+ * the previous frame changed as well. When they drew exactly the same pixels at the same place
+ * (a.e. a cursor that did not move), nothing changed.
+ */
+class cam_annotation_damage
+{
+public:
+    // call after the annotations are drawn on the canvas.
+    void update(cam_canvas &canvas, cam_frame_damage &damage);
+
+    // forget the previous annotations, a.e. when the frame buffer is reallocated.
+    void reset() noexcept;
+
+    // the area the annotations of the previous frame covered, in frame coordinates.
+    auto get_rect() const noexcept -> const cam::rect<int> &;
+
+private:
+    cam::rect<int> rect_;
+    std::vector<uint32_t> pixels_;
+};
+
+namespace cam
+{
+
+/*!
+ * Clip desktop damage (screen coordinates) to a capture rect, and translate it to frame
+ * coordinates. A move from outside of the capture rect is turned into a dirty rect, as its source
+ * pixels are not in the previous frame.
+ */
+void clip_damage(const cam_frame_damage &desktop_damage, const cam::rect<int> &capture_rect,
+    cam_frame_damage &frame_damage);
+
+// copy a rect between two 32 bit images of the same size, the rect is clipped to the size.
+void copy_rect(const uint8_t *src, const int src_stride, uint8_t *dst, const int dst_stride,
+    const cam::size<int> &size, const cam::rect<int> &rect) noexcept;
+
+/*!
+ * Bring dst up to date with src by only copying the changed rects, both 32 bit images of the same
+ * size. With invalid damage everything is copied.
+ */
+void copy_damaged(const uint8_t *src, const int src_stride, uint8_t *dst, const int dst_stride,
+    const cam::size<int> &size, const cam_frame_damage &damage);
+
+} // namespace cam
@@ -0,0 +1,47 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_frame_damage.h"
+#include <cstdint>
+
+/*!
+ * Decides which frames to encode based on their damage, frames that are identical to the previous
+ * frame are skipped. The encoder uses variable frame rate timestamps, so a skipped frame simply
+ * extends the duration of the previous frame. A frame is still encoded every max_skip_time
+ * seconds, so a recording of a still desktop keeps progressing.
+ */
+class cam_frame_dedup
+{
+public:
+    explicit cam_frame_dedup(const double max_skip_time = 1.0) noexcept;
+
+    // returns true when the frame captured at time (seconds) must be encoded.
+    bool should_encode(const cam_frame_damage &damage, const double time) noexcept;
+
+    // the next frame is always encoded, a.e. after a pause.
+    void reset() noexcept;
+
+    auto get_skipped_count() const noexcept -> int64_t;
+
+private:
+    double max_skip_time_;
+    double last_encoded_time_{0.0};
+    bool has_encoded_{false};
+    int64_t skipped_count_{0};
+};
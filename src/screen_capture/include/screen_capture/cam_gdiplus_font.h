@@ -0,0 +1,40 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_font.h"
+#include "cam_gdiplus_fwd.h"
+#include <memory>
+
+/*!
+ * Renders glyphs with a GDI+ font. Only used to fill the glyph cache of the text overlay, so the
+ * (slow) GDI+ text rendering is done once per glyph instead of every frame.
+ */
+class cam_gdiplus_font : public cam_font
+{
+public:
+    cam_gdiplus_font(const wchar_t *font_family, const float font_size);
+    ~cam_gdiplus_font() override;
+
+    auto get_line_height() const noexcept -> int override;
+    auto render_glyph(const wchar_t glyph, const cam::color &color) const -> cam_sprite override;
+
+private:
+    std::unique_ptr<Gdiplus::Font> font_;
+    int line_height_{0};
+};
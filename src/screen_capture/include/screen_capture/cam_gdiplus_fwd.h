@@ -22,4 +22,5 @@ namespace Gdiplus
 struct GdiplusStartupInput;
 class Graphics;
 class Bitmap;
+class Font;
 } // namespace Gdiplus
@@ -0,0 +1,34 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_mouse_button.h"
+#include "cam_point.h"
+
+/*!
+ * A mouse input event that happened while a frame was captured.
+ */
+struct cam_input_event
+{
+    // the time the event happened in seconds, relative to the previous frame (0 .. frame delta).
+    double time{0.0};
+    // the mouse position in the same space as the mouse position of the draw data.
+    point<int> position{};
+    // a single button down or up flag.
+    cam_mouse_button::type button{cam_mouse_button::none};
+};
@@ -0,0 +1,71 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_draw_data.h"
+#include "cam_input_event.h"
+#include "cam_input_stream.h"
+#include "cam_point.h"
+#include "cam_rect.h"
+#include "cam_span.h"
+#include <vector>
+
+/*!
+ * Plays back a recorded input stream against the frames of a recording, so cursor and click
+ * annotations can be drawn onto decoded frames offline.
+ *
+ * \code
+ * cam_input_replay replay(input_stream);
+ * for (each decoded frame)
+ * {
+ *     replay.advance(frame_time);
+ *     annotation.draw(canvas, replay.get_draw_data(canvas_rect));
+ * }
+ * \endcode
+ */
+class cam_input_replay
+{
+public:
+    explicit cam_input_replay(cam::span<const uint8_t> input_stream);
+
+    // advance to a frame, frame_time is in seconds since the start of the recording.
+    void advance(const double frame_time);
+
+    /*!
+     * skip the records up to frame_time without producing input events, a.e. to start replaying in
+     * the middle of a recording. The stream can only be read forward.
+     */
+    void seek(const double frame_time);
+
+    // the draw data of the frame advanced to, canvas_rect must outlive the draw data.
+    auto get_draw_data(const cam::rect<int> &canvas_rect) const noexcept -> cam_draw_data;
+
+    auto get_mouse_position() const noexcept -> const point<int> &;
+    auto get_input_events() const noexcept -> cam::span<const cam_input_event>;
+
+private:
+    cam_input_stream_reader reader_;
+    cam_input_record next_record_{};
+    bool has_next_record_{false};
+
+    double frame_time_{0.0};
+    double frame_delta_{0.0};
+    point<int> mouse_position_{};
+    unsigned int mouse_button_state_{0};
+    std::vector<cam_input_event> input_events_;
+};
@@ -0,0 +1,110 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_point.h"
+#include "cam_span.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class cam_input_record_type : uint8_t
+{
+    mouse_move,
+    mouse_button_down,
+    mouse_button_up,
+    key_down,
+    key_up
+};
+
+struct cam_input_record
+{
+    // microseconds since the start of the recording.
+    int64_t time{0};
+    cam_input_record_type type{cam_input_record_type::mouse_move};
+    // the mouse position in frame coordinates, only used for mouse records.
+    point<int> position{};
+    // the mouse button (cam_mouse_button down flag) or virtual key code.
+    uint32_t code{0};
+};
+
+constexpr bool operator == (const cam_input_record &lhs, const cam_input_record &rhs)
+{
+    return lhs.time == rhs.time
+        && lhs.type == rhs.type
+        && lhs.position == rhs.position
+        && lhs.code == rhs.code;
+}
+
+/*!
+ * Encodes input records into a compact binary stream, so cursor and click effects can be rendered
+ * later instead of during capture.
+ *
+ * The stream starts with a magic and version, followed by the records. Every record is a type byte,
+ * followed by the time and (for mouse records) the position as a delta to the previous record, and
+ * (for button and key records) the code. All numbers are (zigzag) LEB128 varints, so a typical record
+ * takes 3 to 5 bytes.
+ */
+class cam_input_stream_writer
+{
+public:
+    cam_input_stream_writer();
+
+    void write(const cam_input_record &record);
+
+    auto get_data() const noexcept -> const std::vector<uint8_t> &;
+    auto get_record_count() const noexcept -> int64_t;
+
+private:
+    std::vector<uint8_t> data_;
+    int64_t record_count_{0};
+    int64_t last_time_{0};
+    point<int> last_position_{};
+};
+
+/*!
+ * Reads the records from an input stream.
+ * \throws std::runtime_error when the stream is not an input stream or is corrupt.
+ */
+class cam_input_stream_reader
+{
+public:
+    explicit cam_input_stream_reader(cam::span<const uint8_t> data);
+
+    // read the next record, returns false at the end of the stream.
+    bool read(cam_input_record &record);
+
+private:
+    auto _read_varint() -> uint64_t;
+
+    cam::span<const uint8_t> data_;
+    std::size_t offset_{0};
+    int64_t last_time_{0};
+    point<int> last_position_{};
+};
+
+namespace cam
+{
+
+// the extension of the sidecar file that holds the input stream of a recording.
+constexpr auto input_stream_extension = ".caminput";
+
+void save_input_stream(const std::string &filename, cam::span<const uint8_t> data);
+auto load_input_stream(const std::string &filename) -> std::vector<uint8_t>;
+
+} // namespace cam
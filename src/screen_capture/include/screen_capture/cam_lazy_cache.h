@@ -0,0 +1,147 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+/*!
+ * Cache of values that are expensive to create, a.e. the icon of a process. Values are created
+ * lazily by a loader on a worker thread, so the caller never blocks on a slow load.
+ *
+ * get() returns the value when it is loaded, otherwise it queues the key and returns nothing. When
+ * the value is loaded the loaded callback is called from the worker thread. Every key is loaded
+ * only once, a loader that throws caches a default constructed value.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class cam_lazy_cache
+{
+public:
+    using loader_type = std::function<Value(const Key &key)>;
+    using loaded_callback_type = std::function<void(const Key &key)>;
+
+    explicit cam_lazy_cache(loader_type loader, loaded_callback_type loaded_callback = {})
+        : loader_(std::move(loader))
+        , loaded_callback_(std::move(loaded_callback))
+        , worker_([this]() { _run(); })
+    {
+    }
+
+    ~cam_lazy_cache()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        queue_changed_.notify_all();
+        worker_.join();
+    }
+
+    cam_lazy_cache(const cam_lazy_cache &) = delete;
+    cam_lazy_cache &operator=(const cam_lazy_cache &) = delete;
+
+    // the value of the key, or nothing when it is not loaded yet.
+    auto get(const Key &key) -> std::optional<Value>
+    {
+        std::unique_lock lock(mutex_);
+        if (const auto itr = values_.find(key); itr != values_.end())
+            return itr->second;
+
+        if (pending_.insert(key).second)
+        {
+            queue_.push_back(key);
+            lock.unlock();
+            queue_changed_.notify_one();
+        }
+        return std::nullopt;
+    }
+
+    // wait until all queued keys are loaded.
+    void wait_idle()
+    {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this]() { return pending_.empty(); });
+    }
+
+    auto size() const -> std::size_t
+    {
+        std::lock_guard lock(mutex_);
+        return values_.size();
+    }
+
+private:
+    void _run()
+    {
+        std::unique_lock lock(mutex_);
+        while (true)
+        {
+            queue_changed_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (stop_)
+                return;
+
+            const auto key = queue_.front();
+            queue_.pop_front();
+
+            lock.unlock();
+            Value value{};
+            try
+            {
+                value = loader_(key);
+            }
+            catch (...)
+            {
+                // keep the default value, so we do not try again.
+            }
+            lock.lock();
+
+            values_.emplace(key, std::move(value));
+
+            if (loaded_callback_)
+            {
+                lock.unlock();
+                loaded_callback_(key);
+                lock.lock();
+            }
+
+            /* only idle after the callback, so wait_idle() also waits for the callbacks */
+            pending_.erase(key);
+            if (pending_.empty())
+                idle_.notify_all();
+        }
+    }
+
+    loader_type loader_;
+    loaded_callback_type loaded_callback_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_changed_;
+    std::condition_variable idle_;
+    std::deque<Key> queue_;
+    std::unordered_set<Key, Hash> pending_;
+    std::unordered_map<Key, Value, Hash> values_;
+    bool stop_{false};
+
+    // the worker is started last, after all members it uses are initialized.
+    std::thread worker_;
+};
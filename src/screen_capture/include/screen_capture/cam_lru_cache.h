@@ -0,0 +1,131 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+/*!
+ * Fixed capacity key value cache with least recently used replacement. Lookup, insert and erase
+ * are O(1). When the cache is full, inserting a new key evicts the least recently used entry and
+ * reuses its node, so a full cache does not allocate list nodes anymore.
+ *
+ * \note this container is not thread safe.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class cam_lru_cache
+{
+    using entry = std::pair<Key, Value>;
+    using entry_list = std::list<entry>;
+
+public:
+    explicit cam_lru_cache(const std::size_t capacity)
+        : capacity_(capacity)
+    {
+        if (capacity_ == 0)
+            throw std::invalid_argument("cam_lru_cache: capacity must be at least 1");
+
+        index_.reserve(capacity_);
+    }
+
+    // find a value and mark it as most recently used, returns nullptr when the key is not cached.
+    auto find(const Key &key) -> Value *
+    {
+        const auto itr = index_.find(key);
+        if (itr == index_.end())
+            return nullptr;
+
+        entries_.splice(entries_.begin(), entries_, itr->second);
+        return &itr->second->second;
+    }
+
+    // check if a key is cached, without changing its recently used order.
+    bool contains(const Key &key) const
+    {
+        return index_.find(key) != index_.end();
+    }
+
+    // insert or replace a value, it becomes the most recently used entry.
+    auto insert(const Key &key, Value value) -> Value &
+    {
+        if (auto *existing = find(key); existing != nullptr)
+        {
+            *existing = std::move(value);
+            return *existing;
+        }
+
+        if (entries_.size() == capacity_)
+        {
+            /* recycle the least recently used node for the new entry */
+            auto lru = std::prev(entries_.end());
+            index_.erase(lru->first);
+            lru->first = key;
+            lru->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, lru);
+        }
+        else
+        {
+            entries_.emplace_front(key, std::move(value));
+        }
+
+        index_.emplace(key, entries_.begin());
+        return entries_.front().second;
+    }
+
+    bool erase(const Key &key)
+    {
+        const auto itr = index_.find(key);
+        if (itr == index_.end())
+            return false;
+
+        entries_.erase(itr->second);
+        index_.erase(itr);
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        index_.clear();
+        entries_.clear();
+    }
+
+    auto size() const noexcept -> std::size_t
+    {
+        return entries_.size();
+    }
+
+    auto capacity() const noexcept -> std::size_t
+    {
+        return capacity_;
+    }
+
+    bool empty() const noexcept
+    {
+        return entries_.empty();
+    }
+
+private:
+    std::size_t capacity_;
+    // most recently used entry first.
+    entry_list entries_;
+    std::unordered_map<Key, typename entry_list::iterator, Hash, KeyEqual> index_;
+};
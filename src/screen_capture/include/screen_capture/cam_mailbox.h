@@ -0,0 +1,83 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+/*!
+ * Latest value mailbox between a single producer and a single consumer thread (a triple buffer).
+ *
+ * The producer fills write_slot() and publishes it, the consumer takes the latest published value.
+ * Neither side ever waits on the other: a value that was not taken yet is simply replaced by the
+ * next one, so a slow consumer never holds up the producer and values are never queued.
+ *
+ * \note the slots are reused, a producer must overwrite the complete value it publishes.
+ */
+template <typename T>
+class cam_mailbox
+{
+public:
+    // the slot the producer writes the next value into, only valid on the producer thread.
+    auto write_slot() noexcept -> T &
+    {
+        return slots_[write_index_];
+    }
+
+    /*!
+     * Publish the value in the write slot.
+     * \return false when the previous value was never taken and is dropped.
+     */
+    bool publish() noexcept
+    {
+        const auto previous = shared_.exchange(write_index_ | fresh_bit, std::memory_order_acq_rel);
+        write_index_ = previous & index_mask;
+        return (previous & fresh_bit) == 0;
+    }
+
+    /*!
+     * Take the latest published value, only valid on the consumer thread.
+     * \return nullptr when nothing was published since the last take, otherwise the value, which
+     *         stays valid until the next take.
+     */
+    auto take() noexcept -> const T *
+    {
+        if ((shared_.load(std::memory_order_relaxed) & fresh_bit) == 0)
+            return nullptr;
+
+        const auto previous = shared_.exchange(read_index_, std::memory_order_acq_rel);
+        read_index_ = previous & index_mask;
+        return &slots_[read_index_];
+    }
+
+    // true when a value was published that is not taken yet.
+    bool has_value() const noexcept
+    {
+        return (shared_.load(std::memory_order_acquire) & fresh_bit) != 0;
+    }
+
+private:
+    static constexpr int index_mask = 0x3;
+    static constexpr int fresh_bit = 0x4;
+
+    std::array<T, 3> slots_{};
+    // the index of the slot between producer and consumer, with the fresh bit when it is not taken.
+    std::atomic<int> shared_{1};
+    int write_index_{0};
+    int read_index_{2};
+};
@@ -0,0 +1,109 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_frame.h"
+#include "cam_mailbox.h"
+#include "cam_scale.h"
+#include "cam_size.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct cam_preview_config
+{
+    // the preview is scaled down to fit this size, it is never scaled up.
+    cam::size<int> max_size{320, 180};
+    // only every frame_interval-th offered frame is previewed.
+    int frame_interval{2};
+};
+
+// a downscaled copy of a captured frame, 32 bit bgr0.
+struct cam_preview_image
+{
+    cam::size<int> size;
+    int stride{0};
+    std::vector<uint8_t> data;
+    // the sequence number and timestamp of the captured frame.
+    uint64_t sequence{0};
+    int64_t timestamp{0};
+};
+
+/*!
+ * Live preview tap on the capture pipeline.
+ *
+ * The capture thread offers every frame, every frame_interval-th frame is copied into a mailbox for
+ * the preview worker, which scales it down and publishes it into a second mailbox for the ui. Both
+ * hand overs only keep the latest value, so a slow worker or ui drops preview frames instead of
+ * holding up the capture.
+ */
+class cam_preview_tap
+{
+public:
+    explicit cam_preview_tap(const cam_preview_config &config);
+    ~cam_preview_tap();
+
+    cam_preview_tap(const cam_preview_tap &) = delete;
+    cam_preview_tap &operator=(const cam_preview_tap &) = delete;
+
+    // offer a captured frame, only call this from a single (capture) thread. Never waits.
+    void offer(const cam_frame &frame);
+
+    /*!
+     * Take the latest preview, only call this from a single (ui) thread.
+     * \return nullptr when there is no new preview, otherwise a preview that stays valid until the
+     *         next call.
+     */
+    auto take_preview() noexcept -> const cam_preview_image *;
+
+    auto get_offered_count() const noexcept -> int64_t;
+    // the amount of copied frames that were replaced before the worker scaled them.
+    auto get_dropped_count() const noexcept -> int64_t;
+
+private:
+    struct frame_copy
+    {
+        cam::size<int> size;
+        std::vector<uint8_t> data;
+        uint64_t sequence{0};
+        int64_t timestamp{0};
+    };
+
+    void _run_worker();
+    void _scale_frame(const frame_copy &frame);
+
+    cam_preview_config config_;
+    cam_mailbox<frame_copy> frames_;
+    cam_mailbox<cam_preview_image> previews_;
+
+    std::atomic<int64_t> offered_count_{0};
+    std::atomic<int64_t> dropped_count_{0};
+
+    /* the worker thread, owned by the tap. Only touched by the worker. */
+    std::unique_ptr<cam_scaler> scaler_;
+
+    std::thread worker_;
+    std::mutex worker_mutex_;
+    std::condition_variable frame_offered_;
+    bool stop_{false};
+};
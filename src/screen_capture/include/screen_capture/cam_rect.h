@@ -19,6 +19,7 @@
 
 #include "cam_size.h"
 #include "cam_point.h"
+#include <algorithm>
 
 namespace cam
 {
@@ -131,4 +132,18 @@ constexpr auto operator == (const rect<T> &lhs, const rect<T> &rhs) noexcept ->
         && lhs.top() == rhs.top()
         && lhs.bottom() == rhs.bottom();
 }
+
+// the intersection of two rects, an empty (all zero) rect when they do not intersect.
+template<typename T>
+constexpr auto intersect(const rect<T> &lhs, const rect<T> &rhs) noexcept -> rect<T>
+{
+    const auto left = std::max(lhs.left(), rhs.left());
+    const auto top = std::max(lhs.top(), rhs.top());
+    const auto right = std::min(lhs.right(), rhs.right());
+    const auto bottom = std::min(lhs.bottom(), rhs.bottom());
+    if (left >= right || top >= bottom)
+        return {};
+
+    return {left, top, right, bottom};
+}
 } // namespace cam
@@ -0,0 +1,50 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_color.h"
+#include "cam_sprite.h"
+#include "cam_sprite_atlas.h"
+#include <cstdint>
+
+/*!
+ * The pre rendered frames of the click ring animation, one ring sprite for every ring size from 0 up
+ * to and including the max size. The frames are only rendered again when the ring config changes.
+ */
+class cam_ring_animation
+{
+public:
+    // make sure the frames match the given ring config, re-renders them when the config changed.
+    void update(const int max_size, const cam::color &color, const double stroke_width);
+
+    // get the frame for a ring size, the size is clamped to the available frames.
+    auto get_frame(const int ring_size) const noexcept -> cam_sprite_view;
+
+    int get_frame_count() const noexcept;
+
+private:
+    struct key
+    {
+        int max_size{-1};
+        uint32_t color{0};
+        double stroke_width{0.0};
+    };
+
+    key key_;
+    cam_sprite_atlas atlas_;
+};
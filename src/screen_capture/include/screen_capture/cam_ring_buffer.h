@@ -0,0 +1,97 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+/*!
+ * Fixed capacity FIFO queue without any allocations. When the buffer is full, pushing a new element
+ * drops the oldest one.
+ *
+ * \note this container is not thread safe.
+ */
+template <typename T, std::size_t Capacity>
+class cam_ring_buffer
+{
+    static_assert(Capacity > 0, "a ring buffer needs a capacity");
+
+public:
+    // push an element at the back, drops the front element when the buffer is full.
+    void push_back(const T &value) noexcept
+    {
+        if (size_ == Capacity)
+            pop_front();
+
+        elements_[(head_ + size_) % Capacity] = value;
+        ++size_;
+    }
+
+    void pop_front() noexcept
+    {
+        assert(size_ > 0);
+        head_ = (head_ + 1) % Capacity;
+        --size_;
+    }
+
+    auto front() noexcept -> T &
+    {
+        assert(size_ > 0);
+        return elements_[head_];
+    }
+
+    // access the element at the given position from the front.
+    auto operator[](const std::size_t index) noexcept -> T &
+    {
+        assert(index < size_);
+        return elements_[(head_ + index) % Capacity];
+    }
+
+    auto operator[](const std::size_t index) const noexcept -> const T &
+    {
+        assert(index < size_);
+        return elements_[(head_ + index) % Capacity];
+    }
+
+    auto size() const noexcept -> std::size_t
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    static constexpr auto capacity() noexcept -> std::size_t
+    {
+        return Capacity;
+    }
+
+    void clear() noexcept
+    {
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    std::array<T, Capacity> elements_{};
+    std::size_t head_{0};
+    std::size_t size_{0};
+};
@@ -0,0 +1,100 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_size.h"
+#include <cstdint>
+#include <vector>
+
+namespace cam
+{
+
+enum class scale_filter
+{
+    bilinear, // sharp, for up scaling and small down scale factors.
+    area // averages all covered pixels, for down scaling without aliasing.
+};
+
+/*!
+ * Scale kernels, all kernels use the same fixed point math so they produce bit identical results.
+ */
+enum class scale_kernel
+{
+    scalar,
+    sse2
+};
+
+// the source pixels that contribute to a destination pixel, and the offset of their weights.
+struct scale_contributor
+{
+    int first{0};
+    int count{0};
+    int weight_offset{0};
+};
+
+// returns true when the kernel is supported by the current cpu.
+bool is_scale_kernel_supported(const scale_kernel kernel) noexcept;
+
+// the fastest kernel supported by the current cpu.
+auto get_best_scale_kernel() noexcept -> scale_kernel;
+
+} // namespace cam
+
+/*!
+ * Separable BGRA image scaler.
+ *
+ * The filter weights are calculated once for a source and destination size, scaling an image
+ * first filters the needed source rows horizontally (cached, every source row is filtered once)
+ * and then blends those rows vertically. Only the source_size region of the source is read, so a
+ * region of a larger frame can be scaled without copying it first.
+ */
+class cam_scaler
+{
+public:
+    cam_scaler(const cam::size<int> &src_size, const cam::size<int> &dst_size, const cam::scale_filter filter,
+               const cam::scale_kernel kernel = cam::get_best_scale_kernel());
+
+    void scale(const uint8_t *src, const int src_stride, uint8_t *dst, const int dst_stride);
+
+    auto get_src_size() const noexcept -> const cam::size<int> &;
+    auto get_dst_size() const noexcept -> const cam::size<int> &;
+
+private:
+    struct filter_table
+    {
+        std::vector<cam::scale_contributor> contributors;
+        std::vector<int16_t> weights;
+        int max_count{0};
+    };
+
+    static auto _create_filter_table(const int src_length, const int dst_length, const cam::scale_filter filter)
+        -> filter_table;
+
+    auto _get_filtered_row(const uint8_t *src, const int src_stride, const int row) -> const uint16_t *;
+
+    cam::size<int> src_size_;
+    cam::size<int> dst_size_;
+    cam::scale_kernel kernel_;
+    filter_table horizontal_;
+    filter_table vertical_;
+
+    // horizontally filtered source rows, a ring with room for the rows of one destination row.
+    std::vector<uint16_t> row_cache_;
+    std::vector<int> row_cache_rows_;
+    std::vector<const uint16_t *> rows_;
+};
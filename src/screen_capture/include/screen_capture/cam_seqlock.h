@@ -0,0 +1,113 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/*!
+ * Sequence lock around a small trivially copyable value, a.e. a stats snapshot.
+ *
+ * A single writer stores complete values without ever waiting, any number of readers load a
+ * consistent copy at their own cadence. A reader that overlaps with a store simply tries again, so
+ * readers never slow down the writer.
+ *
+ * The value is kept in atomic words, so the racing reads of a retried load are well defined.
+ */
+template <typename T>
+class cam_seqlock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "the seqlock value must be trivially copyable");
+    static_assert(std::is_default_constructible_v<T>, "the seqlock value must be default constructible");
+
+public:
+    cam_seqlock() noexcept
+    {
+        store(T{});
+    }
+
+    explicit cam_seqlock(const T &value) noexcept
+    {
+        store(value);
+    }
+
+    cam_seqlock(const cam_seqlock &) = delete;
+    cam_seqlock &operator=(const cam_seqlock &) = delete;
+
+    // store a new value, only call this from a single writer thread.
+    void store(const T &value) noexcept
+    {
+        std::array<uint64_t, word_count> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        /* an odd sequence marks a store in progress */
+        const auto sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (std::size_t i = 0; i < word_count; ++i)
+            words_[i].store(words[i], std::memory_order_relaxed);
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    // load a consistent copy of the value, retries while a store is in progress.
+    auto load() const noexcept -> T
+    {
+        T value;
+        while (!try_load(value))
+            std::this_thread::yield();
+        return value;
+    }
+
+    // a single load attempt, returns false when it overlapped with a store.
+    bool try_load(T &value) const noexcept
+    {
+        std::array<uint64_t, word_count> words;
+
+        const auto sequence = sequence_.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0)
+            return false;
+
+        for (std::size_t i = 0; i < word_count; ++i)
+            words[i] = words_[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != sequence)
+            return false;
+
+        std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+        return true;
+    }
+
+    // changes with every store, a.e. to detect a new value without loading it.
+    auto get_version() const noexcept -> uint64_t
+    {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr std::size_t word_count = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence_{0};
+    std::array<std::atomic<uint64_t>, word_count> words_{};
+};
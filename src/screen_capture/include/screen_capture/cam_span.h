@@ -0,0 +1,92 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace cam
+{
+
+/*!
+ * A non owning view on a contiguous sequence of elements, until we can use std::span (c++20).
+ */
+template <typename T>
+class span
+{
+public:
+    constexpr span() noexcept = default;
+
+    constexpr span(T *data, const std::size_t size) noexcept
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    template <typename U>
+    span(const std::vector<U> &container) noexcept
+        : data_(container.data())
+        , size_(container.size())
+    {
+    }
+
+    template <typename U>
+    span(std::vector<U> &container) noexcept
+        : data_(container.data())
+        , size_(container.size())
+    {
+    }
+
+    constexpr auto data() const noexcept -> T *
+    {
+        return data_;
+    }
+
+    constexpr auto size() const noexcept -> std::size_t
+    {
+        return size_;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    constexpr auto begin() const noexcept -> T *
+    {
+        return data_;
+    }
+
+    constexpr auto end() const noexcept -> T *
+    {
+        return data_ + size_;
+    }
+
+    constexpr auto operator[](const std::size_t index) const noexcept -> T &
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+private:
+    T *data_{nullptr};
+    std::size_t size_{0};
+};
+
+} // namespace cam
@@ -0,0 +1,112 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_color.h"
+#include "cam_size.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// a non owning view on premultiplied BGRA pixels, for example a sprite inside a sprite atlas.
+struct cam_sprite_view
+{
+    const uint32_t *data{nullptr};
+    int width{0};
+    int height{0};
+    int stride{0}; // in pixels.
+
+    auto row(const int y) const noexcept -> const uint32_t *
+    {
+        return data + static_cast<ptrdiff_t>(y) * stride;
+    }
+};
+
+/*!
+ * A small premultiplied BGRA image, used to render annotations once and blend them into the
+ * captured frames.
+ */
+class cam_sprite
+{
+public:
+    cam_sprite() noexcept = default;
+    cam_sprite(const int width, const int height);
+
+    int width() const noexcept;
+    int height() const noexcept;
+    bool empty() const noexcept;
+
+    auto data() noexcept -> uint32_t *;
+    auto data() const noexcept -> const uint32_t *;
+
+    auto row(const int y) noexcept -> uint32_t *;
+    auto row(const int y) const noexcept -> const uint32_t *;
+
+    auto view() const noexcept -> cam_sprite_view;
+
+private:
+    int width_{0};
+    int height_{0};
+    std::vector<uint32_t> pixels_;
+};
+
+/*!
+ * Keeps a sprite until the parameters (the key) it was rendered with change.
+ */
+template <typename key_type>
+class cam_cached_sprite
+{
+public:
+    template <typename render_function>
+    auto get(const key_type &key, render_function &&render) -> const cam_sprite &
+    {
+        if (!valid_ || !(key_ == key))
+        {
+            sprite_ = render();
+            key_ = key;
+            valid_ = true;
+        }
+        return sprite_;
+    }
+
+    void invalidate() noexcept
+    {
+        valid_ = false;
+    }
+
+private:
+    key_type key_{};
+    cam_sprite sprite_;
+    bool valid_{false};
+};
+
+namespace cam
+{
+
+// convert a straight alpha color into a premultiplied pixel, scaled by a (anti alias) coverage.
+auto premultiply(const color &color, const uint8_t coverage = 0xff) noexcept -> uint32_t;
+
+auto create_filled_rect_sprite(const size<int> &size, const color &color) -> cam_sprite;
+
+// an anti aliased filled ellipse that fits the given size.
+auto create_filled_ellipse_sprite(const size<int> &size, const color &color) -> cam_sprite;
+
+// an anti aliased circle outline, the sprite is sized to fit the stroke.
+auto create_ring_sprite(const double diameter, const double stroke_width, const color &color) -> cam_sprite;
+
+} // namespace cam
@@ -0,0 +1,69 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_sprite.h"
+#include <cstdint>
+#include <vector>
+
+/*!
+ * Packs many small sprites into a single image, so a set of related sprites (for example the frames
+ * of an animation) is rendered once and stays close together in memory.
+ *
+ * Sprites are packed on shelves from left to right; a new shelf is started when a sprite does not fit
+ * the current one. The atlas has a fixed width and grows in height.
+ *
+ * \note adding a sprite can reallocate the atlas, invalidating all views returned by get().
+ */
+class cam_sprite_atlas
+{
+public:
+    static constexpr int default_width = 512;
+
+    explicit cam_sprite_atlas(const int width = default_width);
+
+    // copy a sprite into the atlas, returns the index to get it back with.
+    auto add(const cam_sprite &sprite) -> int;
+
+    auto get(const int index) const noexcept -> cam_sprite_view;
+
+    // the number of sprites in the atlas.
+    int size() const noexcept;
+
+    int width() const noexcept;
+    int height() const noexcept;
+
+    void clear() noexcept;
+
+private:
+    struct entry
+    {
+        int x{0};
+        int y{0};
+        int width{0};
+        int height{0};
+    };
+
+    int width_{0};
+    int height_{0};
+    int shelf_x_{0};
+    int shelf_y_{0};
+    int shelf_height_{0};
+    std::vector<entry> entries_;
+    std::vector<uint32_t> pixels_;
+};
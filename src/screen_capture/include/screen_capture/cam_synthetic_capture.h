@@ -0,0 +1,65 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_frame.h"
+#include "cam_frame_damage.h"
+#include "cam_rect.h"
+#include <cstdint>
+#include <vector>
+
+/*!
+ * A capture source that captures an in memory desktop, so the capture pipeline can be tested
+ * without a display. Changes are made with fill_rect() and move_rect(), and are reported as damage
+ * the way desktop duplication does.
+ */
+class cam_synthetic_capture_source
+{
+public:
+    // the desktop rect in screen coordinates, the desktop starts black.
+    explicit cam_synthetic_capture_source(const cam::rect<int> &desktop_rect);
+
+    // fill a rect (screen coordinates) with a BGRA color.
+    void fill_rect(const cam::rect<int> &rect, const uint32_t color);
+
+    // move the pixels of the src rect (screen coordinates) to dst, the uncovered pixels are kept.
+    void move_rect(const cam::rect<int> &src, const point<int> &dst);
+
+    /*!
+     * Copy the capture rect into data, and report what changed in it since the previous capture.
+     * The first capture has no damage information.
+     */
+    void capture_frame(const cam::rect<int> &capture_rect, uint8_t *data, const int stride,
+        cam_frame_damage &damage);
+
+    // capture into a frame owned by the source, which stays valid until the next capture.
+    auto capture_frame(const cam::rect<int> &capture_rect) -> const cam_frame &;
+
+    auto get_desktop_rect() const noexcept -> const cam::rect<int> &;
+
+private:
+    auto _get_pixel(const int x, const int y) noexcept -> uint32_t &;
+
+    cam::rect<int> desktop_rect_;
+    std::vector<uint32_t> pixels_;
+    // the damage since the previous capture, in screen coordinates.
+    cam_frame_damage damage_;
+
+    std::vector<uint8_t> frame_data_;
+    cam_frame frame_;
+};
@@ -0,0 +1,80 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_color.h"
+#include "cam_point.h"
+#include "cam_sprite.h"
+#include "cam_sprite_atlas.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class cam_canvas;
+class cam_font;
+
+/*!
+ * Renders a single line of text from cached glyphs.
+ *
+ * Every glyph is rendered by the font only once, into a glyph atlas. The text line itself is kept in
+ * a sprite, and when the text changes only the glyphs that changed are copied into it again. For a
+ * running clock this means only a couple of digits per frame.
+ *
+ * \note the font must outlive the text overlay.
+ */
+class cam_text_overlay
+{
+public:
+    cam_text_overlay(const cam_font &font, const cam::color &color);
+
+    void set_text(std::wstring_view text);
+    auto get_text() const noexcept -> const std::wstring &;
+
+    // changing the color renders all glyphs again.
+    void set_color(const cam::color &color);
+
+    void draw(cam_canvas &canvas, const point<int> &position) const noexcept;
+
+    // the rendered text line.
+    auto get_sprite() const noexcept -> const cam_sprite &;
+
+    // the number of glyphs the font had to render.
+    auto get_rendered_glyph_count() const noexcept -> int;
+
+    // the total number of glyphs that were copied into the text line.
+    auto get_composited_glyph_count() const noexcept -> int64_t;
+
+private:
+    auto _get_glyph(const wchar_t glyph) -> cam_sprite_view;
+    void _composite_glyph(const cam_sprite_view &glyph, const int x);
+
+    const cam_font &font_;
+    cam::color color_;
+
+    cam_sprite_atlas glyph_atlas_;
+    std::unordered_map<wchar_t, int> glyph_index_;
+
+    std::wstring text_;
+    // the x offset of every glyph in the text line.
+    std::vector<int> glyph_offsets_;
+    std::vector<int> new_glyph_offsets_;
+    cam_sprite line_;
+    int64_t composited_glyph_count_{0};
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "screen_capture/cam_rect.h"
+#include <vector>
 
 namespace cam
 {
@@ -15,4 +16,7 @@ struct virtual_screen_info
 };
 
 virtual_screen_info get_virtual_screen_info();
+
+// the rects of all attached monitors, in screen coordinates.
+std::vector<cam::rect<int>> get_monitor_rects();
 } // namespace cam
@@ -0,0 +1,138 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// an opaque window handle, a HWND on windows.
+using cam_window_id = std::uintptr_t;
+
+struct cam_window_info
+{
+    cam_window_id id{0};
+    uint32_t process_id{0};
+    std::wstring process_name;
+    std::wstring process_filepath;
+    std::wstring title;
+};
+
+inline bool operator == (const cam_window_info &lhs, const cam_window_info &rhs)
+{
+    return lhs.id == rhs.id
+        && lhs.process_id == rhs.process_id
+        && lhs.process_name == rhs.process_name
+        && lhs.process_filepath == rhs.process_filepath
+        && lhs.title == rhs.title;
+}
+
+inline bool operator != (const cam_window_info &lhs, const cam_window_info &rhs)
+{
+    return !(lhs == rhs);
+}
+
+enum class cam_window_event_type
+{
+    created, // created or shown.
+    destroyed, // destroyed or hidden.
+    renamed
+};
+
+struct cam_window_event
+{
+    cam_window_event_type type{cam_window_event_type::created};
+    cam_window_id id{0};
+};
+
+enum class cam_window_change_type
+{
+    added,
+    removed,
+    updated
+};
+
+struct cam_window_change
+{
+    cam_window_change_type type{cam_window_change_type::added};
+    cam_window_info window;
+};
+
+/*!
+ * The windows that can be captured, a.e. all visible top level windows of other processes.
+ */
+class cam_window_source
+{
+public:
+    virtual ~cam_window_source() = default;
+
+    // all capturable windows, top most first.
+    virtual auto enumerate() -> std::vector<cam_window_info> = 0;
+
+    // a single window, or nothing when it is not (or no longer) a capturable window.
+    virtual auto query(const cam_window_id id) -> std::optional<cam_window_info> = 0;
+};
+
+/*!
+ * Incrementally updated list of capturable windows.
+ *
+ * The list is populated once, after that it is kept current with window events, so opening the
+ * window picker does not have to enumerate all windows again. Only the window of an event is
+ * queried. When events might have been missed, resync() enumerates again and only applies the
+ * differences.
+ *
+ * \note the list can be read from any thread, while the events are applied from another.
+ */
+class cam_window_list
+{
+public:
+    explicit cam_window_list(cam_window_source &source);
+
+    // enumerate all windows, and replace the list.
+    void populate();
+
+    // apply a single window event, returns the change of the list if there was one.
+    auto apply(const cam_window_event &event) -> std::optional<cam_window_change>;
+
+    // enumerate all windows, and apply the differences to the list.
+    auto resync() -> std::vector<cam_window_change>;
+
+    // a copy of the current list, top most (or most recently created) first.
+    auto get_windows() const -> std::vector<cam_window_info>;
+
+    auto size() const -> std::size_t;
+
+    // increases with every change of the list.
+    auto get_revision() const noexcept -> uint64_t;
+
+private:
+    void _add(cam_window_info window, std::size_t position);
+    void _remove(cam_window_id id);
+    void _rebuild_index(std::size_t first);
+
+    cam_window_source &source_;
+    mutable std::mutex mutex_;
+    std::vector<cam_window_info> windows_;
+    std::unordered_map<cam_window_id, std::size_t> index_;
+    std::atomic<uint64_t> revision_{0};
+};
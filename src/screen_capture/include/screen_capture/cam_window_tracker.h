@@ -0,0 +1,91 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cam_rect.h"
+#include "cam_scale.h"
+#include "cam_size.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+enum class cam_fit_mode
+{
+    letterbox, // scale the window to fit the output, keeping its aspect ratio.
+    shrink // like letterbox, but never scale up. A smaller window is centered at its own size.
+};
+
+struct cam_window_tracker_config
+{
+    // the size of the output frames, this never changes during a recording.
+    cam::size<int> output_size{0, 0};
+    // the largest window size that is captured, a.e. the virtual screen size. Larger windows are cropped.
+    cam::size<int> max_size{0, 0};
+    cam_fit_mode fit_mode{cam_fit_mode::letterbox};
+    cam::scale_filter filter{cam::scale_filter::area};
+};
+
+namespace cam
+{
+
+// the rect in the output the content is drawn in, centered with letterbox bars around it.
+auto fit_rect(const cam::size<int> &content_size, const cam::size<int> &output_size, const cam_fit_mode mode) noexcept
+    -> cam::rect<int>;
+
+} // namespace cam
+
+/*!
+ * Fits a window that moves and resizes into fixed size output frames, a stage between capture and
+ * encode.
+ *
+ * The capture buffer is allocated once at max size, so a resize only changes which part of it is
+ * used. The window content is scaled into the output, the output size and with that the encoder
+ * configuration never changes.
+ */
+class cam_window_tracker
+{
+public:
+    explicit cam_window_tracker(const cam_window_tracker_config &config);
+
+    // update the geometry for the current window size, returns true when the geometry changed.
+    bool update(const cam::size<int> &window_size);
+
+    // the part of the window that is captured, at most max size.
+    auto get_capture_size() const noexcept -> const cam::size<int> &;
+
+    // where the captured window is drawn in the output, empty when there is nothing to capture.
+    auto get_content_rect() const noexcept -> const cam::rect<int> &;
+
+    // scale the captured window (capture size) into the output, the letterbox bars are black.
+    void render(const uint8_t *src, const int src_stride);
+
+    auto get_output_data() const noexcept -> const uint8_t *;
+    auto get_output_size() const noexcept -> const cam::size<int> &;
+    auto get_output_stride() const noexcept -> int;
+
+private:
+    cam_window_tracker_config config_;
+    cam::size<int> capture_size_;
+    cam::rect<int> content_rect_;
+    bool has_geometry_{false};
+
+    // recreated on a resize only, the output buffer is never reallocated.
+    std::optional<cam_scaler> scaler_;
+    std::vector<uint8_t> output_;
+    bool clear_output_{true};
+};
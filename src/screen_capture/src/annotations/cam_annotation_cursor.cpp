@@ -16,11 +16,72 @@
  */
 
 #include "screen_capture/annotations/cam_annotation_cursor.h"
-#include "screen_capture/cam_gdiplus.h"
+#include "screen_capture/cam_canvas.h"
 #include "screen_capture/cam_draw_data.h"
 #include <windows.h>
-#include <stdexcept>
-#include <cmath>
+
+// the shape of a cursor with an unchanged handle is checked this often (seconds), for animated cursors.
+constexpr auto cursor_revalidate_interval = 0.1;
+
+struct cursor_bitmap_info
+{
+    int width{0};
+    int height{0};
+    int mask_stride{0};
+};
+
+/*!
+ * Read the and/xor mask and the color bitmap (if any) of a cursor, top down. For monochrome cursors
+ * the mask contains the and mask followed by the xor mask.
+ */
+static bool read_cursor_bits(const ICONINFO &icon_info, std::vector<uint8_t> &mask_bits,
+                             std::vector<uint32_t> &color_bits, cursor_bitmap_info &info)
+{
+    BITMAP mask_bitmap = {};
+    if (::GetObject(icon_info.hbmMask, sizeof(BITMAP), &mask_bitmap) == 0)
+        return false;
+
+    const auto is_monochrome = icon_info.hbmColor == nullptr;
+    info.width = mask_bitmap.bmWidth;
+    info.height = is_monochrome ? mask_bitmap.bmHeight / 2 : mask_bitmap.bmHeight;
+    info.mask_stride = ((info.width + 31) / 32) * 4;
+
+    struct
+    {
+        BITMAPINFOHEADER header;
+        RGBQUAD colors[2];
+    } mask_info = {};
+    mask_info.header.biSize = sizeof(BITMAPINFOHEADER);
+    mask_info.header.biWidth = info.width;
+    mask_info.header.biHeight = -mask_bitmap.bmHeight;
+    mask_info.header.biPlanes = 1;
+    mask_info.header.biBitCount = 1;
+    mask_info.header.biCompression = BI_RGB;
+
+    HDC dc = ::GetDC(nullptr);
+    mask_bits.resize(static_cast<size_t>(info.mask_stride) * mask_bitmap.bmHeight);
+    auto ret = ::GetDIBits(dc, icon_info.hbmMask, 0, mask_bitmap.bmHeight, mask_bits.data(),
+        reinterpret_cast<BITMAPINFO *>(&mask_info), DIB_RGB_COLORS) != 0;
+
+    color_bits.clear();
+    if (ret && !is_monochrome)
+    {
+        BITMAPINFO color_info = {};
+        color_info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        color_info.bmiHeader.biWidth = info.width;
+        color_info.bmiHeader.biHeight = -info.height;
+        color_info.bmiHeader.biPlanes = 1;
+        color_info.bmiHeader.biBitCount = 32;
+        color_info.bmiHeader.biCompression = BI_RGB;
+
+        color_bits.resize(static_cast<size_t>(info.width) * info.height);
+        ret = ::GetDIBits(dc, icon_info.hbmColor, 0, info.height, color_bits.data(), &color_info,
+            DIB_RGB_COLORS) != 0;
+    }
+
+    ::ReleaseDC(nullptr, dc);
+    return ret;
+}
 
 cam_annotation_cursor::cam_annotation_cursor(const bool cursor_enabled,
                                              const bool ring_enabled,
@@ -31,7 +92,7 @@ cam_annotation_cursor::cam_annotation_cursor(const bool cursor_enabled,
                                              const mouse_action_config &halo_config,
                                              const mouse_action_config &halo_left_click_config,
                                              const mouse_action_config &halo_right_click_config,
-                                             const mouse_action_config &halo_middle_click_config) noexcept
+                                             const mouse_action_config &halo_middle_click_config)
     : cursor_enabled_(cursor_enabled)
     , halo_type_(halo_type)
     , halo_config_(halo_config)
@@ -39,15 +100,15 @@ cam_annotation_cursor::cam_annotation_cursor(const bool cursor_enabled,
     , halo_right_click_config_(halo_right_click_config)
     , halo_middle_click_config_(halo_middle_click_config)
     , ring_enabled_(ring_enabled)
-    , ring_left_click_config_(ring_left_click_config)
-    , ring_right_click_config_(ring_right_click_config)
-    , ring_middle_click_config_(ring_middle_click_config)
 {
+    set_ring_left_click_config(ring_left_click_config);
+    set_ring_right_click_config(ring_right_click_config);
+    set_ring_middle_click_config(ring_middle_click_config);
 }
 
 cam_annotation_cursor::~cam_annotation_cursor() = default;
 
-void cam_annotation_cursor::draw(Gdiplus::Graphics &canvas, const cam_draw_data &draw_data)
+void cam_annotation_cursor::draw(cam_canvas &canvas, const cam_draw_data &draw_data)
 {
     const auto &rect = draw_data.canvas_rect_;
     const auto &position = draw_data.mouse_pos_;
@@ -57,7 +118,13 @@ void cam_annotation_cursor::draw(Gdiplus::Graphics &canvas, const cam_draw_data
     mouse_button_state |= (draw_data.mouse_button_state_ & cam_mouse_button::right_button_down);
     mouse_button_state |= (draw_data.mouse_button_state_ & cam_mouse_button::middle_button_down);
 
-    if (ring_enabled_ && mouse_button_state != mouse_button_state_)
+    /* with timestamped input events every click starts a ring at the time it happened, otherwise
+     * we only know the buttons that went down since the last frame. */
+    if (ring_enabled_ && !draw_data.input_events_.empty())
+    {
+        rings_.add(draw_data.input_events_);
+    }
+    else if (ring_enabled_ && mouse_button_state != mouse_button_state_)
     {
         _handle_ring_button_state_changed(position, mouse_button_state, cam_mouse_button::left_button_down);
         _handle_ring_button_state_changed(position, mouse_button_state, cam_mouse_button::right_button_down);
@@ -74,25 +141,25 @@ void cam_annotation_cursor::draw(Gdiplus::Graphics &canvas, const cam_draw_data
             || halo_middle_click_config_.enabled;
 
         if (mouse_click_enabled && mouse_button_state_ == 0)
-            _draw_halo(canvas, rect, position, halo_config_);
+            _draw_halo(canvas, rect, position, halo_config_, halo_sprite_);
         else if (mouse_click_enabled == false)
-            _draw_halo(canvas, rect, position, halo_config_);
+            _draw_halo(canvas, rect, position, halo_config_, halo_sprite_);
     }
 
     if (halo_left_click_config_.enabled && (mouse_button_state_ & cam_mouse_button::left_button_down) != 0)
-        _draw_halo(canvas, rect, position, halo_left_click_config_);
+        _draw_halo(canvas, rect, position, halo_left_click_config_, halo_left_click_sprite_);
 
     if (halo_right_click_config_.enabled && (mouse_button_state_ & cam_mouse_button::right_button_down) != 0)
-        _draw_halo(canvas, rect, position, halo_right_click_config_);
+        _draw_halo(canvas, rect, position, halo_right_click_config_, halo_right_click_sprite_);
 
     if (halo_middle_click_config_.enabled && (mouse_button_state_ & cam_mouse_button::middle_button_down) != 0)
-        _draw_halo(canvas, rect, position, halo_middle_click_config_);
+        _draw_halo(canvas, rect, position, halo_middle_click_config_, halo_middle_click_sprite_);
 
-    if (ring_enabled_ && !queued_rings_.empty())
-        _draw_rings(canvas, rect, draw_data.frame_delta_);
+    if (ring_enabled_ && !rings_.empty())
+        rings_.draw(canvas, point<int>(rect.left(), rect.top()), draw_data.frame_delta_);
 
     if (cursor_enabled_)
-        _draw_cursor(canvas, rect, position);
+        _draw_cursor(canvas, rect, position, draw_data.cursor_, draw_data.frame_delta_);
 
     if (draw_data.mouse_button_state_ & cam_mouse_button::left_button_up)
         mouse_button_state_ &= ~cam_mouse_button::left_button_down;
@@ -114,23 +181,23 @@ void cam_annotation_cursor::set_cursor_ring_enabled(const bool enabled)
     if (enabled == ring_enabled_)
         return;
 
-    queued_rings_.clear();
+    rings_.clear();
     ring_enabled_ = enabled;
 }
 
-void cam_annotation_cursor::set_ring_left_click_config(const mouse_action_config &config) noexcept
+void cam_annotation_cursor::set_ring_left_click_config(const mouse_action_config &config)
 {
-    ring_left_click_config_ = config;
+    rings_.set_style(cam_mouse_button::left_button_down, config.size.width(), config.color);
 }
 
-void cam_annotation_cursor::set_ring_right_click_config(const mouse_action_config &config) noexcept
+void cam_annotation_cursor::set_ring_right_click_config(const mouse_action_config &config)
 {
-    ring_right_click_config_ = config;
+    rings_.set_style(cam_mouse_button::right_button_down, config.size.width(), config.color);
 }
 
-void cam_annotation_cursor::set_ring_middle_click_config(const mouse_action_config &config) noexcept
+void cam_annotation_cursor::set_ring_middle_click_config(const mouse_action_config &config)
 {
-    ring_middle_click_config_ = config;
+    rings_.set_style(cam_mouse_button::middle_button_down, config.size.width(), config.color);
 }
 
 void cam_annotation_cursor::set_halo_type(const cam_halo_type halo_type) noexcept
@@ -165,28 +232,20 @@ void cam_annotation_cursor::_handle_ring_button_state_changed(const point<int> &
     const auto is_state_new = mouse_button_state & mouse_button_type;
     if (is_state_changed && is_state_new)
     {
-        queued_rings_.emplace_back(
-            cam_mouse_ring_state(position, mouse_button_type)
-        );
+        rings_.add(position, mouse_button_type);
     }
 }
 
-void cam_annotation_cursor::_draw_cursor(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect,
-                                         const point<int> &mouse_pos)
+void cam_annotation_cursor::_draw_cursor(cam_canvas &canvas, const cam::rect<int> &canvas_rect,
+                                         const point<int> &mouse_pos, const cam_cursor_state &cursor,
+                                         const double frame_delta)
 {
-    CURSORINFO cursor_info = {};
-    cursor_info.cbSize = sizeof(CURSORINFO);
-
-    auto ret = ::GetCursorInfo(&cursor_info);
-    if (!ret)
-        return;
-
-    if (!(cursor_info.flags & CURSOR_SHOWING))
+    /* the capture source reads the cursor once per frame, the shape id is the cursor handle */
+    if (!cursor.visible || cursor.shape_id == 0)
         return;
 
-    ICONINFO icon_info;
-    ret = ::GetIconInfo(cursor_info.hCursor, &icon_info);
-    if (!ret)
+    const auto *cursor_image = _get_cursor_image(static_cast<uintptr_t>(cursor.shape_id), frame_delta);
+    if (cursor_image == nullptr)
         return;
 
     auto cursor_x = mouse_pos.x();
@@ -195,121 +254,98 @@ void cam_annotation_cursor::_draw_cursor(Gdiplus::Graphics &canvas, const cam::r
     cursor_x -= canvas_rect.left();
     cursor_y -= canvas_rect.top();
 
-    cursor_x -= icon_info.xHotspot;
-    cursor_y -= icon_info.yHotspot;
-
-    const auto hdc = canvas.GetHDC();
-    ::DrawIconEx(hdc, cursor_x, cursor_y, cursor_info.hCursor, 0, 0, 0, NULL, DI_NORMAL);
-    canvas.ReleaseHDC(hdc);
+    cursor_x -= cursor_image->hotspot.x();
+    cursor_y -= cursor_image->hotspot.y();
 
-    ::DeleteObject(icon_info.hbmColor);
-    ::DeleteObject(icon_info.hbmMask);
+    canvas.draw_sprite(cursor_image->sprite, point<int>(cursor_x, cursor_y));
 }
 
-void cam_annotation_cursor::_draw_halo(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect,
-                                       const point<int> &mouse_pos,
-                                       const mouse_action_config &halo_config)
+auto cam_annotation_cursor::_get_cursor_image(const uintptr_t cursor_handle, const double frame_delta)
+    -> const cam_cursor_image *
 {
-    auto cursor_x = mouse_pos.x();
-    auto cursor_y = mouse_pos.y();
-
-    cursor_x -= canvas_rect.left();
-    cursor_y -= canvas_rect.top();
-
-    cursor_x -= halo_config.size.width() / 2;
-    cursor_y -= halo_config.size.height() / 2;
+    cursor_revalidate_time_ += frame_delta;
 
-    const auto halo_rect = Gdiplus::Rect(
-        cursor_x,
-        cursor_y,
-        halo_config.size.width(),
-        halo_config.size.height()
-    );
-    const Gdiplus::Color c(
-        halo_config.color.a_,
-        halo_config.color.r_,
-        halo_config.color.g_,
-        halo_config.color.b_);
-    const Gdiplus::SolidBrush b(c);
-
-    switch(halo_type_)
+    /* the cursor did not change since the last frame, so we can skip reading its bitmaps. */
+    if (cursor_handle == cursor_handle_ && cursor_revalidate_time_ < cursor_revalidate_interval)
     {
-    case cam_halo_type::circle:
-        [[fallthrough]];
-    case cam_halo_type::ellipse:
-        canvas.FillEllipse(&b, halo_rect);
-        break;
-
-    case cam_halo_type::square:
-        [[fallthrough]];
-    case cam_halo_type::rectangle:
-        canvas.FillRectangle(&b, halo_rect);
-        break;
+        if (const auto *cursor_image = cursor_cache_.find(cursor_handle, cursor_shape_hash_); cursor_image)
+            return cursor_image;
     }
-}
 
-void cam_annotation_cursor::_draw_rings(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect,
-                                        const double frame_delta)
-{
-    std::vector<cam_mouse_ring_state *> dead_rings;
-    for (auto &ring : queued_rings_)
-    {
-        if (_draw_ring(canvas, canvas_rect, ring, frame_delta))
-            dead_rings.push_back(&ring);
-    }
+    cursor_revalidate_time_ = 0.0;
 
-    for (const auto &dead_ring : dead_rings)
-    {
-        if (const auto itr = std::find(begin(queued_rings_), end(queued_rings_), *dead_ring); itr != end(queued_rings_))
-            queued_rings_.erase(itr);
-    }
-}
+    ICONINFO icon_info;
+    if (!::GetIconInfo(reinterpret_cast<HCURSOR>(cursor_handle), &icon_info))
+        return nullptr;
 
-bool cam_annotation_cursor::_draw_ring(Gdiplus::Graphics &canvas, const cam::rect<int> &canvas_rect,
-                                       cam_mouse_ring_state &ring, const double frame_delta)
-{
-    const auto config = _get_ring_config(ring.ring_type_);
+    cursor_bitmap_info info;
+    const auto ret = read_cursor_bits(icon_info, cursor_mask_bits_, cursor_color_bits_, info);
 
-    ring.lifetime_ += frame_delta * ring_speed_;
+    ::DeleteObject(icon_info.hbmColor);
+    ::DeleteObject(icon_info.hbmMask);
 
-    // \todo make sure that ring size is always 'odd'.
-    const auto ring_size = static_cast<int>(std::round(ring.lifetime_ * 20));
+    if (!ret)
+        return nullptr;
+
+    const int32_t geometry[] = {
+        info.width, info.height, static_cast<int32_t>(icon_info.xHotspot), static_cast<int32_t>(icon_info.yHotspot)
+    };
+    auto shape_hash = cam::hash_bytes(geometry, sizeof(geometry));
+    shape_hash = cam::hash_bytes(cursor_mask_bits_.data(), cursor_mask_bits_.size(), shape_hash);
+    shape_hash = cam::hash_bytes(cursor_color_bits_.data(), cursor_color_bits_.size() * sizeof(uint32_t),
+        shape_hash);
+
+    cursor_handle_ = cursor_handle;
+    cursor_shape_hash_ = shape_hash;
+
+    return &cursor_cache_.get(cursor_handle, shape_hash, [&]() {
+        cam_cursor_image cursor_image;
+        if (cursor_color_bits_.empty())
+        {
+            const auto *xor_mask = cursor_mask_bits_.data() + static_cast<size_t>(info.mask_stride) * info.height;
+            cursor_image.sprite = cam::create_monochrome_cursor_sprite(info.width, info.height,
+                cursor_mask_bits_.data(), xor_mask, info.mask_stride);
+        }
+        else
+        {
+            cursor_image.sprite = cam::create_color_cursor_sprite(info.width, info.height,
+                cursor_color_bits_.data(), cursor_mask_bits_.data(), info.mask_stride);
+        }
+        cursor_image.hotspot = point<int>(icon_info.xHotspot, icon_info.yHotspot);
+        return cursor_image;
+    });
+}
 
-    const auto center = ring.ring_center_;
-    auto cursor_x = center.x();
-    auto cursor_y = center.y();
+void cam_annotation_cursor::_draw_halo(cam_canvas &canvas, const cam::rect<int> &canvas_rect,
+                                       const point<int> &mouse_pos,
+                                       const mouse_action_config &halo_config,
+                                       cam_cached_sprite<cam_halo_sprite_key> &halo_sprite)
+{
+    auto cursor_x = mouse_pos.x();
+    auto cursor_y = mouse_pos.y();
 
     cursor_x -= canvas_rect.left();
     cursor_y -= canvas_rect.top();
 
-    cursor_x -= ring_size / 2;
-    cursor_y -= ring_size / 2;
-
-    const auto ring_rect = Gdiplus::Rect(
-        cursor_x,
-        cursor_y,
-        ring_size,
-        ring_size
-    );
-
-    const auto color = Gdiplus::Color(config.color.a_, config.color.r_, config.color.g_,
-        config.color.b_);
-
-    const auto pen = Gdiplus::Pen(color, static_cast<Gdiplus::REAL>(ring_width_));
-    canvas.DrawEllipse(&pen, ring_rect);
-
-    // return true when this ring needs to be deleted.
-    return ring_size > config.size.width();
-}
-
-auto cam_annotation_cursor::_get_ring_config(const cam_mouse_button::type mouse_button_type) -> mouse_action_config &
-{
-    switch(mouse_button_type)
-    {
-    case cam_mouse_button::left_button_down: return ring_left_click_config_;
-    case cam_mouse_button::right_button_down: return ring_right_click_config_;
-    case cam_mouse_button::middle_button_down: return ring_middle_click_config_;
-    }
+    cursor_x -= halo_config.size.width() / 2;
+    cursor_y -= halo_config.size.height() / 2;
 
-    throw std::runtime_error("invalid ring mouse button type");
+    const auto key = cam_halo_sprite_key{halo_type_, halo_config.size, halo_config.color};
+    const auto &sprite = halo_sprite.get(key, [&]() {
+        switch (halo_type_)
+        {
+        case cam_halo_type::circle:
+            [[fallthrough]];
+        case cam_halo_type::ellipse:
+            return cam::create_filled_ellipse_sprite(halo_config.size, halo_config.color);
+
+        case cam_halo_type::square:
+            [[fallthrough]];
+        case cam_halo_type::rectangle:
+            break;
+        }
+        return cam::create_filled_rect_sprite(halo_config.size, halo_config.color);
+    });
+
+    canvas.draw_sprite(sprite, point<int>(cursor_x, cursor_y));
 }
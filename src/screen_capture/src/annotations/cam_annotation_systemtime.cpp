@@ -16,48 +16,12 @@
  */
 
 #include "annotations/cam_annotation_systemtime.h"
-#include "cam_gdiplus.h"
-#include <fmt/chrono.h>
-#include <windows.h>
-#include <chrono>
+#include "cam_gdiplus_font.h"
 
-struct font_ptr
-{
-    std::unique_ptr<Gdiplus::Font> myFont;
-    std::unique_ptr<Gdiplus::SolidBrush> blackBrush;
-};
-
-cam_annotation_systemtime::cam_annotation_systemtime(point<int> systemtime_position, cam::color systemtime_color) noexcept
-    : systemtime_position_(systemtime_position)
-    , systemtime_color_(systemtime_color)
-{
-    font_pimpl_ = std::make_unique<font_ptr>();
-    font_pimpl_->myFont = std::make_unique<Gdiplus::Font>(L"Arial", 16.f);
-    font_pimpl_->blackBrush = std::make_unique<Gdiplus::SolidBrush>(Gdiplus::Color(255, 255, 0, 0));
-}
-
-cam_annotation_systemtime::~cam_annotation_systemtime()
+cam_annotation_systemtime::cam_annotation_systemtime(point<int> systemtime_position, cam::color systemtime_color)
+    : cam_annotation_text(cam_text_overlay_type::system_time, systemtime_position, systemtime_color,
+        std::make_unique<cam_gdiplus_font>(L"Arial", 16.f))
 {
 }
 
-void cam_annotation_systemtime::draw(Gdiplus::Graphics &canvas, const cam_draw_data &/*draw_data*/)
-{
-    const auto tp = std::chrono::system_clock::now();
-    const auto t = std::chrono::system_clock::to_time_t(tp);
-
-    const auto seconds = std::chrono::time_point_cast<std::chrono::seconds>(tp);
-    const auto fraction = tp - seconds;
-    const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(fraction);
-
-    const auto str = fmt::format(L"{:%Y-%m-%d %H:%M:%S}.{:03d}", fmt::localtime(t),
-        milliseconds.count());
-
-    Gdiplus::PointF pos;
-    pos.X = (float)systemtime_position_.x();
-    pos.Y = (float)systemtime_position_.y();
-
-    canvas.DrawString(str.c_str(), (INT)str.size(), font_pimpl_->myFont.get(),
-        pos,
-        font_pimpl_->blackBrush.get()
-    );
-}
+cam_annotation_systemtime::~cam_annotation_systemtime() = default;
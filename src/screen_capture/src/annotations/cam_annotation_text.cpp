@@ -0,0 +1,105 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/annotations/cam_annotation_text.h"
+#include "screen_capture/cam_canvas.h"
+#include "screen_capture/cam_rect.h"
+#include "screen_capture/cam_draw_data.h"
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+
+cam_annotation_text::cam_annotation_text(const cam_text_overlay_type type, const point<int> &position,
+                                         const cam::color &color, std::unique_ptr<cam_font> font,
+                                         std::wstring watermark)
+    : type_(type)
+    , position_(position)
+    , watermark_(std::move(watermark))
+    , font_(std::move(font))
+    , overlay_(*font_, color)
+{
+}
+
+cam_annotation_text::~cam_annotation_text() = default;
+
+void cam_annotation_text::draw(cam_canvas &canvas, const cam_draw_data &draw_data)
+{
+    /* the frame delta of the first frame is the time since the annotation was created */
+    if (first_frame_)
+        first_frame_ = false;
+    else
+    {
+        recording_time_ += draw_data.frame_delta_;
+        ++frame_number_;
+    }
+
+    _format_text();
+    overlay_.set_text(text_);
+    overlay_.draw(canvas, position_);
+}
+
+auto cam_annotation_text::get_overlay() const noexcept -> const cam_text_overlay &
+{
+    return overlay_;
+}
+
+void cam_annotation_text::_format_text()
+{
+    text_.clear();
+    switch (type_)
+    {
+    case cam_text_overlay_type::system_time:
+    {
+        const auto tp = std::chrono::system_clock::now();
+        const auto t = std::chrono::system_clock::to_time_t(tp);
+
+        const auto seconds = std::chrono::time_point_cast<std::chrono::seconds>(tp);
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(tp - seconds);
+
+        fmt::format_to(std::back_inserter(text_), L"{:%Y-%m-%d %H:%M:%S}.{:03d}", fmt::localtime(t),
+            milliseconds.count());
+        break;
+    }
+    case cam_text_overlay_type::recording_time:
+        cam::format_recording_time(text_, recording_time_);
+        break;
+    case cam_text_overlay_type::frame_number:
+        fmt::format_to(std::back_inserter(text_), L"{}", frame_number_);
+        break;
+    case cam_text_overlay_type::watermark:
+        text_ = watermark_;
+        break;
+    }
+}
+
+namespace cam
+{
+
+void format_recording_time(std::wstring &text, const double seconds)
+{
+    const auto total_milliseconds = static_cast<int64_t>(std::floor(std::max(seconds, 0.0) * 1000.0));
+    const auto milliseconds = total_milliseconds % 1000;
+    const auto total_seconds = total_milliseconds / 1000;
+
+    fmt::format_to(std::back_inserter(text), L"{:02d}:{:02d}:{:02d}.{:03d}", total_seconds / 3600,
+        (total_seconds / 60) % 60, total_seconds % 60, milliseconds);
+}
+
+} // namespace cam
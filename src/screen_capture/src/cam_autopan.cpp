@@ -0,0 +1,119 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_autopan.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// the viewport covers this part of the remaining distance per second, until max speed is reached.
+constexpr double follow_rate = 4.0;
+
+static auto get_viewport_size(const cam::size<int> &frame_size, const cam_autopan_config &config)
+    -> cam::size<int>
+{
+    if (frame_size.width() <= 0 || frame_size.height() <= 0)
+        throw std::invalid_argument("cam_autopan: invalid frame size");
+
+    if (config.viewport_size.width() <= 0 || config.viewport_size.height() <= 0)
+        throw std::invalid_argument("cam_autopan: invalid viewport size");
+
+    return cam::size<int>(std::min(config.viewport_size.width(), frame_size.width()),
+        std::min(config.viewport_size.height(), frame_size.height()));
+}
+
+cam_autopan::cam_autopan(const cam::size<int> &frame_size, const cam_autopan_config &config)
+    : frame_size_(frame_size)
+    , viewport_size_(get_viewport_size(frame_size, config))
+    , config_(config)
+    , scaler_(viewport_size_, config.output_size, config.filter)
+{
+    config_.margin = std::clamp(config_.margin, 0.0, 0.5);
+    output_.resize(static_cast<size_t>(get_output_stride()) * config.output_size.height());
+}
+
+void cam_autopan::update(const point<int> &cursor, const double frame_delta) noexcept
+{
+    if (!center_)
+    {
+        center_ = _clamp_center(cursor.x(), cursor.y());
+        return;
+    }
+
+    const auto target = _get_target(cursor);
+    const auto dx = target.x() - center_->x();
+    const auto dy = target.y() - center_->y();
+    const auto distance = std::sqrt(dx * dx + dy * dy);
+    if (distance < 0.5)
+        return;
+
+    /* ease out, and never faster than max speed */
+    const auto speed = std::min(distance * follow_rate, config_.max_speed);
+    const auto step = std::min(speed * frame_delta, distance);
+    center_ = _clamp_center(center_->x() + dx / distance * step, center_->y() + dy / distance * step);
+}
+
+void cam_autopan::render(const uint8_t *frame_data, const int frame_stride)
+{
+    const auto viewport = get_viewport();
+    const auto *viewport_data = frame_data + static_cast<ptrdiff_t>(viewport.top()) * frame_stride
+        + static_cast<ptrdiff_t>(viewport.left()) * 4;
+    scaler_.scale(viewport_data, frame_stride, output_.data(), get_output_stride());
+}
+
+auto cam_autopan::get_viewport() const noexcept -> cam::rect<int>
+{
+    const auto center = center_.value_or(point<double>(frame_size_.width() / 2.0, frame_size_.height() / 2.0));
+    const auto left = std::clamp(static_cast<int>(std::lround(center.x() - viewport_size_.width() / 2.0)), 0,
+        frame_size_.width() - viewport_size_.width());
+    const auto top = std::clamp(static_cast<int>(std::lround(center.y() - viewport_size_.height() / 2.0)), 0,
+        frame_size_.height() - viewport_size_.height());
+    return cam::rect<int>(left, top, left + viewport_size_.width(), top + viewport_size_.height());
+}
+
+auto cam_autopan::get_output_data() const noexcept -> const uint8_t *
+{
+    return output_.data();
+}
+
+auto cam_autopan::get_output_size() const noexcept -> const cam::size<int> &
+{
+    return scaler_.get_dst_size();
+}
+
+auto cam_autopan::get_output_stride() const noexcept -> int
+{
+    return scaler_.get_dst_size().width() * 4;
+}
+
+auto cam_autopan::_clamp_center(const double x, const double y) const noexcept -> point<double>
+{
+    const auto half_width = viewport_size_.width() / 2.0;
+    const auto half_height = viewport_size_.height() / 2.0;
+    return point<double>(std::clamp(x, half_width, frame_size_.width() - half_width),
+        std::clamp(y, half_height, frame_size_.height() - half_height));
+}
+
+auto cam_autopan::_get_target(const point<int> &cursor) const noexcept -> point<double>
+{
+    /* the smallest move of the viewport that brings the cursor back into its center region */
+    const auto free_x = viewport_size_.width() * (0.5 - config_.margin);
+    const auto free_y = viewport_size_.height() * (0.5 - config_.margin);
+    const auto x = std::clamp(center_->x(), cursor.x() - free_x, cursor.x() + free_x);
+    const auto y = std::clamp(center_->y(), cursor.y() - free_y, cursor.y() + free_y);
+    return _clamp_center(x, y);
+}
@@ -0,0 +1,247 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_blend.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CAM_BLEND_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+/* msvc allows avx2 intrinsics without /arch:AVX2, gcc and clang need the target attribute. */
+#if defined(CAM_BLEND_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CAM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CAM_TARGET_AVX2
+#endif
+
+namespace cam
+{
+
+namespace detail
+{
+/* x * (255 - a) / 255, with rounding. */
+static inline uint32_t blend_channel(const uint32_t dst, const uint32_t src, const uint32_t inv_alpha) noexcept
+{
+    const auto t = dst * inv_alpha + 128;
+    const auto value = src + ((t + (t >> 8)) >> 8);
+    return value > 255 ? 255 : value;
+}
+
+#if defined(CAM_BLEND_X86)
+/* blend 2 (unpacked to 16 bit) pixels. */
+static inline __m128i blend_unpacked_sse2(const __m128i dst, const __m128i src) noexcept
+{
+    const auto inv_alpha_mask = _mm_set1_epi16(0xff);
+    const auto rounding = _mm_set1_epi16(128);
+
+    auto alpha = _mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+    const auto inv_alpha = _mm_xor_si128(alpha, inv_alpha_mask);
+
+    auto t = _mm_add_epi16(_mm_mullo_epi16(dst, inv_alpha), rounding);
+    t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    return t;
+}
+
+CAM_TARGET_AVX2
+static inline __m256i blend_unpacked_avx2(const __m256i dst, const __m256i src) noexcept
+{
+    const auto inv_alpha_mask = _mm256_set1_epi16(0xff);
+    const auto rounding = _mm256_set1_epi16(128);
+
+    auto alpha = _mm256_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+    const auto inv_alpha = _mm256_xor_si256(alpha, inv_alpha_mask);
+
+    auto t = _mm256_add_epi16(_mm256_mullo_epi16(dst, inv_alpha), rounding);
+    t = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    return t;
+}
+#endif
+} // namespace detail
+
+void blend_row_scalar(uint32_t *dst, const uint32_t *src, int count) noexcept
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const auto s = src[i];
+        const auto src_alpha = s >> 24;
+
+        /* fully transparent and fully opaque pixels are the common case in sprites. */
+        if (s == 0)
+            continue;
+
+        if (src_alpha == 255)
+        {
+            dst[i] = s;
+            continue;
+        }
+
+        const auto d = dst[i];
+        const auto inv_alpha = 255 - src_alpha;
+        uint32_t result = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            const auto channel = detail::blend_channel((d >> shift) & 0xff, (s >> shift) & 0xff, inv_alpha);
+            result |= channel << shift;
+        }
+        dst[i] = result;
+    }
+}
+
+#if defined(CAM_BLEND_X86)
+void blend_row_sse2(uint32_t *dst, const uint32_t *src, int count) noexcept
+{
+    const auto zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+        const auto lo = detail::blend_unpacked_sse2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+        const auto hi = detail::blend_unpacked_sse2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+
+        const auto result = _mm_adds_epu8(_mm_packus_epi16(lo, hi), s);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), result);
+    }
+
+    blend_row_scalar(dst + i, src + i, count - i);
+}
+
+CAM_TARGET_AVX2
+void blend_row_avx2(uint32_t *dst, const uint32_t *src, int count) noexcept
+{
+    const auto zero = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+
+        /* unpack and pack both work per 128 bit lane, so the pixel order is preserved. */
+        const auto lo = detail::blend_unpacked_avx2(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero));
+        const auto hi = detail::blend_unpacked_avx2(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero));
+
+        const auto result = _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), s);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), result);
+    }
+
+    blend_row_sse2(dst + i, src + i, count - i);
+}
+
+static bool has_avx2() noexcept
+{
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    const bool has_avx = (info[2] & (1 << 28)) != 0;
+    if (!has_osxsave || !has_avx)
+        return false;
+
+    /* the os must save the ymm registers. */
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#else
+void blend_row_sse2(uint32_t *dst, const uint32_t *src, int count) noexcept
+{
+    blend_row_scalar(dst, src, count);
+}
+
+void blend_row_avx2(uint32_t *dst, const uint32_t *src, int count) noexcept
+{
+    blend_row_scalar(dst, src, count);
+}
+
+static bool has_avx2() noexcept
+{
+    return false;
+}
+#endif
+
+bool is_blend_kernel_supported(const blend_kernel kernel) noexcept
+{
+    switch (kernel)
+    {
+    case blend_kernel::scalar:
+        return true;
+    case blend_kernel::sse2:
+#if defined(CAM_BLEND_X86)
+        return true;
+#else
+        return false;
+#endif
+    case blend_kernel::avx2:
+        return has_avx2();
+    }
+    return false;
+}
+
+auto get_best_blend_kernel() noexcept -> blend_kernel
+{
+    static const auto best_kernel = []() {
+        if (is_blend_kernel_supported(blend_kernel::avx2))
+            return blend_kernel::avx2;
+        if (is_blend_kernel_supported(blend_kernel::sse2))
+            return blend_kernel::sse2;
+        return blend_kernel::scalar;
+    }();
+    return best_kernel;
+}
+
+auto get_blend_row_function(const blend_kernel kernel) noexcept -> blend_row_function
+{
+    switch (kernel)
+    {
+    case blend_kernel::sse2:
+        return blend_row_sse2;
+    case blend_kernel::avx2:
+        return blend_row_avx2;
+    case blend_kernel::scalar:
+        break;
+    }
+    return blend_row_scalar;
+}
+
+void blend_row(uint32_t *dst, const uint32_t *src, int count) noexcept
+{
+    static const auto blend_function = get_blend_row_function(get_best_blend_kernel());
+    blend_function(dst, src, count);
+}
+
+} // namespace cam
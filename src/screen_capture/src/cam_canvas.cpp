@@ -0,0 +1,110 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_canvas.h"
+#include "screen_capture/cam_sprite.h"
+#include "screen_capture/cam_blend.h"
+#include <algorithm>
+#include <cstddef>
+
+cam_canvas::cam_canvas(uint8_t *data, const int width, const int height, const int stride) noexcept
+    : data_(data)
+    , width_(width)
+    , height_(height)
+    , stride_(stride)
+{
+}
+
+void cam_canvas::draw_sprite(const cam_sprite_view &sprite, const point<int> &position) noexcept
+{
+    const auto left = std::max(position.x(), 0);
+    const auto top = std::max(position.y(), 0);
+    const auto right = std::min(position.x() + sprite.width, width_);
+    const auto bottom = std::min(position.y() + sprite.height, height_);
+    if (left >= right || top >= bottom)
+        return;
+
+    const auto count = right - left;
+    const auto sprite_x = left - position.x();
+    for (int y = top; y < bottom; ++y)
+    {
+        const auto *src = sprite.row(y - position.y()) + sprite_x;
+        cam::blend_row(row(y) + left, src, count);
+    }
+
+    if (dirty_rect_.empty())
+    {
+        dirty_rect_ = cam::rect<int>(left, top, right, bottom);
+    }
+    else
+    {
+        dirty_rect_.left(std::min(dirty_rect_.left(), left));
+        dirty_rect_.top(std::min(dirty_rect_.top(), top));
+        dirty_rect_.right(std::max(dirty_rect_.right(), right));
+        dirty_rect_.bottom(std::max(dirty_rect_.bottom(), bottom));
+    }
+}
+
+void cam_canvas::draw_sprite(const cam_sprite &sprite, const point<int> &position) noexcept
+{
+    draw_sprite(sprite.view(), position);
+}
+
+void cam_canvas::draw_sprite_centered(const cam_sprite_view &sprite, const point<int> &center) noexcept
+{
+    draw_sprite(sprite, point<int>(center.x() - sprite.width / 2, center.y() - sprite.height / 2));
+}
+
+void cam_canvas::draw_sprite_centered(const cam_sprite &sprite, const point<int> &center) noexcept
+{
+    draw_sprite_centered(sprite.view(), center);
+}
+
+int cam_canvas::width() const noexcept
+{
+    return width_;
+}
+
+int cam_canvas::height() const noexcept
+{
+    return height_;
+}
+
+int cam_canvas::stride() const noexcept
+{
+    return stride_;
+}
+
+auto cam_canvas::data() noexcept -> uint8_t *
+{
+    return data_;
+}
+
+auto cam_canvas::row(const int y) noexcept -> uint32_t *
+{
+    return reinterpret_cast<uint32_t *>(data_ + static_cast<ptrdiff_t>(y) * stride_);
+}
+
+auto cam_canvas::get_dirty_rect() const noexcept -> const cam::rect<int> &
+{
+    return dirty_rect_;
+}
+
+void cam_canvas::reset_dirty_rect() noexcept
+{
+    dirty_rect_ = {};
+}
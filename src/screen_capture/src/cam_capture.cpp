@@ -19,17 +19,23 @@
 #include "screen_capture/cam_size.h"
 #include "screen_capture/cam_draw_data.h"
 #include "screen_capture/cam_stop_watch.h"
-#include "screen_capture/cam_gdiplus.h"
+#include "screen_capture/cam_canvas.h"
+#include "screen_capture/cam_dxgi_capture.h"
+#include "screen_capture/cam_input_stream.h"
 #include "screen_capture/annotations/cam_annotation_cursor.h"
 #include "screen_capture/annotations/cam_annotation_systemtime.h"
 #include <cam_hook/cam_hook.h>
+#include <algorithm>
 #include <memory>
+#include <future>
+#include <stdexcept>
 #include <cassert>
+#include <cstring>
 #include <ctime>
 
 constexpr auto CAPTURE_BPP = 32;
 
-cam_capture_source::cam_capture_source(HWND hwnd, const cam::rect<int> & /*view*/)
+cam_capture_source::cam_capture_source(HWND hwnd, const cam::rect<int> &view)
     : bitmap_info_{}
     , bitmap_frame_{nullptr}
     , hwnd_{hwnd}
@@ -42,7 +48,9 @@ cam_capture_source::cam_capture_source(HWND hwnd, const cam::rect<int> & /*view*
 {
     if (hwnd == nullptr)
     {
-        src_rect_ = virtual_screen_info_.size;
+        /* only allocate the region we capture, not the entire virtual screen */
+        src_rect_ = view.empty() ? virtual_screen_info_.size : view;
+        monitors_ = cam::get_monitor_rects();
     }
     else
     {
@@ -56,39 +64,103 @@ cam_capture_source::cam_capture_source(HWND hwnd, const cam::rect<int> & /*view*
         src_rect_.bottom_ = window_rect.bottom;
     }
 
-    bitmap_info_.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bitmap_info_.bmiHeader.biWidth = src_rect_.width();
-    bitmap_info_.bmiHeader.biHeight = -src_rect_.height();
-    bitmap_info_.bmiHeader.biPlanes = 1;
-    bitmap_info_.bmiHeader.biBitCount = CAPTURE_BPP;
-    bitmap_info_.bmiHeader.biCompression = BI_RGB;
-
-    bitmap_frame_ = ::CreateDIBSection(desktop_dc_, &bitmap_info_, DIB_RGB_COLORS,
-        reinterpret_cast<void **>(&bitmap_data_), nullptr, 0);
-
-    /* \todo handle CreateDIBSection failure */
-    assert(bitmap_frame_);
-
-    frame_.bitmap_info = &bitmap_info_;
-    frame_.bitmap_data = bitmap_data_;
+    _create_frame_bitmap(src_rect_.size());
 
     stopwatch_->time_start();
 }
 
 cam_capture_source::~cam_capture_source()
 {
+    _release_copy_targets();
+    _release_frame_bitmap();
     ::DeleteDC(memory_dc_);
     ::ReleaseDC(hwnd_, desktop_dc_);
 }
 
+void cam_capture_source::enable_window_tracking(const cam_fit_mode fit_mode)
+{
+    assert(hwnd_ != nullptr && "window tracking needs a window");
+
+    RECT client_rect = {};
+    ::GetClientRect(hwnd_, &client_rect);
+
+    /* the output is the initial window size, even sized for yuv420 encoders. The capture buffer
+     * is allocated once at the size of the virtual screen, a window can grow up to that size. */
+    const auto output_size = cam::size<int>(
+        std::max((client_rect.right + 1) & ~1, 2),
+        std::max((client_rect.bottom + 1) & ~1, 2));
+
+    cam_window_tracker_config config;
+    config.output_size = output_size;
+    config.max_size = cam::size<int>(
+        std::max(virtual_screen_info_.size.width(), output_size.width()),
+        std::max(virtual_screen_info_.size.height(), output_size.height()));
+    config.fit_mode = fit_mode;
+
+    window_tracker_ = std::make_unique<cam_window_tracker>(config);
+    src_rect_ = cam::rect<int>(point<int>(0, 0), config.max_size);
+    _create_frame_bitmap(config.max_size);
+}
+
+bool cam_capture_source::enable_desktop_duplication()
+{
+    assert(hwnd_ == nullptr && "desktop duplication can only capture the desktop");
+    if (hwnd_ != nullptr)
+        return false;
+
+    desktop_duplication_ = true;
+    return _update_desktop_duplication(src_rect_);
+}
+
 bool cam_capture_source::capture_frame(const cam::rect<int> &capture_rect)
 {
+    const auto timestamp = cam::get_frame_time();
+
+    /* the cursor is read once per frame, the cursor annotation draws it from the frame */
+    _read_cursor_state();
+    if (!_capture_frame(capture_rect))
+        return false;
+
+    ++frame_.sequence;
+    frame_.timestamp = timestamp;
+    _update_cursor_position();
+    return true;
+}
+
+bool cam_capture_source::_capture_frame(const cam::rect<int> &capture_rect)
+{
+    if (window_tracker_)
+        return _capture_tracked_window();
+
+    if (desktop_duplication_ && !capture_rect.empty() && _capture_desktop_duplication(capture_rect))
+    {
+        captured_rect_ = capture_rect;
+        _read_input(capture_rect);
+        _draw_annotations(capture_rect);
+        return true;
+    }
+
+    /* gdi does not know what changed */
+    frame_.damage.reset(false);
+
+    assert(capture_rect.width() <= src_rect_.width() && capture_rect.height() <= src_rect_.height());
+
     old_selected_bitmap_ = ::SelectObject(memory_dc_, bitmap_frame_);
-    const auto ret = ::BitBlt(memory_dc_, 0, 0,
-        capture_rect.width(), capture_rect.height(),
-        desktop_dc_,
-        capture_rect.left(), capture_rect.top(),
-        SRCCOPY | CAPTUREBLT);
+
+    BOOL ret = FALSE;
+    if (hwnd_ == nullptr && !capture_rect.empty())
+    {
+        _update_capture_plan(capture_rect);
+        ret = _copy_capture_plan();
+    }
+    else
+    {
+        ret = ::BitBlt(memory_dc_, 0, 0,
+            capture_rect.width(), capture_rect.height(),
+            desktop_dc_,
+            capture_rect.left(), capture_rect.top(),
+            SRCCOPY | CAPTUREBLT);
+    }
 
     assert(ret);
     if (!ret)
@@ -99,6 +171,7 @@ bool cam_capture_source::capture_frame(const cam::rect<int> &capture_rect)
 
     captured_rect_ = capture_rect;
 
+    _read_input(capture_rect);
     _draw_annotations(capture_rect);
 
     ::SelectObject(memory_dc_, old_selected_bitmap_);
@@ -108,12 +181,29 @@ bool cam_capture_source::capture_frame(const cam::rect<int> &capture_rect)
 
 const cam_frame *cam_capture_source::get_frame()
 {
+    if (window_tracker_)
+    {
+        /* the tracked window is scaled into the output */
+        const auto &output_size = window_tracker_->get_output_size();
+        frame_.bitmap_data = const_cast<unsigned char *>(window_tracker_->get_output_data());
+        frame_.width = output_size.width();
+        frame_.height = output_size.height();
+        frame_.stride = window_tracker_->get_output_stride();
+        return &frame_;
+    }
+
     frame_.width = captured_rect_.width();
     frame_.height = captured_rect_.height();
     frame_.stride = src_rect_.width() * (CAPTURE_BPP / 8);
     return &frame_;
 }
 
+auto cam_capture_source::get_native_pixel_formats() const -> std::vector<cam_pixel_format>
+{
+    /* both the gdi dib section and desktop duplication are 32 bit, the 4th byte is not used */
+    return {cam_pixel_format::bgr0};
+}
+
 void cam_capture_source::enable_annotations()
 {
     enable_annotations_ = true;
@@ -124,6 +214,96 @@ void cam_capture_source::add_annotation(std::unique_ptr<cam_iannotation> annotat
     annotations_.emplace_back(std::move(annotation));
 }
 
+void cam_capture_source::enable_input_recording()
+{
+    input_stream_ = std::make_unique<cam_input_stream_writer>();
+    input_start_tick_ = ::GetTickCount();
+    last_recorded_mouse_position_.reset();
+}
+
+auto cam_capture_source::get_input_stream() const noexcept -> const cam_input_stream_writer *
+{
+    return input_stream_.get();
+}
+
+auto cam_capture_source::get_mouse_position() const noexcept -> point<int>
+{
+    return _to_frame_position(mouse_point_, captured_rect_);
+}
+
+void cam_capture_source::_read_input(const cam::rect<int> &capture_rect)
+{
+    const auto draw_annotations = enable_annotations_ && !annotations_.empty();
+    if (!draw_annotations && input_stream_ == nullptr)
+        return;
+
+    /* read together with the cursor state of the frame */
+    mouse_point_ = cursor_point_;
+
+    const auto mouse_event_count = mouse_hook::get().get_mouse_events_count();
+    if (mouse_event_count > 0)
+    {
+        mouse_events_.resize(mouse_event_count);
+        const auto copied = mouse_hook::get().get_mouse_events(&mouse_events_[0], mouse_event_count);
+        mouse_events_.resize(copied);
+    }
+
+    frame_delta_ = stopwatch_->time_since();
+    stopwatch_->time_start();
+
+    /* the hook events are stamped with the tick count (ms) */
+    const auto now_tick = ::GetTickCount();
+
+    mouse_status_ = 0;
+    input_events_.clear();
+    for (const auto &mouse_event : mouse_events_)
+    {
+        auto button = cam_mouse_button::none;
+        auto button_down = cam_mouse_button::none;
+        switch (mouse_event.dwExtraInfo)
+        {
+        case WM_LBUTTONDOWN: button = cam_mouse_button::left_button_down; button_down = button; break;
+        case WM_LBUTTONUP:   button = cam_mouse_button::left_button_up; button_down = cam_mouse_button::left_button_down; break;
+        case WM_RBUTTONDOWN: button = cam_mouse_button::right_button_down; button_down = button; break;
+        case WM_RBUTTONUP:   button = cam_mouse_button::right_button_up; button_down = cam_mouse_button::right_button_down; break;
+        case WM_MBUTTONDOWN: button = cam_mouse_button::middle_button_down; button_down = button; break;
+        case WM_MBUTTONUP:   button = cam_mouse_button::middle_button_up; button_down = cam_mouse_button::middle_button_down; break;
+        }
+
+        if (button == cam_mouse_button::none)
+            continue;
+
+        mouse_status_ |= button;
+
+        /* events from before the previous frame (a.e. the first frame) are clamped to its start */
+        const auto position = _translate_from_virtual(mouse_event.pt);
+        const auto age = static_cast<DWORD>(now_tick - mouse_event.time) / 1000.0;
+        const auto time = std::clamp(frame_delta_ - age, 0.0, frame_delta_);
+        input_events_.push_back({time, position, button});
+
+        if (input_stream_)
+        {
+            const auto type = button == button_down
+                ? cam_input_record_type::mouse_button_down
+                : cam_input_record_type::mouse_button_up;
+            input_stream_->write({_get_input_time(mouse_event.time), type,
+                _to_frame_position(position, capture_rect), button_down});
+        }
+    }
+    mouse_events_.clear();
+
+    /* the cursor position is sampled once per frame, and only stored when it moved */
+    if (input_stream_)
+    {
+        const auto position = _to_frame_position(mouse_point_, capture_rect);
+        if (!last_recorded_mouse_position_ || !(*last_recorded_mouse_position_ == position))
+        {
+            input_stream_->write({_get_input_time(now_tick), cam_input_record_type::mouse_move, position, 0});
+            last_recorded_mouse_position_ = position;
+        }
+    }
+}
+
 void cam_capture_source::_draw_annotations(const cam::rect<int> &capture_rect)
 {
     if (!enable_annotations_)
@@ -131,46 +311,267 @@ void cam_capture_source::_draw_annotations(const cam::rect<int> &capture_rect)
     if (annotations_.empty())
         return;
 
+    /* make sure gdi is done with the dib section, before we draw into it ourselves. */
+    ::GdiFlush();
+    cam_canvas canvas(bitmap_data_, capture_rect.width(), capture_rect.height(),
+        src_rect_.width() * (CAPTURE_BPP / 8));
+
+    cam_draw_data draw_data(frame_delta_, capture_rect, mouse_point_,
+        static_cast<cam_mouse_button::type>(mouse_status_), input_events_, frame_.cursor);
+
+    for (const auto &annotation : annotations_)
+        annotation->draw(canvas, draw_data);
+
+    /* the annotations (a.e. the cursor) change the frame outside of the desktop damage */
+    annotation_damage_.update(canvas, frame_.damage);
+}
+
+void cam_capture_source::_read_cursor_state()
+{
+    CURSORINFO cursor_info = {};
+    cursor_info.cbSize = sizeof(CURSORINFO);
+    if (!::GetCursorInfo(&cursor_info))
     {
-        POINT pt;
-        ::GetCursorPos(&pt);
-        const auto mouse_point = _translate_from_virtual(pt);
+        frame_.cursor = {};
+        cursor_point_ = {};
+        return;
+    }
 
-        Gdiplus::Graphics canvas(memory_dc_);
-        canvas.SetSmoothingMode(Gdiplus::SmoothingMode::SmoothingModeAntiAlias);
+    frame_.cursor.visible = (cursor_info.flags & CURSOR_SHOWING) != 0;
+    frame_.cursor.shape_id = reinterpret_cast<uintptr_t>(cursor_info.hCursor);
+    cursor_point_ = _translate_from_virtual(cursor_info.ptScreenPos);
+}
 
-        const auto mouse_event_count = mouse_hook::get().get_mouse_events_count();
-        if (mouse_event_count > 0)
+void cam_capture_source::_update_cursor_position()
+{
+    auto position = _to_frame_position(cursor_point_, captured_rect_);
+    if (window_tracker_)
+    {
+        /* the tracked window is scaled into the content rect of the output */
+        const auto &capture_size = window_tracker_->get_capture_size();
+        const auto &content_rect = window_tracker_->get_content_rect();
+        if (capture_size.width() > 0 && capture_size.height() > 0)
         {
-            mouse_events_.resize(mouse_event_count);
-            mouse_hook::get().get_mouse_events(&mouse_events_[0], mouse_event_count);
+            position = point<int>(
+                content_rect.left() + position.x() * content_rect.width() / capture_size.width(),
+                content_rect.top() + position.y() * content_rect.height() / capture_size.height());
         }
+    }
+
+    frame_.cursor.position = position;
+}
+
+bool cam_capture_source::_capture_tracked_window()
+{
+    RECT client_rect = {};
+    if (!::GetClientRect(hwnd_, &client_rect))
+        return false;
+
+    POINT client_origin = {0, 0};
+    ::ClientToScreen(hwnd_, &client_origin);
+
+    frame_.damage.reset(false);
+
+    /* a resize only changes the used part of the capture buffer, and the scale to the output */
+    window_tracker_->update({client_rect.right, client_rect.bottom});
+    const auto &capture_size = window_tracker_->get_capture_size();
 
-        unsigned int mouse_status = 0;
-        if (!mouse_events_.empty())
+    old_selected_bitmap_ = ::SelectObject(memory_dc_, bitmap_frame_);
+    if (capture_size.width() > 0 && capture_size.height() > 0)
+    {
+        const auto ret = ::BitBlt(memory_dc_, 0, 0, capture_size.width(), capture_size.height(),
+            desktop_dc_, 0, 0, SRCCOPY | CAPTUREBLT);
+        if (!ret)
         {
-            for (const auto &mouse_event : mouse_events_)
-            {
-                switch (mouse_event.dwExtraInfo)
-                {
-                case WM_LBUTTONDOWN: mouse_status |= cam_mouse_button::left_button_down; break;
-                case WM_LBUTTONUP:   mouse_status |= cam_mouse_button::left_button_up; break;
-                case WM_RBUTTONDOWN: mouse_status |= cam_mouse_button::right_button_down; break;
-                case WM_RBUTTONUP:   mouse_status |= cam_mouse_button::right_button_up; break;
-                case WM_MBUTTONDOWN: mouse_status |= cam_mouse_button::middle_button_down; break;
-                case WM_MBUTTONUP:   mouse_status |= cam_mouse_button::middle_button_up; break;
-                }
-            }
+            ::SelectObject(memory_dc_, old_selected_bitmap_);
+            return false;
         }
-        mouse_events_.clear();
+    }
+
+    /* the captured rect is in the same space as the mouse input */
+    captured_rect_ = cam::rect<int>(_translate_from_virtual(client_origin), capture_size);
+
+    _read_input(captured_rect_);
+    _draw_annotations(captured_rect_);
+
+    ::SelectObject(memory_dc_, old_selected_bitmap_);
+
+    ::GdiFlush();
+    window_tracker_->render(bitmap_data_, src_rect_.width() * (CAPTURE_BPP / 8));
+    return true;
+}
+
+void cam_capture_source::_create_frame_bitmap(const cam::size<int> &size)
+{
+    _release_frame_bitmap();
+
+    bitmap_info_ = {};
+    bitmap_info_.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bitmap_info_.bmiHeader.biWidth = size.width();
+    bitmap_info_.bmiHeader.biHeight = -size.height();
+    bitmap_info_.bmiHeader.biPlanes = 1;
+    bitmap_info_.bmiHeader.biBitCount = CAPTURE_BPP;
+    bitmap_info_.bmiHeader.biCompression = BI_RGB;
 
-        double dt = stopwatch_->time_since();
-        stopwatch_->time_start();
-        cam_draw_data draw_data(dt, capture_rect, mouse_point, static_cast<cam_mouse_button::type>(mouse_status));
+    /* the frame lives in a section, so copies of a capture plan can map their own view on it */
+    const auto frame_size = static_cast<DWORD>(size.width()) * (CAPTURE_BPP / 8) * size.height();
+    frame_section_ = ::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, frame_size, nullptr);
+    assert(frame_section_);
 
-        for (const auto &annotation : annotations_)
-            annotation->draw(canvas, draw_data);
+    bitmap_frame_ = ::CreateDIBSection(desktop_dc_, &bitmap_info_, DIB_RGB_COLORS,
+        reinterpret_cast<void **>(&bitmap_data_), frame_section_, 0);
+
+    /* \todo handle CreateDIBSection failure */
+    assert(bitmap_frame_);
+
+    frame_.bitmap_data = bitmap_data_;
+    annotation_damage_.reset();
+}
+
+void cam_capture_source::_release_frame_bitmap() noexcept
+{
+    if (bitmap_frame_)
+        ::DeleteObject(bitmap_frame_);
+    if (frame_section_)
+        ::CloseHandle(frame_section_);
+
+    bitmap_frame_ = nullptr;
+    frame_section_ = nullptr;
+    bitmap_data_ = nullptr;
+}
+
+void cam_capture_source::_update_capture_plan(const cam::rect<int> &capture_rect)
+{
+    if (capture_plan_ && capture_plan_->capture_rect == capture_rect)
+        return;
+
+    _release_copy_targets();
+    capture_plan_ = cam_create_capture_plan(capture_rect, monitors_);
+
+    /* a single copy is done directly into the frame, on the capture thread. */
+    if (capture_plan_->copies.size() < 2)
+        return;
+
+    const auto stride = src_rect_.width() * (CAPTURE_BPP / 8);
+    for (const auto &copy : capture_plan_->copies)
+    {
+        /* every copy gets a view on the frame rows it covers, at full frame width */
+        auto view_info = bitmap_info_;
+        view_info.bmiHeader.biHeight = -copy.src.height();
+
+        copy_target target;
+        target.screen_dc = ::CreateDCW(L"DISPLAY", nullptr, nullptr, nullptr);
+        target.memory_dc = ::CreateCompatibleDC(target.screen_dc);
+        void *view_data = nullptr;
+        target.bitmap = ::CreateDIBSection(target.screen_dc, &view_info, DIB_RGB_COLORS, &view_data,
+            frame_section_, static_cast<DWORD>(copy.dst.y() * stride));
+        assert(target.bitmap);
+        target.old_bitmap = ::SelectObject(target.memory_dc, target.bitmap);
+        copy_targets_.push_back(target);
+    }
+}
+
+auto cam_capture_source::_copy_capture_plan() -> bool
+{
+    const auto &plan = *capture_plan_;
+    if (!plan.fully_covered)
+    {
+        /* parts of the region are not on any monitor, these stay black */
+        ::GdiFlush();
+        std::memset(bitmap_data_, 0, static_cast<size_t>(src_rect_.width()) * (CAPTURE_BPP / 8) * src_rect_.height());
+    }
+
+    if (copy_targets_.empty())
+    {
+        if (plan.copies.empty())
+            return true;
+
+        const auto &copy = plan.copies.front();
+        return ::BitBlt(memory_dc_, copy.dst.x(), copy.dst.y(), copy.src.width(), copy.src.height(),
+            desktop_dc_, copy.src.left(), copy.src.top(), SRCCOPY | CAPTUREBLT) != 0;
     }
+
+    /* the region spans multiple monitors, copy them in parallel. Gdi batches per thread, so
+     * every copy flushes its own batch before we touch the frame. */
+    const auto copy_monitor = [&plan, this](size_t index) {
+        const auto &copy = plan.copies[index];
+        const auto &target = copy_targets_[index];
+        const auto ret = ::BitBlt(target.memory_dc, copy.dst.x(), 0, copy.src.width(), copy.src.height(),
+            target.screen_dc, copy.src.left(), copy.src.top(), SRCCOPY | CAPTUREBLT);
+        ::GdiFlush();
+        return ret != 0;
+    };
+
+    std::vector<std::future<bool>> copies;
+    for (auto i = 1u; i < plan.copies.size(); ++i)
+        copies.push_back(std::async(std::launch::async, copy_monitor, i));
+
+    auto result = copy_monitor(0);
+    for (auto &copy : copies)
+        result = copy.get() && result;
+
+    return result;
+}
+
+void cam_capture_source::_release_copy_targets() noexcept
+{
+    for (const auto &target : copy_targets_)
+    {
+        ::SelectObject(target.memory_dc, target.old_bitmap);
+        ::DeleteObject(target.bitmap);
+        ::DeleteDC(target.memory_dc);
+        ::DeleteDC(target.screen_dc);
+    }
+    copy_targets_.clear();
+}
+
+bool cam_capture_source::_update_desktop_duplication(const cam::rect<int> &capture_rect)
+{
+    if (dxgi_capture_ && dxgi_capture_->get_capture_rect() == capture_rect)
+        return true;
+
+    dxgi_capture_.reset();
+    try
+    {
+        dxgi_capture_ = std::make_unique<cam_dxgi_capture>(capture_rect);
+    }
+    catch (const std::runtime_error &)
+    {
+        desktop_duplication_ = false;
+        return false;
+    }
+    return true;
+}
+
+bool cam_capture_source::_capture_desktop_duplication(const cam::rect<int> &capture_rect)
+{
+    assert(capture_rect.width() <= src_rect_.width() && capture_rect.height() <= src_rect_.height());
+
+    if (!_update_desktop_duplication(capture_rect))
+        return false;
+
+    /* make sure gdi is done with the dib section, before we write into it ourselves. */
+    ::GdiFlush();
+    if (dxgi_capture_->capture_frame(bitmap_data_, src_rect_.width() * (CAPTURE_BPP / 8),
+            annotation_damage_.get_rect(), frame_.damage))
+        return true;
+
+    /* a.e. the secure desktop is shown, continue the recording with gdi */
+    dxgi_capture_.reset();
+    desktop_duplication_ = false;
+    return false;
+}
+
+auto cam_capture_source::_get_input_time(const DWORD tick) const noexcept -> int64_t
+{
+    /* the unsigned difference survives the tick count wrapping around */
+    return static_cast<int64_t>(static_cast<DWORD>(tick - input_start_tick_)) * 1000;
+}
+
+auto cam_capture_source::_to_frame_position(const point<int> &position, const cam::rect<int> &capture_rect) noexcept
+    -> point<int>
+{
+    return point<int>(position.x() - capture_rect.left(), position.y() - capture_rect.top());
 }
 
 auto cam_capture_source::_translate_from_virtual(const POINT &mouse_position) -> point<int>
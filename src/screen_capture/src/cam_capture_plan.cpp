@@ -0,0 +1,93 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_capture_plan.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace cam
+{
+
+/* check if the copies cover the whole rect. Monitors are allowed to overlap (a.e. cloned
+ * displays), so instead of summing areas we check every cell of the grid the copy edges span. */
+static auto is_covered(const cam::rect<int> &rect, const std::vector<cam_capture_copy> &copies) -> bool
+{
+    std::vector<int> x_edges{rect.left(), rect.right()};
+    std::vector<int> y_edges{rect.top(), rect.bottom()};
+    for (const auto &copy : copies)
+    {
+        x_edges.insert(x_edges.end(), {copy.src.left(), copy.src.right()});
+        y_edges.insert(y_edges.end(), {copy.src.top(), copy.src.bottom()});
+    }
+
+    const auto sort_unique = [](std::vector<int> &edges) {
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    };
+    sort_unique(x_edges);
+    sort_unique(y_edges);
+
+    for (auto y = 0u; y + 1 < y_edges.size(); ++y)
+    {
+        for (auto x = 0u; x + 1 < x_edges.size(); ++x)
+        {
+            const auto cell_x = x_edges[x];
+            const auto cell_y = y_edges[y];
+            const auto covered = std::any_of(copies.begin(), copies.end(), [cell_x, cell_y](const auto &copy) {
+                return cell_x >= copy.src.left() && cell_x < copy.src.right()
+                    && cell_y >= copy.src.top() && cell_y < copy.src.bottom();
+            });
+
+            if (!covered)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace cam
+
+auto cam_create_capture_plan(const cam::rect<int> &capture_rect, const std::vector<cam::rect<int>> &monitors)
+    -> cam_capture_plan
+{
+    if (capture_rect.width() <= 0 || capture_rect.height() <= 0)
+        throw std::invalid_argument("cam_create_capture_plan: empty capture rect");
+
+    cam_capture_plan plan;
+    plan.capture_rect = capture_rect;
+
+    for (auto i = 0u; i < monitors.size(); ++i)
+    {
+        const auto src = cam::intersect(capture_rect, monitors[i]);
+        if (src.width() <= 0 || src.height() <= 0)
+            continue;
+
+        /* mirrored monitors report the same rect, copying it once is enough. */
+        const auto duplicate = std::any_of(plan.copies.begin(), plan.copies.end(), [&src](const auto &copy) {
+            return cam::intersect(copy.src, src) == src;
+        });
+        if (duplicate)
+            continue;
+
+        const auto dst = point<int>(src.left() - capture_rect.left(), src.top() - capture_rect.top());
+        plan.copies.push_back({static_cast<int>(i), src, dst});
+    }
+
+    plan.fully_covered = cam::is_covered(capture_rect, plan.copies);
+    return plan;
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_click_rings.h"
+#include "screen_capture/cam_canvas.h"
+#include <cmath>
+
+/* the ring diameter grows with 20 pixels per second of lifetime */
+constexpr double ring_growth = 20.0;
+
+static auto get_ring_size(const double lifetime) noexcept -> int
+{
+    // \todo make sure that ring size is always 'odd'.
+    return static_cast<int>(std::round(lifetime * ring_growth));
+}
+
+void cam_click_rings::set_style(const cam_mouse_button::type button, const int max_size, const cam::color &color)
+{
+    auto &style = _get_style(button);
+    style.max_size = max_size;
+    style.color = color;
+}
+
+void cam_click_rings::add(const point<int> &center, const cam_mouse_button::type button, const double time) noexcept
+{
+    /* the ring grows the full frame delta when it is drawn, so a click later in the frame starts
+     * with a negative lifetime. */
+    cam_mouse_ring_state ring(center, button);
+    ring.lifetime_ = -time * ring_speed_;
+    rings_.push_back(ring);
+}
+
+void cam_click_rings::add(cam::span<const cam_input_event> input_events) noexcept
+{
+    for (const auto &input_event : input_events)
+    {
+        switch (input_event.button)
+        {
+        case cam_mouse_button::left_button_down:
+            [[fallthrough]];
+        case cam_mouse_button::right_button_down:
+            [[fallthrough]];
+        case cam_mouse_button::middle_button_down:
+            add(input_event.position, input_event.button, input_event.time);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void cam_click_rings::draw(cam_canvas &canvas, const point<int> &origin, const double frame_delta)
+{
+    for (std::size_t i = 0; i < rings_.size(); ++i)
+    {
+        auto &ring = rings_[i];
+        if (ring.alive_ && _draw_ring(canvas, origin, ring, frame_delta))
+            ring.alive_ = false;
+    }
+
+    /* rings expire mostly in the order they were created, a ring that outlives an older one is
+     * skipped until the rings in front of it are gone. */
+    while (!rings_.empty() && !rings_.front().alive_)
+        rings_.pop_front();
+}
+
+auto cam_click_rings::size() const noexcept -> std::size_t
+{
+    return rings_.size();
+}
+
+bool cam_click_rings::empty() const noexcept
+{
+    return rings_.empty();
+}
+
+void cam_click_rings::clear() noexcept
+{
+    rings_.clear();
+}
+
+auto cam_click_rings::get_ring_size(const std::size_t index) const noexcept -> int
+{
+    return ::get_ring_size(rings_[index].lifetime_);
+}
+
+auto cam_click_rings::get_ring(const std::size_t index) const noexcept -> const cam_mouse_ring_state &
+{
+    return rings_[index];
+}
+
+auto cam_click_rings::_get_style(const cam_mouse_button::type button) noexcept -> ring_style &
+{
+    switch (button)
+    {
+    case cam_mouse_button::right_button_down: return right_style_;
+    case cam_mouse_button::middle_button_down: return middle_style_;
+    default: break;
+    }
+    return left_style_;
+}
+
+bool cam_click_rings::_draw_ring(cam_canvas &canvas, const point<int> &origin, cam_mouse_ring_state &ring,
+                                 const double frame_delta)
+{
+    auto &style = _get_style(ring.ring_type_);
+
+    ring.lifetime_ += frame_delta * ring_speed_;
+    const auto ring_size = ::get_ring_size(ring.lifetime_);
+
+    // return true when this ring needs to be deleted.
+    if (ring_size > style.max_size)
+        return true;
+
+    /* the click happens after this frame */
+    if (ring_size < 0)
+        return false;
+
+    style.animation.update(style.max_size, style.color, ring_width_);
+    const auto center = point<int>(ring.ring_center_.x() - origin.x(), ring.ring_center_.y() - origin.y());
+    canvas.draw_sprite_centered(style.animation.get_frame(ring_size), center);
+
+    return false;
+}
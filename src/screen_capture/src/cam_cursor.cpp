@@ -0,0 +1,160 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_cursor.h"
+#include <algorithm>
+
+namespace cam
+{
+
+auto hash_bytes(const void *data, const size_t size, const uint64_t seed) noexcept -> uint64_t
+{
+    constexpr uint64_t fnv_prime = 0x100000001b3ull;
+
+    auto hash = seed;
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+static bool get_mask_bit(const uint8_t *mask, const int mask_stride, const int x, const int y) noexcept
+{
+    const auto byte = mask[static_cast<size_t>(y) * mask_stride + x / 8];
+    return (byte & (0x80 >> (x % 8))) != 0;
+}
+
+auto create_monochrome_cursor_sprite(const int width, const int height, const uint8_t *and_mask,
+    const uint8_t *xor_mask, const int mask_stride) -> cam_sprite
+{
+    constexpr uint32_t black = 0xff000000;
+    constexpr uint32_t white = 0xffffffff;
+
+    cam_sprite sprite(width, height);
+    for (int y = 0; y < sprite.height(); ++y)
+    {
+        auto *row = sprite.row(y);
+        for (int x = 0; x < sprite.width(); ++x)
+        {
+            const auto and_bit = get_mask_bit(and_mask, mask_stride, x, y);
+            const auto xor_bit = get_mask_bit(xor_mask, mask_stride, x, y);
+
+            if (!and_bit)
+                row[x] = xor_bit ? white : black;
+            else
+                row[x] = xor_bit ? black : 0;
+        }
+    }
+    return sprite;
+}
+
+auto create_color_cursor_sprite(const int width, const int height, const uint32_t *pixels,
+    const uint8_t *and_mask, const int mask_stride) -> cam_sprite
+{
+    const auto pixel_count = static_cast<size_t>(std::max(width, 0)) * std::max(height, 0);
+    const auto has_alpha = std::any_of(pixels, pixels + pixel_count, [](const uint32_t pixel) {
+        return (pixel >> 24) != 0;
+    });
+
+    cam_sprite sprite(width, height);
+    for (int y = 0; y < sprite.height(); ++y)
+    {
+        auto *row = sprite.row(y);
+        const auto *src = pixels + static_cast<size_t>(y) * width;
+        for (int x = 0; x < sprite.width(); ++x)
+        {
+            const auto pixel = src[x];
+            if (has_alpha)
+            {
+                row[x] = premultiply(cam::color(pixel));
+            }
+            else
+            {
+                const auto transparent = and_mask != nullptr && get_mask_bit(and_mask, mask_stride, x, y);
+                row[x] = transparent ? 0 : (pixel | 0xff000000);
+            }
+        }
+    }
+    return sprite;
+}
+
+} // namespace cam
+
+cam_cursor_cache::cam_cursor_cache(const size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1))
+{
+    entries_.reserve(capacity_);
+}
+
+auto cam_cursor_cache::find(const handle_type handle, const uint64_t shape_hash) noexcept -> const cam_cursor_image *
+{
+    for (auto &entry : entries_)
+    {
+        if (entry.handle == handle && entry.shape_hash == shape_hash)
+        {
+            entry.last_used = ++use_counter_;
+            ++hit_count_;
+            return &entry.image;
+        }
+    }
+    return nullptr;
+}
+
+void cam_cursor_cache::clear() noexcept
+{
+    entries_.clear();
+}
+
+auto cam_cursor_cache::size() const noexcept -> size_t
+{
+    return entries_.size();
+}
+
+auto cam_cursor_cache::capacity() const noexcept -> size_t
+{
+    return capacity_;
+}
+
+auto cam_cursor_cache::get_hit_count() const noexcept -> uint64_t
+{
+    return hit_count_;
+}
+
+auto cam_cursor_cache::get_miss_count() const noexcept -> uint64_t
+{
+    return miss_count_;
+}
+
+auto cam_cursor_cache::_insert(const handle_type handle, const uint64_t shape_hash, cam_cursor_image &&image)
+    -> const cam_cursor_image &
+{
+    if (entries_.size() < capacity_)
+    {
+        entries_.push_back({handle, shape_hash, ++use_counter_, std::move(image)});
+        return entries_.back().image;
+    }
+
+    auto lru = std::min_element(entries_.begin(), entries_.end(), [](const entry &lhs, const entry &rhs) {
+        return lhs.last_used < rhs.last_used;
+    });
+
+    *lru = {handle, shape_hash, ++use_counter_, std::move(image)};
+    return lru->image;
+}
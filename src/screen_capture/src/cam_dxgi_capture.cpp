@@ -0,0 +1,276 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_dxgi_capture.h"
+#include "screen_capture/cam_virtual_screen_info.h"
+#include <fmt/format.h>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+using Microsoft::WRL::ComPtr;
+
+// the duplicated desktop image is always B8G8R8A8.
+constexpr auto dxgi_pixel_size = 4;
+
+static auto to_rect(const RECT &rect, const int x_offset = 0, const int y_offset = 0) noexcept -> cam::rect<int>
+{
+    return {rect.left + x_offset, rect.top + y_offset, rect.right + x_offset, rect.bottom + y_offset};
+}
+
+cam_dxgi_capture::cam_dxgi_capture(const cam::rect<int> &capture_rect)
+    : capture_rect_(capture_rect)
+{
+    if (capture_rect.width() <= 0 || capture_rect.height() <= 0)
+        throw std::runtime_error("cam_dxgi_capture: empty capture rect");
+
+    if (const auto hr = ::D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, nullptr, 0,
+            D3D11_SDK_VERSION, &device_, nullptr, &context_); FAILED(hr))
+        throw std::runtime_error(fmt::format("cam_dxgi_capture: unable to create a d3d11 device: {:#x}",
+            static_cast<uint32_t>(hr)));
+
+    ComPtr<IDXGIDevice> dxgi_device;
+    ComPtr<IDXGIAdapter> adapter;
+    if (FAILED(device_.As(&dxgi_device)) || FAILED(dxgi_device->GetAdapter(&adapter)))
+        throw std::runtime_error("cam_dxgi_capture: unable to get the dxgi adapter");
+
+    std::vector<ComPtr<IDXGIOutput1>> adapter_outputs;
+    std::vector<cam::rect<int>> output_rects;
+    ComPtr<IDXGIOutput> output;
+    for (UINT i = 0; adapter->EnumOutputs(i, &output) != DXGI_ERROR_NOT_FOUND; ++i)
+    {
+        DXGI_OUTPUT_DESC desc = {};
+        ComPtr<IDXGIOutput1> output1;
+        if (SUCCEEDED(output->GetDesc(&desc)) && desc.AttachedToDesktop && SUCCEEDED(output.As(&output1)))
+        {
+            adapter_outputs.push_back(output1);
+            output_rects.push_back(to_rect(desc.DesktopCoordinates));
+        }
+        output.Reset();
+    }
+
+    /* the outputs of one adapter must cover the same part of the capture rect as all monitors do,
+     * otherwise part of the rect is on another adapter */
+    const auto plan = cam_create_capture_plan(capture_rect, output_rects);
+    const auto monitor_plan = cam_create_capture_plan(capture_rect, cam::get_monitor_rects());
+    if (plan.copies.size() != monitor_plan.copies.size() || plan.fully_covered != monitor_plan.fully_covered)
+        throw std::runtime_error("cam_dxgi_capture: the capture rect spans outputs of another adapter");
+
+    for (const auto &copy : plan.copies)
+    {
+        output_duplication duplication;
+        duplication.output = adapter_outputs.at(copy.monitor_index);
+        duplication.desktop_rect = output_rects.at(copy.monitor_index);
+        duplication.copy = copy;
+        _duplicate_output(duplication);
+        outputs_.push_back(std::move(duplication));
+    }
+
+    /* parts of the capture rect that are not on any output stay black */
+    image_.resize(static_cast<size_t>(capture_rect.width()) * capture_rect.height() * dxgi_pixel_size, 0);
+}
+
+cam_dxgi_capture::~cam_dxgi_capture() = default;
+
+bool cam_dxgi_capture::capture_frame(uint8_t *data, const int stride, const cam::rect<int> &restore_rect,
+    cam_frame_damage &damage)
+{
+    desktop_damage_.reset(true);
+
+    bool full_copy = false;
+    for (auto &output : outputs_)
+    {
+        if (!_update_output(output, full_copy))
+            return false;
+    }
+
+    cam::clip_damage(desktop_damage_, capture_rect_, damage);
+    if (full_copy || data != previous_data_)
+        damage.reset(false);
+    previous_data_ = data;
+
+    /* the annotations draw on the frame, the pixels they covered are restored from the clean image */
+    const auto image_stride = capture_rect_.width() * dxgi_pixel_size;
+    cam::copy_damaged(image_.data(), image_stride, data, stride, capture_rect_.size(), damage);
+    if (damage.valid)
+        cam::copy_rect(image_.data(), image_stride, data, stride, capture_rect_.size(), restore_rect);
+
+    return true;
+}
+
+auto cam_dxgi_capture::get_capture_rect() const noexcept -> const cam::rect<int> &
+{
+    return capture_rect_;
+}
+
+void cam_dxgi_capture::_duplicate_output(output_duplication &output)
+{
+    output.duplication.Reset();
+    output.staging.Reset();
+    output.needs_full_copy = true;
+
+    if (const auto hr = output.output->DuplicateOutput(device_.Get(), &output.duplication); FAILED(hr))
+        throw std::runtime_error(fmt::format("cam_dxgi_capture: unable to duplicate output: {:#x}",
+            static_cast<uint32_t>(hr)));
+
+    DXGI_OUTDUPL_DESC duplication_desc = {};
+    output.duplication->GetDesc(&duplication_desc);
+    if (duplication_desc.Rotation != DXGI_MODE_ROTATION_IDENTITY)
+        throw std::runtime_error("cam_dxgi_capture: rotated outputs are not supported");
+
+    D3D11_TEXTURE2D_DESC texture_desc = {};
+    texture_desc.Width = duplication_desc.ModeDesc.Width;
+    texture_desc.Height = duplication_desc.ModeDesc.Height;
+    texture_desc.MipLevels = 1;
+    texture_desc.ArraySize = 1;
+    texture_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    texture_desc.SampleDesc.Count = 1;
+    texture_desc.Usage = D3D11_USAGE_STAGING;
+    texture_desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    if (FAILED(device_->CreateTexture2D(&texture_desc, nullptr, &output.staging)))
+        throw std::runtime_error("cam_dxgi_capture: unable to create the staging texture");
+}
+
+bool cam_dxgi_capture::_update_output(output_duplication &output, bool &full_copy)
+{
+    DXGI_OUTDUPL_FRAME_INFO frame_info = {};
+    ComPtr<IDXGIResource> resource;
+    auto hr = output.duplication->AcquireNextFrame(0, &frame_info, &resource);
+
+    /* nothing changed on this output */
+    if (hr == DXGI_ERROR_WAIT_TIMEOUT)
+        return true;
+
+    /* a.e. a mode change or a switch to the secure desktop, duplicate the output again */
+    if (hr == DXGI_ERROR_ACCESS_LOST)
+    {
+        try
+        {
+            _duplicate_output(output);
+        }
+        catch (const std::runtime_error &)
+        {
+            return false;
+        }
+        full_copy = true;
+        return true;
+    }
+
+    if (FAILED(hr))
+        return false;
+
+    /* only the pointer changed, which is not part of the image */
+    if (frame_info.LastPresentTime.QuadPart == 0)
+    {
+        output.duplication->ReleaseFrame();
+        return true;
+    }
+
+    ComPtr<ID3D11Texture2D> texture;
+    if (FAILED(resource.As(&texture)))
+    {
+        output.duplication->ReleaseFrame();
+        return false;
+    }
+
+    context_->CopyResource(output.staging.Get(), texture.Get());
+
+    const auto first_dirty_rect = desktop_damage_.dirty_rects.size();
+    const auto first_move_rect = desktop_damage_.move_rects.size();
+    if (!output.needs_full_copy && !_read_metadata(output, frame_info))
+        output.needs_full_copy = true;
+
+    /* map before releasing the frame, so the copy is done before the desktop image is reused */
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    hr = context_->Map(output.staging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+    output.duplication->ReleaseFrame();
+    if (FAILED(hr))
+        return false;
+
+    if (output.needs_full_copy)
+    {
+        _copy_rect(mapped, output, output.copy.src);
+        output.needs_full_copy = false;
+        full_copy = true;
+    }
+    else
+    {
+        /* the staging texture holds the complete new image, so a move is just a changed rect */
+        for (auto i = first_dirty_rect; i < desktop_damage_.dirty_rects.size(); ++i)
+            _copy_rect(mapped, output, desktop_damage_.dirty_rects[i]);
+        for (auto i = first_move_rect; i < desktop_damage_.move_rects.size(); ++i)
+            _copy_rect(mapped, output, desktop_damage_.move_rects[i].dst);
+    }
+
+    context_->Unmap(output.staging.Get(), 0);
+    return true;
+}
+
+bool cam_dxgi_capture::_read_metadata(output_duplication &output, const DXGI_OUTDUPL_FRAME_INFO &frame_info)
+{
+    if (frame_info.TotalMetadataBufferSize == 0)
+        return true;
+
+    metadata_buffer_.resize(frame_info.TotalMetadataBufferSize);
+    const auto left = output.desktop_rect.left();
+    const auto top = output.desktop_rect.top();
+
+    UINT move_size = 0;
+    auto *move_rects = reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT *>(metadata_buffer_.data());
+    if (FAILED(output.duplication->GetFrameMoveRects(static_cast<UINT>(metadata_buffer_.size()), move_rects,
+            &move_size)))
+        return false;
+
+    UINT dirty_size = 0;
+    auto *dirty_rects = reinterpret_cast<RECT *>(metadata_buffer_.data() + move_size);
+    if (FAILED(output.duplication->GetFrameDirtyRects(static_cast<UINT>(metadata_buffer_.size() - move_size),
+            dirty_rects, &dirty_size)))
+        return false;
+
+    /* the metadata is in output coordinates */
+    for (UINT i = 0; i < move_size / sizeof(DXGI_OUTDUPL_MOVE_RECT); ++i)
+    {
+        const auto &move_rect = move_rects[i];
+        desktop_damage_.move_rects.push_back({
+            point<int>(move_rect.SourcePoint.x + left, move_rect.SourcePoint.y + top),
+            to_rect(move_rect.DestinationRect, left, top)});
+    }
+
+    for (UINT i = 0; i < dirty_size / sizeof(RECT); ++i)
+        desktop_damage_.dirty_rects.push_back(to_rect(dirty_rects[i], left, top));
+
+    return true;
+}
+
+void cam_dxgi_capture::_copy_rect(const D3D11_MAPPED_SUBRESOURCE &mapped, const output_duplication &output,
+    const cam::rect<int> &rect)
+{
+    const auto clipped = cam::intersect(rect, output.copy.src);
+    if (clipped.empty())
+        return;
+
+    const auto image_stride = static_cast<ptrdiff_t>(capture_rect_.width()) * dxgi_pixel_size;
+    const auto row_size = static_cast<size_t>(clipped.width()) * dxgi_pixel_size;
+    const auto *src = static_cast<const uint8_t *>(mapped.pData)
+        + static_cast<ptrdiff_t>(clipped.top() - output.desktop_rect.top()) * mapped.RowPitch
+        + static_cast<ptrdiff_t>(clipped.left() - output.desktop_rect.left()) * dxgi_pixel_size;
+    auto *dst = image_.data() + (clipped.top() - capture_rect_.top()) * image_stride
+        + static_cast<ptrdiff_t>(clipped.left() - capture_rect_.left()) * dxgi_pixel_size;
+
+    for (int y = 0; y < clipped.height(); ++y)
+        std::memcpy(dst + y * image_stride, src + static_cast<ptrdiff_t>(y) * mapped.RowPitch, row_size);
+}
@@ -0,0 +1,146 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_frame_damage.h"
+#include "screen_capture/cam_canvas.h"
+#include <cstddef>
+#include <cstring>
+
+namespace cam
+{
+
+static auto to_frame_rect(const cam::rect<int> &rect, const cam::rect<int> &capture_rect) noexcept -> cam::rect<int>
+{
+    return {rect.left() - capture_rect.left(), rect.top() - capture_rect.top(),
+        rect.right() - capture_rect.left(), rect.bottom() - capture_rect.top()};
+}
+
+static auto is_empty(const cam::rect<int> &rect) noexcept -> bool
+{
+    return rect.width() <= 0 || rect.height() <= 0;
+}
+
+void clip_damage(const cam_frame_damage &desktop_damage, const cam::rect<int> &capture_rect,
+    cam_frame_damage &frame_damage)
+{
+    frame_damage.reset(desktop_damage.valid);
+    if (!desktop_damage.valid)
+        return;
+
+    for (const auto &dirty_rect : desktop_damage.dirty_rects)
+    {
+        const auto clipped = cam::intersect(dirty_rect, capture_rect);
+        if (!is_empty(clipped))
+            frame_damage.dirty_rects.push_back(to_frame_rect(clipped, capture_rect));
+    }
+
+    for (const auto &move_rect : desktop_damage.move_rects)
+    {
+        const auto dst = cam::intersect(move_rect.dst, capture_rect);
+        if (is_empty(dst))
+            continue;
+
+        /* the source of the clipped destination, it must be completely inside the previous frame */
+        const auto dx = move_rect.src.x() - move_rect.dst.left();
+        const auto dy = move_rect.src.y() - move_rect.dst.top();
+        const auto src = cam::rect<int>(dst.left() + dx, dst.top() + dy, dst.right() + dx, dst.bottom() + dy);
+        if (cam::intersect(src, capture_rect) == src)
+        {
+            const auto frame_src = to_frame_rect(src, capture_rect);
+            frame_damage.move_rects.push_back({point<int>(frame_src.left(), frame_src.top()),
+                to_frame_rect(dst, capture_rect)});
+        }
+        else
+        {
+            frame_damage.dirty_rects.push_back(to_frame_rect(dst, capture_rect));
+        }
+    }
+}
+
+void copy_rect(const uint8_t *src, const int src_stride, uint8_t *dst, const int dst_stride,
+    const cam::size<int> &size, const cam::rect<int> &rect) noexcept
+{
+    const auto clipped = cam::intersect(rect, cam::rect<int>(point<int>(0, 0), size));
+    if (is_empty(clipped))
+        return;
+
+    const auto row_size = static_cast<size_t>(clipped.width()) * 4;
+    for (int y = clipped.top(); y < clipped.bottom(); ++y)
+    {
+        std::memcpy(dst + static_cast<ptrdiff_t>(y) * dst_stride + clipped.left() * 4,
+            src + static_cast<ptrdiff_t>(y) * src_stride + clipped.left() * 4, row_size);
+    }
+}
+
+void copy_damaged(const uint8_t *src, const int src_stride, uint8_t *dst, const int dst_stride,
+    const cam::size<int> &size, const cam_frame_damage &damage)
+{
+    if (!damage.valid)
+    {
+        copy_rect(src, src_stride, dst, dst_stride, size, cam::rect<int>(point<int>(0, 0), size));
+        return;
+    }
+
+    /* src is the complete new image, so a move is just a changed rect */
+    for (const auto &rect : damage.dirty_rects)
+        copy_rect(src, src_stride, dst, dst_stride, size, rect);
+    for (const auto &move_rect : damage.move_rects)
+        copy_rect(src, src_stride, dst, dst_stride, size, move_rect.dst);
+}
+
+} // namespace cam
+
+void cam_annotation_damage::update(cam_canvas &canvas, cam_frame_damage &damage)
+{
+    const auto &dirty_rect = canvas.get_dirty_rect();
+
+    /* compare the annotated pixels with the ones of the previous frame */
+    auto unchanged = dirty_rect == rect_;
+    std::size_t offset = 0;
+    pixels_.resize(static_cast<std::size_t>(dirty_rect.width()) * dirty_rect.height());
+    for (int y = dirty_rect.top(); y < dirty_rect.bottom(); ++y)
+    {
+        const auto *row = canvas.row(y) + dirty_rect.left();
+        auto *pixels = pixels_.data() + offset;
+        if (unchanged && std::memcmp(pixels, row, static_cast<std::size_t>(dirty_rect.width()) * 4) != 0)
+            unchanged = false;
+        if (!unchanged)
+            std::memcpy(pixels, row, static_cast<std::size_t>(dirty_rect.width()) * 4);
+        offset += dirty_rect.width();
+    }
+
+    if (damage.valid && !unchanged)
+    {
+        if (!rect_.empty())
+            damage.dirty_rects.push_back(rect_);
+        if (!dirty_rect.empty())
+            damage.dirty_rects.push_back(dirty_rect);
+    }
+
+    rect_ = dirty_rect;
+}
+
+void cam_annotation_damage::reset() noexcept
+{
+    rect_ = {};
+    pixels_.clear();
+}
+
+auto cam_annotation_damage::get_rect() const noexcept -> const cam::rect<int> &
+{
+    return rect_;
+}
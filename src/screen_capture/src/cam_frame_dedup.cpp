@@ -0,0 +1,46 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_frame_dedup.h"
+
+cam_frame_dedup::cam_frame_dedup(const double max_skip_time) noexcept
+    : max_skip_time_(max_skip_time)
+{
+}
+
+bool cam_frame_dedup::should_encode(const cam_frame_damage &damage, const double time) noexcept
+{
+    if (has_encoded_ && damage.is_unchanged() && time - last_encoded_time_ < max_skip_time_)
+    {
+        ++skipped_count_;
+        return false;
+    }
+
+    has_encoded_ = true;
+    last_encoded_time_ = time;
+    return true;
+}
+
+void cam_frame_dedup::reset() noexcept
+{
+    has_encoded_ = false;
+}
+
+auto cam_frame_dedup::get_skipped_count() const noexcept -> int64_t
+{
+    return skipped_count_;
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_gdiplus_font.h"
+#include "screen_capture/cam_gdiplus.h"
+#include <cmath>
+#include <cstring>
+
+cam_gdiplus_font::cam_gdiplus_font(const wchar_t *font_family, const float font_size)
+    : font_(std::make_unique<Gdiplus::Font>(font_family, font_size))
+{
+    Gdiplus::Bitmap measure_bitmap(1, 1, PixelFormat32bppPARGB);
+    Gdiplus::Graphics measure_canvas(&measure_bitmap);
+    line_height_ = static_cast<int>(std::ceil(font_->GetHeight(&measure_canvas)));
+}
+
+cam_gdiplus_font::~cam_gdiplus_font() = default;
+
+auto cam_gdiplus_font::get_line_height() const noexcept -> int
+{
+    return line_height_;
+}
+
+auto cam_gdiplus_font::render_glyph(const wchar_t glyph, const cam::color &color) const -> cam_sprite
+{
+    /* the typographic format does not add padding around the glyph, so the measured width is the
+     * advance of the glyph. */
+    Gdiplus::StringFormat format(Gdiplus::StringFormat::GenericTypographic());
+    format.SetFormatFlags(format.GetFormatFlags() | Gdiplus::StringFormatFlagsMeasureTrailingSpaces);
+
+    Gdiplus::RectF bounds;
+    {
+        Gdiplus::Bitmap measure_bitmap(1, 1, PixelFormat32bppPARGB);
+        Gdiplus::Graphics measure_canvas(&measure_bitmap);
+        measure_canvas.MeasureString(&glyph, 1, font_.get(), Gdiplus::PointF(0.f, 0.f), &format, &bounds);
+    }
+
+    const auto width = static_cast<int>(std::ceil(bounds.Width));
+    const auto height = line_height_;
+    if (width <= 0 || height <= 0)
+        return {};
+
+    /* gdi+ renders straight into a premultiplied bitmap, which we copy into the sprite. */
+    Gdiplus::Bitmap bitmap(width, height, PixelFormat32bppPARGB);
+    {
+        Gdiplus::SolidBrush brush(Gdiplus::Color(color.a_, color.r_, color.g_, color.b_));
+        Gdiplus::Graphics text_canvas(&bitmap);
+        text_canvas.SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAliasGridFit);
+        text_canvas.DrawString(&glyph, 1, font_.get(), Gdiplus::PointF(0.f, 0.f), &format, &brush);
+    }
+
+    cam_sprite sprite(width, height);
+    Gdiplus::Rect lock_rect(0, 0, width, height);
+    Gdiplus::BitmapData bitmap_data = {};
+    if (bitmap.LockBits(&lock_rect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, &bitmap_data) != Gdiplus::Ok)
+        return sprite;
+
+    for (int y = 0; y < height; ++y)
+    {
+        const auto *src = static_cast<const uint8_t *>(bitmap_data.Scan0) + y * bitmap_data.Stride;
+        std::memcpy(sprite.row(y), src, width * sizeof(uint32_t));
+    }
+
+    bitmap.UnlockBits(&bitmap_data);
+    return sprite;
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_input_replay.h"
+#include <algorithm>
+
+static auto get_up_flag(const cam_mouse_button::type button) noexcept -> cam_mouse_button::type
+{
+    switch (button)
+    {
+    case cam_mouse_button::left_button_down: return cam_mouse_button::left_button_up;
+    case cam_mouse_button::right_button_down: return cam_mouse_button::right_button_up;
+    case cam_mouse_button::middle_button_down: return cam_mouse_button::middle_button_up;
+    default: break;
+    }
+    return cam_mouse_button::none;
+}
+
+cam_input_replay::cam_input_replay(cam::span<const uint8_t> input_stream)
+    : reader_(input_stream)
+{
+    has_next_record_ = reader_.read(next_record_);
+}
+
+void cam_input_replay::advance(const double frame_time)
+{
+    frame_delta_ = std::max(frame_time - frame_time_, 0.0);
+    const auto previous_frame_time = frame_time_;
+    frame_time_ = frame_time;
+
+    mouse_button_state_ = 0;
+    input_events_.clear();
+
+    const auto frame_time_us = static_cast<int64_t>(frame_time * 1000000.0);
+    while (has_next_record_ && next_record_.time <= frame_time_us)
+    {
+        const auto &record = next_record_;
+        switch (record.type)
+        {
+        case cam_input_record_type::mouse_move:
+            mouse_position_ = record.position;
+            break;
+
+        case cam_input_record_type::mouse_button_down:
+            [[fallthrough]];
+        case cam_input_record_type::mouse_button_up:
+        {
+            const auto down = static_cast<cam_mouse_button::type>(record.code);
+            const auto button = record.type == cam_input_record_type::mouse_button_down ? down : get_up_flag(down);
+            if (button == cam_mouse_button::none)
+                break;
+
+            /* events from before the previous frame are clamped to its start */
+            const auto time = std::clamp(record.time / 1000000.0 - previous_frame_time, 0.0, frame_delta_);
+            input_events_.push_back({time, record.position, button});
+            mouse_button_state_ |= button;
+            break;
+        }
+
+        case cam_input_record_type::key_down:
+            [[fallthrough]];
+        case cam_input_record_type::key_up:
+            break;
+        }
+
+        has_next_record_ = reader_.read(next_record_);
+    }
+}
+
+void cam_input_replay::seek(const double frame_time)
+{
+    frame_delta_ = 0.0;
+    frame_time_ = std::max(frame_time, frame_time_);
+    mouse_button_state_ = 0;
+    input_events_.clear();
+
+    const auto frame_time_us = static_cast<int64_t>(frame_time_ * 1000000.0);
+    while (has_next_record_ && next_record_.time <= frame_time_us)
+    {
+        mouse_position_ = next_record_.position;
+        has_next_record_ = reader_.read(next_record_);
+    }
+}
+
+auto cam_input_replay::get_draw_data(const cam::rect<int> &canvas_rect) const noexcept -> cam_draw_data
+{
+    return cam_draw_data(frame_delta_, canvas_rect, mouse_position_,
+        static_cast<cam_mouse_button::type>(mouse_button_state_), input_events_);
+}
+
+auto cam_input_replay::get_mouse_position() const noexcept -> const point<int> &
+{
+    return mouse_position_;
+}
+
+auto cam_input_replay::get_input_events() const noexcept -> cam::span<const cam_input_event>
+{
+    return input_events_;
+}
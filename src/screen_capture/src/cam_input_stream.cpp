@@ -0,0 +1,168 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_input_stream.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+constexpr std::array<uint8_t, 4> stream_magic = {'C', 'S', 'I', 'N'};
+constexpr uint8_t stream_version = 1;
+constexpr auto max_record_type = static_cast<uint8_t>(cam_input_record_type::key_up);
+
+static bool is_mouse_record(const cam_input_record_type type) noexcept
+{
+    return type == cam_input_record_type::mouse_move
+        || type == cam_input_record_type::mouse_button_down
+        || type == cam_input_record_type::mouse_button_up;
+}
+
+static void write_varint(std::vector<uint8_t> &data, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        data.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+static constexpr auto zigzag_encode(const int64_t value) noexcept -> uint64_t
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static constexpr auto zigzag_decode(const uint64_t value) noexcept -> int64_t
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+cam_input_stream_writer::cam_input_stream_writer()
+{
+    data_.assign(stream_magic.begin(), stream_magic.end());
+    data_.push_back(stream_version);
+}
+
+void cam_input_stream_writer::write(const cam_input_record &record)
+{
+    data_.push_back(static_cast<uint8_t>(record.type));
+    write_varint(data_, zigzag_encode(record.time - last_time_));
+    last_time_ = record.time;
+
+    if (is_mouse_record(record.type))
+    {
+        write_varint(data_, zigzag_encode(static_cast<int64_t>(record.position.x()) - last_position_.x()));
+        write_varint(data_, zigzag_encode(static_cast<int64_t>(record.position.y()) - last_position_.y()));
+        last_position_ = record.position;
+    }
+
+    if (record.type != cam_input_record_type::mouse_move)
+        write_varint(data_, record.code);
+
+    ++record_count_;
+}
+
+auto cam_input_stream_writer::get_data() const noexcept -> const std::vector<uint8_t> &
+{
+    return data_;
+}
+
+auto cam_input_stream_writer::get_record_count() const noexcept -> int64_t
+{
+    return record_count_;
+}
+
+cam_input_stream_reader::cam_input_stream_reader(cam::span<const uint8_t> data)
+    : data_(data)
+{
+    if (data.size() < stream_magic.size() + 1 || !std::equal(stream_magic.begin(), stream_magic.end(), data.begin()))
+        throw std::runtime_error("not a camstudio input stream");
+
+    if (data[stream_magic.size()] != stream_version)
+        throw std::runtime_error("unsupported camstudio input stream version");
+
+    offset_ = stream_magic.size() + 1;
+}
+
+bool cam_input_stream_reader::read(cam_input_record &record)
+{
+    if (offset_ == data_.size())
+        return false;
+
+    const auto type = data_[offset_++];
+    if (type > max_record_type)
+        throw std::runtime_error("invalid input stream record");
+
+    record.type = static_cast<cam_input_record_type>(type);
+    record.time = last_time_ + zigzag_decode(_read_varint());
+    last_time_ = record.time;
+
+    if (is_mouse_record(record.type))
+    {
+        const auto x = last_position_.x() + zigzag_decode(_read_varint());
+        const auto y = last_position_.y() + zigzag_decode(_read_varint());
+        last_position_ = point<int>(static_cast<int>(x), static_cast<int>(y));
+    }
+    record.position = last_position_;
+
+    record.code = 0;
+    if (record.type != cam_input_record_type::mouse_move)
+        record.code = static_cast<uint32_t>(_read_varint());
+
+    return true;
+}
+
+auto cam_input_stream_reader::_read_varint() -> uint64_t
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (offset_ == data_.size())
+            throw std::runtime_error("truncated input stream");
+
+        const auto byte = data_[offset_++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    throw std::runtime_error("invalid input stream varint");
+}
+
+namespace cam
+{
+
+void save_input_stream(const std::string &filename, cam::span<const uint8_t> data)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("unable to create input stream file: " + filename);
+
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+auto load_input_stream(const std::string &filename) -> std::vector<uint8_t>
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("unable to open input stream file: " + filename);
+
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+} // namespace cam
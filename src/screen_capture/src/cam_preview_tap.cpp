@@ -0,0 +1,122 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_preview_tap.h"
+#include "screen_capture/cam_window_tracker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+/* the worker also checks for new frames on this interval, offer() does not lock so a wake up can
+ * be missed. */
+constexpr auto worker_poll_interval = std::chrono::milliseconds(20);
+
+cam_preview_tap::cam_preview_tap(const cam_preview_config &config)
+    : config_(config)
+{
+    if (config_.max_size.width() <= 0 || config_.max_size.height() <= 0)
+        throw std::invalid_argument("cam_preview_tap: invalid preview size");
+
+    config_.frame_interval = std::max(config_.frame_interval, 1);
+    worker_ = std::thread([this]() { _run_worker(); });
+}
+
+cam_preview_tap::~cam_preview_tap()
+{
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        stop_ = true;
+    }
+    frame_offered_.notify_one();
+    worker_.join();
+}
+
+void cam_preview_tap::offer(const cam_frame &frame)
+{
+    if (offered_count_++ % config_.frame_interval != 0)
+        return;
+
+    /* the preview only handles 32 bit frames */
+    if (frame.bitmap_data == nullptr || frame.width <= 0 || frame.height <= 0
+        || cam::get_pixel_size(frame.pixel_format) != 4)
+        return;
+
+    auto &copy = frames_.write_slot();
+    const auto row_size = static_cast<size_t>(frame.width) * 4;
+    copy.size = cam::size<int>(frame.width, frame.height);
+    copy.data.resize(row_size * frame.height);
+    for (int y = 0; y < frame.height; ++y)
+        std::memcpy(copy.data.data() + y * row_size, frame.bitmap_data + static_cast<ptrdiff_t>(y) * frame.stride,
+            row_size);
+    copy.sequence = frame.sequence;
+    copy.timestamp = frame.timestamp;
+
+    if (!frames_.publish())
+        ++dropped_count_;
+
+    frame_offered_.notify_one();
+}
+
+auto cam_preview_tap::take_preview() noexcept -> const cam_preview_image *
+{
+    return previews_.take();
+}
+
+auto cam_preview_tap::get_offered_count() const noexcept -> int64_t
+{
+    return offered_count_;
+}
+
+auto cam_preview_tap::get_dropped_count() const noexcept -> int64_t
+{
+    return dropped_count_;
+}
+
+void cam_preview_tap::_run_worker()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(worker_mutex_);
+            frame_offered_.wait_for(lock, worker_poll_interval, [this]() { return stop_ || frames_.has_value(); });
+            if (stop_)
+                return;
+        }
+
+        if (const auto *frame = frames_.take(); frame != nullptr)
+            _scale_frame(*frame);
+    }
+}
+
+void cam_preview_tap::_scale_frame(const frame_copy &frame)
+{
+    const auto preview_size = cam::fit_rect(frame.size, config_.max_size, cam_fit_mode::shrink).size();
+    if (!scaler_ || !(scaler_->get_src_size() == frame.size) || !(scaler_->get_dst_size() == preview_size))
+        scaler_ = std::make_unique<cam_scaler>(frame.size, preview_size, cam::scale_filter::area);
+
+    auto &preview = previews_.write_slot();
+    preview.size = preview_size;
+    preview.stride = preview_size.width() * 4;
+    preview.data.resize(static_cast<size_t>(preview.stride) * preview_size.height());
+    preview.sequence = frame.sequence;
+    preview.timestamp = frame.timestamp;
+    scaler_->scale(frame.data.data(), frame.size.width() * 4, preview.data.data(), preview.stride);
+
+    previews_.publish();
+}
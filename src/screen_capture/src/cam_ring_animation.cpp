@@ -0,0 +1,49 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_ring_animation.h"
+#include <algorithm>
+
+void cam_ring_animation::update(const int max_size, const cam::color &color, const double stroke_width)
+{
+    const auto new_max_size = std::max(max_size, 0);
+    if (key_.max_size == new_max_size && key_.color == color && key_.stroke_width == stroke_width)
+        return;
+
+    /* the biggest ring decides the width of the atlas, so every frame fits a shelf */
+    auto largest_frame = cam::create_ring_sprite(new_max_size, stroke_width, color);
+    atlas_ = cam_sprite_atlas(std::max(cam_sprite_atlas::default_width, largest_frame.width()));
+
+    for (int ring_size = 0; ring_size < new_max_size; ++ring_size)
+        atlas_.add(cam::create_ring_sprite(ring_size, stroke_width, color));
+    atlas_.add(largest_frame);
+
+    key_ = key{new_max_size, color, stroke_width};
+}
+
+auto cam_ring_animation::get_frame(const int ring_size) const noexcept -> cam_sprite_view
+{
+    if (atlas_.size() == 0)
+        return {};
+
+    return atlas_.get(std::clamp(ring_size, 0, atlas_.size() - 1));
+}
+
+int cam_ring_animation::get_frame_count() const noexcept
+{
+    return atlas_.size();
+}
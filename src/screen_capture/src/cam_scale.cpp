@@ -0,0 +1,327 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_scale.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CAM_SCALE_X86 1
+#include <emmintrin.h>
+#endif
+
+/* the filter weights are 1.14 fixed point, the horizontally filtered rows are 8.7 fixed point. This
+ * keeps all intermediate values in 16 bit, and all sums in 32 bit. */
+constexpr int weight_bits = 14;
+constexpr int weight_one = 1 << weight_bits;
+constexpr int row_bits = 7;
+constexpr int horizontal_shift = weight_bits - row_bits;
+constexpr int vertical_shift = weight_bits + row_bits;
+
+namespace cam
+{
+
+namespace detail
+{
+static void filter_row_scalar(uint16_t *dst, const uint8_t *src, const int dst_width,
+                              const scale_contributor *contributors, const int16_t *weights) noexcept
+{
+    for (int x = 0; x < dst_width; ++x)
+    {
+        const auto &contributor = contributors[x];
+        const auto *w = weights + contributor.weight_offset;
+        const auto *s = src + contributor.first * 4;
+        for (int c = 0; c < 4; ++c)
+        {
+            int32_t sum = 0;
+            for (int i = 0; i < contributor.count; ++i)
+                sum += s[i * 4 + c] * w[i];
+            dst[x * 4 + c] = static_cast<uint16_t>((sum + (1 << (horizontal_shift - 1))) >> horizontal_shift);
+        }
+    }
+}
+
+static void blend_rows_scalar(uint8_t *dst, const uint16_t *const *rows, const int16_t *weights, const int count,
+                              const int value_count) noexcept
+{
+    for (int i = 0; i < value_count; ++i)
+    {
+        int32_t sum = 0;
+        for (int r = 0; r < count; ++r)
+            sum += rows[r][i] * weights[r];
+
+        const auto value = (sum + (1 << (vertical_shift - 1))) >> vertical_shift;
+        dst[i] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+}
+
+#if defined(CAM_SCALE_X86)
+/* two 16 bit weights, interleaved for _mm_madd_epi16. */
+static inline __m128i weight_pair(const int16_t a, const int16_t b) noexcept
+{
+    return _mm_set1_epi32(static_cast<int32_t>(static_cast<uint16_t>(b)) << 16 | static_cast<uint16_t>(a));
+}
+
+static inline __m128i load_pixel(const uint8_t *src) noexcept
+{
+    int32_t pixel;
+    std::copy(src, src + 4, reinterpret_cast<uint8_t *>(&pixel));
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), _mm_setzero_si128());
+}
+
+static void filter_row_sse2(uint16_t *dst, const uint8_t *src, const int dst_width,
+                            const scale_contributor *contributors, const int16_t *weights) noexcept
+{
+    const auto rounding = _mm_set1_epi32(1 << (horizontal_shift - 1));
+    for (int x = 0; x < dst_width; ++x)
+    {
+        const auto &contributor = contributors[x];
+        const auto *w = weights + contributor.weight_offset;
+        const auto *s = src + contributor.first * 4;
+        const auto count = contributor.count;
+
+        /* the channels of two pixels interleaved, so madd multiplies and adds both taps at once. */
+        auto sum = rounding;
+        int i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const auto pixels = _mm_unpacklo_epi16(load_pixel(s + i * 4), load_pixel(s + i * 4 + 4));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pixels, weight_pair(w[i], w[i + 1])));
+        }
+
+        if (i < count)
+        {
+            const auto pixels = _mm_unpacklo_epi16(load_pixel(s + i * 4), _mm_setzero_si128());
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pixels, weight_pair(w[i], 0)));
+        }
+
+        const auto result = _mm_packs_epi32(_mm_srai_epi32(sum, horizontal_shift), _mm_setzero_si128());
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x * 4), result);
+    }
+}
+
+static void blend_rows_sse2(uint8_t *dst, const uint16_t *const *rows, const int16_t *weights, const int count,
+                            const int value_count) noexcept
+{
+    const auto rounding = _mm_set1_epi32(1 << (vertical_shift - 1));
+
+    int i = 0;
+    for (; i + 8 <= value_count; i += 8)
+    {
+        auto sum_lo = rounding;
+        auto sum_hi = rounding;
+
+        int r = 0;
+        for (; r + 2 <= count; r += 2)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + i));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r + 1] + i));
+            const auto w = weight_pair(weights[r], weights[r + 1]);
+            sum_lo = _mm_add_epi32(sum_lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            sum_hi = _mm_add_epi32(sum_hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+
+        if (r < count)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + i));
+            const auto zero = _mm_setzero_si128();
+            const auto w = weight_pair(weights[r], 0);
+            sum_lo = _mm_add_epi32(sum_lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, zero), w));
+            sum_hi = _mm_add_epi32(sum_hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, zero), w));
+        }
+
+        const auto values = _mm_packs_epi32(_mm_srai_epi32(sum_lo, vertical_shift),
+            _mm_srai_epi32(sum_hi, vertical_shift));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(values, values));
+    }
+
+    if (i < value_count)
+    {
+        const uint16_t *tail_rows[64];
+        for (int r = 0; r < count; ++r)
+            tail_rows[r] = rows[r] + i;
+        blend_rows_scalar(dst + i, tail_rows, weights, count, value_count - i);
+    }
+}
+#endif
+} // namespace detail
+
+bool is_scale_kernel_supported(const scale_kernel kernel) noexcept
+{
+    switch (kernel)
+    {
+    case scale_kernel::scalar:
+        return true;
+    case scale_kernel::sse2:
+#if defined(CAM_SCALE_X86)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+auto get_best_scale_kernel() noexcept -> scale_kernel
+{
+    if (is_scale_kernel_supported(scale_kernel::sse2))
+        return scale_kernel::sse2;
+    return scale_kernel::scalar;
+}
+
+} // namespace cam
+
+cam_scaler::cam_scaler(const cam::size<int> &src_size, const cam::size<int> &dst_size,
+                       const cam::scale_filter filter, const cam::scale_kernel kernel)
+    : src_size_(src_size)
+    , dst_size_(dst_size)
+    , kernel_(kernel)
+{
+    if (src_size.width() <= 0 || src_size.height() <= 0 || dst_size.width() <= 0 || dst_size.height() <= 0)
+        throw std::invalid_argument("cam_scaler: invalid size");
+
+    if (!cam::is_scale_kernel_supported(kernel))
+        throw std::invalid_argument("cam_scaler: unsupported kernel");
+
+    horizontal_ = _create_filter_table(src_size.width(), dst_size.width(), filter);
+    vertical_ = _create_filter_table(src_size.height(), dst_size.height(), filter);
+
+    /* the sse2 tail handling has a fixed amount of rows, that is a down scale of 60x */
+    if (vertical_.max_count > 64)
+        throw std::invalid_argument("cam_scaler: scale factor too large");
+
+    const auto row_size = static_cast<size_t>(dst_size.width()) * 4;
+    row_cache_.resize(row_size * vertical_.max_count);
+    row_cache_rows_.assign(vertical_.max_count, -1);
+    rows_.resize(vertical_.max_count);
+}
+
+void cam_scaler::scale(const uint8_t *src, const int src_stride, uint8_t *dst, const int dst_stride)
+{
+    /* the cache is only valid for a single source image. */
+    std::fill(row_cache_rows_.begin(), row_cache_rows_.end(), -1);
+
+    const auto value_count = dst_size_.width() * 4;
+    for (int y = 0; y < dst_size_.height(); ++y)
+    {
+        const auto &contributor = vertical_.contributors[y];
+        for (int i = 0; i < contributor.count; ++i)
+            rows_[i] = _get_filtered_row(src, src_stride, contributor.first + i);
+
+        const auto *weights = vertical_.weights.data() + contributor.weight_offset;
+        auto *dst_row = dst + static_cast<ptrdiff_t>(y) * dst_stride;
+
+#if defined(CAM_SCALE_X86)
+        if (kernel_ == cam::scale_kernel::sse2)
+        {
+            cam::detail::blend_rows_sse2(dst_row, rows_.data(), weights, contributor.count, value_count);
+            continue;
+        }
+#endif
+        cam::detail::blend_rows_scalar(dst_row, rows_.data(), weights, contributor.count, value_count);
+    }
+}
+
+auto cam_scaler::get_src_size() const noexcept -> const cam::size<int> &
+{
+    return src_size_;
+}
+
+auto cam_scaler::get_dst_size() const noexcept -> const cam::size<int> &
+{
+    return dst_size_;
+}
+
+auto cam_scaler::_create_filter_table(const int src_length, const int dst_length, const cam::scale_filter filter)
+    -> filter_table
+{
+    filter_table table;
+    table.contributors.reserve(dst_length);
+
+    const auto ratio = static_cast<double>(src_length) / dst_length;
+    std::vector<double> weights;
+    for (int i = 0; i < dst_length; ++i)
+    {
+        int first = 0;
+        weights.clear();
+
+        /* area is only a box filter for down scaling, up scaling with a box filter is blocky. */
+        if (filter == cam::scale_filter::area && ratio > 1.0)
+        {
+            const auto begin = i * ratio;
+            const auto end = std::min((i + 1) * ratio, static_cast<double>(src_length));
+            first = static_cast<int>(begin);
+            for (int s = first; s < end; ++s)
+                weights.push_back(std::min<double>(s + 1, end) - std::max<double>(s, begin));
+        }
+        else
+        {
+            const auto center = std::clamp((i + 0.5) * ratio - 0.5, 0.0, src_length - 1.0);
+            first = static_cast<int>(center);
+            const auto fraction = center - first;
+            weights.push_back(1.0 - fraction);
+            if (first + 1 < src_length)
+                weights.push_back(fraction);
+        }
+
+        /* the fixed point weights must add up to exactly one, so flat areas stay flat. */
+        double total = 0.0;
+        for (const auto weight : weights)
+            total += weight;
+
+        const auto weight_offset = static_cast<int>(table.weights.size());
+        int fixed_total = 0;
+        for (const auto weight : weights)
+        {
+            const auto fixed_weight = static_cast<int16_t>(std::lround(weight / total * weight_one));
+            table.weights.push_back(fixed_weight);
+            fixed_total += fixed_weight;
+        }
+
+        const auto largest = std::max_element(table.weights.begin() + weight_offset, table.weights.end());
+        *largest = static_cast<int16_t>(*largest + weight_one - fixed_total);
+
+        const auto count = static_cast<int>(weights.size());
+        table.contributors.push_back({first, count, weight_offset});
+        table.max_count = std::max(table.max_count, count);
+    }
+
+    return table;
+}
+
+auto cam_scaler::_get_filtered_row(const uint8_t *src, const int src_stride, const int row) -> const uint16_t *
+{
+    const auto slot = row % vertical_.max_count;
+    auto *cached_row = row_cache_.data() + static_cast<size_t>(slot) * dst_size_.width() * 4;
+    if (row_cache_rows_[slot] == row)
+        return cached_row;
+
+    const auto *src_row = src + static_cast<ptrdiff_t>(row) * src_stride;
+    const auto *contributors = horizontal_.contributors.data();
+    const auto *weights = horizontal_.weights.data();
+
+#if defined(CAM_SCALE_X86)
+    if (kernel_ == cam::scale_kernel::sse2)
+        cam::detail::filter_row_sse2(cached_row, src_row, dst_size_.width(), contributors, weights);
+    else
+#endif
+        cam::detail::filter_row_scalar(cached_row, src_row, dst_size_.width(), contributors, weights);
+
+    row_cache_rows_[slot] = row;
+    return cached_row;
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_sprite.h"
+#include <cmath>
+
+// the anti aliasing is done by sampling every pixel on a subsample_count x subsample_count grid.
+constexpr auto subsample_count = 4;
+
+cam_sprite::cam_sprite(const int width, const int height)
+    : width_(width > 0 ? width : 0)
+    , height_(height > 0 ? height : 0)
+    , pixels_(static_cast<size_t>(width_) * height_, 0)
+{
+}
+
+int cam_sprite::width() const noexcept
+{
+    return width_;
+}
+
+int cam_sprite::height() const noexcept
+{
+    return height_;
+}
+
+bool cam_sprite::empty() const noexcept
+{
+    return pixels_.empty();
+}
+
+auto cam_sprite::data() noexcept -> uint32_t *
+{
+    return pixels_.data();
+}
+
+auto cam_sprite::data() const noexcept -> const uint32_t *
+{
+    return pixels_.data();
+}
+
+auto cam_sprite::row(const int y) noexcept -> uint32_t *
+{
+    return pixels_.data() + static_cast<size_t>(y) * width_;
+}
+
+auto cam_sprite::row(const int y) const noexcept -> const uint32_t *
+{
+    return pixels_.data() + static_cast<size_t>(y) * width_;
+}
+
+auto cam_sprite::view() const noexcept -> cam_sprite_view
+{
+    return {pixels_.data(), width_, height_, width_};
+}
+
+namespace cam
+{
+
+/* x * y / 255, with rounding. */
+static uint32_t mul_div_255(const uint32_t x, const uint32_t y) noexcept
+{
+    const auto t = x * y + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+auto premultiply(const color &color, const uint8_t coverage) noexcept -> uint32_t
+{
+    const auto alpha = mul_div_255(color.a_, coverage);
+    return alpha << 24
+        | mul_div_255(color.r_, alpha) << 16
+        | mul_div_255(color.g_, alpha) << 8
+        | mul_div_255(color.b_, alpha) << 0;
+}
+
+/* render a sprite by counting the subsamples for which the inside function returns true. */
+template <typename inside_function>
+static auto rasterize(const int width, const int height, const color &color, inside_function &&inside) -> cam_sprite
+{
+    constexpr auto max_samples = subsample_count * subsample_count;
+
+    cam_sprite sprite(width, height);
+    for (int y = 0; y < sprite.height(); ++y)
+    {
+        auto *row = sprite.row(y);
+        for (int x = 0; x < sprite.width(); ++x)
+        {
+            int samples = 0;
+            for (int j = 0; j < subsample_count; ++j)
+            {
+                const auto sample_y = y + (j + 0.5) / subsample_count;
+                for (int i = 0; i < subsample_count; ++i)
+                {
+                    const auto sample_x = x + (i + 0.5) / subsample_count;
+                    if (inside(sample_x, sample_y))
+                        ++samples;
+                }
+            }
+
+            if (samples > 0)
+                row[x] = premultiply(color, static_cast<uint8_t>(samples * 255 / max_samples));
+        }
+    }
+    return sprite;
+}
+
+auto create_filled_rect_sprite(const size<int> &size, const color &color) -> cam_sprite
+{
+    cam_sprite sprite(size.width(), size.height());
+    const auto pixel = premultiply(color);
+    for (int y = 0; y < sprite.height(); ++y)
+    {
+        auto *row = sprite.row(y);
+        for (int x = 0; x < sprite.width(); ++x)
+            row[x] = pixel;
+    }
+    return sprite;
+}
+
+auto create_filled_ellipse_sprite(const size<int> &size, const color &color) -> cam_sprite
+{
+    const auto radius_x = size.width() / 2.0;
+    const auto radius_y = size.height() / 2.0;
+    return rasterize(size.width(), size.height(), color, [&](const double x, const double y) {
+        const auto dx = (x - radius_x) / radius_x;
+        const auto dy = (y - radius_y) / radius_y;
+        return dx * dx + dy * dy <= 1.0;
+    });
+}
+
+auto create_ring_sprite(const double diameter, const double stroke_width, const color &color) -> cam_sprite
+{
+    /* +2 so the anti aliased edge always fits. */
+    const auto sprite_size = static_cast<int>(std::ceil(diameter + stroke_width)) + 2;
+    const auto center = sprite_size / 2.0;
+    const auto radius = diameter / 2.0;
+    const auto half_stroke = stroke_width / 2.0;
+
+    return rasterize(sprite_size, sprite_size, color, [&](const double x, const double y) {
+        const auto distance = std::hypot(x - center, y - center);
+        return std::abs(distance - radius) <= half_stroke;
+    });
+}
+
+} // namespace cam
@@ -0,0 +1,95 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_sprite_atlas.h"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+cam_sprite_atlas::cam_sprite_atlas(const int width)
+    : width_(width)
+{
+    if (width <= 0)
+        throw std::invalid_argument("invalid sprite atlas width");
+}
+
+auto cam_sprite_atlas::add(const cam_sprite &sprite) -> int
+{
+    if (sprite.width() > width_)
+        throw std::invalid_argument("sprite is wider than the sprite atlas");
+
+    /* start a new shelf when the sprite does not fit next to the previous one */
+    if (shelf_x_ + sprite.width() > width_)
+    {
+        shelf_y_ += shelf_height_;
+        shelf_x_ = 0;
+        shelf_height_ = 0;
+    }
+
+    entry new_entry{shelf_x_, shelf_y_, sprite.width(), sprite.height()};
+    shelf_x_ += sprite.width();
+    shelf_height_ = std::max(shelf_height_, sprite.height());
+
+    if (shelf_y_ + shelf_height_ > height_)
+    {
+        height_ = shelf_y_ + shelf_height_;
+        pixels_.resize(static_cast<size_t>(width_) * height_);
+    }
+
+    for (int y = 0; y < sprite.height(); ++y)
+    {
+        const auto *src = sprite.row(y);
+        auto *dst = pixels_.data() + static_cast<size_t>(new_entry.y + y) * width_ + new_entry.x;
+        std::copy(src, src + sprite.width(), dst);
+    }
+
+    entries_.push_back(new_entry);
+    return static_cast<int>(entries_.size()) - 1;
+}
+
+auto cam_sprite_atlas::get(const int index) const noexcept -> cam_sprite_view
+{
+    assert(index >= 0 && index < size());
+    const auto &e = entries_[index];
+    const auto *data = pixels_.data() + static_cast<size_t>(e.y) * width_ + e.x;
+    return {data, e.width, e.height, width_};
+}
+
+int cam_sprite_atlas::size() const noexcept
+{
+    return static_cast<int>(entries_.size());
+}
+
+int cam_sprite_atlas::width() const noexcept
+{
+    return width_;
+}
+
+int cam_sprite_atlas::height() const noexcept
+{
+    return height_;
+}
+
+void cam_sprite_atlas::clear() noexcept
+{
+    height_ = 0;
+    shelf_x_ = 0;
+    shelf_y_ = 0;
+    shelf_height_ = 0;
+    entries_.clear();
+    pixels_.clear();
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_synthetic_capture.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+cam_synthetic_capture_source::cam_synthetic_capture_source(const cam::rect<int> &desktop_rect)
+    : desktop_rect_(desktop_rect)
+{
+    if (desktop_rect.width() <= 0 || desktop_rect.height() <= 0)
+        throw std::invalid_argument("cam_synthetic_capture_source: invalid desktop rect");
+
+    pixels_.resize(static_cast<size_t>(desktop_rect.width()) * desktop_rect.height(), 0);
+}
+
+void cam_synthetic_capture_source::fill_rect(const cam::rect<int> &rect, const uint32_t color)
+{
+    const auto clipped = cam::intersect(rect, desktop_rect_);
+    if (clipped.empty())
+        return;
+
+    for (int y = clipped.top(); y < clipped.bottom(); ++y)
+        std::fill_n(&_get_pixel(clipped.left(), y), clipped.width(), color);
+
+    damage_.dirty_rects.push_back(clipped);
+}
+
+void cam_synthetic_capture_source::move_rect(const cam::rect<int> &src, const point<int> &dst)
+{
+    /* only the part of the move of which both source and destination are on the desktop */
+    const auto dx = dst.x() - src.left();
+    const auto dy = dst.y() - src.top();
+    const auto clipped_dst = cam::intersect(cam::rect<int>(src.left() + dx, src.top() + dy, src.right() + dx,
+        src.bottom() + dy), desktop_rect_);
+    const auto valid_src = cam::intersect(cam::rect<int>(clipped_dst.left() - dx, clipped_dst.top() - dy,
+        clipped_dst.right() - dx, clipped_dst.bottom() - dy), desktop_rect_);
+    if (valid_src.empty())
+        return;
+
+    const auto valid_dst = cam::rect<int>(valid_src.left() + dx, valid_src.top() + dy,
+        valid_src.right() + dx, valid_src.bottom() + dy);
+
+    /* the rects can overlap, so go through a copy */
+    std::vector<uint32_t> copy(static_cast<size_t>(valid_src.width()) * valid_src.height());
+    for (int y = 0; y < valid_src.height(); ++y)
+        std::copy_n(&_get_pixel(valid_src.left(), valid_src.top() + y), valid_src.width(),
+            copy.begin() + static_cast<ptrdiff_t>(y) * valid_src.width());
+    for (int y = 0; y < valid_dst.height(); ++y)
+        std::copy_n(copy.begin() + static_cast<ptrdiff_t>(y) * valid_src.width(), valid_src.width(),
+            &_get_pixel(valid_dst.left(), valid_dst.top() + y));
+
+    /* a move refers to the previously captured frame, when the pixels already changed since then
+     * it can only be reported as dirty */
+    if (damage_.dirty_rects.empty() && damage_.move_rects.empty())
+        damage_.move_rects.push_back({point<int>(valid_src.left(), valid_src.top()), valid_dst});
+    else
+        damage_.dirty_rects.push_back(valid_dst);
+}
+
+void cam_synthetic_capture_source::capture_frame(const cam::rect<int> &capture_rect, uint8_t *data,
+    const int stride, cam_frame_damage &damage)
+{
+    const auto row_size = static_cast<size_t>(capture_rect.width()) * 4;
+    for (int y = 0; y < capture_rect.height(); ++y)
+    {
+        auto *row = data + static_cast<ptrdiff_t>(y) * stride;
+        std::memset(row, 0, row_size);
+
+        const auto screen_y = capture_rect.top() + y;
+        if (screen_y < desktop_rect_.top() || screen_y >= desktop_rect_.bottom())
+            continue;
+
+        const auto left = std::max(capture_rect.left(), desktop_rect_.left());
+        const auto right = std::min(capture_rect.right(), desktop_rect_.right());
+        if (left < right)
+            std::memcpy(row + static_cast<ptrdiff_t>(left - capture_rect.left()) * 4, &_get_pixel(left, screen_y),
+                static_cast<size_t>(right - left) * 4);
+    }
+
+    cam::clip_damage(damage_, capture_rect, damage);
+    damage_.reset(true);
+}
+
+auto cam_synthetic_capture_source::capture_frame(const cam::rect<int> &capture_rect) -> const cam_frame &
+{
+    const auto timestamp = cam::get_frame_time();
+    const auto stride = capture_rect.width() * cam::get_pixel_size(cam_pixel_format::bgr0);
+    frame_data_.resize(static_cast<size_t>(stride) * capture_rect.height());
+    capture_frame(capture_rect, frame_data_.data(), stride, frame_.damage);
+
+    frame_.bitmap_data = frame_data_.data();
+    frame_.width = capture_rect.width();
+    frame_.height = capture_rect.height();
+    frame_.stride = stride;
+    frame_.pixel_format = cam_pixel_format::bgr0;
+    ++frame_.sequence;
+    frame_.timestamp = timestamp;
+    return frame_;
+}
+
+auto cam_synthetic_capture_source::get_desktop_rect() const noexcept -> const cam::rect<int> &
+{
+    return desktop_rect_;
+}
+
+auto cam_synthetic_capture_source::_get_pixel(const int x, const int y) noexcept -> uint32_t &
+{
+    const auto index = static_cast<size_t>(y - desktop_rect_.top()) * desktop_rect_.width() + (x - desktop_rect_.left());
+    return pixels_[index];
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_text_overlay.h"
+#include "screen_capture/cam_canvas.h"
+#include "screen_capture/cam_font.h"
+#include <algorithm>
+
+cam_text_overlay::cam_text_overlay(const cam_font &font, const cam::color &color)
+    : font_(font)
+    , color_(color)
+{
+}
+
+void cam_text_overlay::set_text(std::wstring_view text)
+{
+    if (text == text_)
+        return;
+
+    /* layout the new text, this also renders the glyphs that we did not see before */
+    new_glyph_offsets_.resize(text.size());
+    int width = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        new_glyph_offsets_[i] = width;
+        width += _get_glyph(text[i]).width;
+    }
+
+    /* a different line size means everything moves, so start with a new line */
+    const auto full_update = width != line_.width() || font_.get_line_height() != line_.height();
+    if (full_update)
+        line_ = cam_sprite(width, font_.get_line_height());
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const auto unchanged = !full_update
+            && i < text_.size()
+            && text[i] == text_[i]
+            && new_glyph_offsets_[i] == glyph_offsets_[i];
+        if (unchanged)
+            continue;
+
+        _composite_glyph(glyph_atlas_.get(glyph_index_[text[i]]), new_glyph_offsets_[i]);
+    }
+
+    text_.assign(text);
+    std::swap(glyph_offsets_, new_glyph_offsets_);
+}
+
+auto cam_text_overlay::get_text() const noexcept -> const std::wstring &
+{
+    return text_;
+}
+
+void cam_text_overlay::set_color(const cam::color &color)
+{
+    if (color == color_)
+        return;
+
+    color_ = color;
+    glyph_atlas_.clear();
+    glyph_index_.clear();
+
+    const auto text = std::move(text_);
+    text_.clear();
+    line_ = {};
+    set_text(text);
+}
+
+void cam_text_overlay::draw(cam_canvas &canvas, const point<int> &position) const noexcept
+{
+    canvas.draw_sprite(line_, position);
+}
+
+auto cam_text_overlay::get_sprite() const noexcept -> const cam_sprite &
+{
+    return line_;
+}
+
+auto cam_text_overlay::get_rendered_glyph_count() const noexcept -> int
+{
+    return glyph_atlas_.size();
+}
+
+auto cam_text_overlay::get_composited_glyph_count() const noexcept -> int64_t
+{
+    return composited_glyph_count_;
+}
+
+auto cam_text_overlay::_get_glyph(const wchar_t glyph) -> cam_sprite_view
+{
+    if (const auto itr = glyph_index_.find(glyph); itr != glyph_index_.end())
+        return glyph_atlas_.get(itr->second);
+
+    const auto index = glyph_atlas_.add(font_.render_glyph(glyph, color_));
+    glyph_index_.emplace(glyph, index);
+    return glyph_atlas_.get(index);
+}
+
+void cam_text_overlay::_composite_glyph(const cam_sprite_view &glyph, const int x)
+{
+    /* glyphs do not overlap, so the glyph cell can simply be overwritten */
+    const auto height = std::min(glyph.height, line_.height());
+    for (int y = 0; y < line_.height(); ++y)
+    {
+        auto *dst = line_.row(y) + x;
+        if (y < height)
+            std::copy(glyph.row(y), glyph.row(y) + glyph.width, dst);
+        else
+            std::fill(dst, dst + glyph.width, 0u);
+    }
+
+    ++composited_glyph_count_;
+}
@@ -25,4 +25,18 @@ virtual_screen_info get_virtual_screen_info()
     return result;
 }
 
+static BOOL CALLBACK enum_monitor_rect(HMONITOR /*monitor*/, HDC /*dc*/, LPRECT rect, LPARAM data)
+{
+    auto &monitors = *reinterpret_cast<std::vector<cam::rect<int>> *>(data);
+    monitors.emplace_back(rect->left, rect->top, rect->right, rect->bottom);
+    return TRUE;
+}
+
+std::vector<cam::rect<int>> get_monitor_rects()
+{
+    std::vector<cam::rect<int>> result;
+    ::EnumDisplayMonitors(nullptr, nullptr, enum_monitor_rect, reinterpret_cast<LPARAM>(&result));
+    return result;
+}
+
 } // namespace cam
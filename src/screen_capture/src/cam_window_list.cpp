@@ -0,0 +1,166 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_window_list.h"
+#include <unordered_set>
+#include <utility>
+
+cam_window_list::cam_window_list(cam_window_source &source)
+    : source_(source)
+{
+}
+
+void cam_window_list::populate()
+{
+    auto windows = source_.enumerate();
+
+    std::lock_guard lock(mutex_);
+    windows_ = std::move(windows);
+    _rebuild_index(0);
+    ++revision_;
+}
+
+auto cam_window_list::apply(const cam_window_event &event) -> std::optional<cam_window_change>
+{
+    if (event.type == cam_window_event_type::destroyed)
+    {
+        std::lock_guard lock(mutex_);
+        const auto itr = index_.find(event.id);
+        if (itr == index_.end())
+            return std::nullopt;
+
+        cam_window_change change{cam_window_change_type::removed, windows_[itr->second]};
+        _remove(event.id);
+        return change;
+    }
+
+    /* a rename of a window we do not know is not interesting, it is a.e. a child control or a
+     * hidden window. When it becomes visible we get a created event. */
+    if (event.type == cam_window_event_type::renamed)
+    {
+        std::lock_guard lock(mutex_);
+        if (index_.find(event.id) == index_.end())
+            return std::nullopt;
+    }
+
+    /* query outside of the lock, the source might be slow */
+    auto window = source_.query(event.id);
+
+    std::lock_guard lock(mutex_);
+    const auto itr = index_.find(event.id);
+    if (itr == index_.end())
+    {
+        if (!window)
+            return std::nullopt;
+
+        _add(*window, 0);
+        return cam_window_change{cam_window_change_type::added, std::move(*window)};
+    }
+
+    if (!window)
+    {
+        cam_window_change change{cam_window_change_type::removed, windows_[itr->second]};
+        _remove(event.id);
+        return change;
+    }
+
+    auto &existing = windows_[itr->second];
+    if (existing == *window)
+        return std::nullopt;
+
+    existing = *window;
+    ++revision_;
+    return cam_window_change{cam_window_change_type::updated, std::move(*window)};
+}
+
+auto cam_window_list::resync() -> std::vector<cam_window_change>
+{
+    auto windows = source_.enumerate();
+
+    std::lock_guard lock(mutex_);
+    std::vector<cam_window_change> changes;
+
+    std::unordered_set<cam_window_id> current;
+    current.reserve(windows.size());
+    for (const auto &window : windows)
+    {
+        current.insert(window.id);
+
+        const auto itr = index_.find(window.id);
+        if (itr == index_.end())
+            changes.push_back({cam_window_change_type::added, window});
+        else if (windows_[itr->second] != window)
+            changes.push_back({cam_window_change_type::updated, window});
+    }
+
+    for (const auto &window : windows_)
+    {
+        if (current.find(window.id) == current.end())
+            changes.push_back({cam_window_change_type::removed, window});
+    }
+
+    /* take over the order of the enumeration */
+    windows_ = std::move(windows);
+    _rebuild_index(0);
+
+    if (!changes.empty())
+        ++revision_;
+
+    return changes;
+}
+
+auto cam_window_list::get_windows() const -> std::vector<cam_window_info>
+{
+    std::lock_guard lock(mutex_);
+    return windows_;
+}
+
+auto cam_window_list::size() const -> std::size_t
+{
+    std::lock_guard lock(mutex_);
+    return windows_.size();
+}
+
+auto cam_window_list::get_revision() const noexcept -> uint64_t
+{
+    return revision_;
+}
+
+void cam_window_list::_add(cam_window_info window, const std::size_t position)
+{
+    windows_.insert(windows_.begin() + position, std::move(window));
+    _rebuild_index(position);
+    ++revision_;
+}
+
+void cam_window_list::_remove(const cam_window_id id)
+{
+    const auto position = index_.at(id);
+    index_.erase(id);
+    windows_.erase(windows_.begin() + position);
+    _rebuild_index(position);
+    ++revision_;
+}
+
+void cam_window_list::_rebuild_index(const std::size_t first)
+{
+    if (first == 0)
+        index_.clear();
+
+    for (auto i = first; i < windows_.size(); ++i)
+        index_[windows_[i].id] = i;
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "screen_capture/cam_window_tracker.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace cam
+{
+
+auto fit_rect(const cam::size<int> &content_size, const cam::size<int> &output_size, const cam_fit_mode mode) noexcept
+    -> cam::rect<int>
+{
+    if (content_size.width() <= 0 || content_size.height() <= 0)
+        return {};
+
+    const auto content_width = static_cast<int64_t>(content_size.width());
+    const auto content_height = static_cast<int64_t>(content_size.height());
+    const auto output_width = static_cast<int64_t>(output_size.width());
+    const auto output_height = static_cast<int64_t>(output_size.height());
+
+    int64_t width = output_width;
+    int64_t height = output_height;
+    if (mode == cam_fit_mode::shrink && content_width <= output_width && content_height <= output_height)
+    {
+        width = content_width;
+        height = content_height;
+    }
+    /* compare the aspect ratios without rounding, the limiting side fills the output */
+    else if (content_width * output_height > content_height * output_width)
+    {
+        height = std::max<int64_t>((content_height * output_width + content_width / 2) / content_width, 1);
+    }
+    else
+    {
+        width = std::max<int64_t>((content_width * output_height + content_height / 2) / content_height, 1);
+    }
+
+    const auto left = static_cast<int>((output_width - width) / 2);
+    const auto top = static_cast<int>((output_height - height) / 2);
+    return {left, top, left + static_cast<int>(width), top + static_cast<int>(height)};
+}
+
+} // namespace cam
+
+cam_window_tracker::cam_window_tracker(const cam_window_tracker_config &config)
+    : config_(config)
+{
+    if (config.output_size.width() <= 0 || config.output_size.height() <= 0)
+        throw std::invalid_argument("cam_window_tracker: invalid output size");
+
+    if (config.max_size.width() <= 0 || config.max_size.height() <= 0)
+        throw std::invalid_argument("cam_window_tracker: invalid max size");
+
+    output_.resize(static_cast<size_t>(get_output_stride()) * config.output_size.height());
+}
+
+bool cam_window_tracker::update(const cam::size<int> &window_size)
+{
+    const auto capture_size = cam::size<int>(
+        std::clamp(window_size.width(), 0, config_.max_size.width()),
+        std::clamp(window_size.height(), 0, config_.max_size.height()));
+
+    if (has_geometry_ && capture_size == capture_size_)
+        return false;
+
+    has_geometry_ = true;
+    capture_size_ = capture_size;
+    content_rect_ = cam::fit_rect(capture_size_, config_.output_size, config_.fit_mode);
+    if (content_rect_.empty())
+        scaler_.reset();
+    else
+        scaler_.emplace(capture_size_, content_rect_.size(), config_.filter);
+
+    /* the old content might be larger than the new content, so clear the bars once */
+    clear_output_ = true;
+    return true;
+}
+
+auto cam_window_tracker::get_capture_size() const noexcept -> const cam::size<int> &
+{
+    return capture_size_;
+}
+
+auto cam_window_tracker::get_content_rect() const noexcept -> const cam::rect<int> &
+{
+    return content_rect_;
+}
+
+void cam_window_tracker::render(const uint8_t *src, const int src_stride)
+{
+    if (clear_output_)
+    {
+        std::memset(output_.data(), 0, output_.size());
+        clear_output_ = false;
+    }
+
+    if (!scaler_)
+        return;
+
+    auto *dst = output_.data() + static_cast<ptrdiff_t>(content_rect_.top()) * get_output_stride()
+        + static_cast<ptrdiff_t>(content_rect_.left()) * 4;
+    scaler_->scale(src, src_stride, dst, get_output_stride());
+}
+
+auto cam_window_tracker::get_output_data() const noexcept -> const uint8_t *
+{
+    return output_.data();
+}
+
+auto cam_window_tracker::get_output_size() const noexcept -> const cam::size<int> &
+{
+    return config_.output_size;
+}
+
+auto cam_window_tracker::get_output_stride() const noexcept -> int
+{
+    return config_.output_size.width() * 4;
+}
@@ -0,0 +1,162 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_autopan.h>
+#include <cmath>
+#include <vector>
+
+constexpr double test_frame_delta = 1.0 / 30.0;
+
+static auto create_test_config() -> cam_autopan_config
+{
+    cam_autopan_config config;
+    config.viewport_size = cam::size<int>(640, 360);
+    config.output_size = cam::size<int>(1280, 720);
+    config.max_speed = 1000.0;
+    config.margin = 0.25;
+    return config;
+}
+
+static auto get_center(const cam::rect<int> &rect) -> point<int>
+{
+    return point<int>((rect.left() + rect.right()) / 2, (rect.top() + rect.bottom()) / 2);
+}
+
+TEST(test_autopan, test_first_update_centers_on_cursor)
+{
+    cam_autopan autopan(cam::size<int>(1920, 1080), create_test_config());
+    autopan.update(point<int>(1000, 500), test_frame_delta);
+    EXPECT_EQ(autopan.get_viewport(), cam::rect<int>(680, 320, 1320, 680));
+}
+
+TEST(test_autopan, test_viewport_stays_inside_frame)
+{
+    cam_autopan autopan(cam::size<int>(1920, 1080), create_test_config());
+    autopan.update(point<int>(5, 5), test_frame_delta);
+    EXPECT_EQ(autopan.get_viewport(), cam::rect<int>(0, 0, 640, 360));
+
+    for (int i = 0; i < 300; ++i)
+        autopan.update(point<int>(1919, 1079), test_frame_delta);
+    EXPECT_EQ(autopan.get_viewport(), cam::rect<int>(1280, 720, 1920, 1080));
+}
+
+TEST(test_autopan, test_no_pan_in_center_region)
+{
+    cam_autopan autopan(cam::size<int>(1920, 1080), create_test_config());
+    autopan.update(point<int>(960, 540), test_frame_delta);
+    const auto viewport = autopan.get_viewport();
+
+    // a small circle around the center, well inside the center region (160x90).
+    for (int i = 0; i < 100; ++i)
+    {
+        const auto angle = i * 0.1;
+        autopan.update(point<int>(960 + static_cast<int>(std::cos(angle) * 100),
+            540 + static_cast<int>(std::sin(angle) * 60)), test_frame_delta);
+        ASSERT_EQ(autopan.get_viewport(), viewport);
+    }
+}
+
+TEST(test_autopan, test_pan_speed_is_limited)
+{
+    auto config = create_test_config();
+    cam_autopan autopan(cam::size<int>(4000, 1080), config);
+    autopan.update(point<int>(400, 540), test_frame_delta);
+
+    // jump far to the right, the viewport must follow smoothly.
+    auto previous = get_center(autopan.get_viewport());
+    int arrival_frame = -1;
+    for (int frame = 0; frame < 300; ++frame)
+    {
+        autopan.update(point<int>(3500, 540), test_frame_delta);
+        const auto center = get_center(autopan.get_viewport());
+        ASSERT_LE(std::abs(center.x() - previous.x()), config.max_speed * test_frame_delta + 1.0);
+        previous = center;
+
+        // the cursor is back in the center region, which ends 160 pixels from the viewport edge.
+        if (arrival_frame < 0 && center.x() >= 3500 - 160 - 5)
+            arrival_frame = frame;
+    }
+
+    // 2940 pixels at 1000 pixels per second, plus easing in at the end.
+    EXPECT_GT(arrival_frame, 2940 * 30 / 1000);
+    EXPECT_LT(arrival_frame, 150);
+    EXPECT_EQ(get_center(autopan.get_viewport()).x(), 3500 - 160);
+}
+
+TEST(test_autopan, test_follows_cursor_path)
+{
+    cam_autopan autopan(cam::size<int>(1920, 1080), create_test_config());
+
+    // a cursor path that moves at 300 pixels per second, slower than the max pan speed.
+    point<int> cursor(100, 100);
+    autopan.update(cursor, test_frame_delta);
+    for (int i = 0; i < 300; ++i)
+    {
+        cursor = point<int>(100 + i * 10 / 2, 100 + i * 6 / 2);
+        autopan.update(cursor, test_frame_delta);
+
+        // the cursor never leaves the viewport.
+        const auto viewport = autopan.get_viewport();
+        ASSERT_GE(cursor.x(), viewport.left());
+        ASSERT_LT(cursor.x(), viewport.right());
+        ASSERT_GE(cursor.y(), viewport.top());
+        ASSERT_LT(cursor.y(), viewport.bottom());
+    }
+}
+
+TEST(test_autopan, test_render_reads_only_the_viewport)
+{
+    auto config = create_test_config();
+    config.viewport_size = cam::size<int>(64, 32);
+    config.output_size = cam::size<int>(32, 16);
+    config.filter = cam::scale_filter::area;
+
+    // a 256x256 frame, the pixels outside the viewport get another value every render.
+    const cam::size<int> frame_size(256, 256);
+    std::vector<uint32_t> frame(256 * 256);
+    cam_autopan autopan(frame_size, config);
+    autopan.update(point<int>(100, 150), test_frame_delta);
+    const auto viewport = autopan.get_viewport();
+    ASSERT_EQ(viewport, cam::rect<int>(68, 134, 132, 166));
+
+    std::vector<uint8_t> first_output;
+    for (const uint32_t outside : {0xff000000u, 0xffffffffu})
+    {
+        for (int y = 0; y < 256; ++y)
+        {
+            for (int x = 0; x < 256; ++x)
+            {
+                const auto inside = x >= viewport.left() && x < viewport.right()
+                    && y >= viewport.top() && y < viewport.bottom();
+                frame[y * 256 + x] = inside ? 0xff000000u | (x << 8) | y : outside;
+            }
+        }
+
+        autopan.render(reinterpret_cast<const uint8_t *>(frame.data()), 256 * 4);
+        const auto *output = autopan.get_output_data();
+        std::vector<uint8_t> result(output, output + autopan.get_output_stride() * 16);
+        if (first_output.empty())
+            first_output = result;
+        else
+            EXPECT_EQ(first_output, result);
+    }
+
+    // the top left output pixel is the average of the top left 2x2 pixels of the viewport.
+    EXPECT_NEAR(first_output[0], (134 + 135) / 2.0, 1.0);
+    EXPECT_NEAR(first_output[1], (68 + 69) / 2.0, 1.0);
+}
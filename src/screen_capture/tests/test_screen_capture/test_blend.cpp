@@ -0,0 +1,83 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_blend.h>
+#include <random>
+#include <vector>
+
+/* a random but valid premultiplied pixel, every color channel is <= alpha. */
+static uint32_t random_premultiplied_pixel(std::mt19937 &random)
+{
+    std::uniform_int_distribution<uint32_t> distribution(0, 255);
+    const auto alpha = distribution(random);
+    const auto channel = [&]() { return alpha == 0 ? 0 : distribution(random) % (alpha + 1); };
+    return alpha << 24 | channel() << 16 | channel() << 8 | channel();
+}
+
+TEST(test_blend, test_transparent_and_opaque)
+{
+    uint32_t dst[2] = {0xff102030, 0xff102030};
+    const uint32_t src[2] = {0x00000000, 0xff405060};
+    cam::blend_row_scalar(dst, src, 2);
+
+    EXPECT_EQ(dst[0], 0xff102030u);
+    EXPECT_EQ(dst[1], 0xff405060u);
+}
+
+TEST(test_blend, test_half_transparent)
+{
+    // 50% white over black.
+    uint32_t dst = 0xff000000;
+    const uint32_t src = 0x80808080;
+    cam::blend_row_scalar(&dst, &src, 1);
+    EXPECT_EQ(dst, 0xff808080u);
+}
+
+TEST(test_blend, test_kernels_are_bit_identical)
+{
+    std::mt19937 random(42);
+
+    // odd sizes, to test the scalar tail of the simd kernels.
+    for (const auto kernel : {cam::blend_kernel::sse2, cam::blend_kernel::avx2})
+    {
+        if (!cam::is_blend_kernel_supported(kernel))
+            continue;
+
+        const auto blend_function = cam::get_blend_row_function(kernel);
+        for (int count = 0; count < 67; ++count)
+        {
+            std::vector<uint32_t> src(count);
+            std::vector<uint32_t> expected(count);
+            for (int i = 0; i < count; ++i)
+            {
+                src[i] = random_premultiplied_pixel(random);
+                expected[i] = random_premultiplied_pixel(random) | 0xff000000;
+            }
+
+            auto actual = expected;
+            cam::blend_row_scalar(expected.data(), src.data(), count);
+            blend_function(actual.data(), src.data(), count);
+            ASSERT_EQ(expected, actual) << "kernel " << static_cast<int>(kernel) << " count " << count;
+        }
+    }
+}
+
+TEST(test_blend, test_best_kernel_is_supported)
+{
+    EXPECT_TRUE(cam::is_blend_kernel_supported(cam::get_best_blend_kernel()));
+}
@@ -0,0 +1,154 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_canvas.h>
+#include <screen_capture/cam_sprite.h>
+#include <vector>
+
+constexpr auto canvas_width = 64;
+constexpr auto canvas_height = 32;
+constexpr uint32_t background = 0xff000000;
+
+class test_canvas : public ::testing::Test
+{
+protected:
+    std::vector<uint32_t> pixels_ = std::vector<uint32_t>(canvas_width * canvas_height, background);
+    cam_canvas canvas_{reinterpret_cast<uint8_t *>(pixels_.data()), canvas_width, canvas_height,
+        canvas_width * 4};
+
+    uint32_t pixel(int x, int y) const
+    {
+        return pixels_[y * canvas_width + x];
+    }
+};
+
+TEST_F(test_canvas, test_draw_sprite)
+{
+    const auto sprite = cam::create_filled_rect_sprite({4, 2}, cam::colors::white);
+    canvas_.draw_sprite(sprite, {10, 5});
+
+    EXPECT_EQ(pixel(9, 5), background);
+    EXPECT_EQ(pixel(10, 5), 0xffffffffu);
+    EXPECT_EQ(pixel(13, 6), 0xffffffffu);
+    EXPECT_EQ(pixel(14, 6), background);
+    EXPECT_EQ(pixel(10, 7), background);
+
+    EXPECT_EQ(canvas_.get_dirty_rect(), cam::rect<int>(10, 5, 14, 7));
+}
+
+TEST_F(test_canvas, test_clip_sprite)
+{
+    const auto sprite = cam::create_filled_rect_sprite({8, 8}, cam::colors::red);
+    canvas_.draw_sprite(sprite, {-4, -4});
+    canvas_.draw_sprite(sprite, {canvas_width - 4, canvas_height - 4});
+
+    EXPECT_EQ(pixel(0, 0), 0xffff0000u);
+    EXPECT_EQ(pixel(3, 3), 0xffff0000u);
+    EXPECT_EQ(pixel(4, 4), background);
+    EXPECT_EQ(pixel(canvas_width - 1, canvas_height - 1), 0xffff0000u);
+
+    // the dirty rect is the union, clipped against the canvas.
+    EXPECT_EQ(canvas_.get_dirty_rect(), cam::rect<int>(0, 0, canvas_width, canvas_height));
+}
+
+TEST_F(test_canvas, test_sprite_outside_canvas)
+{
+    const auto sprite = cam::create_filled_rect_sprite({8, 8}, cam::colors::red);
+    canvas_.draw_sprite(sprite, {-8, 0});
+    canvas_.draw_sprite(sprite, {canvas_width, 0});
+
+    EXPECT_TRUE(canvas_.get_dirty_rect().empty());
+    for (const auto value : pixels_)
+        ASSERT_EQ(value, background);
+}
+
+TEST_F(test_canvas, test_draw_sprite_centered)
+{
+    const auto sprite = cam::create_filled_rect_sprite({3, 3}, cam::colors::green);
+    canvas_.draw_sprite_centered(sprite, {20, 20});
+    EXPECT_EQ(canvas_.get_dirty_rect(), cam::rect<int>(19, 19, 22, 22));
+}
+
+TEST(test_sprite, test_premultiply)
+{
+    EXPECT_EQ(cam::premultiply(cam::color(0xff, 0xff, 0x80, 0x00)), 0xffff8000u);
+    EXPECT_EQ(cam::premultiply(cam::color(0x80, 0xff, 0xff, 0xff)), 0x80808080u);
+    EXPECT_EQ(cam::premultiply(cam::colors::white, 0), 0u);
+}
+
+TEST(test_sprite, test_filled_ellipse)
+{
+    const auto sprite = cam::create_filled_ellipse_sprite({16, 16}, cam::colors::white);
+    ASSERT_EQ(sprite.width(), 16);
+    ASSERT_EQ(sprite.height(), 16);
+
+    // the center is opaque, the corners are transparent and the edge is anti aliased.
+    EXPECT_EQ(sprite.row(8)[8], 0xffffffffu);
+    EXPECT_EQ(sprite.row(0)[0], 0u);
+    EXPECT_EQ(sprite.row(15)[15], 0u);
+
+    int partial_count = 0;
+    for (int y = 0; y < sprite.height(); ++y)
+    {
+        for (int x = 0; x < sprite.width(); ++x)
+        {
+            const auto value = sprite.row(y)[x];
+            const auto alpha = value >> 24;
+            if (alpha > 0 && alpha < 255)
+                ++partial_count;
+
+            // premultiplied color never exceeds alpha, and the ellipse is symmetric.
+            ASSERT_LE(value & 0xff, alpha);
+            ASSERT_EQ(value, sprite.row(y)[sprite.width() - 1 - x]);
+            ASSERT_EQ(value, sprite.row(sprite.height() - 1 - y)[x]);
+        }
+    }
+    EXPECT_GT(partial_count, 0);
+}
+
+TEST(test_sprite, test_ring)
+{
+    const auto sprite = cam::create_ring_sprite(20.0, 2.0, cam::colors::white);
+    ASSERT_EQ(sprite.width(), 24);
+
+    // the ring is hollow.
+    const auto center = sprite.width() / 2;
+    EXPECT_EQ(sprite.row(center)[center], 0u);
+    EXPECT_EQ(sprite.row(center)[center - 10] >> 24, 255u);
+}
+
+TEST(test_sprite, test_cached_sprite)
+{
+    cam_cached_sprite<int> cache;
+    int render_count = 0;
+    const auto render = [&]() {
+        ++render_count;
+        return cam::create_filled_rect_sprite({2, 2}, cam::colors::white);
+    };
+
+    cache.get(1, render);
+    cache.get(1, render);
+    EXPECT_EQ(render_count, 1);
+
+    cache.get(2, render);
+    EXPECT_EQ(render_count, 2);
+
+    cache.invalidate();
+    cache.get(2, render);
+    EXPECT_EQ(render_count, 3);
+}
@@ -0,0 +1,204 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_capture_plan.h>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using monitor_layout = std::vector<cam::rect<int>>;
+
+// three 4k monitors side by side, the primary monitor in the middle.
+static auto create_triple_4k_layout() -> monitor_layout
+{
+    return {{-3840, 0, 0, 2160}, {0, 0, 3840, 2160}, {3840, 0, 7680, 2160}};
+}
+
+// a 1080p monitor next to a 1440p monitor, leaving a gap below the smaller one.
+static auto create_l_shaped_layout() -> monitor_layout
+{
+    return {{0, 0, 1920, 1080}, {1920, 0, 4480, 1440}};
+}
+
+/* the value a synthetic screen has at a screen position, or 0 when there is no monitor. */
+static auto screen_pixel(const monitor_layout &monitors, int x, int y) -> uint32_t
+{
+    for (const auto &monitor : monitors)
+    {
+        if (x >= monitor.left() && x < monitor.right() && y >= monitor.top() && y < monitor.bottom())
+            return (static_cast<uint32_t>(x + 10000) << 16) | static_cast<uint32_t>(y + 10000);
+    }
+    return 0;
+}
+
+/* execute a plan the way the capture source does, but copying from a synthetic screen. */
+static auto execute_plan(const cam_capture_plan &plan, const monitor_layout &monitors) -> std::vector<uint32_t>
+{
+    const auto size = plan.get_frame_size();
+    std::vector<uint32_t> frame(static_cast<size_t>(size.width()) * size.height(), 0xffffffff);
+    if (!plan.fully_covered)
+        std::fill(frame.begin(), frame.end(), 0);
+
+    for (const auto &copy : plan.copies)
+    {
+        for (int y = 0; y < copy.src.height(); ++y)
+        {
+            for (int x = 0; x < copy.src.width(); ++x)
+            {
+                const auto index = static_cast<size_t>(copy.dst.y() + y) * size.width() + copy.dst.x() + x;
+                frame[index] = screen_pixel(monitors, copy.src.left() + x, copy.src.top() + y);
+            }
+        }
+    }
+    return frame;
+}
+
+static void expect_frame_matches_screen(const cam::rect<int> &capture_rect, const monitor_layout &monitors)
+{
+    const auto plan = cam_create_capture_plan(capture_rect, monitors);
+    const auto frame = execute_plan(plan, monitors);
+    for (int y = 0; y < capture_rect.height(); ++y)
+    {
+        for (int x = 0; x < capture_rect.width(); ++x)
+        {
+            const auto expected = screen_pixel(monitors, capture_rect.left() + x, capture_rect.top() + y);
+            ASSERT_EQ(frame[static_cast<size_t>(y) * capture_rect.width() + x], expected)
+                << "at " << x << ", " << y;
+        }
+    }
+}
+
+TEST(test_capture_plan, test_intersect)
+{
+    const cam::rect<int> a{0, 0, 100, 100};
+    EXPECT_EQ(cam::intersect(a, cam::rect<int>{50, -20, 150, 50}), (cam::rect<int>{50, 0, 100, 50}));
+    EXPECT_EQ(cam::intersect(a, cam::rect<int>{10, 10, 20, 20}), (cam::rect<int>{10, 10, 20, 20}));
+    EXPECT_EQ(cam::intersect(a, cam::rect<int>{-50, -50, -10, -10}), cam::rect<int>{});
+    // touching edges do not intersect.
+    EXPECT_EQ(cam::intersect(a, cam::rect<int>{100, 0, 200, 100}), cam::rect<int>{});
+}
+
+TEST(test_capture_plan, test_region_on_one_monitor)
+{
+    const auto monitors = create_triple_4k_layout();
+    const cam::rect<int> capture_rect{100, 200, 2020, 1280};
+    const auto plan = cam_create_capture_plan(capture_rect, monitors);
+
+    // only the 1080p region is allocated, not the 11520x2160 virtual screen.
+    EXPECT_EQ(plan.get_frame_size().width(), 1920);
+    EXPECT_EQ(plan.get_frame_size().height(), 1080);
+    EXPECT_TRUE(plan.fully_covered);
+    ASSERT_EQ(plan.copies.size(), 1u);
+    EXPECT_EQ(plan.copies[0].monitor_index, 1);
+    EXPECT_EQ(plan.copies[0].src, capture_rect);
+    EXPECT_EQ(plan.copies[0].dst.x(), 0);
+    EXPECT_EQ(plan.copies[0].dst.y(), 0);
+}
+
+TEST(test_capture_plan, test_region_on_negative_monitor)
+{
+    const auto monitors = create_triple_4k_layout();
+    const cam::rect<int> capture_rect{-3000, 100, -1000, 1100};
+    const auto plan = cam_create_capture_plan(capture_rect, monitors);
+
+    ASSERT_EQ(plan.copies.size(), 1u);
+    EXPECT_EQ(plan.copies[0].monitor_index, 0);
+    EXPECT_TRUE(plan.fully_covered);
+    expect_frame_matches_screen(capture_rect, monitors);
+}
+
+TEST(test_capture_plan, test_region_spanning_monitors)
+{
+    const auto monitors = create_triple_4k_layout();
+    const cam::rect<int> capture_rect{-500, 1000, 4340, 1500};
+    const auto plan = cam_create_capture_plan(capture_rect, monitors);
+
+    EXPECT_TRUE(plan.fully_covered);
+    ASSERT_EQ(plan.copies.size(), 3u);
+    EXPECT_EQ(plan.copies[0].src, (cam::rect<int>{-500, 1000, 0, 1500}));
+    EXPECT_EQ(plan.copies[1].src, (cam::rect<int>{0, 1000, 3840, 1500}));
+    EXPECT_EQ(plan.copies[1].dst.x(), 500);
+    EXPECT_EQ(plan.copies[2].src, (cam::rect<int>{3840, 1000, 4340, 1500}));
+    EXPECT_EQ(plan.copies[2].dst.x(), 4340);
+    expect_frame_matches_screen(capture_rect, monitors);
+}
+
+TEST(test_capture_plan, test_virtual_screen)
+{
+    const auto monitors = create_l_shaped_layout();
+    const cam::rect<int> capture_rect{0, 0, 4480, 1440};
+    const auto plan = cam_create_capture_plan(capture_rect, monitors);
+
+    EXPECT_EQ(plan.copies.size(), 2u);
+    // the area below the 1080p monitor is not on any monitor.
+    EXPECT_FALSE(plan.fully_covered);
+    expect_frame_matches_screen(capture_rect, monitors);
+}
+
+TEST(test_capture_plan, test_region_in_gap)
+{
+    const auto monitors = create_l_shaped_layout();
+    const cam::rect<int> capture_rect{100, 1100, 500, 1300};
+    const auto plan = cam_create_capture_plan(capture_rect, monitors);
+
+    EXPECT_TRUE(plan.copies.empty());
+    EXPECT_FALSE(plan.fully_covered);
+    EXPECT_EQ(plan.get_frame_size().width(), 400);
+    EXPECT_EQ(plan.get_frame_size().height(), 200);
+}
+
+TEST(test_capture_plan, test_region_partially_off_screen)
+{
+    const auto monitors = create_l_shaped_layout();
+    const cam::rect<int> capture_rect{-100, -100, 300, 300};
+    const auto plan = cam_create_capture_plan(capture_rect, monitors);
+
+    ASSERT_EQ(plan.copies.size(), 1u);
+    EXPECT_EQ(plan.copies[0].dst.x(), 100);
+    EXPECT_EQ(plan.copies[0].dst.y(), 100);
+    EXPECT_FALSE(plan.fully_covered);
+    expect_frame_matches_screen(capture_rect, monitors);
+}
+
+TEST(test_capture_plan, test_mirrored_monitors)
+{
+    const monitor_layout monitors{{0, 0, 1920, 1080}, {0, 0, 1920, 1080}, {1920, 0, 3840, 1080}};
+    const auto plan = cam_create_capture_plan({1000, 0, 2000, 500}, monitors);
+
+    ASSERT_EQ(plan.copies.size(), 2u);
+    EXPECT_EQ(plan.copies[0].monitor_index, 0);
+    EXPECT_EQ(plan.copies[1].monitor_index, 2);
+    EXPECT_TRUE(plan.fully_covered);
+}
+
+TEST(test_capture_plan, test_overlapping_monitors_do_not_fake_coverage)
+{
+    // the overlap makes the copy areas add up to the capture area, while a corner is uncovered.
+    const monitor_layout monitors{{0, 0, 100, 100}, {50, 0, 150, 100}, {0, 100, 100, 200}};
+    const auto plan = cam_create_capture_plan({0, 0, 150, 200}, monitors);
+
+    EXPECT_EQ(plan.copies.size(), 3u);
+    EXPECT_FALSE(plan.fully_covered);
+}
+
+TEST(test_capture_plan, test_empty_capture_rect)
+{
+    const auto monitors = create_triple_4k_layout();
+    EXPECT_THROW(cam_create_capture_plan({10, 10, 10, 20}, monitors), std::invalid_argument);
+    EXPECT_THROW(cam_create_capture_plan({10, 10, 0, 0}, monitors), std::invalid_argument);
+}
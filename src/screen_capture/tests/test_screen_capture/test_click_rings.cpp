@@ -0,0 +1,173 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_canvas.h>
+#include <screen_capture/cam_click_rings.h>
+#include <cmath>
+#include <vector>
+
+constexpr auto frame_delta = 1.0 / 30.0;
+constexpr auto canvas_size = 256;
+constexpr auto ring_max_size = 100;
+
+// ring diameter growth in pixels per second (ring speed 5 * 20).
+constexpr auto ring_growth = 100.0;
+
+/* an input event as it was recorded, with the time since the start of the recording */
+struct recorded_event
+{
+    double timestamp;
+    point<int> position;
+    cam_mouse_button::type button;
+};
+
+class test_click_rings : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        rings_.set_style(cam_mouse_button::left_button_down, ring_max_size, cam::colors::red);
+        rings_.set_style(cam_mouse_button::right_button_down, ring_max_size, cam::colors::green);
+    }
+
+    /* replay the recorded events against a fixed frame clock, the events that happened since the
+     * previous frame are passed with their time relative to that frame. */
+    void replay(const int frame_count)
+    {
+        std::vector<cam_input_event> frame_events;
+        for (int i = 0; i < frame_count; ++i)
+        {
+            const auto frame_start = frame_ * frame_delta;
+            const auto frame_end = frame_start + frame_delta;
+
+            frame_events.clear();
+            while (next_event_ < recording_.size() && recording_[next_event_].timestamp <= frame_end)
+            {
+                const auto &event = recording_[next_event_++];
+                frame_events.push_back({event.timestamp - frame_start, event.position, event.button});
+            }
+
+            rings_.add(frame_events);
+            rings_.draw(canvas_, {0, 0}, frame_delta);
+            ++frame_;
+        }
+    }
+
+    auto now() const noexcept -> double
+    {
+        return frame_ * frame_delta;
+    }
+
+    std::vector<uint32_t> pixels_ = std::vector<uint32_t>(canvas_size * canvas_size, 0xff000000);
+    cam_canvas canvas_{reinterpret_cast<uint8_t *>(pixels_.data()), canvas_size, canvas_size, canvas_size * 4};
+    cam_click_rings rings_;
+    std::vector<recorded_event> recording_;
+    size_t next_event_{0};
+    int frame_{0};
+};
+
+TEST_F(test_click_rings, test_click_within_frame)
+{
+    // a click and release within the first frame.
+    recording_ = {
+        {0.005, {100, 100}, cam_mouse_button::left_button_down},
+        {0.010, {100, 100}, cam_mouse_button::left_button_up},
+    };
+    replay(1);
+
+    ASSERT_EQ(rings_.size(), 1u);
+    EXPECT_EQ(rings_.get_ring_size(0), static_cast<int>(std::round((frame_delta - 0.005) * ring_growth)));
+    EXPECT_FALSE(canvas_.get_dirty_rect().empty());
+}
+
+TEST_F(test_click_rings, test_rings_start_at_click_time)
+{
+    // two clicks in the same frame, the later click has a smaller ring.
+    recording_ = {
+        {0.001, {50, 50}, cam_mouse_button::left_button_down},
+        {0.002, {50, 50}, cam_mouse_button::left_button_up},
+        {0.030, {150, 150}, cam_mouse_button::right_button_down},
+        {0.031, {150, 150}, cam_mouse_button::right_button_up},
+    };
+    replay(1);
+
+    ASSERT_EQ(rings_.size(), 2u);
+    EXPECT_EQ(rings_.get_ring(0).ring_type_, cam_mouse_button::left_button_down);
+    EXPECT_EQ(rings_.get_ring(1).ring_type_, cam_mouse_button::right_button_down);
+    EXPECT_GT(rings_.get_ring_size(0), rings_.get_ring_size(1));
+}
+
+TEST_F(test_click_rings, test_replay_recording)
+{
+    recording_ = {
+        {0.020, {30, 30}, cam_mouse_button::left_button_down},
+        {0.090, {30, 30}, cam_mouse_button::left_button_up},
+        {0.210, {90, 60}, cam_mouse_button::right_button_down},
+        {0.215, {90, 60}, cam_mouse_button::right_button_up},
+        {0.216, {200, 200}, cam_mouse_button::left_button_down},
+        {0.240, {200, 200}, cam_mouse_button::left_button_up},
+    };
+
+    // every frame the ring size must match the time since the recorded click.
+    replay(7);
+    std::vector<double> click_times = {0.020};
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        if (now() >= 0.216 && click_times.size() == 1)
+            click_times = {0.020, 0.210, 0.216};
+
+        ASSERT_EQ(rings_.size(), click_times.size()) << "frame " << frame_;
+        for (size_t i = 0; i < click_times.size(); ++i)
+        {
+            const auto expected = static_cast<int>(std::round((now() - click_times[i]) * ring_growth));
+            EXPECT_NEAR(rings_.get_ring_size(i), expected, 1) << "frame " << frame_ << " ring " << i;
+        }
+
+        replay(1);
+    }
+}
+
+TEST_F(test_click_rings, test_rings_expire)
+{
+    recording_ = {{0.0, {100, 100}, cam_mouse_button::left_button_down}};
+    replay(1);
+    ASSERT_EQ(rings_.size(), 1u);
+
+    // the ring grows to its max size in a second.
+    replay(31);
+    EXPECT_EQ(rings_.size(), 0u);
+}
+
+TEST_F(test_click_rings, test_button_up_is_ignored)
+{
+    recording_ = {{0.01, {100, 100}, cam_mouse_button::left_button_up}};
+    replay(1);
+    EXPECT_TRUE(rings_.empty());
+    EXPECT_TRUE(canvas_.get_dirty_rect().empty());
+}
+
+TEST_F(test_click_rings, test_drop_oldest_ring)
+{
+    std::vector<cam_input_event> events;
+    for (int i = 0; i < 40; ++i)
+        events.push_back({0.0, {i, i}, cam_mouse_button::left_button_down});
+
+    rings_.add(events);
+    ASSERT_EQ(rings_.size(), cam_click_rings::max_rings);
+    EXPECT_EQ(rings_.get_ring(0).ring_center_, point<int>(8, 8));
+}
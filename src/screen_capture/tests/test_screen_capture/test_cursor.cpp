@@ -0,0 +1,159 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_cursor.h>
+#include <screen_capture/cam_canvas.h>
+#include <vector>
+
+constexpr auto cursor_size = 8;
+// 1 bit per pixel, padded to 32 bit like windows dibs.
+constexpr auto mask_stride = 4;
+
+/* a synthetic monochrome 8x8 cursor: a white square with a black border, transparent right half,
+ * and an inverted bottom row. */
+static std::vector<uint8_t> create_monochrome_masks()
+{
+    std::vector<uint8_t> masks(mask_stride * cursor_size * 2, 0);
+    auto *and_mask = masks.data();
+    auto *xor_mask = masks.data() + mask_stride * cursor_size;
+
+    for (int y = 0; y < cursor_size; ++y)
+    {
+        and_mask[y * mask_stride] = 0x0f; // right half transparent.
+        xor_mask[y * mask_stride] = (y == 0 || y == 7) ? 0x00 : 0x60; // white inside a black border.
+    }
+
+    // inverted bottom row, in the transparent half.
+    xor_mask[7 * mask_stride] = 0x0f;
+    return masks;
+}
+
+TEST(test_cursor, test_monochrome_cursor)
+{
+    const auto masks = create_monochrome_masks();
+    const auto sprite = cam::create_monochrome_cursor_sprite(cursor_size, cursor_size, masks.data(),
+        masks.data() + mask_stride * cursor_size, mask_stride);
+
+    ASSERT_EQ(sprite.width(), cursor_size);
+    ASSERT_EQ(sprite.height(), cursor_size);
+
+    EXPECT_EQ(sprite.row(0)[0], 0xff000000u); // black border
+    EXPECT_EQ(sprite.row(3)[1], 0xffffffffu); // white inside
+    EXPECT_EQ(sprite.row(3)[6], 0u); // transparent
+    EXPECT_EQ(sprite.row(7)[6], 0xff000000u); // inverted, drawn as black
+}
+
+TEST(test_cursor, test_color_cursor_with_alpha)
+{
+    std::vector<uint32_t> pixels(cursor_size * cursor_size, 0x80ffffff);
+    pixels[0] = 0xffff0000;
+    pixels[1] = 0x00000000;
+
+    const auto sprite = cam::create_color_cursor_sprite(cursor_size, cursor_size, pixels.data(), nullptr, 0);
+    EXPECT_EQ(sprite.row(0)[0], 0xffff0000u);
+    EXPECT_EQ(sprite.row(0)[1], 0u);
+    EXPECT_EQ(sprite.row(0)[2], 0x80808080u); // straight alpha is premultiplied.
+}
+
+TEST(test_cursor, test_color_cursor_without_alpha)
+{
+    std::vector<uint32_t> pixels(cursor_size * cursor_size, 0x00102030);
+    std::vector<uint8_t> and_mask(mask_stride * cursor_size, 0);
+    and_mask[0] = 0x80; // the first pixel is transparent.
+
+    const auto sprite = cam::create_color_cursor_sprite(cursor_size, cursor_size, pixels.data(),
+        and_mask.data(), mask_stride);
+    EXPECT_EQ(sprite.row(0)[0], 0u);
+    EXPECT_EQ(sprite.row(0)[1], 0xff102030u);
+}
+
+TEST(test_cursor, test_hash_bytes)
+{
+    const uint8_t a[] = {1, 2, 3};
+    const uint8_t b[] = {1, 2, 4};
+    EXPECT_EQ(cam::hash_bytes(a, sizeof(a)), cam::hash_bytes(a, sizeof(a)));
+    EXPECT_NE(cam::hash_bytes(a, sizeof(a)), cam::hash_bytes(b, sizeof(b)));
+}
+
+static cam_cursor_image create_test_cursor_image(uint32_t color)
+{
+    cam_cursor_image image;
+    image.sprite = cam::create_filled_rect_sprite({2, 2}, cam::color(color));
+    image.hotspot = point<int>(1, 1);
+    return image;
+}
+
+TEST(test_cursor_cache, test_cache_hit)
+{
+    cam_cursor_cache cache;
+    int create_count = 0;
+    const auto create = [&]() {
+        ++create_count;
+        return create_test_cursor_image(0xffffffff);
+    };
+
+    for (int i = 0; i < 100; ++i)
+        cache.get(1, 42, create);
+
+    EXPECT_EQ(create_count, 1);
+    EXPECT_EQ(cache.get_miss_count(), 1u);
+    EXPECT_EQ(cache.get_hit_count(), 99u);
+}
+
+TEST(test_cursor_cache, test_same_handle_new_shape)
+{
+    cam_cursor_cache cache;
+    cache.get(1, 42, [] { return create_test_cursor_image(0xffffffff); });
+    const auto &image = cache.get(1, 43, [] { return create_test_cursor_image(0xff000000); });
+
+    EXPECT_EQ(image.sprite.row(0)[0], 0xff000000u);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find(2, 42), nullptr);
+}
+
+TEST(test_cursor_cache, test_evict_least_recently_used)
+{
+    cam_cursor_cache cache(2);
+    cache.get(1, 1, [] { return create_test_cursor_image(0xffffffff); });
+    cache.get(2, 2, [] { return create_test_cursor_image(0xffffffff); });
+
+    // use cursor 1, so cursor 2 is the least recently used.
+    ASSERT_NE(cache.find(1, 1), nullptr);
+    cache.get(3, 3, [] { return create_test_cursor_image(0xffffffff); });
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_NE(cache.find(1, 1), nullptr);
+    EXPECT_EQ(cache.find(2, 2), nullptr);
+    EXPECT_NE(cache.find(3, 3), nullptr);
+}
+
+TEST(test_cursor_cache, test_blend_cursor)
+{
+    const auto masks = create_monochrome_masks();
+    cam_cursor_image image;
+    image.sprite = cam::create_monochrome_cursor_sprite(cursor_size, cursor_size, masks.data(),
+        masks.data() + mask_stride * cursor_size, mask_stride);
+
+    std::vector<uint32_t> frame(16 * 16, 0xff3a6ea5);
+    cam_canvas canvas(reinterpret_cast<uint8_t *>(frame.data()), 16, 16, 16 * 4);
+    canvas.draw_sprite(image.sprite, {4, 4});
+
+    EXPECT_EQ(frame[4 * 16 + 4], 0xff000000u); // border
+    EXPECT_EQ(frame[7 * 16 + 5], 0xffffffffu); // inside
+    EXPECT_EQ(frame[7 * 16 + 10], 0xff3a6ea5u); // transparent half shows the frame
+}
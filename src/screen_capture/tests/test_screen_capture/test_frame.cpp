@@ -0,0 +1,67 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_frame.h>
+#include <screen_capture/cam_synthetic_capture.h>
+
+TEST(test_frame, test_pixel_size)
+{
+    EXPECT_EQ(cam::get_pixel_size(cam_pixel_format::bgr0), 4);
+    EXPECT_EQ(cam::get_pixel_size(cam_pixel_format::bgra), 4);
+    EXPECT_EQ(cam::get_pixel_size(cam_pixel_format::bgr24), 3);
+    static_assert(cam::get_pixel_size(cam_pixel_format::bgr24) == 3);
+}
+
+TEST(test_frame, test_synthetic_frame_sequence_and_timestamp)
+{
+    cam_synthetic_capture_source source({0, 0, 640, 480});
+    const cam::rect<int> capture_rect{10, 20, 330, 260};
+
+    const auto time_before = cam::get_frame_time();
+    const auto &first = source.capture_frame(capture_rect);
+    EXPECT_EQ(first.sequence, 1u);
+    EXPECT_GE(first.timestamp, time_before);
+    EXPECT_EQ(first.width, 320);
+    EXPECT_EQ(first.height, 240);
+    EXPECT_EQ(first.stride, 320 * 4);
+    EXPECT_EQ(first.pixel_format, cam_pixel_format::bgr0);
+    EXPECT_FALSE(first.damage.valid);
+
+    // every capture gets the next sequence number, and a timestamp that does not go back in time.
+    auto previous_timestamp = first.timestamp;
+    for (uint64_t i = 2; i <= 10; ++i)
+    {
+        const auto &frame = source.capture_frame(capture_rect);
+        EXPECT_EQ(frame.sequence, i);
+        EXPECT_GE(frame.timestamp, previous_timestamp);
+        EXPECT_TRUE(frame.damage.is_unchanged());
+        previous_timestamp = frame.timestamp;
+    }
+    EXPECT_LE(previous_timestamp, cam::get_frame_time());
+}
+
+TEST(test_frame, test_synthetic_frame_pixels)
+{
+    cam_synthetic_capture_source source({0, 0, 64, 64});
+    source.fill_rect({8, 8, 16, 16}, 0xff00ff00);
+
+    const auto &frame = source.capture_frame({8, 8, 24, 24});
+    const auto *row = reinterpret_cast<const uint32_t *>(frame.bitmap_data);
+    EXPECT_EQ(row[0], 0xff00ff00u);
+    EXPECT_EQ(row[8], 0u);
+}
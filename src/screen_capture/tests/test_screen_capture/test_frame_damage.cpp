@@ -0,0 +1,231 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_canvas.h>
+#include <screen_capture/cam_frame_damage.h>
+#include <screen_capture/cam_frame_dedup.h>
+#include <screen_capture/cam_sprite.h>
+#include <screen_capture/cam_synthetic_capture.h>
+#include <random>
+#include <vector>
+
+// two 1080p monitors, the left one at negative coordinates.
+const cam::rect<int> test_desktop_rect{-1920, 0, 1920, 1080};
+
+static auto create_valid_damage() -> cam_frame_damage
+{
+    cam_frame_damage damage;
+    damage.valid = true;
+    return damage;
+}
+
+static auto create_frame(const cam::rect<int> &capture_rect) -> std::vector<uint8_t>
+{
+    return std::vector<uint8_t>(static_cast<size_t>(capture_rect.width()) * capture_rect.height() * 4);
+}
+
+TEST(test_frame_damage, test_clip_dirty_rects)
+{
+    auto desktop_damage = create_valid_damage();
+    desktop_damage.dirty_rects = {{50, 50, 150, 150}, {500, 500, 600, 600}, {-100, 0, 10, 10}};
+
+    cam_frame_damage frame_damage;
+    cam::clip_damage(desktop_damage, {100, 0, 400, 300}, frame_damage);
+
+    EXPECT_TRUE(frame_damage.valid);
+    ASSERT_EQ(frame_damage.dirty_rects.size(), 1u);
+    EXPECT_EQ(frame_damage.dirty_rects[0], cam::rect<int>(0, 50, 50, 150));
+}
+
+TEST(test_frame_damage, test_clip_invalid_damage)
+{
+    cam_frame_damage desktop_damage;
+    desktop_damage.dirty_rects = {{0, 0, 10, 10}};
+
+    auto frame_damage = create_valid_damage();
+    cam::clip_damage(desktop_damage, {0, 0, 100, 100}, frame_damage);
+    EXPECT_FALSE(frame_damage.valid);
+    EXPECT_TRUE(frame_damage.dirty_rects.empty());
+    EXPECT_FALSE(frame_damage.is_unchanged());
+}
+
+TEST(test_frame_damage, test_clip_move_rects)
+{
+    auto desktop_damage = create_valid_damage();
+    // moved within the capture rect.
+    desktop_damage.move_rects.push_back({point<int>(120, 20), cam::rect<int>(150, 20, 200, 70)});
+    // moved into the capture rect from outside, the previous frame does not have these pixels.
+    desktop_damage.move_rects.push_back({point<int>(900, 100), cam::rect<int>(300, 100, 350, 150)});
+
+    cam_frame_damage frame_damage;
+    cam::clip_damage(desktop_damage, {100, 0, 400, 300}, frame_damage);
+
+    ASSERT_EQ(frame_damage.move_rects.size(), 1u);
+    EXPECT_EQ(frame_damage.move_rects[0].src.x(), 20);
+    EXPECT_EQ(frame_damage.move_rects[0].src.y(), 20);
+    EXPECT_EQ(frame_damage.move_rects[0].dst, cam::rect<int>(50, 20, 100, 70));
+    ASSERT_EQ(frame_damage.dirty_rects.size(), 1u);
+    EXPECT_EQ(frame_damage.dirty_rects[0], cam::rect<int>(200, 100, 250, 150));
+}
+
+TEST(test_frame_damage, test_synthetic_source_reports_damage)
+{
+    cam_synthetic_capture_source source(test_desktop_rect);
+    const cam::rect<int> capture_rect{-200, 0, 200, 200};
+    auto frame = create_frame(capture_rect);
+    cam_frame_damage damage;
+
+    source.capture_frame(capture_rect, frame.data(), capture_rect.width() * 4, damage);
+    EXPECT_FALSE(damage.valid);
+
+    source.capture_frame(capture_rect, frame.data(), capture_rect.width() * 4, damage);
+    EXPECT_TRUE(damage.is_unchanged());
+
+    // changes outside of the capture rect are not reported.
+    source.fill_rect({1000, 500, 1100, 600}, 0xff00ff00);
+    source.capture_frame(capture_rect, frame.data(), capture_rect.width() * 4, damage);
+    EXPECT_TRUE(damage.is_unchanged());
+
+    source.fill_rect({-250, 10, -150, 20}, 0xff0000ff);
+    source.capture_frame(capture_rect, frame.data(), capture_rect.width() * 4, damage);
+    ASSERT_EQ(damage.dirty_rects.size(), 1u);
+    EXPECT_EQ(damage.dirty_rects[0], cam::rect<int>(0, 10, 50, 20));
+
+    source.move_rect({-100, 50, 0, 100}, point<int>(0, 50));
+    source.capture_frame(capture_rect, frame.data(), capture_rect.width() * 4, damage);
+    ASSERT_EQ(damage.move_rects.size(), 1u);
+    EXPECT_EQ(damage.move_rects[0].dst, cam::rect<int>(200, 50, 300, 100));
+    EXPECT_TRUE(damage.dirty_rects.empty());
+
+    // a move after other changes can only be reported as dirty.
+    source.fill_rect({-100, 50, 0, 100}, 0xffff0000);
+    source.move_rect({-100, 50, 0, 100}, point<int>(0, 150));
+    source.capture_frame(capture_rect, frame.data(), capture_rect.width() * 4, damage);
+    EXPECT_TRUE(damage.move_rects.empty());
+    EXPECT_EQ(damage.dirty_rects.size(), 2u);
+}
+
+TEST(test_frame_damage, test_copy_damaged_keeps_frame_in_sync)
+{
+    cam_synthetic_capture_source source(test_desktop_rect);
+    const cam::rect<int> capture_rect{-500, 100, 700, 900};
+    const auto stride = capture_rect.width() * 4;
+    auto frame = create_frame(capture_rect);
+    auto synced_frame = create_frame(capture_rect);
+    cam_frame_damage damage;
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> x_distribution(test_desktop_rect.left(), test_desktop_rect.right());
+    std::uniform_int_distribution<int> y_distribution(test_desktop_rect.top(), test_desktop_rect.bottom());
+    std::uniform_int_distribution<int> size_distribution(1, 300);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        const auto x = x_distribution(random);
+        const auto y = y_distribution(random);
+        const auto rect = cam::rect<int>(x, y, x + size_distribution(random), y + size_distribution(random));
+        if (i % 3 == 0)
+            source.move_rect(rect, point<int>(x_distribution(random), y_distribution(random)));
+        else
+            source.fill_rect(rect, static_cast<uint32_t>(random()));
+
+        source.capture_frame(capture_rect, frame.data(), stride, damage);
+        cam::copy_damaged(frame.data(), stride, synced_frame.data(), stride, capture_rect.size(), damage);
+        ASSERT_EQ(synced_frame, frame) << "after change " << i;
+    }
+}
+
+TEST(test_frame_damage, test_dedup_skips_unchanged_frames)
+{
+    cam_frame_dedup dedup(1.0);
+    auto unchanged = create_valid_damage();
+    auto changed = create_valid_damage();
+    changed.dirty_rects = {{0, 0, 10, 10}};
+
+    // the first frame is always encoded.
+    EXPECT_TRUE(dedup.should_encode(unchanged, 0.0));
+    EXPECT_FALSE(dedup.should_encode(unchanged, 0.1));
+    EXPECT_FALSE(dedup.should_encode(unchanged, 0.2));
+    EXPECT_TRUE(dedup.should_encode(changed, 0.3));
+    EXPECT_EQ(dedup.get_skipped_count(), 2);
+
+    // a still desktop is encoded once per max skip time.
+    EXPECT_FALSE(dedup.should_encode(unchanged, 1.2));
+    EXPECT_TRUE(dedup.should_encode(unchanged, 1.3));
+
+    // unknown damage is always encoded.
+    EXPECT_TRUE(dedup.should_encode(cam_frame_damage{}, 1.4));
+
+    dedup.reset();
+    EXPECT_TRUE(dedup.should_encode(unchanged, 1.5));
+}
+
+/* capture a frame, and draw a cursor on it like the capture source draws its annotations */
+static void capture_with_cursor(cam_synthetic_capture_source &source, const cam::rect<int> &capture_rect,
+    std::vector<uint8_t> &frame, const cam_sprite &cursor, const point<int> &cursor_position,
+    cam_annotation_damage &annotation_damage, cam_frame_damage &damage)
+{
+    const auto stride = capture_rect.width() * 4;
+    source.capture_frame(capture_rect, frame.data(), stride, damage);
+
+    cam_canvas canvas(frame.data(), capture_rect.width(), capture_rect.height(), stride);
+    canvas.draw_sprite(cursor, cursor_position);
+    annotation_damage.update(canvas, damage);
+}
+
+TEST(test_frame_damage, test_dedup_skips_static_cursor)
+{
+    cam_synthetic_capture_source source(test_desktop_rect);
+    const cam::rect<int> capture_rect{0, 0, 400, 300};
+    auto frame = create_frame(capture_rect);
+    const auto cursor = cam::create_filled_ellipse_sprite({32, 32}, cam::colors::white);
+    cam_annotation_damage annotation_damage;
+    cam_frame_damage damage;
+    cam_frame_dedup dedup(10.0);
+
+    capture_with_cursor(source, capture_rect, frame, cursor, {100, 100}, annotation_damage, damage);
+    EXPECT_TRUE(dedup.should_encode(damage, 0.0));
+
+    // the cursor is drawn every frame, but the frame did not change.
+    for (int i = 1; i <= 3; ++i)
+    {
+        capture_with_cursor(source, capture_rect, frame, cursor, {100, 100}, annotation_damage, damage);
+        EXPECT_TRUE(damage.is_unchanged());
+        EXPECT_FALSE(dedup.should_encode(damage, i * 0.1));
+    }
+    EXPECT_EQ(dedup.get_skipped_count(), 3);
+
+    // a moved cursor damages both its old and its new position.
+    capture_with_cursor(source, capture_rect, frame, cursor, {150, 120}, annotation_damage, damage);
+    ASSERT_EQ(damage.dirty_rects.size(), 2u);
+    EXPECT_EQ(damage.dirty_rects[0], cam::rect<int>(100, 100, 132, 132));
+    EXPECT_EQ(damage.dirty_rects[1], cam::rect<int>(150, 120, 182, 152));
+    EXPECT_TRUE(dedup.should_encode(damage, 0.4));
+
+    // the desktop shows through the corners of a static cursor, so its pixels changed as well.
+    source.fill_rect({140, 110, 200, 160}, 0xff0000ff);
+    capture_with_cursor(source, capture_rect, frame, cursor, {150, 120}, annotation_damage, damage);
+    ASSERT_EQ(damage.dirty_rects.size(), 3u);
+    EXPECT_EQ(damage.dirty_rects[0], cam::rect<int>(140, 110, 200, 160));
+    EXPECT_EQ(damage.dirty_rects[2], cam::rect<int>(150, 120, 182, 152));
+
+    capture_with_cursor(source, capture_rect, frame, cursor, {150, 120}, annotation_damage, damage);
+    EXPECT_TRUE(damage.is_unchanged());
+    EXPECT_EQ(annotation_damage.get_rect(), cam::rect<int>(150, 120, 182, 152));
+}
+
@@ -0,0 +1,207 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_canvas.h>
+#include <screen_capture/cam_click_rings.h>
+#include <screen_capture/cam_input_replay.h>
+#include <screen_capture/cam_input_stream.h>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+static std::vector<cam_input_record> create_test_records()
+{
+    return {
+        {0, cam_input_record_type::mouse_move, {100, 100}, 0},
+        {16000, cam_input_record_type::mouse_move, {104, 98}, 0},
+        {20000, cam_input_record_type::mouse_button_down, {104, 98}, cam_mouse_button::left_button_down},
+        {95000, cam_input_record_type::mouse_button_up, {104, 98}, cam_mouse_button::left_button_down},
+        {96000, cam_input_record_type::key_down, {104, 98}, 0x41},
+        {97000, cam_input_record_type::key_up, {104, 98}, 0x41},
+        {120000, cam_input_record_type::mouse_move, {-20, 2000}, 0},
+        {121000, cam_input_record_type::mouse_button_down, {-20, 2000}, cam_mouse_button::right_button_down},
+        {3600000000, cam_input_record_type::mouse_button_up, {-20, 2000}, cam_mouse_button::right_button_down},
+    };
+}
+
+static auto write_records(const std::vector<cam_input_record> &records) -> cam_input_stream_writer
+{
+    cam_input_stream_writer writer;
+    for (const auto &record : records)
+        writer.write(record);
+    return writer;
+}
+
+TEST(test_input_stream, test_round_trip)
+{
+    const auto records = create_test_records();
+    const auto writer = write_records(records);
+    EXPECT_EQ(writer.get_record_count(), static_cast<int64_t>(records.size()));
+
+    cam_input_stream_reader reader(writer.get_data());
+    cam_input_record record;
+    for (const auto &expected : records)
+    {
+        ASSERT_TRUE(reader.read(record));
+        EXPECT_EQ(record, expected);
+    }
+    EXPECT_FALSE(reader.read(record));
+}
+
+TEST(test_input_stream, test_compact)
+{
+    // a mouse move every frame, for a minute.
+    cam_input_stream_writer writer;
+    for (int i = 0; i < 60 * 30; ++i)
+        writer.write({i * 33333, cam_input_record_type::mouse_move, {500 + i % 7, 300 - i % 5}, 0});
+
+    // type, time delta (3 bytes), and two small position deltas.
+    EXPECT_LE(writer.get_data().size(), 5u + 6u * 60 * 30);
+}
+
+TEST(test_input_stream, test_invalid_stream)
+{
+    const std::vector<uint8_t> no_stream = {'R', 'I', 'F', 'F', 1};
+    EXPECT_THROW(cam_input_stream_reader{no_stream}, std::runtime_error);
+
+    const std::vector<uint8_t> too_short = {'C', 'S'};
+    EXPECT_THROW(cam_input_stream_reader{too_short}, std::runtime_error);
+
+    const std::vector<uint8_t> bad_version = {'C', 'S', 'I', 'N', 99};
+    EXPECT_THROW(cam_input_stream_reader{bad_version}, std::runtime_error);
+}
+
+TEST(test_input_stream, test_corrupt_stream)
+{
+    auto data = write_records(create_test_records()).get_data();
+
+    // truncate in the middle of a record.
+    auto truncated = data;
+    truncated.resize(truncated.size() - 2);
+    cam_input_stream_reader truncated_reader(truncated);
+    cam_input_record record;
+    EXPECT_THROW(while (truncated_reader.read(record)) {}, std::runtime_error);
+
+    // an unknown record type.
+    data[5] = 0x7f;
+    cam_input_stream_reader invalid_reader(data);
+    EXPECT_THROW(invalid_reader.read(record), std::runtime_error);
+}
+
+TEST(test_input_stream, test_save_load)
+{
+    const auto writer = write_records(create_test_records());
+    const std::string filename = "test_input_stream.caminput";
+
+    cam::save_input_stream(filename, writer.get_data());
+    const auto data = cam::load_input_stream(filename);
+    std::remove(filename.c_str());
+
+    EXPECT_EQ(data, writer.get_data());
+    EXPECT_THROW(cam::load_input_stream("does_not_exist.caminput"), std::runtime_error);
+}
+
+TEST(test_input_replay, test_advance)
+{
+    const auto writer = write_records(create_test_records());
+    cam_input_replay replay(writer.get_data());
+
+    replay.advance(0.0);
+    EXPECT_EQ(replay.get_mouse_position(), point<int>(100, 100));
+    EXPECT_TRUE(replay.get_input_events().empty());
+
+    // the click and release both happen in the next frame.
+    replay.advance(0.1);
+    EXPECT_EQ(replay.get_mouse_position(), point<int>(104, 98));
+    const auto events = replay.get_input_events();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].button, cam_mouse_button::left_button_down);
+    EXPECT_NEAR(events[0].time, 0.020, 1e-9);
+    EXPECT_EQ(events[1].button, cam_mouse_button::left_button_up);
+    EXPECT_NEAR(events[1].time, 0.095, 1e-9);
+
+    const cam::rect<int> canvas_rect(0, 0, 640, 480);
+    const auto draw_data = replay.get_draw_data(canvas_rect);
+    EXPECT_NEAR(draw_data.frame_delta_, 0.1, 1e-9);
+    EXPECT_EQ(draw_data.mouse_button_state_,
+        cam_mouse_button::left_button_down | cam_mouse_button::left_button_up);
+    EXPECT_EQ(draw_data.input_events_.size(), 2u);
+
+    replay.advance(0.2);
+    ASSERT_EQ(replay.get_input_events().size(), 1u);
+    EXPECT_EQ(replay.get_input_events()[0].position, point<int>(-20, 2000));
+    EXPECT_EQ(replay.get_input_events()[0].button, cam_mouse_button::right_button_down);
+
+    replay.advance(0.3);
+    EXPECT_TRUE(replay.get_input_events().empty());
+}
+
+TEST(test_input_replay, test_seek)
+{
+    const auto writer = write_records(create_test_records());
+    cam_input_replay replay(writer.get_data());
+
+    // the click in the skipped part does not produce events.
+    replay.seek(0.110);
+    EXPECT_EQ(replay.get_mouse_position(), point<int>(104, 98));
+    EXPECT_TRUE(replay.get_input_events().empty());
+
+    replay.advance(0.130);
+    EXPECT_EQ(replay.get_mouse_position(), point<int>(-20, 2000));
+    ASSERT_EQ(replay.get_input_events().size(), 1u);
+    EXPECT_NEAR(replay.get_input_events()[0].time, 0.011, 1e-9);
+    EXPECT_NEAR(replay.get_draw_data(cam::rect<int>(0, 0, 1, 1)).frame_delta_, 0.020, 1e-9);
+}
+
+/* render click rings onto 'decoded' frames from a recorded input stream */
+TEST(test_input_replay, test_composite_offline)
+{
+    cam_input_stream_writer writer;
+    writer.write({0, cam_input_record_type::mouse_move, {32, 32}, 0});
+    writer.write({40000, cam_input_record_type::mouse_button_down, {32, 32}, cam_mouse_button::left_button_down});
+    writer.write({60000, cam_input_record_type::mouse_button_up, {32, 32}, cam_mouse_button::left_button_down});
+
+    cam_input_replay replay(writer.get_data());
+    cam_click_rings rings;
+    rings.set_style(cam_mouse_button::left_button_down, 40, cam::colors::red);
+
+    std::vector<uint32_t> frame(64 * 64);
+    const cam::rect<int> canvas_rect(0, 0, 64, 64);
+    int frames_with_rings = 0;
+    for (int i = 0; i < 30; ++i)
+    {
+        std::fill(frame.begin(), frame.end(), 0xff000000);
+        cam_canvas canvas(reinterpret_cast<uint8_t *>(frame.data()), 64, 64, 64 * 4);
+
+        replay.advance(i / 30.0);
+        const auto draw_data = replay.get_draw_data(canvas_rect);
+        rings.add(draw_data.input_events_);
+        rings.draw(canvas, {0, 0}, draw_data.frame_delta_);
+
+        if (!canvas.get_dirty_rect().empty())
+        {
+            ++frames_with_rings;
+            const auto center = canvas.get_dirty_rect();
+            EXPECT_EQ((center.left() + center.right()) / 2, 32);
+        }
+    }
+
+    // the ring grows to 40 pixels in 0.4 seconds, 12 frames.
+    EXPECT_GE(frames_with_rings, 11);
+    EXPECT_LE(frames_with_rings, 13);
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_lru_cache.h>
+#include <string>
+#include <utility>
+
+TEST(test_lru_cache, test_insert_find)
+{
+    cam_lru_cache<int, std::string> cache(4);
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(cache.find(1), nullptr);
+
+    cache.insert(1, "one");
+    cache.insert(2, "two");
+    ASSERT_EQ(cache.size(), 2u);
+
+    ASSERT_NE(cache.find(1), nullptr);
+    EXPECT_EQ(*cache.find(1), "one");
+    EXPECT_EQ(*cache.find(2), "two");
+    EXPECT_EQ(cache.find(3), nullptr);
+}
+
+TEST(test_lru_cache, test_replace_value)
+{
+    cam_lru_cache<int, std::string> cache(4);
+    cache.insert(1, "one");
+    cache.insert(1, "uno");
+
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(*cache.find(1), "uno");
+}
+
+TEST(test_lru_cache, test_evict_least_recently_used)
+{
+    cam_lru_cache<int, int> cache(3);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.insert(3, 30);
+
+    // touching 1 makes 2 the least recently used entry.
+    ASSERT_NE(cache.find(1), nullptr);
+    cache.insert(4, 40);
+
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_EQ(*cache.find(4), 40);
+}
+
+TEST(test_lru_cache, test_contains_does_not_touch)
+{
+    cam_lru_cache<int, int> cache(2);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+
+    // contains must not refresh 1, so it is still the first to go.
+    EXPECT_TRUE(cache.contains(1));
+    cache.insert(3, 30);
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(2));
+}
+
+TEST(test_lru_cache, test_erase_and_clear)
+{
+    cam_lru_cache<int, int> cache(4);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+
+    EXPECT_TRUE(cache.erase(1));
+    EXPECT_FALSE(cache.erase(1));
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache.clear();
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(cache.find(2), nullptr);
+}
+
+TEST(test_lru_cache, test_many_evictions)
+{
+    constexpr auto capacity = 32;
+    cam_lru_cache<int, int> cache(capacity);
+    for (int i = 0; i < 1000; ++i)
+    {
+        cache.insert(i, i * 2);
+        ASSERT_LE(cache.size(), static_cast<std::size_t>(capacity));
+    }
+
+    // only the last 'capacity' keys are left.
+    for (int i = 0; i < 1000 - capacity; ++i)
+        EXPECT_FALSE(cache.contains(i));
+    for (int i = 1000 - capacity; i < 1000; ++i)
+        EXPECT_EQ(*cache.find(i), i * 2);
+}
+
+struct pair_hash
+{
+    auto operator()(const std::pair<int, int> &value) const noexcept -> std::size_t
+    {
+        return std::hash<int>{}(value.first) ^ (std::hash<int>{}(value.second) << 1);
+    }
+};
+
+TEST(test_lru_cache, test_custom_hash)
+{
+    cam_lru_cache<std::pair<int, int>, int, pair_hash> cache(2);
+    cache.insert({1, 2}, 3);
+    cache.insert({2, 1}, 4);
+
+    EXPECT_EQ(*cache.find({1, 2}), 3);
+    EXPECT_EQ(*cache.find({2, 1}), 4);
+    EXPECT_EQ(cache.find({1, 1}), nullptr);
+}
+
+TEST(test_lru_cache, test_zero_capacity)
+{
+    EXPECT_THROW((cam_lru_cache<int, int>{0}), std::invalid_argument);
+}
@@ -0,0 +1,197 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_mailbox.h>
+#include <screen_capture/cam_preview_tap.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+struct test_value
+{
+    int64_t first{0};
+    int64_t second{0};
+};
+
+static void publish_value(cam_mailbox<test_value> &mailbox, int64_t value)
+{
+    auto &slot = mailbox.write_slot();
+    slot.first = value;
+    slot.second = value;
+    mailbox.publish();
+}
+
+static auto wait_for_preview(cam_preview_tap &tap) -> const cam_preview_image *
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        if (const auto *preview = tap.take_preview(); preview != nullptr)
+            return preview;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return nullptr;
+}
+
+TEST(test_preview_tap, test_mailbox_keeps_latest_value)
+{
+    cam_mailbox<test_value> mailbox;
+    EXPECT_EQ(mailbox.take(), nullptr);
+
+    mailbox.write_slot().first = 1;
+    EXPECT_TRUE(mailbox.publish());
+    mailbox.write_slot().first = 2;
+    // the first value was never taken.
+    EXPECT_FALSE(mailbox.publish());
+
+    const auto *value = mailbox.take();
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(value->first, 2);
+    EXPECT_EQ(mailbox.take(), nullptr);
+}
+
+TEST(test_preview_tap, test_mailbox_never_blocks_on_a_stalled_consumer)
+{
+    cam_mailbox<test_value> mailbox;
+    publish_value(mailbox, 1);
+
+    // the consumer holds on to its value, while the producer keeps publishing.
+    const auto *held = mailbox.take();
+    ASSERT_NE(held, nullptr);
+    for (int64_t i = 2; i <= 10000; ++i)
+        publish_value(mailbox, i);
+
+    EXPECT_EQ(held->first, 1);
+    EXPECT_EQ(held->second, 1);
+
+    const auto *latest = mailbox.take();
+    ASSERT_NE(latest, nullptr);
+    EXPECT_EQ(latest->first, 10000);
+}
+
+TEST(test_preview_tap, test_mailbox_concurrent)
+{
+    constexpr int64_t value_count = 200000;
+    cam_mailbox<test_value> mailbox;
+
+    std::thread producer([&mailbox]() {
+        for (int64_t i = 1; i <= value_count; ++i)
+            publish_value(mailbox, i);
+    });
+
+    /* values are never torn and never go back in time */
+    int64_t last_value = 0;
+    while (last_value < value_count)
+    {
+        if (const auto *value = mailbox.take(); value != nullptr)
+        {
+            ASSERT_EQ(value->first, value->second);
+            ASSERT_GT(value->first, last_value);
+            last_value = value->first;
+        }
+    }
+    producer.join();
+}
+
+TEST(test_preview_tap, test_preview_is_downscaled)
+{
+    cam_preview_config config;
+    config.max_size = cam::size<int>(320, 180);
+    config.frame_interval = 2;
+    cam_preview_tap tap(config);
+
+    std::vector<uint8_t> data(640 * 360 * 4, 0x80);
+    cam_frame frame;
+    frame.bitmap_data = data.data();
+    frame.width = 640;
+    frame.height = 360;
+    frame.stride = 640 * 4;
+    frame.sequence = 1;
+    tap.offer(frame);
+
+    const auto *preview = wait_for_preview(tap);
+    ASSERT_NE(preview, nullptr);
+    EXPECT_EQ(preview->size, cam::size<int>(320, 180));
+    EXPECT_EQ(preview->sequence, 1u);
+    EXPECT_EQ(preview->data[(90 * preview->stride) + 160 * 4], 0x80);
+}
+
+TEST(test_preview_tap, test_every_nth_frame_is_previewed)
+{
+    cam_preview_config config;
+    config.frame_interval = 3;
+    cam_preview_tap tap(config);
+
+    std::vector<uint8_t> data(64 * 32 * 4, 0);
+    cam_frame frame;
+    frame.bitmap_data = data.data();
+    frame.width = 64;
+    frame.height = 32;
+    frame.stride = 64 * 4;
+
+    for (uint64_t sequence = 1; sequence <= 5; ++sequence)
+    {
+        frame.sequence = sequence;
+        tap.offer(frame);
+    }
+
+    /* frames 1 and 4 are copied, small frames are not scaled up */
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    uint64_t last_sequence = 0;
+    while (last_sequence != 4 && std::chrono::steady_clock::now() < deadline)
+    {
+        if (const auto *preview = tap.take_preview(); preview != nullptr)
+        {
+            EXPECT_EQ(preview->size, cam::size<int>(64, 32));
+            EXPECT_EQ((preview->sequence - 1) % 3, 0u);
+            last_sequence = preview->sequence;
+        }
+    }
+    EXPECT_EQ(last_sequence, 4u);
+    EXPECT_EQ(tap.get_offered_count(), 5);
+}
+
+TEST(test_preview_tap, test_offer_without_consumer)
+{
+    cam_preview_config config;
+    config.frame_interval = 1;
+    cam_preview_tap tap(config);
+
+    std::vector<uint8_t> data(256 * 256 * 4, 0);
+    cam_frame frame;
+    frame.bitmap_data = data.data();
+    frame.width = 256;
+    frame.height = 256;
+    frame.stride = 256 * 4;
+
+    // nobody takes the previews, offering must still never wait.
+    for (uint64_t sequence = 1; sequence <= 1000; ++sequence)
+    {
+        frame.sequence = sequence;
+        tap.offer(frame);
+    }
+    EXPECT_EQ(tap.get_offered_count(), 1000);
+}
+
+TEST(test_preview_tap, test_invalid_config)
+{
+    cam_preview_config config;
+    config.max_size = cam::size<int>(0, 0);
+    EXPECT_THROW(cam_preview_tap{config}, std::invalid_argument);
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_ring_buffer.h>
+
+TEST(test_ring_buffer, test_push_pop)
+{
+    cam_ring_buffer<int, 4> buffer;
+    EXPECT_TRUE(buffer.empty());
+
+    buffer.push_back(1);
+    buffer.push_back(2);
+    buffer.push_back(3);
+    ASSERT_EQ(buffer.size(), 3u);
+    EXPECT_EQ(buffer.front(), 1);
+    EXPECT_EQ(buffer[2], 3);
+
+    buffer.pop_front();
+    EXPECT_EQ(buffer.front(), 2);
+    EXPECT_EQ(buffer.size(), 2u);
+}
+
+TEST(test_ring_buffer, test_overwrite_oldest)
+{
+    cam_ring_buffer<int, 4> buffer;
+    for (int i = 0; i < 10; ++i)
+        buffer.push_back(i);
+
+    ASSERT_EQ(buffer.size(), buffer.capacity());
+    for (std::size_t i = 0; i < buffer.size(); ++i)
+        EXPECT_EQ(buffer[i], static_cast<int>(6 + i));
+}
+
+TEST(test_ring_buffer, test_wrap_around)
+{
+    cam_ring_buffer<int, 3> buffer;
+    for (int i = 0; i < 100; ++i)
+    {
+        buffer.push_back(i);
+        buffer.push_back(i + 1000);
+        EXPECT_EQ(buffer.front(), i);
+        buffer.pop_front();
+        buffer.pop_front();
+        EXPECT_TRUE(buffer.empty());
+    }
+}
+
+TEST(test_ring_buffer, test_clear)
+{
+    cam_ring_buffer<int, 3> buffer;
+    buffer.push_back(1);
+    buffer.push_back(2);
+    buffer.clear();
+    EXPECT_TRUE(buffer.empty());
+
+    buffer.push_back(3);
+    EXPECT_EQ(buffer.front(), 3);
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_scale.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+static auto create_random_image(const cam::size<int> &size, std::mt19937 &random) -> std::vector<uint8_t>
+{
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<uint8_t> image(static_cast<size_t>(size.width()) * size.height() * 4);
+    for (auto &value : image)
+        value = static_cast<uint8_t>(distribution(random));
+    return image;
+}
+
+static auto scale_image(const std::vector<uint8_t> &src, const cam::size<int> &src_size,
+                        const cam::size<int> &dst_size, const cam::scale_filter filter,
+                        const cam::scale_kernel kernel = cam::scale_kernel::scalar) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> dst(static_cast<size_t>(dst_size.width()) * dst_size.height() * 4);
+    cam_scaler scaler(src_size, dst_size, filter, kernel);
+    scaler.scale(src.data(), src_size.width() * 4, dst.data(), dst_size.width() * 4);
+    return dst;
+}
+
+TEST(test_scale, test_same_size_is_a_copy)
+{
+    std::mt19937 random(42);
+    const cam::size<int> size(37, 23);
+    const auto src = create_random_image(size, random);
+
+    for (const auto filter : {cam::scale_filter::bilinear, cam::scale_filter::area})
+        EXPECT_EQ(scale_image(src, size, size, filter), src);
+}
+
+TEST(test_scale, test_flat_color_stays_flat)
+{
+    const cam::size<int> src_size(192, 108);
+    const std::vector<uint8_t> pixel = {0x12, 0x34, 0x56, 0xff};
+    std::vector<uint8_t> src;
+    for (int i = 0; i < src_size.width() * src_size.height(); ++i)
+        src.insert(src.end(), pixel.begin(), pixel.end());
+
+    for (const auto filter : {cam::scale_filter::bilinear, cam::scale_filter::area})
+    {
+        for (const auto dst_size : {cam::size<int>(128, 72), cam::size<int>(333, 177), cam::size<int>(7, 5)})
+        {
+            const auto dst = scale_image(src, src_size, dst_size, filter);
+            for (size_t i = 0; i < dst.size(); ++i)
+                ASSERT_EQ(dst[i], pixel[i % 4]);
+        }
+    }
+}
+
+TEST(test_scale, test_area_averages)
+{
+    // a black and white checkerboard averages to gray.
+    const cam::size<int> src_size(64, 64);
+    std::vector<uint8_t> src(64 * 64 * 4);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x)
+            std::fill_n(src.begin() + (y * 64 + x) * 4, 4, static_cast<uint8_t>((x + y) % 2 ? 255 : 0));
+
+    for (const auto dst_size : {cam::size<int>(32, 32), cam::size<int>(16, 16), cam::size<int>(8, 8)})
+    {
+        const auto dst = scale_image(src, src_size, dst_size, cam::scale_filter::area);
+        for (const auto value : dst)
+            ASSERT_NEAR(value, 128, 1);
+    }
+}
+
+TEST(test_scale, test_bilinear_gradient)
+{
+    // a horizontal gradient stays a (monotonic) gradient when scaled up.
+    const cam::size<int> src_size(16, 1);
+    std::vector<uint8_t> src;
+    for (int x = 0; x < 16; ++x)
+        src.insert(src.end(), 4, static_cast<uint8_t>(x * 16));
+
+    const auto dst = scale_image(src, src_size, cam::size<int>(64, 1), cam::scale_filter::bilinear);
+    for (int x = 1; x < 64; ++x)
+        EXPECT_GE(dst[x * 4], dst[(x - 1) * 4]);
+
+    EXPECT_EQ(dst[0], 0);
+    EXPECT_EQ(dst[63 * 4], 240);
+}
+
+TEST(test_scale, test_kernels_are_bit_identical)
+{
+    if (!cam::is_scale_kernel_supported(cam::scale_kernel::sse2))
+        GTEST_SKIP();
+
+    std::mt19937 random(7);
+    const std::vector<std::pair<cam::size<int>, cam::size<int>>> sizes = {
+        {{64, 48}, {64, 48}},
+        {{1920, 1080}, {1280, 720}},
+        {{1280, 720}, {1920, 1080}},
+        {{101, 67}, {13, 9}},
+        {{17, 11}, {51, 37}},
+    };
+
+    for (const auto &[src_size, dst_size] : sizes)
+    {
+        const auto src = create_random_image(src_size, random);
+        for (const auto filter : {cam::scale_filter::bilinear, cam::scale_filter::area})
+        {
+            const auto expected = scale_image(src, src_size, dst_size, filter, cam::scale_kernel::scalar);
+            const auto actual = scale_image(src, src_size, dst_size, filter, cam::scale_kernel::sse2);
+            ASSERT_EQ(expected, actual) << src_size.width() << "x" << src_size.height() << " -> "
+                << dst_size.width() << "x" << dst_size.height() << " filter " << static_cast<int>(filter);
+        }
+    }
+}
+
+TEST(test_scale, test_invalid_size)
+{
+    EXPECT_THROW(cam_scaler(cam::size<int>(0, 10), cam::size<int>(10, 10), cam::scale_filter::bilinear),
+        std::invalid_argument);
+    EXPECT_THROW(cam_scaler(cam::size<int>(10, 10), cam::size<int>(10, 0), cam::scale_filter::area),
+        std::invalid_argument);
+}
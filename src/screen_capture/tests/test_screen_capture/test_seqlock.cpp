@@ -0,0 +1,106 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_seqlock.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/* an odd sized value, so the last word is only partially used */
+struct test_snapshot
+{
+    int64_t values[5]{};
+    double rate{0.0};
+    int32_t depth{0};
+};
+
+static auto create_snapshot(int64_t value) -> test_snapshot
+{
+    test_snapshot snapshot;
+    for (auto &v : snapshot.values)
+        v = value;
+    snapshot.rate = static_cast<double>(value) * 0.5;
+    snapshot.depth = static_cast<int32_t>(value);
+    return snapshot;
+}
+
+static bool is_consistent(const test_snapshot &snapshot)
+{
+    for (const auto v : snapshot.values)
+    {
+        if (v != snapshot.values[0])
+            return false;
+    }
+    return snapshot.rate == static_cast<double>(snapshot.values[0]) * 0.5
+        && snapshot.depth == static_cast<int32_t>(snapshot.values[0]);
+}
+
+TEST(test_seqlock, test_store_and_load)
+{
+    cam_seqlock<test_snapshot> seqlock;
+    EXPECT_EQ(seqlock.load().values[0], 0);
+
+    const auto version = seqlock.get_version();
+    seqlock.store(create_snapshot(42));
+    EXPECT_NE(seqlock.get_version(), version);
+
+    const auto snapshot = seqlock.load();
+    EXPECT_TRUE(is_consistent(snapshot));
+    EXPECT_EQ(snapshot.values[4], 42);
+    EXPECT_EQ(snapshot.depth, 42);
+
+    test_snapshot copy;
+    EXPECT_TRUE(seqlock.try_load(copy));
+    EXPECT_EQ(copy.values[0], 42);
+}
+
+TEST(test_seqlock, test_concurrent_readers)
+{
+    constexpr int64_t store_count = 200000;
+    cam_seqlock<test_snapshot> seqlock;
+    std::atomic<bool> done{false};
+
+    /* the readers only ever see complete snapshots, that never go back in time */
+    std::vector<std::thread> readers;
+    std::atomic<int> failures{0};
+    for (int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back([&]() {
+            int64_t last_value = 0;
+            while (!done)
+            {
+                const auto snapshot = seqlock.load();
+                if (!is_consistent(snapshot) || snapshot.values[0] < last_value)
+                    ++failures;
+                last_value = snapshot.values[0];
+            }
+        });
+    }
+
+    // the writer never waits for the readers.
+    for (int64_t i = 1; i <= store_count; ++i)
+        seqlock.store(create_snapshot(i));
+
+    done = true;
+    for (auto &reader : readers)
+        reader.join();
+
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(seqlock.load().values[0], store_count);
+}
@@ -0,0 +1,100 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_ring_animation.h>
+#include <screen_capture/cam_sprite_atlas.h>
+#include <stdexcept>
+
+static bool is_equal(const cam_sprite &sprite, const cam_sprite_view &view)
+{
+    if (sprite.width() != view.width || sprite.height() != view.height)
+        return false;
+
+    for (int y = 0; y < sprite.height(); ++y)
+        for (int x = 0; x < sprite.width(); ++x)
+            if (sprite.row(y)[x] != view.row(y)[x])
+                return false;
+    return true;
+}
+
+TEST(test_sprite_atlas, test_add_and_get)
+{
+    cam_sprite_atlas atlas(32);
+    const auto red = cam::create_filled_rect_sprite({20, 10}, cam::colors::red);
+    const auto green = cam::create_filled_rect_sprite({20, 5}, cam::colors::green);
+    const auto blue = cam::create_filled_rect_sprite({10, 8}, cam::colors::blue);
+
+    const auto red_index = atlas.add(red);
+    const auto green_index = atlas.add(green);
+    const auto blue_index = atlas.add(blue);
+
+    EXPECT_EQ(atlas.size(), 3);
+    EXPECT_TRUE(is_equal(red, atlas.get(red_index)));
+    EXPECT_TRUE(is_equal(green, atlas.get(green_index)));
+    EXPECT_TRUE(is_equal(blue, atlas.get(blue_index)));
+
+    // green does not fit next to red and starts a new shelf, blue fits next to green (10 + 8).
+    EXPECT_EQ(atlas.height(), 18);
+}
+
+TEST(test_sprite_atlas, test_too_wide_sprite)
+{
+    cam_sprite_atlas atlas(16);
+    EXPECT_THROW(atlas.add(cam::create_filled_rect_sprite({17, 1}, cam::colors::red)), std::invalid_argument);
+}
+
+TEST(test_sprite_atlas, test_clear)
+{
+    cam_sprite_atlas atlas;
+    atlas.add(cam::create_filled_rect_sprite({8, 8}, cam::colors::red));
+    atlas.clear();
+    EXPECT_EQ(atlas.size(), 0);
+    EXPECT_EQ(atlas.height(), 0);
+}
+
+TEST(test_ring_animation, test_frames_match_ring_sprites)
+{
+    const auto color = cam::color(0xff, 0xff, 0, 0);
+    cam_ring_animation animation;
+    animation.update(40, color, 1.5);
+    ASSERT_EQ(animation.get_frame_count(), 41);
+
+    for (const auto ring_size : {0, 1, 17, 40})
+        EXPECT_TRUE(is_equal(cam::create_ring_sprite(ring_size, 1.5, color), animation.get_frame(ring_size)));
+
+    // sizes outside the animation are clamped.
+    EXPECT_EQ(animation.get_frame(100).width, animation.get_frame(40).width);
+    EXPECT_EQ(animation.get_frame(-1).width, animation.get_frame(0).width);
+}
+
+TEST(test_ring_animation, test_update_on_config_change)
+{
+    cam_ring_animation animation;
+    EXPECT_EQ(animation.get_frame_count(), 0);
+    EXPECT_EQ(animation.get_frame(10).data, nullptr);
+
+    animation.update(10, cam::colors::red, 1.5);
+    const auto *frame_data = animation.get_frame(5).data;
+
+    // the same config keeps the rendered frames.
+    animation.update(10, cam::colors::red, 1.5);
+    EXPECT_EQ(animation.get_frame(5).data, frame_data);
+
+    animation.update(20, cam::colors::red, 1.5);
+    EXPECT_EQ(animation.get_frame_count(), 21);
+}
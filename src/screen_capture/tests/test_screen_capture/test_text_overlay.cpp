@@ -0,0 +1,211 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/annotations/cam_annotation_text.h>
+#include <screen_capture/cam_bitmap_font.h>
+#include <screen_capture/cam_canvas.h>
+#include <screen_capture/cam_rect.h>
+#include <screen_capture/cam_point.h>
+#include <screen_capture/cam_draw_data.h>
+#include <screen_capture/cam_text_overlay.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr auto white = 0xffffffffu;
+
+static bool is_equal(const cam_sprite &lhs, const cam_sprite &rhs)
+{
+    if (lhs.width() != rhs.width() || lhs.height() != rhs.height())
+        return false;
+
+    for (int y = 0; y < lhs.height(); ++y)
+        for (int x = 0; x < lhs.width(); ++x)
+            if (lhs.row(y)[x] != rhs.row(y)[x])
+                return false;
+    return true;
+}
+
+TEST(test_bitmap_font, test_render_glyph)
+{
+    cam_bitmap_font font(1);
+    EXPECT_EQ(font.get_line_height(), 9);
+    EXPECT_EQ(font.get_glyph_advance(), 6);
+
+    // the '1' glyph has a vertical bar in the center column, and a foot of 3 pixels.
+    const auto sprite = font.render_glyph(L'1', cam::colors::white);
+    ASSERT_EQ(sprite.width(), 6);
+    ASSERT_EQ(sprite.height(), 9);
+    EXPECT_EQ(sprite.row(0)[2], 0u);
+    EXPECT_EQ(sprite.row(1)[2], white);
+    EXPECT_EQ(sprite.row(4)[2], white);
+    EXPECT_EQ(sprite.row(4)[1], 0u);
+    EXPECT_EQ(sprite.row(7)[1], white);
+    EXPECT_EQ(sprite.row(7)[3], white);
+    EXPECT_EQ(sprite.row(8)[2], 0u);
+
+    // the spacing column is always empty.
+    for (int y = 0; y < sprite.height(); ++y)
+        EXPECT_EQ(sprite.row(y)[5], 0u);
+}
+
+TEST(test_bitmap_font, test_scale)
+{
+    cam_bitmap_font font(3);
+    const auto sprite = font.render_glyph(L'1', cam::colors::white);
+    ASSERT_EQ(sprite.width(), 18);
+    ASSERT_EQ(sprite.height(), 27);
+    EXPECT_EQ(sprite.row(3)[6], white);
+    EXPECT_EQ(sprite.row(5)[8], white);
+    EXPECT_EQ(sprite.row(2)[6], 0u);
+}
+
+TEST(test_bitmap_font, test_unknown_glyph)
+{
+    cam_bitmap_font font(1);
+    EXPECT_TRUE(is_equal(font.render_glyph(L'\x263a', cam::colors::white),
+        font.render_glyph(L'?', cam::colors::white)));
+    EXPECT_FALSE(is_equal(font.render_glyph(L' ', cam::colors::white),
+        font.render_glyph(L'?', cam::colors::white)));
+}
+
+TEST(test_text_overlay, test_glyphs_are_rendered_once)
+{
+    cam_bitmap_font font;
+    cam_text_overlay overlay(font, cam::colors::white);
+
+    overlay.set_text(L"00:00:00");
+    EXPECT_EQ(overlay.get_rendered_glyph_count(), 2);
+    EXPECT_EQ(overlay.get_composited_glyph_count(), 8);
+    EXPECT_EQ(overlay.get_sprite().width(), 8 * font.get_glyph_advance());
+
+    overlay.set_text(L"00:00:01");
+    EXPECT_EQ(overlay.get_rendered_glyph_count(), 3);
+    EXPECT_EQ(overlay.get_composited_glyph_count(), 9);
+
+    // the same text does not composite anything.
+    overlay.set_text(L"00:00:01");
+    EXPECT_EQ(overlay.get_composited_glyph_count(), 9);
+
+    overlay.set_text(L"00:00:10");
+    EXPECT_EQ(overlay.get_rendered_glyph_count(), 3);
+    EXPECT_EQ(overlay.get_composited_glyph_count(), 11);
+}
+
+TEST(test_text_overlay, test_incremental_update_matches_full_render)
+{
+    cam_bitmap_font font;
+    cam_text_overlay overlay(font, cam::colors::red);
+    overlay.set_text(L"frame 123");
+    overlay.set_text(L"frame 129");
+    overlay.set_text(L"frame 1290");
+    overlay.set_text(L"frame 42");
+
+    cam_text_overlay reference(font, cam::colors::red);
+    reference.set_text(L"frame 42");
+    EXPECT_TRUE(is_equal(overlay.get_sprite(), reference.get_sprite()));
+}
+
+TEST(test_text_overlay, test_set_color)
+{
+    cam_bitmap_font font(1);
+    cam_text_overlay overlay(font, cam::colors::white);
+    overlay.set_text(L"1");
+    EXPECT_EQ(overlay.get_sprite().row(1)[2], white);
+
+    overlay.set_color(cam::colors::red);
+    EXPECT_EQ(overlay.get_text(), L"1");
+    EXPECT_EQ(overlay.get_sprite().row(1)[2], 0xffff0000u);
+}
+
+TEST(test_text_overlay, test_draw)
+{
+    constexpr auto canvas_width = 64;
+    constexpr auto canvas_height = 16;
+    std::vector<uint32_t> pixels(canvas_width * canvas_height, 0xff000000);
+    cam_canvas canvas(reinterpret_cast<uint8_t *>(pixels.data()), canvas_width, canvas_height, canvas_width * 4);
+
+    cam_bitmap_font font(1);
+    cam_text_overlay overlay(font, cam::colors::white);
+    overlay.set_text(L"11");
+    overlay.draw(canvas, {10, 2});
+
+    EXPECT_EQ(canvas.get_dirty_rect(), cam::rect<int>(10, 2, 22, 11));
+    EXPECT_EQ(pixels[3 * canvas_width + 12], white);
+    EXPECT_EQ(pixels[3 * canvas_width + 18], white);
+    EXPECT_EQ(pixels[3 * canvas_width + 13], 0xff000000u);
+}
+
+TEST(test_annotation_text, test_format_recording_time)
+{
+    std::wstring text;
+    cam::format_recording_time(text, 0.0);
+    EXPECT_EQ(text, L"00:00:00.000");
+
+    text.clear();
+    cam::format_recording_time(text, 3723.0456);
+    EXPECT_EQ(text, L"01:02:03.045");
+}
+
+TEST(test_annotation_text, test_frame_number)
+{
+    std::vector<uint32_t> pixels(256 * 32, 0);
+    cam_canvas canvas(reinterpret_cast<uint8_t *>(pixels.data()), 256, 32, 256 * 4);
+    const cam::rect<int> canvas_rect(0, 0, 256, 32);
+    const point<int> mouse_pos(0, 0);
+
+    cam_annotation_text annotation(cam_text_overlay_type::frame_number, {0, 0}, cam::colors::white,
+        std::make_unique<cam_bitmap_font>());
+
+    for (int i = 0; i < 12; ++i)
+        annotation.draw(canvas, cam_draw_data(1.0 / 30.0, canvas_rect, mouse_pos, cam_mouse_button::none));
+
+    EXPECT_EQ(annotation.get_overlay().get_text(), L"11");
+}
+
+TEST(test_annotation_text, test_recording_time)
+{
+    std::vector<uint32_t> pixels(256 * 32, 0);
+    cam_canvas canvas(reinterpret_cast<uint8_t *>(pixels.data()), 256, 32, 256 * 4);
+    const cam::rect<int> canvas_rect(0, 0, 256, 32);
+    const point<int> mouse_pos(0, 0);
+
+    cam_annotation_text annotation(cam_text_overlay_type::recording_time, {0, 0}, cam::colors::white,
+        std::make_unique<cam_bitmap_font>());
+
+    for (int i = 0; i < 31; ++i)
+        annotation.draw(canvas, cam_draw_data(0.25, canvas_rect, mouse_pos, cam_mouse_button::none));
+
+    EXPECT_EQ(annotation.get_overlay().get_text(), L"00:00:07.500");
+}
+
+TEST(test_annotation_text, test_watermark)
+{
+    std::vector<uint32_t> pixels(256 * 32, 0);
+    cam_canvas canvas(reinterpret_cast<uint8_t *>(pixels.data()), 256, 32, 256 * 4);
+    const cam::rect<int> canvas_rect(0, 0, 256, 32);
+    const point<int> mouse_pos(0, 0);
+
+    cam_annotation_text annotation(cam_text_overlay_type::watermark, {0, 0}, cam::colors::white,
+        std::make_unique<cam_bitmap_font>(), L"CamStudio");
+    annotation.draw(canvas, cam_draw_data(0.0, canvas_rect, mouse_pos, cam_mouse_button::none));
+
+    EXPECT_EQ(annotation.get_overlay().get_text(), L"CamStudio");
+    EXPECT_EQ(annotation.get_overlay().get_rendered_glyph_count(), 9);
+    EXPECT_FALSE(canvas.get_dirty_rect().empty());
+}
@@ -0,0 +1,273 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_lazy_cache.h>
+#include <screen_capture/cam_window_list.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <string>
+
+/* a fake desktop, windows can be added, renamed and removed without sending the events. */
+class fake_window_source : public cam_window_source
+{
+public:
+    auto enumerate() -> std::vector<cam_window_info> override
+    {
+        ++enumerate_count_;
+        std::vector<cam_window_info> result;
+        for (auto itr = windows_.rbegin(); itr != windows_.rend(); ++itr)
+            result.push_back(itr->second);
+        return result;
+    }
+
+    auto query(const cam_window_id id) -> std::optional<cam_window_info> override
+    {
+        ++query_count_;
+        const auto itr = windows_.find(id);
+        if (itr == windows_.end())
+            return std::nullopt;
+        return itr->second;
+    }
+
+    void add(const cam_window_id id, const std::wstring &title)
+    {
+        windows_[id] = cam_window_info{id, 1000 + static_cast<uint32_t>(id), L"app.exe", L"c:\\app.exe", title};
+    }
+
+    void rename(const cam_window_id id, const std::wstring &title)
+    {
+        windows_.at(id).title = title;
+    }
+
+    void remove(const cam_window_id id)
+    {
+        windows_.erase(id);
+    }
+
+    int enumerate_count_{0};
+    int query_count_{0};
+
+private:
+    std::map<cam_window_id, cam_window_info> windows_;
+};
+
+static auto get_ids(const cam_window_list &list) -> std::vector<cam_window_id>
+{
+    std::vector<cam_window_id> ids;
+    for (const auto &window : list.get_windows())
+        ids.push_back(window.id);
+    return ids;
+}
+
+TEST(test_window_list, test_populate)
+{
+    fake_window_source source;
+    source.add(1, L"one");
+    source.add(2, L"two");
+
+    cam_window_list list(source);
+    list.populate();
+
+    EXPECT_EQ(list.size(), 2u);
+    EXPECT_EQ(get_ids(list), (std::vector<cam_window_id>{2, 1}));
+    EXPECT_EQ(source.enumerate_count_, 1);
+}
+
+TEST(test_window_list, test_created_window_is_added_on_top)
+{
+    fake_window_source source;
+    source.add(1, L"one");
+    cam_window_list list(source);
+    list.populate();
+    const auto revision = list.get_revision();
+
+    source.add(3, L"three");
+    const auto change = list.apply({cam_window_event_type::created, 3});
+
+    ASSERT_TRUE(change);
+    EXPECT_EQ(change->type, cam_window_change_type::added);
+    EXPECT_EQ(change->window.title, L"three");
+    EXPECT_EQ(get_ids(list), (std::vector<cam_window_id>{3, 1}));
+    EXPECT_GT(list.get_revision(), revision);
+
+    // only the new window was queried, nothing was enumerated again.
+    EXPECT_EQ(source.enumerate_count_, 1);
+    EXPECT_EQ(source.query_count_, 1);
+}
+
+TEST(test_window_list, test_created_non_candidate_is_ignored)
+{
+    fake_window_source source;
+    cam_window_list list(source);
+    list.populate();
+    const auto revision = list.get_revision();
+
+    // the source does not know window 7, a.e. it is a tool window.
+    EXPECT_FALSE(list.apply({cam_window_event_type::created, 7}));
+    EXPECT_EQ(list.size(), 0u);
+    EXPECT_EQ(list.get_revision(), revision);
+}
+
+TEST(test_window_list, test_destroyed_window_is_removed)
+{
+    fake_window_source source;
+    source.add(1, L"one");
+    source.add(2, L"two");
+    source.add(3, L"three");
+    cam_window_list list(source);
+    list.populate();
+
+    source.remove(2);
+    const auto change = list.apply({cam_window_event_type::destroyed, 2});
+    ASSERT_TRUE(change);
+    EXPECT_EQ(change->type, cam_window_change_type::removed);
+    EXPECT_EQ(change->window.id, 2u);
+    EXPECT_EQ(get_ids(list), (std::vector<cam_window_id>{3, 1}));
+
+    // the index is still valid after the removal.
+    source.remove(1);
+    ASSERT_TRUE(list.apply({cam_window_event_type::destroyed, 1}));
+    EXPECT_EQ(get_ids(list), (std::vector<cam_window_id>{3}));
+
+    // destroying an unknown window does not query the source.
+    const auto query_count = source.query_count_;
+    EXPECT_FALSE(list.apply({cam_window_event_type::destroyed, 42}));
+    EXPECT_EQ(source.query_count_, query_count);
+}
+
+TEST(test_window_list, test_renamed_window_is_updated)
+{
+    fake_window_source source;
+    source.add(1, L"one");
+    source.add(2, L"two");
+    cam_window_list list(source);
+    list.populate();
+
+    source.rename(1, L"uno");
+    const auto change = list.apply({cam_window_event_type::renamed, 1});
+    ASSERT_TRUE(change);
+    EXPECT_EQ(change->type, cam_window_change_type::updated);
+    EXPECT_EQ(list.get_windows().at(1).title, L"uno");
+
+    // the position in the list does not change.
+    EXPECT_EQ(get_ids(list), (std::vector<cam_window_id>{2, 1}));
+
+    // a rename to the same title is not a change.
+    EXPECT_FALSE(list.apply({cam_window_event_type::renamed, 1}));
+}
+
+TEST(test_window_list, test_renamed_unknown_window_is_ignored)
+{
+    fake_window_source source;
+    cam_window_list list(source);
+    list.populate();
+
+    source.add(5, L"five");
+    EXPECT_FALSE(list.apply({cam_window_event_type::renamed, 5}));
+    EXPECT_EQ(source.query_count_, 0);
+    EXPECT_EQ(list.size(), 0u);
+}
+
+TEST(test_window_list, test_window_that_is_no_candidate_anymore)
+{
+    fake_window_source source;
+    source.add(1, L"one");
+    cam_window_list list(source);
+    list.populate();
+
+    // a.e. the window changed its style while being renamed.
+    source.remove(1);
+    const auto change = list.apply({cam_window_event_type::renamed, 1});
+    ASSERT_TRUE(change);
+    EXPECT_EQ(change->type, cam_window_change_type::removed);
+    EXPECT_EQ(list.size(), 0u);
+}
+
+TEST(test_window_list, test_resync_applies_differences)
+{
+    fake_window_source source;
+    source.add(1, L"one");
+    source.add(2, L"two");
+    source.add(3, L"three");
+    cam_window_list list(source);
+    list.populate();
+
+    // changes without events, a.e. missed while the hook was not installed.
+    source.remove(1);
+    source.rename(2, L"deux");
+    source.add(4, L"four");
+
+    auto changes = list.resync();
+    std::sort(changes.begin(), changes.end(),
+        [](const auto &lhs, const auto &rhs) { return lhs.window.id < rhs.window.id; });
+
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[0].type, cam_window_change_type::removed);
+    EXPECT_EQ(changes[0].window.id, 1u);
+    EXPECT_EQ(changes[1].type, cam_window_change_type::updated);
+    EXPECT_EQ(changes[1].window.title, L"deux");
+    EXPECT_EQ(changes[2].type, cam_window_change_type::added);
+    EXPECT_EQ(changes[2].window.id, 4u);
+    EXPECT_EQ(get_ids(list), (std::vector<cam_window_id>{4, 3, 2}));
+
+    const auto revision = list.get_revision();
+    EXPECT_TRUE(list.resync().empty());
+    EXPECT_EQ(list.get_revision(), revision);
+}
+
+TEST(test_lazy_cache, test_load_once)
+{
+    std::atomic<int> load_count{0};
+    std::atomic<int> loaded_count{0};
+    cam_lazy_cache<std::wstring, int> cache(
+        [&load_count](const std::wstring &key) { ++load_count; return static_cast<int>(key.size()); },
+        [&loaded_count](const std::wstring &) { ++loaded_count; });
+
+    EXPECT_FALSE(cache.get(L"c:\\app.exe"));
+    cache.wait_idle();
+
+    ASSERT_TRUE(cache.get(L"c:\\app.exe"));
+    EXPECT_EQ(*cache.get(L"c:\\app.exe"), 10);
+    EXPECT_EQ(load_count, 1);
+    EXPECT_EQ(loaded_count, 1);
+}
+
+TEST(test_lazy_cache, test_many_keys)
+{
+    std::atomic<int> load_count{0};
+    cam_lazy_cache<int, int> cache([&load_count](const int &key) { ++load_count; return key * 2; });
+
+    for (int i = 0; i < 100; ++i)
+        cache.get(i % 10);
+    cache.wait_idle();
+
+    EXPECT_EQ(cache.size(), 10u);
+    EXPECT_EQ(load_count, 10);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(cache.get(i).value_or(-1), i * 2);
+}
+
+TEST(test_lazy_cache, test_loader_throws)
+{
+    cam_lazy_cache<int, int> cache([](const int &) -> int { throw std::runtime_error("no icon"); });
+
+    cache.get(1);
+    cache.wait_idle();
+    EXPECT_EQ(cache.get(1).value_or(-1), 0);
+}
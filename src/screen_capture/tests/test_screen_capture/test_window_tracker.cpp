@@ -0,0 +1,167 @@
+/**
+ * Copyright(C) 2018 - 2020  Steven Hoving
+ *
+ * This program is free software : you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <screen_capture/cam_window_tracker.h>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+static auto create_test_config() -> cam_window_tracker_config
+{
+    cam_window_tracker_config config;
+    config.output_size = cam::size<int>(192, 108);
+    config.max_size = cam::size<int>(400, 300);
+    return config;
+}
+
+static auto create_window(const cam::size<int> &size, uint8_t value) -> std::vector<uint8_t>
+{
+    return std::vector<uint8_t>(static_cast<size_t>(size.width()) * size.height() * 4, value);
+}
+
+static auto get_output_pixel(const cam_window_tracker &tracker, int x, int y) -> uint8_t
+{
+    return tracker.get_output_data()[static_cast<size_t>(y) * tracker.get_output_stride() + x * 4];
+}
+
+TEST(test_window_tracker, test_fit_same_aspect_ratio)
+{
+    const cam::size<int> output(1920, 1080);
+    EXPECT_EQ(cam::fit_rect({1280, 720}, output, cam_fit_mode::letterbox), cam::rect<int>(0, 0, 1920, 1080));
+    EXPECT_EQ(cam::fit_rect({3840, 2160}, output, cam_fit_mode::shrink), cam::rect<int>(0, 0, 1920, 1080));
+}
+
+TEST(test_window_tracker, test_fit_pillarbox_and_letterbox)
+{
+    const cam::size<int> output(1920, 1080);
+    // 4:3 gets bars left and right.
+    EXPECT_EQ(cam::fit_rect({1024, 768}, output, cam_fit_mode::letterbox), cam::rect<int>(240, 0, 1680, 1080));
+    // a tall window.
+    EXPECT_EQ(cam::fit_rect({500, 1000}, output, cam_fit_mode::letterbox), cam::rect<int>(690, 0, 1230, 1080));
+    // a wide window gets bars above and below.
+    EXPECT_EQ(cam::fit_rect({2000, 500}, output, cam_fit_mode::letterbox), cam::rect<int>(0, 300, 1920, 780));
+}
+
+TEST(test_window_tracker, test_fit_shrink_does_not_scale_up)
+{
+    const cam::size<int> output(1920, 1080);
+    EXPECT_EQ(cam::fit_rect({800, 600}, output, cam_fit_mode::shrink), cam::rect<int>(560, 240, 1360, 840));
+    EXPECT_EQ(cam::fit_rect({800, 600}, output, cam_fit_mode::letterbox), cam::rect<int>(240, 0, 1680, 1080));
+    // larger than the output, only one side fits.
+    EXPECT_EQ(cam::fit_rect({1024, 1536}, output, cam_fit_mode::shrink), cam::rect<int>(600, 0, 1320, 1080));
+}
+
+TEST(test_window_tracker, test_fit_degenerate_sizes)
+{
+    const cam::size<int> output(1920, 1080);
+    EXPECT_TRUE(cam::fit_rect({0, 0}, output, cam_fit_mode::letterbox).empty());
+    EXPECT_TRUE(cam::fit_rect({100, 0}, output, cam_fit_mode::letterbox).empty());
+
+    // a one pixel wide window keeps at least one pixel.
+    const auto rect = cam::fit_rect({1, 100000}, output, cam_fit_mode::letterbox);
+    EXPECT_EQ(rect.width(), 1);
+    EXPECT_EQ(rect.height(), 1080);
+}
+
+TEST(test_window_tracker, test_update_only_reports_changes)
+{
+    cam_window_tracker tracker(create_test_config());
+    EXPECT_TRUE(tracker.update({200, 150}));
+    EXPECT_FALSE(tracker.update({200, 150}));
+    EXPECT_TRUE(tracker.update({250, 150}));
+
+    // a minimized window has no size, that is a change once.
+    EXPECT_TRUE(tracker.update({0, 0}));
+    EXPECT_FALSE(tracker.update({0, 0}));
+    EXPECT_TRUE(tracker.get_content_rect().empty());
+}
+
+TEST(test_window_tracker, test_capture_size_is_clamped_to_max_size)
+{
+    cam_window_tracker tracker(create_test_config());
+    tracker.update({1000, 200});
+    EXPECT_EQ(tracker.get_capture_size(), cam::size<int>(400, 200));
+
+    // growing beyond the max size in both directions stays at max size.
+    tracker.update({1000, 1000});
+    EXPECT_EQ(tracker.get_capture_size(), cam::size<int>(400, 300));
+    EXPECT_FALSE(tracker.update({2000, 2000}));
+}
+
+TEST(test_window_tracker, test_output_never_changes_on_resize)
+{
+    cam_window_tracker tracker(create_test_config());
+    const auto *output_data = tracker.get_output_data();
+
+    for (const auto &window_size : {cam::size<int>(100, 100), cam::size<int>(400, 100), cam::size<int>(37, 291)})
+    {
+        tracker.update(window_size);
+        const auto window = create_window(tracker.get_capture_size(), 200);
+        tracker.render(window.data(), tracker.get_capture_size().width() * 4);
+
+        EXPECT_EQ(tracker.get_output_size(), cam::size<int>(192, 108));
+        EXPECT_EQ(tracker.get_output_stride(), 192 * 4);
+        EXPECT_EQ(tracker.get_output_data(), output_data);
+    }
+}
+
+TEST(test_window_tracker, test_render_letterbox)
+{
+    cam_window_tracker tracker(create_test_config());
+
+    // a wide window covers the whole output first.
+    tracker.update({384, 216});
+    const auto wide_window = create_window({384, 216}, 200);
+    tracker.render(wide_window.data(), 384 * 4);
+    EXPECT_EQ(get_output_pixel(tracker, 0, 54), 200);
+    EXPECT_EQ(get_output_pixel(tracker, 191, 54), 200);
+
+    // the window is resized to a square, the old content next to it must be cleared.
+    tracker.update({108, 108});
+    EXPECT_EQ(tracker.get_content_rect(), cam::rect<int>(42, 0, 150, 108));
+    const auto square_window = create_window({108, 108}, 100);
+    tracker.render(square_window.data(), 108 * 4);
+    EXPECT_EQ(get_output_pixel(tracker, 0, 54), 0);
+    EXPECT_EQ(get_output_pixel(tracker, 41, 54), 0);
+    EXPECT_EQ(get_output_pixel(tracker, 42, 54), 100);
+    EXPECT_EQ(get_output_pixel(tracker, 149, 54), 100);
+    EXPECT_EQ(get_output_pixel(tracker, 150, 54), 0);
+}
+
+TEST(test_window_tracker, test_render_minimized_window)
+{
+    cam_window_tracker tracker(create_test_config());
+    tracker.update({192, 108});
+    const auto window = create_window({192, 108}, 200);
+    tracker.render(window.data(), 192 * 4);
+
+    tracker.update({0, 0});
+    tracker.render(nullptr, 0);
+    EXPECT_EQ(get_output_pixel(tracker, 96, 54), 0);
+}
+
+TEST(test_window_tracker, test_invalid_config)
+{
+    auto config = create_test_config();
+    config.output_size = cam::size<int>(0, 100);
+    EXPECT_THROW(cam_window_tracker{config}, std::invalid_argument);
+
+    config = create_test_config();
+    config.max_size = cam::size<int>(100, 0);
+    EXPECT_THROW(cam_window_tracker{config}, std::invalid_argument);
+}